@@ -0,0 +1,277 @@
+#include "event_loop.hh"
+#include "http_client.hh"
+#include "resolver.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+struct Results
+{
+  uint64_t ok {};                 // 2xx responses
+  uint64_t not_ok {};             // other complete responses
+  uint64_t failed {};             // requests lost to a failed or closed connection
+  uint64_t connections {};        // connections opened
+  uint64_t body_bytes {};         // of the complete responses
+  vector<double> latencies_ms {}; // of the complete responses
+
+  void merge( Results& other )
+  {
+    ok += other.ok;
+    not_ok += other.not_ok;
+    failed += other.failed;
+    connections += other.connections;
+    body_bytes += other.body_bytes;
+    latencies_ms.insert( latencies_ms.end(), other.latencies_ms.begin(), other.latencies_ms.end() );
+  }
+};
+
+// Keeps `connections` connections busy from one thread, each sending its next request as soon as the previous
+// response is complete, until the deadline passes or the shared request budget runs out. A connection the
+// server won't reuse (or that fails) is replaced.
+class LoadWorker
+{
+  struct Connection
+  {
+    unique_ptr<AsyncHTTPConnection> http {};
+    Clock::time_point sent {};
+  };
+
+  const Address& address_;
+  const string& request_;
+  optional<Clock::time_point> deadline_;
+  atomic<uint64_t>& budget_; // requests left to send, shared by all workers...
+  bool limited_;             // ...if there is a limit
+
+  EventLoop loop_ {};
+  vector<unique_ptr<Connection>> connections_ {};
+  size_t active_ {}; // connections with a request outstanding
+  Results results_ {};
+
+  // May another request be sent?
+  bool claim()
+  {
+    if ( deadline_ and Clock::now() >= *deadline_ ) {
+      return false;
+    }
+    if ( not limited_ ) {
+      return true;
+    }
+    uint64_t left = budget_.load();
+    while ( left > 0 and not budget_.compare_exchange_weak( left, left - 1 ) ) {}
+    return left > 0;
+  }
+
+  void send( Connection& c )
+  {
+    c.http->send( request_ );
+    c.sent = Clock::now();
+    c.http->update( loop_ );
+  }
+
+  // Open a fresh connection for `c` and send on it (or retire it if nothing is left to send)
+  void reconnect( Connection& c )
+  {
+    if ( c.http ) {
+      c.http->unwatch( loop_ );
+      c.http.reset();
+    }
+    if ( not claim() ) {
+      --active_;
+      return;
+    }
+    c.http = make_unique<AsyncHTTPConnection>( address_ );
+    ++results_.connections;
+    c.http->watch( loop_, [this, &c]( uint32_t events ) { on_event( c, events ); } );
+    send( c );
+  }
+
+  void on_event( Connection& c, uint32_t events )
+  {
+    try {
+      if ( not c.http->on_event( events, []( string_view ) {} ) ) {
+        c.http->update( loop_ );
+        return;
+      }
+    } catch ( const exception& ) {
+      ++results_.failed;
+      reconnect( c );
+      return;
+    }
+
+    results_.latencies_ms.push_back( chrono::duration<double, milli>( Clock::now() - c.sent ).count() );
+    results_.body_bytes += c.http->response().body_bytes();
+    const unsigned status = c.http->response().head().status_code;
+    ++( status >= 200 and status < 300 ? results_.ok : results_.not_ok );
+
+    if ( not c.http->reusable() ) {
+      reconnect( c );
+    } else if ( claim() ) {
+      send( c );
+    } else {
+      c.http->unwatch( loop_ );
+      c.http.reset();
+      --active_;
+    }
+  }
+
+public:
+  LoadWorker( const Address& address,
+              const string& request,
+              optional<Clock::time_point> deadline,
+              atomic<uint64_t>& budget,
+              bool limited )
+    : address_( address ), request_( request ), deadline_( deadline ), budget_( budget ), limited_( limited )
+  {}
+
+  Results run( size_t connections )
+  {
+    for ( size_t i = 0; i < connections; ++i ) {
+      connections_.push_back( make_unique<Connection>() );
+      ++active_;
+      reconnect( *connections_.back() );
+    }
+
+    while ( active_ > 0 ) {
+      int timeout_ms = -1;
+      if ( deadline_ ) {
+        const auto left = chrono::ceil<chrono::milliseconds>( *deadline_ - Clock::now() );
+        if ( left.count() <= 0 ) {
+          break; // abandon the requests still outstanding
+        }
+        timeout_ms = static_cast<int>( left.count() );
+      }
+      loop_.wait_next_event( timeout_ms );
+    }
+    return move( results_ );
+  }
+};
+
+void report( Results& results, Clock::duration elapsed )
+{
+  const double seconds = chrono::duration<double>( elapsed ).count();
+  const uint64_t responses = results.ok + results.not_ok;
+  cout << fixed << setprecision( 3 );
+  cout << responses << " responses (" << results.ok << " 2xx), " << results.failed << " failed, over "
+       << results.connections << " connections in " << seconds << " s ("
+       << static_cast<double>( responses ) / seconds << " requests/s)\n";
+  cout << results.body_bytes << " body bytes (" << static_cast<double>( results.body_bytes ) * 8 / seconds / 1e6
+       << " Mbit/s)\n";
+
+  auto& latencies = results.latencies_ms;
+  if ( latencies.empty() ) {
+    return;
+  }
+  ranges::sort( latencies );
+  const auto percentile = [&]( double p ) {
+    const auto rank = static_cast<size_t>( ceil( p * static_cast<double>( latencies.size() ) ) );
+    return latencies.at( max( rank, size_t { 1 } ) - 1 );
+  };
+  cout << "latency (ms): min " << latencies.front() << ", p50 " << percentile( 0.5 ) << ", p90 "
+       << percentile( 0.9 ) << ", p99 " << percentile( 0.99 ) << ", max " << latencies.back() << "\n";
+}
+
+void usage( const char* argv0 )
+{
+  cerr << "Usage: " << argv0
+       << " [--connections N] [--threads N] [--duration SECONDS] [--requests N] [--keep-alive 0|1] URL\n"
+          "\tRequests the http:// URL over N persistent connections (default 16, spread across the threads)\n"
+          "\tfor the duration (default 10 s) or until N requests have been sent, and reports throughput and\n"
+          "\tlatency percentiles. With --keep-alive 0, each request asks for its connection to be closed.\n";
+}
+
+} // namespace
+
+int main( int argc, char* argv[] )
+{
+  try {
+    if ( argc <= 0 ) {
+      abort(); // For sticklers: don't try to access argv[0] if argc <= 0.
+    }
+
+    auto args = span( argv, argc );
+
+    unordered_map<string_view, uint64_t> options;
+    vector<string_view> urls;
+    for ( size_t i = 1; i < args.size(); ++i ) {
+      const string_view arg { args[i] };
+      if ( arg.starts_with( "--" ) and i + 1 < args.size() ) {
+        options[arg] = stoull( args[++i] );
+      } else {
+        urls.push_back( arg );
+      }
+    }
+    const auto option = [&]( string_view name ) -> optional<uint64_t> {
+      const auto it = options.find( name );
+      return it == options.end() ? nullopt : optional { it->second };
+    };
+    if ( urls.size() != 1 ) {
+      usage( args.front() );
+      return EXIT_FAILURE;
+    }
+
+    const URL url = URL::parse( urls.front() );
+    const Address address = Resolver::global().resolve( url.host, url.service );
+    string request = "GET " + url.path + " HTTP/1.1\r\nHost: " + url.host_header() + "\r\n";
+    if ( option( "--keep-alive" ).value_or( 1 ) == 0 ) {
+      request += "Connection: close\r\n";
+    }
+    request += "\r\n";
+
+    const size_t connections = max( option( "--connections" ).value_or( 16 ), uint64_t { 1 } );
+    const size_t threads = clamp( option( "--threads" ).value_or( 1 ), uint64_t { 1 }, uint64_t { connections } );
+    const optional<uint64_t> requests = option( "--requests" );
+    atomic<uint64_t> budget { requests.value_or( 0 ) };
+
+    const auto start = Clock::now();
+    optional<Clock::time_point> deadline;
+    if ( option( "--duration" ) or not requests ) {
+      deadline = start + chrono::seconds( option( "--duration" ).value_or( 10 ) );
+    }
+
+    vector<Results> results( threads );
+    vector<thread> workers;
+    for ( size_t i = 0; i < threads; ++i ) {
+      const size_t share = connections / threads + ( i < connections % threads ? 1 : 0 );
+      workers.emplace_back( [&, i, share] {
+        try {
+          results[i] = LoadWorker( address, request, deadline, budget, requests.has_value() ).run( share );
+        } catch ( const exception& e ) {
+          cerr << e.what() << "\n";
+        }
+      } );
+    }
+    for ( auto& worker : workers ) {
+      worker.join();
+    }
+    const auto elapsed = Clock::now() - start;
+
+    Results total;
+    for ( auto& r : results ) {
+      total.merge( r );
+    }
+    report( total, elapsed );
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
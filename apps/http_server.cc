@@ -0,0 +1,593 @@
+#include "event_loop.hh"
+#include "exception.hh"
+#include "sha256.hh"
+#include "socket.hh"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <csignal>
+#include <cstdlib>
+#include <fcntl.h>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+constexpr size_t kMaxRequestHead = 65536;
+constexpr size_t kOutputTarget = 65536; // generate response bytes this far ahead of the socket
+constexpr size_t kInputLimit = 1 << 20; // stop reading while this much of the request stream is unprocessed
+constexpr size_t kChunkSize = 16384;    // payload per chunk of a /chunked/ response
+constexpr int kListenBacklog = 1024;
+
+struct Options
+{
+  string root {};       // directory to serve files from (none if empty)
+  string hasher_key {}; // prefix hashed along with the word by /nph-hasher/
+};
+
+bool iequals( string_view a, string_view b )
+{
+  return ranges::equal( a, b, []( char x, char y ) { return tolower( x ) == tolower( y ); } );
+}
+
+// Parse all of `text` as a decimal number
+bool parse_number( string_view text, uint64_t& value )
+{
+  const auto [end, ec] = from_chars( text.data(), text.data() + text.size(), value );
+  return not text.empty() and ec == errc {} and end == text.data() + text.size();
+}
+
+// Body byte `i` of a generated response is 'a' + i % 26, so any range of it can be checked
+void append_pattern( string& out, uint64_t offset, size_t length )
+{
+  static const string block = [] {
+    string s( 26 * 2048, 0 );
+    for ( size_t i = 0; i < s.size(); ++i ) {
+      s[i] = static_cast<char>( 'a' + i % 26 );
+    }
+    return s;
+  }();
+
+  while ( length > 0 ) {
+    const size_t start = offset % block.size();
+    const size_t n = min( length, block.size() - start );
+    out.append( block, start, n );
+    offset += n;
+    length -= n;
+  }
+}
+
+// The parts of a GET or HEAD request this server looks at
+struct Request
+{
+  string_view method {};
+  string_view target {};
+  string_view version {};
+  bool keep_alive {};
+  optional<string_view> range {};
+
+  // Parse a request head (without its blank line); returns false if it is malformed
+  bool parse( string_view head )
+  {
+    const size_t eol = head.find( "\r\n" );
+    const string_view request_line = head.substr( 0, eol );
+    head.remove_prefix( eol == string_view::npos ? head.size() : eol + 2 );
+
+    const size_t sp1 = request_line.find( ' ' );
+    const size_t sp2 = request_line.rfind( ' ' );
+    if ( sp1 == string_view::npos or sp1 == sp2 ) {
+      return false;
+    }
+    method = request_line.substr( 0, sp1 );
+    target = request_line.substr( sp1 + 1, sp2 - sp1 - 1 );
+    version = request_line.substr( sp2 + 1 );
+    if ( not version.starts_with( "HTTP/1." ) ) {
+      return false;
+    }
+    keep_alive = version != "HTTP/1.0";
+
+    while ( not head.empty() ) {
+      const size_t end = head.find( "\r\n" );
+      const string_view line = head.substr( 0, end );
+      head.remove_prefix( end == string_view::npos ? head.size() : end + 2 );
+
+      const size_t colon = line.find( ':' );
+      if ( colon == string_view::npos ) {
+        return false;
+      }
+      const string_view name = line.substr( 0, colon );
+      string_view value = line.substr( colon + 1 );
+      while ( not value.empty() and ( value.front() == ' ' or value.front() == '\t' ) ) {
+        value.remove_prefix( 1 );
+      }
+      while ( not value.empty() and ( value.back() == ' ' or value.back() == '\t' ) ) {
+        value.remove_suffix( 1 );
+      }
+
+      if ( iequals( name, "Connection" ) ) {
+        if ( iequals( value, "close" ) ) {
+          keep_alive = false;
+        } else if ( iequals( value, "keep-alive" ) ) {
+          keep_alive = true;
+        }
+      } else if ( iequals( name, "Range" ) ) {
+        range = value;
+      }
+    }
+    return true;
+  }
+};
+
+enum class RangeResult
+{
+  Whole,        // no usable Range header: serve everything
+  Partial,      // serve [begin, end)
+  Unsatisfiable // the range lies beyond the end
+};
+
+// Resolve a Range header against a body of `size` bytes. Anything this server doesn't handle (other units,
+// multiple ranges, bad syntax) selects the whole body, as RFC 9110 allows.
+RangeResult resolve_range( string_view spec, uint64_t size, uint64_t& begin, uint64_t& end )
+{
+  if ( not spec.starts_with( "bytes=" ) ) {
+    return RangeResult::Whole;
+  }
+  spec.remove_prefix( 6 );
+  const size_t dash = spec.find( '-' );
+  if ( dash == string_view::npos or spec.find( ',' ) != string_view::npos ) {
+    return RangeResult::Whole;
+  }
+
+  uint64_t first {};
+  uint64_t last {};
+  if ( dash == 0 ) { // suffix: the final `last` bytes
+    if ( not parse_number( spec.substr( 1 ), last ) ) {
+      return RangeResult::Whole;
+    }
+    if ( last == 0 or size == 0 ) {
+      return RangeResult::Unsatisfiable;
+    }
+    begin = size - min( last, size );
+    end = size;
+    return RangeResult::Partial;
+  }
+
+  if ( not parse_number( spec.substr( 0, dash ), first ) ) {
+    return RangeResult::Whole;
+  }
+  if ( dash + 1 == spec.size() ) {
+    last = UINT64_MAX;
+  } else if ( not parse_number( spec.substr( dash + 1 ), last ) or last < first ) {
+    return RangeResult::Whole;
+  }
+  if ( first >= size ) {
+    return RangeResult::Unsatisfiable;
+  }
+  begin = first;
+  end = min( last, size - 1 ) + 1;
+  return RangeResult::Partial;
+}
+
+// A response body generated as the socket drains: bytes [offset, end) of some source, written by `fill`
+struct BodySource
+{
+  function<void( string& out, uint64_t offset, size_t length )> fill {};
+  uint64_t offset {};
+  uint64_t end {};
+  bool chunked {};
+};
+
+// One client connection: reads pipelined requests and answers them in order, generating bodies lazily so
+// that a large response costs only kOutputTarget bytes of memory
+class Client
+{
+  TCPSocket socket_;
+  const Options& options_;
+
+  string input_ {};              // request bytes received...
+  size_t input_used_ {};         // ...and how many of them have been answered
+  string output_ {};             // response bytes...
+  size_t output_sent_ {};        // ...and how many of them have been written
+  optional<BodySource> body_ {}; // rest of the current response's body, if still being generated
+  bool closing_ {};              // answer no more requests; close once the output is written
+  bool peer_done_ {};            // the client has finished sending
+  uint32_t watched_ {};          // events registered with the EventLoop
+  string buffer_ {};
+
+  uint32_t wanted() const
+  {
+    uint32_t events = 0;
+    if ( not closing_ and not peer_done_ and input_.size() - input_used_ < kInputLimit ) {
+      events |= EPOLLIN; // NOLINT(*-bitwise)
+    }
+    if ( output_sent_ < output_.size() or body_ ) {
+      events |= EPOLLOUT; // NOLINT(*-bitwise)
+    }
+    return events;
+  }
+
+  void start_response( string_view status, const Request& request, string_view headers, uint64_t length )
+  {
+    output_.append( "HTTP/1.1 " ).append( status ).append( "\r\n" ).append( headers );
+    if ( not body_ or not body_->chunked ) {
+      output_.append( "Content-Length: " ).append( to_string( length ) ).append( "\r\n" );
+    }
+    if ( not request.keep_alive ) {
+      output_.append( "Connection: close\r\n" );
+      closing_ = true;
+    }
+    output_.append( "\r\n" );
+    if ( request.method == "HEAD" ) {
+      body_.reset();
+    }
+  }
+
+  // Respond with a short text/plain body
+  void respond( string_view status, const Request& request, string_view text )
+  {
+    body_.reset();
+    start_response( status, request, "Content-Type: text/plain\r\n", text.size() );
+    if ( request.method != "HEAD" ) {
+      output_.append( text );
+    }
+  }
+
+  // Respond with `size` bytes from `fill`, or the part of them selected by a Range header
+  void respond_ranged( const Request& request,
+                       uint64_t size,
+                       function<void( string&, uint64_t, size_t )> fill,
+                       string_view content_type )
+  {
+    uint64_t begin = 0;
+    uint64_t end = size;
+    string headers = "Accept-Ranges: bytes\r\nContent-Type: " + string( content_type ) + "\r\n";
+    const RangeResult range
+      = request.range ? resolve_range( *request.range, size, begin, end ) : RangeResult::Whole;
+    if ( range == RangeResult::Unsatisfiable ) {
+      body_.reset();
+      const string content_range = "Content-Range: bytes */" + to_string( size ) + "\r\n";
+      start_response( "416 Range Not Satisfiable", request, content_range, 0 );
+      return;
+    }
+
+    body_ = BodySource { move( fill ), begin, end, false };
+    if ( range == RangeResult::Partial ) {
+      headers += "Content-Range: bytes " + to_string( begin ) + "-" + to_string( end - 1 ) + "/" + to_string( size )
+                 + "\r\n";
+      start_response( "206 Partial Content", request, headers, end - begin );
+    } else {
+      start_response( "200 OK", request, headers, size );
+    }
+  }
+
+  // Serve a regular file below options_.root
+  void respond_file( const Request& request, string_view path )
+  {
+    if ( options_.root.empty() or path.find( ".." ) != string_view::npos ) {
+      respond( "404 Not Found", request, "not found\n" );
+      return;
+    }
+
+    const string filename = options_.root + string( path );
+    const int fd = ::open( filename.c_str(), O_RDONLY | O_CLOEXEC ); // NOLINT(*-vararg, *-bitwise)
+    if ( fd < 0 ) {
+      respond( "404 Not Found", request, "not found\n" );
+      return;
+    }
+    auto file = make_shared<FileDescriptor>( fd );
+    struct stat st {};
+    CheckSystemCall( "fstat", ::fstat( file->fd_num(), &st ) );
+    if ( not S_ISREG( st.st_mode ) ) { // NOLINT(*-bitwise)
+      respond( "404 Not Found", request, "not found\n" );
+      return;
+    }
+
+    const auto read_file = [file]( string& out, uint64_t offset, size_t length ) {
+      const size_t old_size = out.size();
+      out.resize( old_size + length );
+      for ( size_t done = 0; done < length; ) {
+        const ssize_t n = ::pread( file->fd_num(), out.data() + old_size + done, length - done, offset + done );
+        if ( n < 0 ) {
+          throw unix_error { "pread" };
+        }
+        if ( n == 0 ) {
+          throw runtime_error( "file shrank while being served" );
+        }
+        done += n;
+      }
+    };
+    respond_ranged( request, st.st_size, read_file, "application/octet-stream" );
+  }
+
+  // Answer the next complete request in input_, if there is one
+  bool next_request()
+  {
+    const size_t head_end = input_.find( "\r\n\r\n", input_used_ );
+    if ( head_end == string::npos ) {
+      if ( input_.size() - input_used_ > kMaxRequestHead ) {
+        respond( "431 Request Header Fields Too Large", Request {}, "request head too large\n" );
+      }
+      return false;
+    }
+
+    const string_view head = string_view( input_ ).substr( input_used_, head_end - input_used_ );
+    input_used_ = head_end + 4;
+
+    Request request;
+    if ( not request.parse( head ) ) {
+      respond( "400 Bad Request", Request {}, "bad request\n" );
+      return true;
+    }
+    if ( request.method != "GET" and request.method != "HEAD" ) {
+      request.keep_alive = false; // any request body would follow, so don't try to parse what comes next
+      respond( "501 Not Implemented", request, "only GET and HEAD are supported\n" );
+      return true;
+    }
+
+    string_view path = request.target.substr( 0, request.target.find( '?' ) );
+    uint64_t size {};
+    if ( path.starts_with( "/nph-hasher/" ) ) {
+      // A "non-parsed header" response, like the original CGI script's: no length, ended by closing
+      const string word { path.substr( 12 ) };
+      output_.append( "HTTP/1.1 200 OK\r\nContent-type: text/plain\r\n\r\n" );
+      if ( request.method != "HEAD" ) {
+        output_.append( base64_encode( SHA256::hash( options_.hasher_key + word ), false ) ).append( "\n" );
+      }
+      closing_ = true;
+    } else if ( path.starts_with( "/bytes/" ) and parse_number( path.substr( 7 ), size ) ) {
+      respond_ranged( request, size, append_pattern, "application/octet-stream" );
+    } else if ( path.starts_with( "/chunked/" ) and parse_number( path.substr( 9 ), size ) ) {
+      if ( request.version == "HTTP/1.0" ) { // doesn't understand chunked transfer coding
+        respond_ranged( request, size, append_pattern, "application/octet-stream" );
+      } else {
+        body_ = BodySource { append_pattern, 0, size, true };
+        start_response(
+          "200 OK", request, "Transfer-Encoding: chunked\r\nContent-Type: application/octet-stream\r\n", 0 );
+      }
+    } else {
+      respond_file( request, path );
+    }
+    return true;
+  }
+
+  // Append the next piece of the current body
+  void generate_body()
+  {
+    BodySource& body = *body_;
+    const size_t n = min( body.end - body.offset, uint64_t { body.chunked ? kChunkSize : kOutputTarget } );
+    if ( n > 0 ) {
+      if ( body.chunked ) {
+        array<char, 16> hex {};
+        const auto [end, ec] = to_chars( hex.data(), hex.data() + hex.size(), n, 16 );
+        output_.append( hex.data(), end ).append( "\r\n" );
+      }
+      body.fill( output_, body.offset, n );
+      body.offset += n;
+      if ( body.chunked ) {
+        output_.append( "\r\n" );
+      }
+    }
+    if ( body.offset == body.end ) {
+      if ( body.chunked ) {
+        output_.append( "0\r\n\r\n" );
+      }
+      body_.reset();
+    }
+  }
+
+  // Fill output_ up to kOutputTarget unsent bytes, answering requests as needed
+  void produce()
+  {
+    output_.erase( 0, output_sent_ );
+    output_sent_ = 0;
+    while ( output_.size() < kOutputTarget ) {
+      if ( body_ ) {
+        generate_body();
+      } else if ( closing_ or not next_request() ) {
+        break;
+      }
+    }
+  }
+
+public:
+  Client( TCPSocket socket, const Options& options ) : socket_( move( socket ) ), options_( options ) {}
+
+  const TCPSocket& socket() const { return socket_; }
+
+  // Has everything been answered that ever will be?
+  bool finished() const
+  {
+    return ( closing_ or peer_done_ ) and not body_ and output_sent_ == output_.size();
+  }
+
+  void watch( EventLoop& loop, EventLoop::Handler handler )
+  {
+    watched_ = wanted();
+    loop.add( socket_, watched_, move( handler ) );
+  }
+
+  void update( EventLoop& loop )
+  {
+    if ( wanted() != watched_ ) {
+      watched_ = wanted();
+      loop.modify( socket_, watched_ );
+    }
+  }
+
+  void on_event( uint32_t events )
+  {
+    if ( ( events & ( EPOLLIN | EPOLLHUP | EPOLLERR ) ) and not peer_done_ ) { // NOLINT(*-bitwise)
+      if ( input_used_ == input_.size() ) {
+        input_.clear();
+        input_used_ = 0;
+      }
+      while ( input_.size() - input_used_ < kInputLimit ) {
+        socket_.read( buffer_ );
+        if ( buffer_.empty() ) {
+          peer_done_ = socket_.eof();
+          break;
+        }
+        input_.append( buffer_ );
+      }
+    }
+
+    while ( true ) {
+      produce();
+      if ( output_.empty() ) {
+        break;
+      }
+      const size_t written = socket_.write( output_ );
+      if ( written == 0 ) {
+        break; // socket buffer full: wait for EPOLLOUT
+      }
+      output_sent_ = written;
+    }
+  }
+};
+
+// One thread's share of the server: a listener (sharing the port with the others) and its clients
+class Server
+{
+  TCPSocket listener_;
+  const Options& options_;
+  EventLoop loop_ {};
+  unordered_map<const Client*, unique_ptr<Client>> clients_ {};
+
+  void drop( Client& client )
+  {
+    loop_.remove( client.socket() );
+    clients_.erase( &client );
+  }
+
+  void serve( Client& client, uint32_t events )
+  {
+    try {
+      client.on_event( events );
+      if ( client.finished() ) {
+        drop( client );
+      } else {
+        client.update( loop_ );
+      }
+    } catch ( const exception& ) {
+      drop( client ); // e.g., the client reset the connection
+    }
+  }
+
+  void accept()
+  {
+    for ( auto& socket : listener_.accept_batch() ) {
+      auto client = make_unique<Client>( move( socket ), options_ );
+      Client* c = client.get();
+      clients_.emplace( c, move( client ) );
+      c->watch( loop_, [this, c]( uint32_t events ) { serve( *c, events ); } );
+    }
+  }
+
+public:
+  Server( TCPSocket listener, const Options& options ) : listener_( move( listener ) ), options_( options ) {}
+
+  [[noreturn]] void run()
+  {
+    listener_.set_blocking( false );
+    loop_.add( listener_, EPOLLIN, [this]( uint32_t ) { accept(); } );
+    while ( true ) {
+      loop_.wait_next_event( -1 );
+    }
+  }
+};
+
+TCPSocket make_listener( const Address& address )
+{
+  TCPSocket listener;
+  listener.set_reuseaddr();
+  listener.set_reuseport();
+  listener.bind( address );
+  listener.listen( kListenBacklog );
+  return listener;
+}
+
+void usage( const char* argv0 )
+{
+  cerr << "Usage: " << argv0
+       << " [--address IP] [--port N] [--threads N] [--root DIR] [--hasher-key KEY]\n"
+          "\tServes HTTP/1.1 (keep-alive, pipelining, single byte ranges) on IP (default 127.0.0.1) port N\n"
+          "\t(default 8080; 0 picks a free port), printing the address it listens on. Paths:\n"
+          "\t  /bytes/N         N generated bytes\n"
+          "\t  /chunked/N       N generated bytes in chunked transfer coding\n"
+          "\t  /nph-hasher/WORD base64 SHA-256 of KEY followed by WORD, on a close-delimited response\n"
+          "\t  anything else    the file at that path under DIR\n";
+}
+
+} // namespace
+
+int main( int argc, char* argv[] )
+{
+  try {
+    if ( argc <= 0 ) {
+      abort(); // For sticklers: don't try to access argv[0] if argc <= 0.
+    }
+
+    auto args = span( argv, argc );
+
+    Options options;
+    string ip = "127.0.0.1";
+    uint16_t port = 8080;
+    size_t threads = 1;
+    for ( size_t i = 1; i < args.size(); ++i ) {
+      const string_view arg { args[i] };
+      if ( i + 1 == args.size() ) {
+        usage( args.front() );
+        return EXIT_FAILURE;
+      }
+      if ( arg == "--address" ) {
+        ip = args[++i];
+      } else if ( arg == "--port" ) {
+        port = static_cast<uint16_t>( stoul( args[++i] ) );
+      } else if ( arg == "--threads" ) {
+        threads = max( stoul( args[++i] ), 1UL );
+      } else if ( arg == "--root" ) {
+        options.root = args[++i];
+      } else if ( arg == "--hasher-key" ) {
+        options.hasher_key = args[++i];
+      } else {
+        usage( args.front() );
+        return EXIT_FAILURE;
+      }
+    }
+
+    signal( SIGPIPE, SIG_IGN ); // a client that goes away shows up as EPIPE instead
+
+    // Each thread accepts on its own listener; SO_REUSEPORT has the kernel spread connections across them
+    TCPSocket first = make_listener( Address { ip, port } );
+    const Address address = first.local_address();
+    for ( size_t i = 1; i < threads; ++i ) {
+      thread( [listener = make_listener( address ), &options]() mutable {
+        try {
+          Server( move( listener ), options ).run();
+        } catch ( const exception& e ) {
+          cerr << e.what() << "\n";
+          _exit( EXIT_FAILURE );
+        }
+      } ).detach();
+    }
+
+    cout << "listening on " << address.to_string() << endl;
+    Server( move( first ), options ).run();
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,121 @@
+#include "exception.hh"
+#include "socket.hh"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstdlib>
+#include <iostream>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <poll.h>
+#include <span>
+#include <string>
+
+using namespace std;
+
+// an EtherType reserved for local experiments, so only our own frames are captured
+static constexpr uint16_t kExperimentalEtherType = 0x88B5;
+
+// bind a packet socket to one interface
+static void bind_to_interface( PacketSocket& sock, const string& interface )
+{
+  sockaddr_ll addr {};
+  addr.sll_family = AF_PACKET;
+  addr.sll_protocol = htons( kExperimentalEtherType );
+  addr.sll_ifindex = static_cast<int>( if_nametoindex( interface.c_str() ) );
+  if ( addr.sll_ifindex == 0 ) {
+    throw runtime_error( "unknown interface: " + interface );
+  }
+  sock.bind( { reinterpret_cast<const sockaddr*>( &addr ), sizeof( addr ) } ); // NOLINT(*-reinterpret-cast)
+}
+
+// a broadcast Ethernet frame carrying the sequence number `i`
+static string make_frame( size_t i )
+{
+  string frame( 60, 0 );
+  fill( frame.begin(), frame.begin() + 6, char( 0xff ) ); // broadcast destination
+  frame[12] = static_cast<char>( kExperimentalEtherType >> 8 );
+  frame[13] = static_cast<char>( kExperimentalEtherType & 0xff );
+  const string payload = "frame " + to_string( i );
+  frame.replace( 14, payload.size(), payload );
+  return frame;
+}
+
+// send `count` frames through a TX ring and receive them through an RX ring on the same interface
+void loopback( const string& interface, const size_t count )
+{
+  PacketSocket rx_sock { SOCK_RAW, htons( kExperimentalEtherType ) };
+  rx_sock.enable_rings( PacketRingConfig { .block_size = 1 << 16, .block_count = 8, .block_timeout_ms = 5 } );
+  bind_to_interface( rx_sock, interface );
+
+  // a TX geometry whose blocks don't divide into whole frames is refused
+  bool refused = false;
+  try {
+    PacketSocket { SOCK_RAW, 0 }.enable_rings( {}, PacketRingConfig { .block_size = 1 << 16, .frame_size = 3072 } );
+  } catch ( const runtime_error& ) {
+    refused = true;
+  }
+  if ( not refused ) {
+    throw runtime_error( "a TX ring with frames straddling blocks was accepted" );
+  }
+
+  PacketSocket tx_sock { SOCK_RAW, htons( kExperimentalEtherType ) };
+  tx_sock.enable_rings( {}, PacketRingConfig { .block_size = 1 << 16, .block_count = 4 } );
+  bind_to_interface( tx_sock, interface );
+
+  size_t sent = 0;
+  size_t received = 0;
+  vector<string_view> frames;
+  while ( received < count ) {
+    while ( sent < count and tx_sock.queue_frame( make_frame( sent ) ) ) {
+      ++sent;
+    }
+    tx_sock.flush_frames();
+
+    pollfd pfd { rx_sock.fd_num(), POLLIN, 0 };
+    if ( CheckSystemCall( "poll", poll( &pfd, 1, 1000 ) ) == 0 ) {
+      throw runtime_error( "timed out after receiving " + to_string( received ) + " of " + to_string( count )
+                           + " frames" );
+    }
+
+    frames.clear();
+    rx_sock.recv_frames( frames );
+    for ( const auto frame : frames ) {
+      if ( frame.substr( 14, frame.find( '\0', 14 ) - 14 ) != "frame " + to_string( received ) ) {
+        throw runtime_error( "frame " + to_string( received ) + " arrived out of order or corrupted" );
+      }
+      ++received;
+    }
+    rx_sock.release_frames();
+  }
+
+  if ( tx_sock.rejected_frames() > 0 ) {
+    throw runtime_error( to_string( tx_sock.rejected_frames() ) + " frames were refused by the kernel" );
+  }
+  cout << "sent " << sent << " and received " << received << " frames through TPACKET_V3 rings on " << interface
+       << "\n";
+}
+
+int main( int argc, char* argv[] )
+{
+  try {
+    if ( argc <= 0 ) {
+      abort(); // For sticklers: don't try to access argv[0] if argc <= 0.
+    }
+
+    auto args = span( argv, argc );
+
+    if ( argc != 3 ) {
+      cerr << "Usage: " << args.front() << " INTERFACE COUNT\n";
+      cerr << "\tExample: " << args.front() << " lo 10000\n";
+      return EXIT_FAILURE;
+    }
+
+    loopback( args[1], stoul( args[2] ) );
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
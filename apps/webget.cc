@@ -1,9 +1,27 @@
+#include "byte_stream.hh"
+#include "event_loop.hh"
+#include "exception.hh"
+#include "http_client.hh"
+#include "http_response.hh"
+#include "resolver.hh"
 #include "socket.hh"
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
 #include <cstdlib>
+#include <deque>
+#include <fcntl.h>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <list>
+#include <memory>
 #include <span>
 #include <string>
+#include <unistd.h>
+#include <unordered_map>
 
 using namespace std;
 
@@ -20,7 +38,7 @@ void get_URL( const string& host, const string& path )
     TCPSocket socket;
 
     // 2. connect to host
-    Address address(host, "http");
+    const Address address = Resolver::global().resolve( host, "http" );
     socket.connect(address);
 
     // 3. send Get request
@@ -38,6 +56,859 @@ void get_URL( const string& host, const string& path )
     }
 }
 
+namespace {
+
+// A persistent HTTP/1.1 connection carrying pipelined GET requests
+class HTTPConnection
+{
+  static constexpr uint64_t kInboundCapacity = 1 << 20;
+
+  TCPSocket socket_ {};
+  ByteStream inbound_ { kInboundCapacity };
+  HTTPResponseParser parser_ {};
+  deque<URL> in_flight_ {};
+  bool reusable_ { true };
+  string buffer_ {};
+
+public:
+  explicit HTTPConnection( const Address& address ) { socket_.connect( address ); }
+
+  size_t in_flight() const { return in_flight_.size(); }
+  bool reusable() const { return reusable_; }
+  bool body_started() const { return parser_.body_bytes() > 0; } // has the unfinished response's body begun?
+
+  // Queue a GET request behind any already in flight
+  void send( const URL& url )
+  {
+    socket_.write( "GET " + url.path + " HTTP/1.1\r\nHost: " + url.host_header() + "\r\n\r\n" );
+    in_flight_.push_back( url );
+  }
+
+  // Read the response to the oldest in-flight request, passing its body to `on_body`.
+  // Returns false if the server closed the connection before that response finished.
+  bool receive( const HTTPResponseParser::BodyCallback& on_body,
+                const function<void( const URL&, const HTTPResponseParser& )>& on_done )
+  {
+    while ( not parser_.parse( inbound_.reader(), on_body ) ) {
+      if ( socket_.eof() ) {
+        reusable_ = false;
+        if ( inbound_.writer().is_closed() ) {
+          return false;
+        }
+        inbound_.writer().close();
+        continue;
+      }
+      socket_.read( buffer_ );
+      if ( buffer_.empty() ) {
+        continue;
+      }
+      inbound_.writer().push( move( buffer_ ) );
+    }
+
+    on_done( in_flight_.front(), parser_ );
+    in_flight_.pop_front();
+    reusable_ = reusable_ and parser_.keep_alive();
+    parser_.reset();
+    return true;
+  }
+
+  // Requests sent but never answered (to be retried elsewhere)
+  deque<URL> take_unanswered() { return exchange( in_flight_, {} ); }
+};
+
+// Fetches URLs over a bounded pool of persistent connections, one per origin, pipelining
+// up to `depth` requests on each. Bodies go to stdout; a status line per URL goes to stderr.
+class PipelinedFetcher
+{
+  size_t depth_;
+  size_t max_connections_;
+  unordered_map<string, HTTPConnection> connections_ {};
+  list<string> lru_ {}; // origins, least recently used first
+  size_t retries_left_ { 3 };
+
+  HTTPConnection& connection( const URL& url )
+  {
+    const string origin = url.origin();
+    auto it = connections_.find( origin );
+    if ( it == connections_.end() ) {
+      if ( connections_.size() >= max_connections_ ) {
+        retire( lru_.front() );
+      }
+      it = connections_.try_emplace( origin, Resolver::global().resolve( url.host, url.service ) ).first;
+    } else {
+      lru_.remove( origin );
+    }
+    lru_.push_back( origin );
+    return it->second;
+  }
+
+  // Receive one response from the connection to `origin`, replacing the connection if it closed
+  void receive_one( const string& origin )
+  {
+    HTTPConnection& conn = connections_.at( origin );
+    const bool ok = conn.receive( []( string_view body ) { cout.write( body.data(), body.size() ); },
+                                  []( const URL& url, const HTTPResponseParser& response ) {
+                                    cerr << response.head().status_code << " " << response.body_bytes() << " "
+                                         << url.text << "\n";
+                                  } );
+    if ( ok and conn.reusable() ) {
+      return;
+    }
+
+    // the server closed the connection: resend whatever it didn't answer on a fresh one, except a response
+    // whose body already went partly to stdout (sending it again would repeat that part)
+    deque<URL> unanswered = conn.take_unanswered();
+    if ( not ok and conn.body_started() ) {
+      cerr << "error " << unanswered.front().text << ": connection closed mid-body\n";
+      unanswered.pop_front();
+    }
+    connections_.erase( origin );
+    lru_.remove( origin );
+    if ( not unanswered.empty() ) {
+      if ( not ok and retries_left_-- == 0 ) {
+        throw runtime_error( "connection to " + origin + " keeps closing mid-response" );
+      }
+      for ( const auto& url : unanswered ) {
+        fetch( url );
+      }
+    }
+  }
+
+  // Drain and close the connection to `origin`
+  void retire( string origin ) // by value: callers pass elements of lru_, which this erases
+  {
+    while ( connections_.contains( origin ) and connections_.at( origin ).in_flight() ) {
+      receive_one( origin );
+    }
+    connections_.erase( origin );
+    lru_.remove( origin );
+  }
+
+public:
+  PipelinedFetcher( size_t depth, size_t max_connections )
+    : depth_( max( depth, size_t { 1 } ) ), max_connections_( max( max_connections, size_t { 1 } ) )
+  {}
+
+  void add( const URL& url ) { fetch( url ); }
+
+  void fetch( const URL& url )
+  {
+    HTTPConnection& conn = connection( url );
+    if ( conn.in_flight() >= depth_ ) {
+      receive_one( url.origin() );
+      fetch( url );
+      return;
+    }
+    conn.send( url );
+  }
+
+  void finish()
+  {
+    while ( not lru_.empty() ) {
+      retire( lru_.front() );
+    }
+  }
+};
+
+// Fetches URLs concurrently from a single thread: non-blocking sockets driven by an EventLoop, with at most
+// `limit` requests outstanding overall and `per_host` per origin. A connection whose response allows it is
+// reused for the next request to the same origin. Bodies are counted and discarded; a status line per URL
+// goes to stderr, and a summary of throughput and latency to stdout.
+class ConcurrentFetcher
+{
+  using Clock = chrono::steady_clock;
+
+  static constexpr int kTickMs = 250; // how often to check for stalled connections
+  static constexpr unsigned kMaxAttempts = 2;
+
+  struct Request
+  {
+    URL url {};
+    Clock::time_point start {};
+    unsigned attempts {};
+  };
+
+  struct Connection
+  {
+    Connection( const Address& address, Request&& r ) : http( address ), request( move( r ) ) {}
+
+    AsyncHTTPConnection http;
+    Request request;
+    bool reused {}; // did this connection carry an earlier response?
+    Clock::time_point deadline {};
+  };
+
+  size_t limit_;
+  size_t per_host_;
+  Clock::duration timeout_;
+
+  EventLoop loop_ {};
+  unordered_map<string, deque<Request>> queued_ {}; // by origin
+  list<string> ready_ {};                           // origins with queued requests, served round-robin
+  unordered_map<string, size_t> active_per_origin_ {};
+  size_t active_ {};                                          // requests resolving, connecting or in flight
+  unordered_map<Connection*, unique_ptr<Connection>> connections_ {};
+
+  vector<double> latencies_ms_ {};
+  uint64_t body_bytes_ {};
+  size_t failures_ {};
+
+  void enqueue( Request&& request, bool front = false )
+  {
+    const string origin = request.url.origin();
+    auto& queue = queued_[origin];
+    if ( queue.empty() ) {
+      ready_.push_back( origin );
+    }
+    if ( front ) {
+      queue.push_front( move( request ) );
+    } else {
+      queue.push_back( move( request ) );
+    }
+  }
+
+  // the next queued request for `origin`, if any
+  optional<Request> take( const string& origin )
+  {
+    const auto it = queued_.find( origin );
+    if ( it == queued_.end() ) {
+      return {};
+    }
+    Request request = move( it->second.front() );
+    it->second.pop_front();
+    if ( it->second.empty() ) {
+      queued_.erase( it );
+      ready_.remove( origin );
+    }
+    return request;
+  }
+
+  // start queued requests while the overall and per-origin limits allow
+  void pump()
+  {
+    bool progress = true;
+    while ( progress and active_ < limit_ ) {
+      progress = false;
+      for ( auto it = ready_.begin(); it != ready_.end() and active_ < limit_; ) {
+        const string origin = *it++; // take() may erase this element
+        if ( active_per_origin_[origin] < per_host_ ) {
+          start( *take( origin ) );
+          progress = true;
+        }
+      }
+    }
+  }
+
+  void start( Request&& request )
+  {
+    ++active_;
+    ++active_per_origin_[request.url.origin()];
+    if ( request.attempts++ == 0 ) {
+      request.start = Clock::now();
+    }
+
+    const string host = request.url.host;
+    const string service = request.url.service;
+    // the callback runs on a resolver thread (or right here on a cache hit); connect from the loop thread
+    Resolver::global().resolve_async(
+      host, service, [this, request = move( request )]( const shared_future<Address>& address ) {
+        loop_.post( [this, request, address]() mutable { connect( move( request ), address ); } );
+      } );
+  }
+
+  void connect( Request&& request, const shared_future<Address>& address )
+  {
+    unique_ptr<Connection> conn;
+    try { // (`request` is only moved from once connecting has started)
+      conn = make_unique<Connection>( address.get(), move( request ) );
+    } catch ( const exception& e ) {
+      release( request.url.origin() );
+      fail( move( request ), e.what() );
+      return;
+    }
+
+    Connection& c = *conn;
+    connections_.emplace( &c, move( conn ) );
+    begin( c );
+    c.http.watch( loop_, [this, &c]( uint32_t events ) { on_event( c, events ); } );
+  }
+
+  // send c.request on c
+  void begin( Connection& c )
+  {
+    const URL& url = c.request.url;
+    c.http.send( "GET " + url.path + " HTTP/1.1\r\nHost: " + url.host_header() + "\r\n\r\n" );
+    c.deadline = Clock::now() + timeout_;
+  }
+
+  // may destroy `c`
+  void on_event( Connection& c, uint32_t events )
+  {
+    try {
+      c.deadline = Clock::now() + timeout_;
+      if ( c.http.on_event( events, [this]( string_view body ) { body_bytes_ += body.size(); } ) ) {
+        complete( c );
+        return;
+      }
+      c.http.update( loop_ );
+    } catch ( const exception& e ) {
+      drop( c, e.what() );
+    }
+  }
+
+  // record a finished response, then reuse or close `c`
+  void complete( Connection& c )
+  {
+    const auto elapsed = chrono::duration<double, milli>( Clock::now() - c.request.start ).count();
+    latencies_ms_.push_back( elapsed );
+    cerr << c.http.response().head().status_code << " " << c.http.response().body_bytes() << " " << fixed
+         << setprecision( 1 )
+         << elapsed << "ms " << c.request.url.text << "\n";
+
+    const string origin = c.request.url.origin();
+    release( origin );
+    if ( c.http.reusable() ) {
+      if ( auto next = take( origin ) ) {
+        ++active_;
+        ++active_per_origin_[origin];
+        if ( next->attempts++ == 0 ) {
+          next->start = Clock::now();
+        }
+        c.request = move( *next );
+        c.reused = true;
+        begin( c );
+        c.http.update( loop_ );
+        return;
+      }
+    }
+    close( c );
+    pump();
+  }
+
+  // give up on `c`, retrying its request on a new connection if a reused one was closed under it
+  void drop( Connection& c, const string& why )
+  {
+    Request request = move( c.request );
+    const bool retry = c.reused and not c.http.got_bytes() and request.attempts < kMaxAttempts;
+    release( request.url.origin() );
+    close( c );
+
+    if ( retry ) {
+      enqueue( move( request ), true );
+      pump();
+    } else {
+      fail( move( request ), why );
+    }
+  }
+
+  // report a request that will not be retried (its slot already released)
+  void fail( Request&& request, const string& why )
+  {
+    ++failures_;
+    cerr << "error " << request.url.text << ": " << why << "\n";
+    pump();
+  }
+
+  // free the request slot held for `origin`
+  void release( const string& origin )
+  {
+    --active_;
+    if ( --active_per_origin_.at( origin ) == 0 ) {
+      active_per_origin_.erase( origin );
+    }
+  }
+
+  void close( Connection& c )
+  {
+    c.http.unwatch( loop_ );
+    connections_.erase( &c ); // destroys c
+  }
+
+  void expire_stalled()
+  {
+    const auto now = Clock::now();
+    vector<Connection*> stalled;
+    for ( const auto& [ptr, conn] : connections_ ) {
+      if ( conn->deadline < now ) {
+        stalled.push_back( conn.get() );
+      }
+    }
+    for ( Connection* c : stalled ) {
+      drop( *c, "timed out" );
+    }
+  }
+
+  void report( Clock::duration elapsed )
+  {
+    const double seconds = chrono::duration<double>( elapsed ).count();
+    cout << fixed << setprecision( 3 );
+    cout << latencies_ms_.size() << " ok, " << failures_ << " failed in " << seconds << " s ("
+         << static_cast<double>( latencies_ms_.size() ) / seconds << " requests/s)\n";
+    cout << body_bytes_ << " body bytes (" << static_cast<double>( body_bytes_ ) * 8 / seconds / 1e6
+         << " Mbit/s)\n";
+
+    if ( latencies_ms_.empty() ) {
+      return;
+    }
+    ranges::sort( latencies_ms_ );
+    const auto percentile = [&]( double p ) {
+      const auto rank = static_cast<size_t>( ceil( p * static_cast<double>( latencies_ms_.size() ) ) );
+      return latencies_ms_.at( max( rank, size_t { 1 } ) - 1 );
+    };
+    cout << "latency (ms): min " << latencies_ms_.front() << ", p50 " << percentile( 0.5 ) << ", p90 "
+         << percentile( 0.9 ) << ", p99 " << percentile( 0.99 ) << ", max " << latencies_ms_.back() << "\n";
+  }
+
+public:
+  ConcurrentFetcher( size_t limit, size_t per_host, Clock::duration timeout )
+    : limit_( max( limit, size_t { 1 } ) ), per_host_( max( per_host, size_t { 1 } ) ), timeout_( timeout )
+  {}
+
+  void add( const URL& url ) { enqueue( Request { url } ); }
+
+  void run()
+  {
+    const auto start = Clock::now();
+    pump();
+    while ( active_ > 0 ) {
+      loop_.wait_next_event( kTickMs );
+      expire_stalled();
+    }
+    report( Clock::now() - start );
+  }
+};
+
+// A Content-Range header value, "bytes FIRST-LAST/SIZE" or "bytes */SIZE"
+struct ContentRange
+{
+  optional<pair<uint64_t, uint64_t>> bytes {}; // first and last byte (inclusive)
+  optional<uint64_t> size {};                  // of the whole object, if known
+
+  static optional<ContentRange> parse( string_view value )
+  {
+    const auto number = [&]( string_view text ) -> optional<uint64_t> {
+      uint64_t n {};
+      const auto [ptr, ec] = from_chars( text.data(), text.data() + text.size(), n );
+      return ec == errc {} and ptr == text.data() + text.size() and not text.empty() ? optional { n } : nullopt;
+    };
+
+    const size_t slash = value.find( '/' );
+    if ( not value.starts_with( "bytes " ) or slash == string_view::npos ) {
+      return {};
+    }
+    ContentRange range;
+    const string_view bytes = value.substr( 6, slash - 6 );
+    const string_view size = value.substr( slash + 1 );
+    if ( size != "*" and not ( range.size = number( size ) ) ) {
+      return {};
+    }
+    if ( bytes != "*" ) {
+      const size_t dash = bytes.find( '-' );
+      const auto first = number( bytes.substr( 0, dash ) );
+      const auto last = dash == string_view::npos ? nullopt : number( bytes.substr( dash + 1 ) );
+      if ( not first or not last or *last < *first ) {
+        return {};
+      }
+      range.bytes = { *first, *last };
+    }
+    return range;
+  }
+};
+
+// Downloads one object over several connections at once. The object is split into byte ranges fetched with
+// Range requests, one range at a time per connection, and written out in order: with positional writes to a
+// file, or to stdout (holding ranges that finish early until those before them are written). The first
+// request doubles as the probe: if the server answers it with 200 rather than 206, that response is used as
+// a single stream. Per-connection and aggregate rates go to stderr at the end.
+class RangedDownload
+{
+  using Clock = chrono::steady_clock;
+
+  static constexpr int kTickMs = 250;           // how often to check for stalled connections
+  static constexpr unsigned kMaxRetries = 3;    // per range
+  static constexpr size_t kWindowPerStream = 2; // stdout: ranges each connection may run ahead of the output
+
+  struct Range
+  {
+    uint64_t start {};
+    optional<uint64_t> end {}; // one past the last byte (empty: whatever the server sends)
+    uint64_t received {};
+    string held {}; // stdout: bytes that arrived before all earlier ranges were written
+    bool done {};
+    unsigned retries {};
+  };
+
+  struct Stream
+  {
+    Stream( const Address& address, size_t s ) : http( address ), slot( s ) {}
+
+    AsyncHTTPConnection http;
+    size_t slot;               // position in the report; a replacement connection takes over the slot
+    optional<size_t> range {}; // the range being fetched, if any
+    bool discard_body {};      // the response's body isn't range data (a 416's error page)
+    Clock::time_point deadline {};
+  };
+
+  struct SlotStats
+  {
+    bool busy {};
+    uint64_t bytes {};
+    size_t responses {};
+    Clock::time_point first {}, last {};
+  };
+
+  URL url_;
+  Address address_;
+  size_t max_streams_;
+  uint64_t chunk_size_;
+  Clock::duration timeout_;
+  optional<FileDescriptor> file_; // output file; stdout if empty
+
+  EventLoop loop_ {};
+  unordered_map<Stream*, unique_ptr<Stream>> streams_ {};
+  vector<SlotStats> slots_;
+
+  bool probed_ {}; // has the first response's head been seen?
+  bool ranged_ {}; // does the server honor Range?
+  vector<Range> ranges_ {};
+  size_t next_range_ {};   // next range never assigned
+  deque<size_t> retry_ {}; // ranges to resume after a connection failed
+  size_t next_output_ {};  // stdout: first range not yet written in full
+  size_t ranges_done_ {};
+  uint64_t bytes_ {};
+
+  bool has_work() const
+  {
+    const bool in_window = file_ or next_range_ < next_output_ + kWindowPerStream * max_streams_;
+    return not retry_.empty() or ( next_range_ < ranges_.size() and in_window );
+  }
+
+  size_t next_work()
+  {
+    if ( not retry_.empty() ) {
+      const size_t index = retry_.front();
+      retry_.pop_front();
+      return index;
+    }
+    return next_range_++;
+  }
+
+  // request the rest of range `index` on `s`
+  void assign( Stream& s, size_t index )
+  {
+    const Range& r = ranges_.at( index );
+    string request = "GET " + url_.path + " HTTP/1.1\r\nHost: " + url_.host_header() + "\r\n";
+    if ( r.end ) {
+      request += "Range: bytes=" + to_string( r.start + r.received ) + "-" + to_string( *r.end - 1 ) + "\r\n";
+    }
+    s.http.send( request + "\r\n" );
+    s.range = index;
+    s.discard_body = false;
+    s.deadline = Clock::now() + timeout_;
+  }
+
+  // keep every connection busy, opening new ones up to the limit (just one until the probe is answered)
+  void dispatch()
+  {
+    for ( auto& [ptr, stream] : streams_ ) {
+      if ( not stream->range and has_work() ) {
+        assign( *stream, next_work() );
+        stream->http.update( loop_ );
+      }
+    }
+
+    const size_t limit = probed_ and ranged_ ? max_streams_ : 1;
+    while ( streams_.size() < limit and has_work() ) {
+      const auto slot = ranges::find_if( slots_, []( const SlotStats& stats ) { return not stats.busy; } );
+      auto stream = make_unique<Stream>( address_, slot - slots_.begin() );
+      slot->busy = true;
+      if ( slot->first == Clock::time_point {} ) {
+        slot->first = Clock::now();
+      }
+
+      Stream& st = *stream;
+      streams_.emplace( &st, move( stream ) );
+      assign( st, next_work() );
+      st.http.watch( loop_, [this, &st]( uint32_t events ) { on_event( st, events ); } );
+    }
+  }
+
+  void on_event( Stream& s, uint32_t events )
+  {
+    try {
+      s.deadline = Clock::now() + timeout_;
+      const bool complete = s.http.on_event(
+        events,
+        [&]( string_view data ) { deliver( s, data ); },
+        [&]( const HTTPResponseHead& head ) { check_head( s, head ); } );
+
+      if ( not s.range ) {
+        throw runtime_error( "unexpected data" ); // (or an idle connection closed by the server)
+      }
+      if ( complete ) {
+        finish_range( s );
+        return;
+      }
+      s.http.update( loop_ );
+    } catch ( const exception& e ) {
+      drop( s, e.what() );
+    }
+  }
+
+  // the first response decides whether ranges work; the rest must answer exactly what was asked
+  void check_head( Stream& s, const HTTPResponseHead& head )
+  {
+    const auto content_range = ContentRange::parse( head.header( "Content-Range" ).value_or( "" ) );
+
+    if ( not probed_ ) {
+      Range& probe = ranges_.front();
+      probed_ = true;
+      if ( head.status_code == 200 ) {
+        ranged_ = false;
+        probe.end.reset();
+        cerr << "server does not support ranges; downloading over one connection\n";
+        return;
+      }
+      if ( head.status_code == 416 and content_range and content_range->size == 0 ) {
+        ranged_ = true;
+        probe.end = 0; // an empty object
+        s.discard_body = true;
+        return;
+      }
+      if ( head.status_code != 206 or not content_range or not content_range->size ) {
+        throw runtime_error( "unexpected response to range request: " + to_string( head.status_code ) );
+      }
+
+      ranged_ = true;
+      const uint64_t size = *content_range->size;
+      probe.end = min( size, chunk_size_ );
+      for ( uint64_t start = *probe.end; start < size; start += chunk_size_ ) { // (invalidates `probe`)
+        ranges_.push_back( Range { start, min( size, start + chunk_size_ ) } );
+      }
+      if ( file_ ) {
+        CheckSystemCall( "ftruncate", ::ftruncate( file_->fd_num(), static_cast<off_t>( size ) ) );
+      }
+    }
+
+    if ( not ranged_ ) {
+      return;
+    }
+    const Range& r = ranges_.at( *s.range );
+    const uint64_t first = r.start + r.received;
+    if ( head.status_code != 206 or not content_range or not content_range->bytes
+         or content_range->bytes->first != first or content_range->bytes->second + 1 != *r.end ) {
+      throw runtime_error( "server answered bytes=" + to_string( first ) + "-" + to_string( *r.end - 1 )
+                           + " with status " + to_string( head.status_code ) + " and Content-Range "
+                           + string( head.header( "Content-Range" ).value_or( "(none)" ) ) );
+    }
+  }
+
+  void deliver( Stream& s, string_view data )
+  {
+    if ( s.discard_body ) {
+      return;
+    }
+    Range& r = ranges_.at( *s.range );
+    if ( r.end and r.start + r.received + data.size() > *r.end ) {
+      throw runtime_error( "server sent more than the requested range" );
+    }
+
+    const uint64_t offset = r.start + r.received;
+    if ( file_ ) {
+      for ( size_t written = 0; written < data.size(); ) {
+        const ssize_t n = ::pwrite( file_->fd_num(),
+                                    data.data() + written,
+                                    data.size() - written,
+                                    static_cast<off_t>( offset + written ) );
+        if ( n < 0 ) {
+          throw unix_error { "pwrite" };
+        }
+        written += n;
+      }
+    } else if ( *s.range == next_output_ ) {
+      cout.write( data.data(), static_cast<streamsize>( data.size() ) );
+    } else {
+      r.held.append( data );
+    }
+
+    r.received += data.size();
+    bytes_ += data.size();
+    SlotStats& stats = slots_.at( s.slot );
+    stats.bytes += data.size();
+    stats.last = Clock::now();
+  }
+
+  void finish_range( Stream& s )
+  {
+    Range& r = ranges_.at( *s.range );
+    if ( r.end and r.start + r.received != *r.end ) {
+      throw runtime_error( "range ended early" );
+    }
+    r.done = true;
+    ++ranges_done_;
+    ++slots_.at( s.slot ).responses;
+    s.range.reset();
+
+    // stdout: write out every range that is now complete and next in line
+    while ( not file_ and next_output_ < ranges_.size() ) {
+      Range& next = ranges_.at( next_output_ );
+      cout.write( next.held.data(), static_cast<streamsize>( next.held.size() ) );
+      next.held = string {};
+      if ( not next.done ) {
+        break;
+      }
+      ++next_output_;
+    }
+
+    if ( not s.http.reusable() ) {
+      close( s );
+    }
+    dispatch();
+  }
+
+  // give up on `s`, resuming its range on another connection
+  void drop( Stream& s, const string& why )
+  {
+    if ( s.range ) {
+      Range& r = ranges_.at( *s.range );
+      if ( probed_ and not ranged_ ) {
+        throw runtime_error( "download failed: " + why ); // no way to resume without ranges
+      }
+      if ( ++r.retries > kMaxRetries ) {
+        throw runtime_error( "download failed after " + to_string( kMaxRetries ) + " retries: " + why );
+      }
+      cerr << "connection " << s.slot << ": " << why << "; retrying\n";
+      retry_.push_front( *s.range );
+    }
+    close( s );
+    dispatch();
+  }
+
+  void close( Stream& s )
+  {
+    slots_.at( s.slot ).busy = false;
+    s.http.unwatch( loop_ );
+    streams_.erase( &s ); // destroys s
+  }
+
+  void expire_stalled()
+  {
+    const auto now = Clock::now();
+    vector<Stream*> stalled;
+    for ( const auto& [ptr, stream] : streams_ ) {
+      if ( stream->range and stream->deadline < now ) {
+        stalled.push_back( ptr );
+      }
+    }
+    for ( Stream* s : stalled ) {
+      drop( *s, "timed out" );
+    }
+  }
+
+  void report( Clock::duration elapsed ) const
+  {
+    const auto mbps = []( uint64_t bytes, Clock::duration duration ) {
+      return static_cast<double>( bytes ) * 8 / max( chrono::duration<double>( duration ).count(), 1e-9 ) / 1e6;
+    };
+
+    cerr << fixed << setprecision( 1 );
+    for ( size_t i = 0; i < slots_.size(); ++i ) {
+      const SlotStats& stats = slots_.at( i );
+      if ( stats.responses ) {
+        cerr << "connection " << i << ": " << stats.bytes << " bytes in " << stats.responses << " responses, "
+             << mbps( stats.bytes, stats.last - stats.first ) << " Mbit/s\n";
+      }
+    }
+    cerr << "total: " << bytes_ << " bytes in " << setprecision( 3 ) << chrono::duration<double>( elapsed ).count()
+         << " s, " << setprecision( 1 ) << mbps( bytes_, elapsed ) << " Mbit/s"
+         << ( ranged_ ? "" : " (single stream)" ) << "\n";
+  }
+
+public:
+  // `output` is a file name, or "-" for stdout
+  RangedDownload( const URL& url,
+                  size_t connections,
+                  uint64_t chunk_size,
+                  Clock::duration timeout,
+                  const string& output )
+    : url_( url )
+    , address_( Resolver::global().resolve( url.host, url.service ) )
+    , max_streams_( max( connections, size_t { 1 } ) )
+    , chunk_size_( max( chunk_size, uint64_t { 1 } ) )
+    , timeout_( timeout )
+    , file_()
+    , slots_( max_streams_ )
+  {
+    if ( output != "-" ) {
+      file_.emplace(
+        CheckSystemCall( "open", ::open( output.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 ) ) );
+    }
+  }
+
+  void run()
+  {
+    const auto start = Clock::now();
+    ranges_.push_back( Range { 0, chunk_size_ } ); // the probe; resized once the object's size is known
+    dispatch();
+    while ( ranges_done_ < ranges_.size() ) {
+      loop_.wait_next_event( kTickMs );
+      expire_stalled();
+    }
+    cout.flush();
+    report( Clock::now() - start );
+  }
+};
+
+// read URLs from the command line, or one per line from stdin if there are none
+template<typename Fetcher>
+void add_URLs( Fetcher& fetcher, const vector<string>& urls )
+{
+  if ( urls.empty() ) {
+    string line;
+    while ( getline( cin, line ) ) {
+      if ( not line.empty() ) {
+        fetcher.add( URL::parse( line ) );
+      }
+    }
+  } else {
+    for ( const auto& url : urls ) {
+      fetcher.add( URL::parse( url ) );
+    }
+  }
+}
+
+void get_URLs( const vector<string>& urls, size_t depth, size_t max_connections )
+{
+  PipelinedFetcher fetcher { depth, max_connections };
+  add_URLs( fetcher, urls );
+  fetcher.finish();
+}
+
+void get_URLs_concurrently( const vector<string>& urls, size_t limit, size_t per_host, chrono::seconds timeout )
+{
+  ConcurrentFetcher fetcher { limit, per_host, timeout };
+  add_URLs( fetcher, urls );
+  fetcher.run();
+}
+
+void usage( const char* argv0 )
+{
+  cerr << "Usage: " << argv0 << " HOST PATH\n";
+  cerr << "\tExample: " << argv0 << " stanford.edu /class/cs144\n";
+  cerr << "   or: " << argv0 << " --multi [--pipeline N] [--connections N] [URL...]\n";
+  cerr << "\tFetches each http:// URL (from the command line, or one per line on stdin) over\n"
+          "\tpersistent, pipelined connections.\n";
+  cerr << "   or: " << argv0 << " --concurrent [--limit N] [--per-host N] [--timeout SECONDS] [URL...]\n";
+  cerr << "\tFetches the URLs concurrently from one thread (default: 256 at once, 8 per host), discards\n"
+          "\tthe bodies, and reports throughput and latency percentiles.\n";
+  cerr << "   or: " << argv0
+       << " --ranged [--connections N] [--chunk BYTES] [--timeout SECONDS] [--output FILE] URL\n";
+  cerr << "\tDownloads one URL as byte ranges over parallel connections (default: 4 connections, 4 MiB\n"
+          "\tranges), writing it to FILE or stdout.\n";
+}
+
+} // namespace
+
 int main( int argc, char* argv[] )
 {
   try {
@@ -47,12 +918,47 @@ int main( int argc, char* argv[] )
 
     auto args = span( argv, argc );
 
+    const string_view mode { argc >= 2 ? args[1] : "" };
+    if ( mode == "--multi" or mode == "--concurrent" or mode == "--ranged" ) {
+      unordered_map<string_view, size_t> options;
+      string output = "-";
+      vector<string> urls;
+      for ( size_t i = 2; i < args.size(); ++i ) {
+        const string_view arg { args[i] };
+        if ( arg == "--output" and i + 1 < args.size() ) {
+          output = args[++i];
+        } else if ( arg.starts_with( "--" ) and i + 1 < args.size() ) {
+          options[arg] = stoul( args[++i] );
+        } else {
+          urls.emplace_back( arg );
+        }
+      }
+      const auto option = [&]( string_view name, size_t fallback ) {
+        const auto it = options.find( name );
+        return it == options.end() ? fallback : it->second;
+      };
+      const chrono::seconds timeout { option( "--timeout", 30 ) };
+
+      if ( mode == "--multi" ) {
+        get_URLs( urls, option( "--pipeline", 8 ), option( "--connections", 64 ) );
+      } else if ( mode == "--concurrent" ) {
+        get_URLs_concurrently( urls, option( "--limit", 256 ), option( "--per-host", 8 ), timeout );
+      } else if ( urls.size() == 1 ) {
+        RangedDownload download {
+          URL::parse( urls.front() ), option( "--connections", 4 ), option( "--chunk", 4 << 20 ), timeout, output };
+        download.run();
+      } else {
+        usage( args.front() );
+        return EXIT_FAILURE;
+      }
+      return EXIT_SUCCESS;
+    }
+
     // The program takes two command-line arguments: the hostname and "path" part of the URL.
     // Print the usage message unless there are these two arguments (plus the program name
     // itself, so arg count = 3 in total).
     if ( argc != 3 ) {
-      cerr << "Usage: " << args.front() << " HOST PATH\n";
-      cerr << "\tExample: " << args.front() << " stanford.edu /class/cs144\n";
+      usage( args.front() );
       return EXIT_FAILURE;
     }
 
@@ -4,7 +4,7 @@ list(APPEND CMAKE_CTEST_ARGUMENTS --output-on-failure --stop-on-failure --timeou
 
 set(compile_name "compile with bug-checkers")
 add_test(NAME ${compile_name}
-  COMMAND "${CMAKE_COMMAND}" --build "${CMAKE_BINARY_DIR}" -t functionality_testing webget)
+  COMMAND "${CMAKE_COMMAND}" --build "${CMAKE_BINARY_DIR}" -t functionality_testing webget tpacket_loopback http_server http_load)
 
 macro (ttest name)
   add_test(NAME ${name} COMMAND "${name}_sanitized")
@@ -17,6 +17,17 @@ set_tests_properties(${compile_name} PROPERTIES FIXTURES_SETUP compile)
 add_test(NAME t_webget COMMAND "${PROJECT_SOURCE_DIR}/tests/webget_t.sh" "${PROJECT_BINARY_DIR}")
 set_property(TEST t_webget PROPERTY FIXTURES_REQUIRED compile)
 
+add_test(NAME t_tpacket COMMAND "${PROJECT_SOURCE_DIR}/tests/tpacket_t.sh" "${PROJECT_BINARY_DIR}")
+set_property(TEST t_tpacket PROPERTY FIXTURES_REQUIRED compile)
+set_property(TEST t_tpacket PROPERTY SKIP_RETURN_CODE 77)
+
+add_test(NAME t_bpf_filter COMMAND "${PROJECT_SOURCE_DIR}/tests/bpf_filter_t.sh" "${PROJECT_BINARY_DIR}")
+set_property(TEST t_bpf_filter PROPERTY FIXTURES_REQUIRED compile)
+set_property(TEST t_bpf_filter PROPERTY SKIP_RETURN_CODE 77)
+
+add_test(NAME t_http_server COMMAND "${PROJECT_SOURCE_DIR}/tests/http_server_t.sh" "${PROJECT_BINARY_DIR}")
+set_property(TEST t_http_server PROPERTY FIXTURES_REQUIRED compile)
+
 ttest(byte_stream_basics)
 ttest(byte_stream_capacity)
 ttest(byte_stream_one_write)
@@ -24,8 +35,58 @@ ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
 
+ttest(http_response)
+
+ttest(wrapping_integers_cmp)
+ttest(wrapping_integers_wrap)
+ttest(wrapping_integers_unwrap)
+ttest(wrapping_integers_roundtrip)
+
+ttest(reassembler_single)
+ttest(reassembler_cap)
+ttest(reassembler_seq)
+ttest(reassembler_dup)
+ttest(reassembler_holes)
+ttest(reassembler_overlapping)
+ttest(reassembler_win)
+
+ttest(recv_connect)
+ttest(recv_transmit)
+ttest(recv_window)
+ttest(recv_reorder)
+ttest(recv_close)
+ttest(recv_delayed_ack)
+ttest(recv_sack)
+ttest(recv_timestamps)
+
+ttest(send_connect)
+ttest(send_transmit)
+ttest(send_retx)
+ttest(send_window)
+ttest(send_close)
+ttest(send_congestion)
+ttest(send_sack)
+
+ttest(tcp_segment_roundtrip)
+ttest(simulated_link)
+
+ttest(net_interface)
+
+ttest(datagram_batch)
+ttest(socket_zerocopy)
+ttest(socket_connect_accept)
+ttest(resolver)
+ttest(ipv4_endpoint)
+ttest(sha256)
+
 add_custom_target (check0 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R 'webget|^byte_stream_')
 
+add_custom_target (check1 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^reassembler_')
+
+add_custom_target (check2 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^reassembler_|^wrapping|^recv')
+
+add_custom_target (check3 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^reassembler_|^wrapping|^recv|^send|^tcp_segment|^simulated_link|^net_interface')
+
 add_custom_target (check_webget COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --timeout 12 -R 'webget')
 
 ###
@@ -45,4 +106,13 @@ set_property(TEST ${compile_name_opt} PROPERTY TIMEOUT -1)
 set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 
 stest(byte_stream_speed_test)
+stest(http_response_speed_test)
+stest(sha256_speed_test)
+stest(wrapping_integers_speed_test)
+stest(reassembler_speed_test)
+stest(congestion_control_speed_test)
+stest(tcp_sender_speed_test)
+stest(tcp_segment_speed_test)
+stest(net_interface_speed_test)
+stest(resolver_speed_test)
 
@@ -16,7 +16,7 @@ void debug_print(const char* format, ...) {
 #endif
 }
 
-ByteStream::ByteStream( uint64_t capacity ) : capacity_( capacity ), buffer(deque<string>()),
+ByteStream::ByteStream( uint64_t capacity ) : capacity_( capacity ), buffer(deque<Buffer>()),
 buffer_view(deque<string_view>()) {}
 
 bool ByteStream::buffer_empty() const {
@@ -27,16 +27,15 @@ uint64_t ByteStream::remaining_capacity() const {
     return capacity_ - buffer_size_;
 }
 
-uint64_t ByteStream::copy_to_buffer(string data) {
-    if (remaining_capacity() == 0 || data.size() == 0)
+uint64_t ByteStream::copy_to_buffer(Buffer data, uint64_t offset, uint64_t length) {
+    length = min(length, remaining_capacity());
+    if (length == 0)
         return 0;
-    if (data.size() > remaining_capacity())
-        data = data.substr(0, remaining_capacity());
-    bytes_written_ += data.size();
-    buffer_size_ += data.size();
-    buffer.push_back(std::move(data)); // TODO: std::move?
-    buffer_view.push_back(buffer.back());
-    return buffer.back().size();
+    bytes_written_ += length;
+    buffer_size_ += length;
+    buffer.push_back(std::move(data));
+    buffer_view.push_back(string_view(buffer.back()).substr(offset, length));
+    return length;
 }
 
 uint64_t ByteStream::pop_out(uint64_t len) {
@@ -61,7 +60,15 @@ uint64_t ByteStream::pop_out(uint64_t len) {
 
 void Writer::push( string data )
 {
-  copy_to_buffer(data);
+  const uint64_t length = data.size();
+  copy_to_buffer(Buffer(std::move(data)), 0, length);
+}
+
+void Writer::push( Buffer data, uint64_t offset, uint64_t length )
+{
+  if (offset + length > data.size())
+    throw runtime_error("Writer::push: slice extends past the end of its Buffer");
+  copy_to_buffer(std::move(data), offset, length);
 }
 
 void Writer::close()
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "buffer.hh"
+
 #include <queue>
 #include <stdexcept>
 #include <string>
@@ -17,12 +19,12 @@ class ByteStream
 protected:
   uint64_t capacity_;
 
-  deque<string> buffer;
+  deque<Buffer> buffer;  //!< Pushed chunks, shared (not copied) with whoever handed them over
   deque<string_view> buffer_view;
 
   uint64_t buffer_size_ = 0, bytes_written_ = 0, bytes_read_ = 0;
 
-  uint64_t copy_to_buffer(string data);
+  uint64_t copy_to_buffer(Buffer data, uint64_t offset, uint64_t length);
 
   bool input_ended_{};  //!< Flag indicating that the stream input has ended.
 
@@ -49,6 +51,10 @@ class Writer : public ByteStream
 public:
   void push( std::string data ); // Push data to stream, but only as much as available capacity allows.
 
+  // Push `length` bytes of `data` starting at `offset`, as above. The stream keeps a reference to
+  // `data` rather than copying the bytes.
+  void push( Buffer data, uint64_t offset, uint64_t length );
+
   void close();     // Signal that the stream has reached its ending. Nothing more will be written.
   void set_error(); // Signal that the stream suffered an error.
 
@@ -0,0 +1,241 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+using namespace std;
+
+unique_ptr<CongestionController> make_congestion_controller( TCPConfig::CongestionControl algorithm,
+                                                             uint64_t mss )
+{
+  switch ( algorithm ) {
+    case TCPConfig::CongestionControl::None:
+      return nullptr;
+    case TCPConfig::CongestionControl::NewReno:
+      return make_unique<NewReno>( mss );
+    case TCPConfig::CongestionControl::CUBIC:
+      return make_unique<CUBIC>( mss );
+    case TCPConfig::CongestionControl::BBR:
+      return make_unique<BBR>( mss );
+  }
+  return nullptr;
+}
+
+/* NewReno */
+
+void NewReno::on_ack( uint64_t /* now_ms */,
+                      uint64_t acked,
+                      std::optional<uint64_t> /* rtt_ms */,
+                      uint64_t /* in_flight */ )
+{
+  if ( cwnd_ < ssthresh_ ) {
+    // slow start, counting bytes acknowledged (RFC 3465, L = 2 segments)
+    cwnd_ += min( acked, 2 * mss_ );
+    return;
+  }
+
+  // congestion avoidance: one segment per window acknowledged
+  acked_in_round_ += acked;
+  if ( acked_in_round_ >= cwnd_ ) {
+    acked_in_round_ -= cwnd_;
+    cwnd_ += mss_;
+  }
+}
+
+void NewReno::on_loss( uint64_t /* now_ms */, uint64_t in_flight )
+{
+  ssthresh_ = max( in_flight / 2, 2 * mss_ );
+  cwnd_ = ssthresh_;
+  acked_in_round_ = 0;
+}
+
+void NewReno::on_rto( uint64_t /* now_ms */, uint64_t in_flight )
+{
+  ssthresh_ = max( in_flight / 2, 2 * mss_ );
+  cwnd_ = mss_;
+  acked_in_round_ = 0;
+}
+
+void NewReno::set_mss( uint64_t mss )
+{
+  cwnd_ = cwnd_ / mss_ * mss;
+  mss_ = mss;
+}
+
+/* CUBIC */
+
+void CUBIC::on_ack( uint64_t now_ms, uint64_t acked, std::optional<uint64_t> rtt_ms, uint64_t /* in_flight */ )
+{
+  if ( rtt_ms.has_value() and ( min_rtt_ms_ == 0 or *rtt_ms < min_rtt_ms_ ) ) {
+    min_rtt_ms_ = *rtt_ms;
+  }
+
+  if ( cwnd_ < ssthresh_ ) {
+    cwnd_ += min( static_cast<double>( acked ), 2 * mss_ );
+    return;
+  }
+
+  const double cwnd_segments = cwnd_ / mss_;
+  if ( not epoch_start_ms_.has_value() ) {
+    epoch_start_ms_ = now_ms;
+    if ( cwnd_segments < w_max_ ) {
+      k_ = cbrt( ( w_max_ - cwnd_segments ) / C );
+    } else {
+      k_ = 0;
+      w_max_ = cwnd_segments;
+    }
+    w_est_ = cwnd_segments;
+  }
+
+  // where the cubic curve will be one RTT from now, limited to 1.5x growth per RTT
+  const double t = static_cast<double>( now_ms - *epoch_start_ms_ + min_rtt_ms_ ) / 1000.0;
+  const double target = clamp( C * pow( t - k_, 3 ) + w_max_, cwnd_segments, 1.5 * cwnd_segments );
+
+  const double acked_segments = static_cast<double>( acked ) / mss_;
+  w_est_ += 3 * ( 1 - BETA ) / ( 1 + BETA ) * acked_segments / cwnd_segments;
+
+  if ( w_est_ > target ) {
+    cwnd_ = w_est_ * mss_; // Reno-friendly region
+  } else {
+    cwnd_ += ( target - cwnd_segments ) / cwnd_segments * acked_segments * mss_;
+  }
+}
+
+void CUBIC::reduce()
+{
+  const double cwnd_segments = cwnd_ / mss_;
+  // fast convergence: if this loss came before regaining the last peak, give up some of it
+  w_max_ = cwnd_segments < w_max_ ? cwnd_segments * ( 1 + BETA ) / 2 : cwnd_segments;
+  k_ = cbrt( w_max_ * ( 1 - BETA ) / C );
+  ssthresh_ = max( cwnd_ * BETA, 2 * mss_ );
+  epoch_start_ms_.reset();
+}
+
+void CUBIC::on_loss( uint64_t /* now_ms */, uint64_t /* in_flight */ )
+{
+  reduce();
+  cwnd_ = ssthresh_;
+}
+
+void CUBIC::on_rto( uint64_t /* now_ms */, uint64_t /* in_flight */ )
+{
+  reduce();
+  cwnd_ = mss_;
+}
+
+void CUBIC::set_mss( uint64_t mss )
+{
+  cwnd_ = cwnd_ / mss_ * static_cast<double>( mss );
+  mss_ = static_cast<double>( mss );
+}
+
+/* BBR */
+
+void BBR::on_ack( uint64_t now_ms, uint64_t acked, std::optional<uint64_t> rtt_ms, uint64_t in_flight )
+{
+  if ( acked == 0 ) {
+    return;
+  }
+  rto_recovery_ = false;
+
+  if ( rtt_ms.has_value()
+       and ( min_rtt_ms_ == 0 or *rtt_ms <= min_rtt_ms_ or now_ms - min_rtt_stamp_ms_ > MIN_RTT_WINDOW_MS ) ) {
+    min_rtt_ms_ = max<uint64_t>( *rtt_ms, 1 );
+    min_rtt_stamp_ms_ = now_ms;
+  }
+
+  // delivery rate over about the last round trip
+  delivered_ += acked;
+  delivery_log_.emplace_back( now_ms, delivered_ );
+  const uint64_t interval = max<uint64_t>( min_rtt_ms_, 1 );
+  while ( delivery_log_.size() > 1 and delivery_log_[1].first + interval <= now_ms ) {
+    delivery_log_.pop_front();
+  }
+  const auto [then_ms, delivered_then] = delivery_log_.front();
+  if ( now_ms > then_ms ) {
+    const double rate
+      = static_cast<double>( delivered_ - delivered_then ) / static_cast<double>( now_ms - then_ms );
+
+    // windowed max: a sample outlives older, smaller ones
+    while ( not bw_samples_.empty() and bw_samples_.back().second <= rate ) {
+      bw_samples_.pop_back();
+    }
+    bw_samples_.emplace_back( round_, rate );
+  }
+  while ( not bw_samples_.empty() and bw_samples_.front().first + BW_WINDOW_ROUNDS <= round_ ) {
+    bw_samples_.pop_front();
+  }
+  btl_bw_ = bw_samples_.empty() ? btl_bw_ : bw_samples_.front().second;
+
+  if ( now_ms - round_start_ms_ >= max<uint64_t>( min_rtt_ms_, 1 ) ) {
+    start_round( now_ms, in_flight );
+  }
+
+  if ( mode_ == Mode::Drain and static_cast<double>( in_flight ) <= bdp() ) {
+    mode_ = Mode::ProbeBW;
+    cycle_index_ = 2;
+  }
+}
+
+void BBR::start_round( uint64_t now_ms, uint64_t /* in_flight */ )
+{
+  ++round_;
+  round_start_ms_ = now_ms;
+
+  switch ( mode_ ) {
+    case Mode::Startup:
+      // the pipe is full once three rounds in a row fail to raise the bandwidth by a quarter
+      if ( btl_bw_ >= full_bw_ * 1.25 ) {
+        full_bw_ = btl_bw_;
+        full_bw_rounds_ = 0;
+      } else if ( ++full_bw_rounds_ >= 3 ) {
+        mode_ = Mode::Drain;
+      }
+      break;
+    case Mode::Drain:
+      break;
+    case Mode::ProbeBW:
+      cycle_index_ = ( cycle_index_ + 1 ) % 8;
+      break;
+  }
+}
+
+double BBR::pacing_gain() const
+{
+  static constexpr array<double, 8> probe_bw_gains { 1.25, 0.75, 1, 1, 1, 1, 1, 1 };
+  switch ( mode_ ) {
+    case Mode::Startup:
+      return HIGH_GAIN;
+    case Mode::Drain:
+      return 1 / HIGH_GAIN;
+    case Mode::ProbeBW:
+      return probe_bw_gains.at( cycle_index_ );
+  }
+  return 1;
+}
+
+void BBR::on_rto( uint64_t /* now_ms */, uint64_t /* in_flight */ )
+{
+  rto_recovery_ = true;
+}
+
+uint64_t BBR::cwnd() const
+{
+  if ( rto_recovery_ ) {
+    return mss_;
+  }
+  if ( btl_bw_ == 0 ) {
+    return 10 * mss_;
+  }
+  const double gain = mode_ == Mode::Startup ? HIGH_GAIN : CWND_GAIN;
+  return max( 4 * mss_, static_cast<uint64_t>( gain * bdp() ) );
+}
+
+optional<double> BBR::pacing_rate() const
+{
+  if ( btl_bw_ == 0 ) {
+    return {}; // the initial window goes out unpaced
+  }
+  return pacing_gain() * btl_bw_;
+}
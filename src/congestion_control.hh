@@ -0,0 +1,161 @@
+#pragma once
+
+#include "tcp_config.hh"
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+/*
+ * CongestionController: decides how many bytes a TCPSender may have in flight (and, optionally, how fast to
+ * send them), from what the sender tells it about ACKs and losses. All sizes are in bytes and all times are
+ * in milliseconds of the sender's clock (the sum of its ticks).
+ */
+class CongestionController
+{
+public:
+  // `acked` bytes were newly acknowledged; `rtt_ms` is a round-trip sample, if the ACK provided one
+  virtual void on_ack( uint64_t now_ms, uint64_t acked, std::optional<uint64_t> rtt_ms, uint64_t in_flight ) = 0;
+
+  // Duplicate ACKs showed that a segment was lost (fast retransmit)
+  virtual void on_loss( uint64_t now_ms, uint64_t in_flight ) = 0;
+
+  // The retransmission timer expired
+  virtual void on_rto( uint64_t now_ms, uint64_t in_flight ) = 0;
+
+  // The sender's segment size changed, as when the endpoints agree on an MSS: the window keeps its size in
+  // segments
+  virtual void set_mss( uint64_t mss ) = 0;
+
+  // The most bytes that may be in flight
+  virtual uint64_t cwnd() const = 0;
+
+  // Bytes per millisecond to pace transmissions at, if the algorithm paces
+  virtual std::optional<double> pacing_rate() const { return {}; }
+
+  virtual std::string_view name() const = 0;
+
+  CongestionController() = default;
+  CongestionController( const CongestionController& other ) = default;
+  CongestionController( CongestionController&& other ) noexcept = default;
+  CongestionController& operator=( const CongestionController& other ) = default;
+  CongestionController& operator=( CongestionController&& other ) noexcept = default;
+  virtual ~CongestionController() = default;
+};
+
+// The controller for `algorithm` (nullptr for None), for segments of up to `mss` bytes
+std::unique_ptr<CongestionController> make_congestion_controller( TCPConfig::CongestionControl algorithm,
+                                                                  uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE );
+
+// RFC 5681 slow start and congestion avoidance, with the RFC 6582 response to loss
+class NewReno : public CongestionController
+{
+public:
+  explicit NewReno( uint64_t mss ) : mss_( mss ), cwnd_( 10 * mss ) {}
+
+  void on_ack( uint64_t now_ms, uint64_t acked, std::optional<uint64_t> rtt_ms, uint64_t in_flight ) override;
+  void on_loss( uint64_t now_ms, uint64_t in_flight ) override;
+  void on_rto( uint64_t now_ms, uint64_t in_flight ) override;
+  void set_mss( uint64_t mss ) override;
+  uint64_t cwnd() const override { return cwnd_; }
+  std::string_view name() const override { return "NewReno"; }
+
+  uint64_t ssthresh() const { return ssthresh_; }
+
+private:
+  uint64_t mss_;
+  uint64_t cwnd_;
+  uint64_t ssthresh_ { std::numeric_limits<uint64_t>::max() };
+  uint64_t acked_in_round_ {}; // bytes acknowledged toward the next one-segment increase
+};
+
+// RFC 9438: after a loss, the window follows a cubic function of time since the loss, back up to (and then
+// beyond) where it was, independent of the RTT; with a Reno-friendly floor on short paths.
+class CUBIC : public CongestionController
+{
+public:
+  explicit CUBIC( uint64_t mss ) : mss_( static_cast<double>( mss ) ), cwnd_( 10 * mss_ ) {}
+
+  void on_ack( uint64_t now_ms, uint64_t acked, std::optional<uint64_t> rtt_ms, uint64_t in_flight ) override;
+  void on_loss( uint64_t now_ms, uint64_t in_flight ) override;
+  void on_rto( uint64_t now_ms, uint64_t in_flight ) override;
+  void set_mss( uint64_t mss ) override;
+  uint64_t cwnd() const override { return static_cast<uint64_t>( cwnd_ ); }
+  std::string_view name() const override { return "CUBIC"; }
+
+private:
+  static constexpr double C = 0.4;
+  static constexpr double BETA = 0.7;
+
+  // Shrink the window by BETA, remembering where it was
+  void reduce();
+
+  double mss_;
+  double cwnd_;                                                 // bytes
+  double ssthresh_ { std::numeric_limits<double>::infinity() }; // bytes
+  double w_max_ {};                                             // segments, just before the last reduction
+  double w_est_ {};                                             // segments, Reno-friendly estimate
+  double k_ {};                                                 // seconds from the epoch back to w_max_
+  std::optional<uint64_t> epoch_start_ms_ {};                   // start of the current avoidance epoch
+  uint64_t min_rtt_ms_ {};
+};
+
+// Simplified BBR (v1): estimates the bottleneck bandwidth (the highest delivery rate over the last few
+// rounds) and the path's minimum RTT, paces at gain * bandwidth, and caps in-flight data at a small multiple
+// of their product. Starts by doubling each round until the bandwidth stops growing, drains the queue it
+// built, then cycles its pacing gain to probe for more bandwidth. Loss alone does not shrink the window.
+class BBR : public CongestionController
+{
+public:
+  explicit BBR( uint64_t mss ) : mss_( mss ) {}
+
+  void on_ack( uint64_t now_ms, uint64_t acked, std::optional<uint64_t> rtt_ms, uint64_t in_flight ) override;
+  void on_loss( uint64_t /* now_ms */, uint64_t /* in_flight */ ) override {}
+  void on_rto( uint64_t now_ms, uint64_t in_flight ) override;
+  void set_mss( uint64_t mss ) override { mss_ = mss; }
+  uint64_t cwnd() const override;
+  std::optional<double> pacing_rate() const override;
+  std::string_view name() const override { return "BBR"; }
+
+  double bottleneck_bandwidth() const { return btl_bw_; } // bytes per ms
+  uint64_t min_rtt_ms() const { return min_rtt_ms_; }
+
+private:
+  enum class Mode : uint8_t
+  {
+    Startup,
+    Drain,
+    ProbeBW
+  };
+
+  static constexpr double HIGH_GAIN = 2.885; // 2 / ln 2: doubles the sending rate each round
+  static constexpr double CWND_GAIN = 2.0;
+  static constexpr uint64_t BW_WINDOW_ROUNDS = 10;
+  static constexpr uint64_t MIN_RTT_WINDOW_MS = 10000;
+
+  double bdp() const { return btl_bw_ * static_cast<double>( min_rtt_ms_ ); }
+  double pacing_gain() const;
+  void start_round( uint64_t now_ms, uint64_t in_flight );
+
+  uint64_t mss_;
+  Mode mode_ { Mode::Startup };
+
+  uint64_t delivered_ {};                                      // total bytes acknowledged
+  std::deque<std::pair<uint64_t, uint64_t>> delivery_log_ {}; // (time, delivered_) over about the last RTT
+  std::deque<std::pair<uint64_t, double>> bw_samples_ {};      // (round, rate) for the max filter
+  double btl_bw_ {};
+
+  uint64_t min_rtt_ms_ {};
+  uint64_t min_rtt_stamp_ms_ {};
+
+  uint64_t round_ {};
+  uint64_t round_start_ms_ {};
+  double full_bw_ {};
+  unsigned full_bw_rounds_ {};
+  unsigned cycle_index_ {};
+  bool rto_recovery_ {}; // after a timeout, hold to one segment until something is acknowledged
+};
@@ -0,0 +1,110 @@
+#include "http_client.hh"
+
+#include <stdexcept>
+#include <sys/epoll.h>
+
+using namespace std;
+
+URL URL::parse( string_view text )
+{
+  URL url;
+  url.text = text;
+
+  if ( text.starts_with( "http://" ) ) {
+    text.remove_prefix( 7 );
+  } else if ( text.find( "://" ) != string_view::npos ) {
+    throw runtime_error( "only http:// URLs are supported: " + url.text );
+  }
+
+  const size_t slash = text.find( '/' );
+  if ( slash != string_view::npos ) {
+    url.path = text.substr( slash );
+  }
+  const string_view authority = text.substr( 0, slash );
+  const size_t colon = authority.find( ':' );
+  url.host = authority.substr( 0, colon );
+  if ( colon != string_view::npos ) {
+    url.service = authority.substr( colon + 1 );
+  }
+
+  if ( url.host.empty() ) {
+    throw runtime_error( "missing host in URL: " + url.text );
+  }
+  return url;
+}
+
+AsyncHTTPConnection::AsyncHTTPConnection( const Address& address )
+{
+  connected_ = socket_.connect_nonblocking( address );
+}
+
+uint32_t AsyncHTTPConnection::wanted() const
+{
+  return connected_ and outbound_.empty() ? EPOLLIN : EPOLLIN | EPOLLOUT; // NOLINT(*-bitwise)
+}
+
+bool AsyncHTTPConnection::reusable() const
+{
+  return parser_.keep_alive() and not socket_.eof() and inbound_.reader().bytes_buffered() == 0;
+}
+
+void AsyncHTTPConnection::send( string request )
+{
+  outbound_ = move( request );
+  parser_.reset();
+  got_bytes_ = false;
+}
+
+void AsyncHTTPConnection::watch( EventLoop& loop, EventLoop::Handler handler )
+{
+  watched_ = wanted();
+  loop.add( socket_, watched_, move( handler ) );
+}
+
+void AsyncHTTPConnection::update( EventLoop& loop )
+{
+  if ( wanted() != watched_ ) {
+    watched_ = wanted();
+    loop.modify( socket_, watched_ );
+  }
+}
+
+bool AsyncHTTPConnection::on_event( uint32_t events,
+                                    const HTTPResponseParser::BodyCallback& on_body,
+                                    const HeadCallback& on_head )
+{
+  if ( not connected_ ) {
+    socket_.throw_if_error();
+    connected_ = true;
+  }
+
+  if ( not outbound_.empty() and ( events & EPOLLOUT ) ) { // NOLINT(*-bitwise)
+    outbound_.erase( 0, socket_.write( outbound_ ) );
+  }
+
+  if ( not( events & ( EPOLLIN | EPOLLHUP | EPOLLERR ) ) ) { // NOLINT(*-bitwise)
+    return false;
+  }
+
+  while ( true ) {
+    socket_.read( buffer_ );
+    if ( not buffer_.empty() ) {
+      got_bytes_ = true;
+      inbound_.writer().push( move( buffer_ ) );
+    } else if ( socket_.eof() ) {
+      inbound_.writer().close();
+    } else {
+      return false; // nothing more until the next event
+    }
+
+    if ( on_head and not parser_.head_done() and parser_.parse_head( inbound_.reader() ) ) {
+      on_head( parser_.head() );
+    }
+    if ( parser_.parse( inbound_.reader(), on_body ) ) {
+      return true;
+    }
+    if ( inbound_.writer().is_closed() ) {
+      throw runtime_error( "connection closed before the response finished" );
+    }
+  }
+}
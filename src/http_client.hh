@@ -0,0 +1,71 @@
+#pragma once
+
+#include "byte_stream.hh"
+#include "event_loop.hh"
+#include "http_response.hh"
+#include "socket.hh"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// An http:// URL split into the parts needed to fetch it
+struct URL
+{
+  std::string text {};
+  std::string host {};
+  std::string service { "http" };
+  std::string path { "/" };
+
+  static URL parse( std::string_view text );
+
+  std::string origin() const { return host + ":" + service; }
+  std::string host_header() const { return service == "http" ? host : host + ":" + service; }
+};
+
+// A non-blocking HTTP/1.1 connection, carrying one request at a time, driven by EventLoop readiness events
+class AsyncHTTPConnection
+{
+  static constexpr uint64_t kInboundCapacity = 1 << 20;
+
+  TCPSocket socket_ {};
+  bool connected_ {};
+  std::string outbound_ {};
+  ByteStream inbound_ { kInboundCapacity };
+  HTTPResponseParser parser_ {};
+  bool got_bytes_ {};
+  uint32_t watched_ {}; // events registered with the EventLoop
+  std::string buffer_ {};
+
+  uint32_t wanted() const;
+
+public:
+  // start connecting to `address`
+  explicit AsyncHTTPConnection( const Address& address );
+
+  const HTTPResponseParser& response() const { return parser_; }
+  bool got_bytes() const { return got_bytes_; } // has any of the current response arrived?
+
+  // may another request follow the completed response?
+  bool reusable() const;
+
+  // send `request` (a complete request head) once the connection is writable
+  void send( std::string request );
+
+  void watch( EventLoop& loop, EventLoop::Handler handler );
+
+  // bring the registered events up to date (e.g., after send() or on_event())
+  void update( EventLoop& loop );
+
+  void unwatch( EventLoop& loop ) { loop.remove( socket_ ); }
+
+  using HeadCallback = std::function<void( const HTTPResponseHead& )>;
+
+  // Handle readiness `events`, passing the response head to `on_head` (while its header fields are available)
+  // and body bytes to `on_body`. Returns true once the response is complete. Throws if the connection fails or
+  // closes before then.
+  bool on_event( uint32_t events,
+                 const HTTPResponseParser::BodyCallback& on_body,
+                 const HeadCallback& on_head = {} );
+};
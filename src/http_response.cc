@@ -0,0 +1,413 @@
+#include "http_response.hh"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+constexpr size_t kMaxLineLength = 65536;
+constexpr size_t kMaxHeadLength = 65536;
+
+// Position of the first `a` or `b` in `data` (npos if neither occurs), sixteen bytes at a time where possible
+size_t find_either( string_view data, char a, char b )
+{
+  size_t i = 0;
+#if defined( __SSE2__ )
+  const __m128i va = _mm_set1_epi8( a );
+  const __m128i vb = _mm_set1_epi8( b );
+  for ( ; i + sizeof( __m128i ) <= data.size(); i += sizeof( __m128i ) ) {
+    const auto* const p = reinterpret_cast<const __m128i*>( data.data() + i ); // NOLINT(*-reinterpret-cast)
+    const __m128i block = _mm_loadu_si128( p );
+    const int mask = _mm_movemask_epi8( _mm_or_si128( _mm_cmpeq_epi8( block, va ), _mm_cmpeq_epi8( block, vb ) ) );
+    if ( mask ) {
+      return i + __builtin_ctz( mask );
+    }
+  }
+#endif
+  for ( ; i < data.size(); ++i ) {
+    if ( data[i] == a or data[i] == b ) {
+      return i;
+    }
+  }
+  return string_view::npos;
+}
+
+size_t find_newline( string_view data )
+{
+  return find_either( data, '\n', '\n' );
+}
+
+// `line` without its trailing CR, if any
+string_view strip_cr( string_view line )
+{
+  if ( not line.empty() and line.back() == '\r' ) {
+    line.remove_suffix( 1 );
+  }
+  return line;
+}
+
+// Offset just past the blank line ending a head block in `data`, searching from `from`; npos if none yet
+size_t find_head_end( string_view data, size_t from )
+{
+  while ( from < data.size() ) {
+    const size_t newline = find_newline( data.substr( from ) );
+    if ( newline == string_view::npos ) {
+      return string_view::npos;
+    }
+    const size_t end = from + newline + 1;
+    // a blank line is "\n" or "\r\n" right after the previous line's newline
+    const bool lf_lf = end >= 2 and data[end - 2] == '\n';
+    const bool lf_crlf = end >= 3 and data[end - 3] == '\n' and data[end - 2] == '\r';
+    if ( lf_lf or lf_crlf ) {
+      return end;
+    }
+    from = end;
+  }
+  return string_view::npos;
+}
+
+bool equals_ignore_case( string_view a, string_view b )
+{
+  return a.size() == b.size() and equal( a.begin(), a.end(), b.begin(), []( char x, char y ) {
+           return tolower( static_cast<unsigned char>( x ) ) == tolower( static_cast<unsigned char>( y ) );
+         } );
+}
+
+string_view trim( string_view s )
+{
+  while ( not s.empty() and ( s.front() == ' ' or s.front() == '\t' ) ) {
+    s.remove_prefix( 1 );
+  }
+  while ( not s.empty() and ( s.back() == ' ' or s.back() == '\t' ) ) {
+    s.remove_suffix( 1 );
+  }
+  return s;
+}
+
+// does the comma-separated header value contain `token`?
+bool has_token( string_view value, string_view token )
+{
+  while ( not value.empty() ) {
+    const size_t comma = value.find( ',' );
+    if ( equals_ignore_case( trim( value.substr( 0, comma ) ), token ) ) {
+      return true;
+    }
+    if ( comma == string_view::npos ) {
+      break;
+    }
+    value.remove_prefix( comma + 1 );
+  }
+  return false;
+}
+} // namespace
+
+optional<string_view> HTTPResponseHead::header( string_view name ) const
+{
+  for ( const auto& [field, value] : headers ) {
+    if ( equals_ignore_case( field, name ) ) {
+      return value;
+    }
+  }
+  return {};
+}
+
+bool HTTPResponseParser::keep_alive() const
+{
+  if ( state_ == State::Done and not remaining_.has_value() ) {
+    return false; // the body was delimited by the connection closing
+  }
+  return http10_ ? connection_keep_alive_ : not connection_close_;
+}
+
+void HTTPResponseParser::reset( bool head_request )
+{
+  auto headers = move( head_.headers );
+  auto head_copy = move( head_copy_ );
+  auto line = move( line_ );
+  headers.clear();
+  head_copy.clear();
+  line.clear();
+
+  *this = HTTPResponseParser { head_request };
+  head_.headers = move( headers );
+  head_copy_ = move( head_copy );
+  line_ = move( line );
+}
+
+bool HTTPResponseParser::next_line( Reader& reader, string_view& line, uint64_t& consumed )
+{
+  while ( reader.bytes_buffered() ) {
+    const string_view chunk = reader.peek();
+    const size_t newline = find_newline( chunk );
+
+    if ( newline != string_view::npos and line_.empty() ) {
+      line = strip_cr( chunk.substr( 0, newline ) ); // entirely within this chunk
+      consumed = newline + 1;
+      return true;
+    }
+
+    const size_t take = newline == string_view::npos ? chunk.size() : newline + 1;
+    if ( line_.size() + take > kMaxLineLength ) {
+      throw runtime_error( "HTTP response line too long" );
+    }
+    line_.append( chunk.substr( 0, take ) );
+    reader.pop( take );
+
+    if ( newline != string_view::npos ) {
+      line = strip_cr( string_view { line_ }.substr( 0, line_.size() - 1 ) );
+      consumed = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HTTPResponseParser::parse_head_block( string_view block )
+{
+  head_ = { {}, {}, {}, move( head_.headers ) };
+  head_.headers.clear();
+
+  // status-line = HTTP-version SP status-code SP [ reason-phrase ]
+  size_t newline = find_newline( block );
+  const string_view status_line = strip_cr( block.substr( 0, newline ) );
+  block.remove_prefix( newline + 1 );
+
+  const size_t sp1 = status_line.find( ' ' );
+  if ( sp1 == string_view::npos or not status_line.starts_with( "HTTP/" ) ) {
+    throw runtime_error( "malformed HTTP status line: " + string( status_line ) );
+  }
+  head_.version = status_line.substr( 0, sp1 );
+
+  const string_view rest = status_line.substr( sp1 + 1 );
+  const auto [ptr, ec]
+    = from_chars( rest.data(), rest.data() + min( rest.size(), size_t { 3 } ), head_.status_code );
+  if ( ec != errc {} or ptr != rest.data() + 3 ) {
+    throw runtime_error( "malformed HTTP status code: " + string( status_line ) );
+  }
+  head_.reason = trim( rest.substr( 3 ) );
+
+  // interim (1xx) responses are followed by the real one
+  if ( head_.status_code >= 100 and head_.status_code < 200 and head_.status_code != 101 ) {
+    return false;
+  }
+
+  // field-line = field-name ":" OWS field-value OWS, one per line until the blank line
+  while ( true ) {
+    const size_t delimiter = find_either( block, ':', '\n' );
+    if ( delimiter == string_view::npos ) {
+      throw runtime_error( "HTTP head ended without a blank line" );
+    }
+    if ( block[delimiter] == '\n' ) {
+      if ( not strip_cr( block.substr( 0, delimiter ) ).empty() ) {
+        throw runtime_error( "malformed HTTP header field: " + string( strip_cr( block.substr( 0, delimiter ) ) ) );
+      }
+      break; // the blank line
+    }
+    if ( delimiter == 0 ) {
+      throw runtime_error( "HTTP header field with an empty name" );
+    }
+
+    newline = delimiter + 1 + find_newline( block.substr( delimiter + 1 ) );
+    const string_view name = block.substr( 0, delimiter );
+    const string_view value = trim( strip_cr( block.substr( delimiter + 1, newline - delimiter - 1 ) ) );
+    head_.headers.emplace_back( name, value );
+    block.remove_prefix( newline + 1 );
+
+    // remember what framing and persistence need, since the fields themselves won't outlive the head's bytes
+    if ( equals_ignore_case( name, "Connection" ) ) {
+      connection_close_ = connection_close_ or has_token( value, "close" );
+      connection_keep_alive_ = connection_keep_alive_ or has_token( value, "keep-alive" );
+    } else if ( equals_ignore_case( name, "Transfer-Encoding" ) ) {
+      chunked_ = chunked_ or has_token( value, "chunked" );
+    } else if ( equals_ignore_case( name, "Content-Length" ) and not content_length_.has_value() ) {
+      uint64_t length {};
+      const auto [end, error] = from_chars( value.data(), value.data() + value.size(), length );
+      if ( error != errc {} or end != value.data() + value.size() ) {
+        throw runtime_error( "malformed Content-Length: " + string( value ) );
+      }
+      content_length_ = length;
+    }
+  }
+
+  http10_ = head_.version == "HTTP/1.0";
+  return true;
+}
+
+bool HTTPResponseParser::parse_head( Reader& reader )
+{
+  while ( state_ == State::Head and reader.bytes_buffered() ) {
+    const string_view chunk = reader.peek();
+
+    // common case: the whole head is in the front chunk, so parse it where it lies
+    if ( head_copy_.empty() ) {
+      const size_t end = find_head_end( chunk, 0 );
+      if ( end != string_view::npos ) {
+        if ( parse_head_block( chunk.substr( 0, end ) ) ) {
+          head_in_stream_ = end;
+          state_ = State::HeadParsed;
+        } else {
+          reader.pop( end ); // skip the interim response
+        }
+        continue;
+      }
+    }
+
+    // otherwise gather it into head_copy_, popping only the bytes that belong to the head
+    const size_t old_size = head_copy_.size();
+    head_copy_.append( chunk );
+    const size_t end = find_head_end( head_copy_, head_scanned_ );
+    if ( end == string_view::npos ) {
+      if ( head_copy_.size() > kMaxHeadLength ) {
+        throw runtime_error( "HTTP response head too long" );
+      }
+      head_scanned_ = head_copy_.size();
+      reader.pop( chunk.size() );
+      continue;
+    }
+
+    head_copy_.resize( end );
+    reader.pop( end - old_size );
+    head_scanned_ = 0;
+    if ( parse_head_block( head_copy_ ) ) {
+      state_ = State::HeadParsed;
+    } else {
+      head_copy_.clear();
+    }
+  }
+  return head_done();
+}
+
+void HTTPResponseParser::start_body()
+{
+  if ( head_request_ or head_.status_code == 204 or head_.status_code == 304 ) {
+    remaining_ = 0;
+    state_ = State::Done;
+  } else if ( chunked_ ) {
+    state_ = State::ChunkSize;
+  } else if ( content_length_.has_value() ) {
+    remaining_ = content_length_;
+    state_ = *content_length_ ? State::Body : State::Done;
+  } else {
+    remaining_.reset(); // read until the connection closes
+    state_ = State::Body;
+  }
+}
+
+void HTTPResponseParser::parse_chunk_size( string_view line )
+{
+  // chunk-size [ chunk-ext ]
+  const string_view digits = line.substr( 0, line.find_first_of( "; \t" ) );
+  uint64_t size {};
+  const auto [ptr, ec] = from_chars( digits.data(), digits.data() + digits.size(), size, 16 );
+  if ( digits.empty() or ec != errc {} or ptr != digits.data() + digits.size() ) {
+    throw runtime_error( "malformed chunk size: " + string( line ) );
+  }
+
+  remaining_ = size;
+  state_ = size ? State::ChunkData : State::Trailers;
+}
+
+bool HTTPResponseParser::read_body( Reader& reader, const BodyCallback& on_body )
+{
+  while ( reader.bytes_buffered() and remaining_.value_or( 1 ) > 0 ) {
+    string_view chunk = reader.peek();
+    if ( remaining_.has_value() ) {
+      chunk = chunk.substr( 0, *remaining_ );
+      *remaining_ -= chunk.size();
+    }
+    on_body( chunk );
+    body_bytes_ += chunk.size();
+    reader.pop( chunk.size() );
+  }
+  return remaining_.has_value() and *remaining_ == 0;
+}
+
+bool HTTPResponseParser::parse( Reader& reader, const BodyCallback& on_body )
+{
+  string_view line;
+  uint64_t consumed {};
+
+  while ( state_ != State::Done ) {
+    switch ( state_ ) {
+      case State::Head:
+        if ( not parse_head( reader ) ) {
+          break;
+        }
+        continue;
+
+      case State::HeadParsed:
+        // the header fields are about to be popped; everything parse() needs was noted in parse_head_block()
+        reader.pop( head_in_stream_ );
+        head_in_stream_ = 0;
+        head_.headers.clear();
+        head_.version = head_.reason = {};
+        start_body();
+        continue;
+
+      case State::Body:
+        if ( read_body( reader, on_body ) ) {
+          state_ = State::Done;
+          continue;
+        }
+        if ( not remaining_.has_value() and reader.is_finished() ) {
+          state_ = State::Done; // close-delimited body ended
+          continue;
+        }
+        break;
+
+      case State::ChunkSize:
+        if ( not next_line( reader, line, consumed ) ) {
+          break;
+        }
+        parse_chunk_size( line );
+        reader.pop( consumed );
+        line_.clear();
+        continue;
+
+      case State::ChunkData:
+        if ( read_body( reader, on_body ) ) {
+          state_ = State::ChunkDataCRLF;
+          continue;
+        }
+        break;
+
+      case State::ChunkDataCRLF:
+        if ( not next_line( reader, line, consumed ) ) {
+          break;
+        }
+        if ( not line.empty() ) {
+          throw runtime_error( "missing CRLF after chunk data" );
+        }
+        reader.pop( consumed );
+        line_.clear();
+        state_ = State::ChunkSize;
+        continue;
+
+      case State::Trailers:
+        if ( not next_line( reader, line, consumed ) ) {
+          break;
+        }
+        if ( line.empty() ) {
+          remaining_ = 0;
+          state_ = State::Done;
+        }
+        reader.pop( consumed );
+        line_.clear();
+        continue;
+
+      case State::Done:
+        continue;
+    }
+
+    // no progress possible without more input
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "byte_stream.hh"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// The status line and header fields of an HTTP/1.1 response, as views into the bytes they were parsed from
+struct HTTPResponseHead
+{
+  std::string_view version {};
+  unsigned status_code {};
+  std::string_view reason {};
+  std::vector<std::pair<std::string_view, std::string_view>> headers {};
+
+  // Value of the first header named `name` (compared case-insensitively), if present
+  std::optional<std::string_view> header( std::string_view name ) const;
+};
+
+/*
+ * HTTPResponseParser: consumes HTTP/1.1 responses incrementally from a ByteStream Reader.
+ *
+ * Call parse() whenever more bytes have been pushed into the stream. It pops what it has
+ * consumed, passes body bytes to the `on_body` callback (already de-chunked, as views into the
+ * stream), and returns true once the whole response has arrived. If it returns false after the
+ * stream has finished, the response was cut short. Bodies are framed by Content-Length, chunked
+ * transfer coding, or (as a last resort) the end of the stream. Call reset() before parsing the
+ * next response on a persistent connection.
+ *
+ * To look at the header fields, call parse_head() first. The fields are views, not copies: into
+ * the Reader's front chunk when the whole head arrived in one (the head's bytes are then left in
+ * the stream until parse() moves on to the body), or else into the parser's own buffer.
+ */
+class HTTPResponseParser
+{
+public:
+  using BodyCallback = std::function<void( std::string_view )>;
+
+  // `head_request`: the response answers a HEAD request, so it has no body regardless of its headers
+  explicit HTTPResponseParser( bool head_request = false ) : head_request_( head_request ) {}
+
+  // Parse the status line and header fields, popping only what does not fit in place; returns true once
+  // head() is complete. Its views stay valid until the next parse() or reset().
+  bool parse_head( Reader& reader );
+
+  // Consume as much of `reader` as possible; returns true once the response is complete
+  bool parse( Reader& reader, const BodyCallback& on_body );
+
+  bool head_done() const { return state_ > State::Head; } // Has the status line and header block arrived?
+  bool done() const { return state_ == State::Done; }     // Has the whole response arrived?
+  const HTTPResponseHead& head() const { return head_; }  // Status line (fields: see parse_head())
+  uint64_t body_bytes() const { return body_bytes_; }     // De-chunked body bytes delivered so far
+
+  // May the connection carry another response after this one?
+  bool keep_alive() const;
+
+  // Prepare for the next response on the same connection (keeping allocated buffers)
+  void reset( bool head_request = false );
+
+private:
+  enum class State
+  {
+    Head,          // status line and header fields
+    HeadParsed,    // head() is complete; its bytes may still be in the stream
+    Body,          // Content-Length or close-delimited body
+    ChunkSize,     // chunk-size line
+    ChunkData,     // chunk payload
+    ChunkDataCRLF, // CRLF after a chunk payload
+    Trailers,      // trailer fields after the last chunk
+    Done
+  };
+
+  bool head_request_;
+  State state_ { State::Head };
+  HTTPResponseHead head_ {};
+
+  std::string head_copy_ {};      // the head so far, when it did not arrive within one chunk
+  size_t head_scanned_ {};        // bytes of head_copy_ already searched for the blank line
+  uint64_t head_in_stream_ {};    // bytes of the head parsed in place and not yet popped
+  bool http10_ {};                // HTTP/1.0 response?
+  bool connection_close_ {};      // "Connection: close"?
+  bool connection_keep_alive_ {}; // "Connection: keep-alive"?
+  bool chunked_ {};               // chunked transfer coding?
+  std::optional<uint64_t> content_length_ {};
+
+  std::string line_ {};                  // partial line carried across stream chunks
+  std::optional<uint64_t> remaining_ {}; // body or chunk bytes still expected (empty = until close)
+  uint64_t body_bytes_ {};
+
+  // Next line (without CRLF) from `reader`: a view into the stream (pop `consumed` bytes once done with it),
+  // or, if it spanned chunks, into line_. Returns false if the line is not complete yet.
+  bool next_line( Reader& reader, std::string_view& line, uint64_t& consumed );
+
+  // Parse a complete head block (ending with its blank line) into head_; returns false for an interim response
+  bool parse_head_block( std::string_view block );
+
+  void start_body();
+  void parse_chunk_size( std::string_view line );
+
+  // Deliver up to remaining_ body bytes; returns true when remaining_ reaches zero
+  bool read_body( Reader& reader, const BodyCallback& on_body );
+};
@@ -0,0 +1,249 @@
+#include "network_interface.hh"
+#include "ipv4_endpoint.hh"
+#include "tcp_config.hh"
+#include "tcp_segment.hh"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+using namespace std;
+
+// A TCPSender's payloads leave room for all three headers, so its frames are built in place
+static_assert( EthernetHeaderView::LENGTH + IPv4HeaderView::MIN_LENGTH + TCPHeaderView::MAX_LENGTH
+               <= TCPConfig::HEADROOM );
+
+NetworkInterface::NetworkInterface( const EthernetAddress& ethernet_address,
+                                    uint32_t ip_address,
+                                    TransmitFunction transmit,
+                                    const NetworkInterfaceConfig& config )
+  : ethernet_address_( ethernet_address )
+  , ip_address_( ip_address )
+  , transmit_( move( transmit ) )
+  , config_( config )
+  , table_( bit_ceil( max<size_t>( 2 * config.max_neighbors, 2 ) ) )
+  , mask_( table_.size() - 1 )
+  , pending_( config.max_pending )
+{
+  if ( config.max_pending >= NONE ) {
+    throw runtime_error( "NetworkInterface: max_pending is too large" );
+  }
+  for ( uint32_t i = 0; i < pending_.size(); ++i ) {
+    pending_[i].next = i + 1 < pending_.size() ? i + 1 : NONE;
+  }
+  free_pending_ = pending_.empty() ? NONE : 0;
+}
+
+NetworkInterface::TransmitFunction NetworkInterface::transmit_to( PacketSocket& socket )
+{
+  return [&socket]( const Buffer& frame ) {
+    if ( not socket.queue_frame( frame ) ) {
+      socket.flush_frames();
+      if ( not socket.queue_frame( frame ) ) {
+        throw runtime_error( "NetworkInterface: frame does not fit in the TX ring" );
+      }
+    }
+  };
+}
+
+void NetworkInterface::send_datagram( Buffer datagram, uint32_t next_hop )
+{
+  size_t slot = find( next_hop );
+  if ( slot != NO_SLOT and table_[slot].deadline_ms <= now_ms_ ) {
+    erase( slot ); // expired: ask again
+    slot = NO_SLOT;
+  }
+
+  if ( slot != NO_SLOT and table_[slot].resolved ) {
+    send_frame( table_[slot].ethernet_address, move( datagram ) );
+    return;
+  }
+
+  if ( slot == NO_SLOT ) {
+    slot = insert( next_hop );
+    if ( slot == NO_SLOT ) {
+      ++dropped_;
+      return;
+    }
+    table_[slot].deadline_ms = now_ms_ + config_.request_timeout_ms;
+    send_arp( ARPMessage::OPCODE_REQUEST, ETHERNET_BROADCAST, next_hop );
+  }
+  enqueue( table_[slot], move( datagram ) );
+}
+
+optional<Buffer> NetworkInterface::recv_frame( const Buffer& frame )
+{
+  const string_view bytes = frame;
+  if ( bytes.size() < EthernetHeaderView::LENGTH ) {
+    return {};
+  }
+  const EthernetHeaderView header { bytes };
+  const EthernetAddress destination = header.destination();
+  if ( destination != ethernet_address_ and destination != ETHERNET_BROADCAST ) {
+    return {};
+  }
+
+  if ( header.type() == EthernetHeaderView::TYPE_IPv4 ) {
+    return frame.slice( EthernetHeaderView::LENGTH, bytes.size() - EthernetHeaderView::LENGTH );
+  }
+  if ( header.type() != EthernetHeaderView::TYPE_ARP ) {
+    return {};
+  }
+  const optional<ARPMessage> arp = parse_arp( bytes.substr( EthernetHeaderView::LENGTH ) );
+  if ( not arp.has_value() ) {
+    return {};
+  }
+
+  // Learn the sender's address if it is already in the cache, or if it is asking for ours (RFC 826)
+  const bool for_us = arp->target_ip_address == ip_address_;
+  size_t slot = find( arp->sender_ip_address );
+  if ( slot == NO_SLOT and for_us ) {
+    slot = insert( arp->sender_ip_address );
+  }
+  if ( slot != NO_SLOT ) {
+    Entry& entry = table_[slot];
+    entry.resolved = true;
+    entry.ethernet_address = arp->sender_ethernet_address;
+    entry.deadline_ms = now_ms_ + config_.mapping_ttl_ms;
+    flush( entry );
+  }
+
+  if ( for_us and arp->opcode == ARPMessage::OPCODE_REQUEST ) {
+    send_arp( ARPMessage::OPCODE_REPLY, arp->sender_ethernet_address, arp->sender_ip_address );
+  }
+  return {};
+}
+
+void NetworkInterface::tick( uint64_t ms_since_last_tick )
+{
+  now_ms_ += ms_since_last_tick;
+
+  // Sweep part of the cache, in proportion to the time passed, so all of it is examined once per period.
+  // Erasing may shift the next entry into the slot just examined, so the hand only moves on past a slot
+  // that stays (each erasure is extra work, but each entry is erased only once).
+  const size_t budget
+    = min( table_.size(), ( table_.size() * ms_since_last_tick + SWEEP_PERIOD_MS - 1 ) / SWEEP_PERIOD_MS );
+  for ( size_t examined = 0; examined < budget; ) {
+    if ( table_[sweep_hand_].used and table_[sweep_hand_].deadline_ms <= now_ms_ ) {
+      erase( sweep_hand_ );
+    } else {
+      sweep_hand_ = ( sweep_hand_ + 1 ) & mask_; // NOLINT(*-bitwise)
+      ++examined;
+    }
+  }
+}
+
+optional<EthernetAddress> NetworkInterface::lookup( uint32_t ip_address ) const
+{
+  const size_t slot = find( ip_address );
+  if ( slot == NO_SLOT or not table_[slot].resolved or table_[slot].deadline_ms <= now_ms_ ) {
+    return {};
+  }
+  return table_[slot].ethernet_address;
+}
+
+size_t NetworkInterface::home( uint32_t ip ) const
+{
+  return mix64( ip ) & mask_; // NOLINT(*-bitwise)
+}
+
+size_t NetworkInterface::find( uint32_t ip ) const
+{
+  for ( size_t slot = home( ip ); table_[slot].used; slot = ( slot + 1 ) & mask_ ) { // NOLINT(*-bitwise)
+    if ( table_[slot].ip == ip ) {
+      return slot;
+    }
+  }
+  return NO_SLOT;
+}
+
+size_t NetworkInterface::insert( uint32_t ip )
+{
+  if ( size_ >= config_.max_neighbors ) {
+    return NO_SLOT;
+  }
+  size_t slot = home( ip );
+  while ( table_[slot].used ) {
+    slot = ( slot + 1 ) & mask_; // NOLINT(*-bitwise)
+  }
+  table_[slot] = { .ip = ip, .used = true };
+  ++size_;
+  return slot;
+}
+
+void NetworkInterface::erase( size_t slot )
+{
+  Entry& entry = table_[slot];
+  dropped_ += entry.queued;
+  while ( entry.head != NONE ) {
+    const uint32_t next = pending_[entry.head].next;
+    pending_[entry.head] = { {}, free_pending_ };
+    free_pending_ = entry.head;
+    entry.head = next;
+  }
+
+  // Move back any later entry of the same probe run that could not have been placed at or before the gap
+  size_t gap = slot;
+  for ( size_t next = ( gap + 1 ) & mask_; table_[next].used; next = ( next + 1 ) & mask_ ) { // NOLINT(*-bitwise)
+    const size_t distance_to_gap = ( gap - home( table_[next].ip ) ) & mask_;   // NOLINT(*-bitwise)
+    const size_t distance_to_next = ( next - home( table_[next].ip ) ) & mask_; // NOLINT(*-bitwise)
+    if ( distance_to_gap < distance_to_next ) {
+      table_[gap] = table_[next];
+      gap = next;
+    }
+  }
+  table_[gap] = {};
+  --size_;
+}
+
+void NetworkInterface::send_frame( const EthernetAddress& destination, Buffer datagram )
+{
+  transmit_(
+    serialize_ethernet_frame( destination, ethernet_address_, EthernetHeaderView::TYPE_IPv4, move( datagram ) ) );
+}
+
+void NetworkInterface::send_arp( uint16_t opcode, const EthernetAddress& destination, uint32_t target_ip )
+{
+  const ARPMessage arp { opcode,
+                         ethernet_address_,
+                         ip_address_,
+                         opcode == ARPMessage::OPCODE_REPLY ? destination : EthernetAddress {},
+                         target_ip };
+  transmit_( serialize_arp_frame( destination, ethernet_address_, arp ) );
+}
+
+void NetworkInterface::enqueue( Entry& entry, Buffer&& datagram )
+{
+  if ( free_pending_ == NONE or entry.queued >= config_.max_pending_per_neighbor ) {
+    ++dropped_;
+    return;
+  }
+  const uint32_t index = free_pending_;
+  free_pending_ = pending_[index].next;
+  pending_[index] = { move( datagram ), NONE };
+
+  if ( entry.tail == NONE ) {
+    entry.head = index;
+  } else {
+    pending_[entry.tail].next = index;
+  }
+  entry.tail = index;
+  ++entry.queued;
+}
+
+void NetworkInterface::flush( Entry& entry )
+{
+  const EthernetAddress destination = entry.ethernet_address;
+  uint32_t index = entry.head;
+  entry.head = entry.tail = NONE;
+  entry.queued = 0;
+
+  while ( index != NONE ) {
+    const uint32_t next = pending_[index].next;
+    Buffer datagram = move( *pending_[index].datagram );
+    pending_[index] = { {}, free_pending_ };
+    free_pending_ = index;
+    send_frame( destination, move( datagram ) );
+    index = next;
+  }
+}
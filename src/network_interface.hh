@@ -0,0 +1,128 @@
+#pragma once
+
+#include "buffer.hh"
+#include "ethernet_frame.hh"
+#include "socket.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+struct NetworkInterfaceConfig
+{
+  size_t max_neighbors = 1 << 16;       // most addresses in the ARP cache, resolved or waiting for a reply
+  size_t max_pending = 1 << 12;         // most datagrams waiting for replies, in all
+  size_t max_pending_per_neighbor = 16; // most datagrams waiting for any one reply
+  uint64_t mapping_ttl_ms = 30000;      // how long a learned mapping is used before it is asked for again
+  uint64_t request_timeout_ms = 5000;   // how long to wait for a reply, before dropping what waits for it
+};
+
+/*
+ * NetworkInterface: connects IPv4 to Ethernet. It sends each datagram in a frame addressed to the Ethernet
+ * address of its next hop, finding that address with ARP (RFC 826), and hands the IPv4 datagrams in frames
+ * addressed to it up to the caller.
+ *
+ * The ARP cache is a flat hash table (open addressing, linear probing) allocated once, at twice the size of
+ * NetworkInterfaceConfig::max_neighbors, so looking up a next hop is O(1) and allocates nothing however many
+ * neighbors there are. A learned mapping is used for `mapping_ttl_ms`.
+ *
+ * A datagram for an address not yet resolved waits in that address's queue, and one ARP request goes out:
+ * datagrams to the same address that follow join the queue without another request, until the reply
+ * arrives (and the whole queue is sent, in order) or `request_timeout_ms` passes (and the queue is
+ * dropped; the next datagram asks again). Queues are linked lists in one pool of slots, also allocated once.
+ * If the cache or the pool is full, the datagram is dropped, as IP allows.
+ *
+ * Mappings are learned from every ARP message whose sender is already in the cache (resolved or waiting),
+ * and from every request for this interface's own address, which is answered.
+ *
+ * Datagrams are Buffers: the Ethernet header goes into the headroom in front of each (see
+ * serialize_ethernet_frame()), and a received datagram is a slice of its frame, so neither is copied.
+ */
+class NetworkInterface
+{
+public:
+  // Called with each frame to send
+  using TransmitFunction = std::function<void( const Buffer& frame )>;
+
+  NetworkInterface( const EthernetAddress& ethernet_address,
+                    uint32_t ip_address,
+                    TransmitFunction transmit,
+                    const NetworkInterfaceConfig& config = {} );
+
+  // A TransmitFunction that queues frames in `socket`'s TX ring (see PacketSocket::enable_rings()), flushing
+  // only when it is full: call socket.flush_frames() after a batch of sends.
+  static TransmitFunction transmit_to( PacketSocket& socket );
+
+  // Send an IPv4 datagram, in a frame to the Ethernet address of `next_hop` (an IPv4 address in host order)
+  void send_datagram( Buffer datagram, uint32_t next_hop );
+
+  // Receive a frame: if it carries an IPv4 datagram for this interface, return the datagram; if it carries
+  // ARP, learn from it (and reply, if asked for this interface's address)
+  std::optional<Buffer> recv_frame( const Buffer& frame );
+
+  // Advance time, expiring mappings and unanswered requests
+  void tick( uint64_t ms_since_last_tick );
+
+  // The Ethernet address `ip_address` is known to have, if any (and not expired)
+  std::optional<EthernetAddress> lookup( uint32_t ip_address ) const;
+
+  // Addresses in the ARP cache, resolved or waiting for a reply (expired ones may linger until swept)
+  size_t neighbors() const { return size_; }
+
+  // Datagrams dropped, because the cache or a queue was full or a request went unanswered
+  uint64_t dropped() const { return dropped_; }
+
+  const EthernetAddress& ethernet_address() const { return ethernet_address_; }
+  uint32_t ip_address() const { return ip_address_; }
+
+private:
+  static constexpr uint32_t NONE = UINT32_MAX;      // end of a pending queue
+  static constexpr size_t NO_SLOT = SIZE_MAX;       // not in the cache
+  static constexpr uint64_t SWEEP_PERIOD_MS = 1000; // tick() examines the whole cache once per this long
+
+  struct Entry
+  {
+    uint32_t ip {};
+    bool used {};
+    bool resolved {};
+    EthernetAddress ethernet_address {};
+    uint64_t deadline_ms {}; // when the mapping expires, or the request times out
+    uint32_t head = NONE;    // the datagrams waiting for the reply, oldest first
+    uint32_t tail = NONE;
+    uint32_t queued {};
+  };
+
+  struct Pending
+  {
+    std::optional<Buffer> datagram {}; // empty in a free slot
+    uint32_t next = NONE;              // next in the same queue, or in the free list
+  };
+
+  size_t home( uint32_t ip ) const;
+  size_t find( uint32_t ip ) const; // slot holding `ip`, or NO_SLOT
+  size_t insert( uint32_t ip );     // a new slot for `ip`, which must not be present; NO_SLOT if full
+  void erase( size_t slot );        // drops its queue, then closes the gap (backward-shift deletion)
+
+  void send_frame( const EthernetAddress& destination, Buffer datagram );
+  void send_arp( uint16_t opcode, const EthernetAddress& destination, uint32_t target_ip );
+  void enqueue( Entry& entry, Buffer&& datagram );
+  void flush( Entry& entry ); // send its queue, now that it is resolved
+
+  EthernetAddress ethernet_address_;
+  uint32_t ip_address_;
+  TransmitFunction transmit_;
+  NetworkInterfaceConfig config_;
+
+  std::vector<Entry> table_;
+  size_t mask_;
+  size_t size_ {};
+  size_t sweep_hand_ {};
+
+  std::vector<Pending> pending_;
+  uint32_t free_pending_ {}; // head of the free list
+
+  uint64_t now_ms_ {};
+  uint64_t dropped_ {};
+};
@@ -0,0 +1,105 @@
+#include "reassembler.hh"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+void Reassembler::insert( uint64_t first_index, string data, bool is_last_substring )
+{
+  insert( first_index, Buffer { move( data ) }, is_last_substring );
+}
+
+void Reassembler::insert( uint64_t first_index, Buffer data, bool is_last_substring )
+{
+  if ( is_last_substring ) {
+    end_index_ = first_index + data.size();
+  }
+
+  Writer& writer = output_.writer();
+  const uint64_t first_unassembled = writer.bytes_pushed();
+  const uint64_t first_unacceptable = first_unassembled + writer.available_capacity();
+
+  // Keep only the part that is new and fits within capacity
+  const uint64_t begin = max( first_index, first_unassembled );
+  const uint64_t end = min( first_index + data.size(), first_unacceptable );
+
+  if ( begin < end ) {
+    if ( begin == first_unassembled ) {
+      Slice slice = make_slice( move( data ), begin - first_index, end - begin );
+      writer.push( move( slice.data ), slice.offset, slice.length );
+      flush();
+    } else {
+      store( begin, data, begin - first_index, end - begin );
+    }
+  }
+
+  check_finished();
+}
+
+Reassembler::Slice Reassembler::make_slice( Buffer data, uint64_t offset, uint64_t length )
+{
+  if ( length * 2 < data.size() ) {
+    return { Buffer { string { string_view { data }.substr( offset, length ) } }, 0, length };
+  }
+  return { move( data ), offset, length };
+}
+
+void Reassembler::flush()
+{
+  Writer& writer = output_.writer();
+  while ( not pending_.empty() and pending_.begin()->first <= writer.bytes_pushed() ) {
+    auto node = pending_.extract( pending_.begin() );
+    Slice& slice = node.mapped();
+    bytes_pending_ -= slice.length;
+
+    // the front of this piece may already have been pushed
+    const uint64_t skip = writer.bytes_pushed() - node.key();
+    if ( skip < slice.length ) {
+      slice = make_slice( move( slice.data ), slice.offset + skip, slice.length - skip );
+      writer.push( move( slice.data ), slice.offset, slice.length );
+    }
+  }
+}
+
+void Reassembler::store( uint64_t first_index, const Buffer& data, uint64_t offset, uint64_t length )
+{
+  uint64_t begin = first_index;
+  uint64_t end = first_index + length;
+
+  // Trim the front against the piece that starts at or before it
+  auto next = pending_.upper_bound( begin );
+  if ( next != pending_.begin() ) {
+    const auto prev = std::prev( next );
+    const uint64_t prev_end = prev->first + prev->second.length;
+    if ( prev_end >= end ) {
+      return; // nothing new
+    }
+    if ( prev_end > begin ) {
+      offset += prev_end - begin;
+      begin = prev_end;
+    }
+  }
+
+  // Drop the pieces it covers entirely, and trim the back against one it covers only partly
+  while ( next != pending_.end() and next->first < end ) {
+    if ( next->first + next->second.length > end ) {
+      end = next->first;
+      break;
+    }
+    bytes_pending_ -= next->second.length;
+    next = pending_.erase( next );
+  }
+
+  if ( begin < end ) {
+    pending_.emplace_hint( next, begin, make_slice( data, offset, end - begin ) );
+    bytes_pending_ += end - begin;
+  }
+}
+
+void Reassembler::check_finished()
+{
+  if ( end_index_.has_value() and output_.writer().bytes_pushed() == *end_index_ ) {
+    output_.writer().close();
+  }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "buffer.hh"
+#include "byte_stream.hh"
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+
+/*
+ * Reassembler: puts substrings of a byte stream, which may arrive out of order, overlapping or
+ * duplicated, back together and writes them into a ByteStream.
+ *
+ * Bytes that fit at the front of the stream are pushed right away; the rest are held as slices of
+ * the Buffers they arrived in, in a map keyed by stream index whose entries never overlap. An insert
+ * costs O(log n) to find its place plus the cost of trimming or dropping the pieces it overlaps, and
+ * the payload is never copied unless only a small part of a large Buffer is kept.
+ *
+ * Only bytes within the stream's available capacity are kept, so bytes_pending() plus the stream's
+ * buffered bytes never exceed its capacity, however the substrings arrive.
+ */
+class Reassembler
+{
+public:
+  // Construct Reassembler to write into given ByteStream.
+  explicit Reassembler( ByteStream&& output ) : output_( std::move( output ) ) {}
+
+  /*
+   * Insert a new substring to be reassembled into a ByteStream.
+   *   `first_index`: the index of the first byte of the substring
+   *   `data`: the substring itself (a Buffer is kept by reference, not copied)
+   *   `is_last_substring`: this substring represents the end of the stream
+   *
+   * The Reassembler's job is to reassemble the indexed substrings (possibly out-of-order
+   * and possibly overlapping) back into the original ByteStream. As soon as the Reassembler
+   * learns the next byte in the stream, it should write it to the output.
+   *
+   * If the Reassembler learns about bytes that fit within the stream's available capacity
+   * but can't yet be written (because earlier bytes remain unknown), it should store them
+   * internally until the gaps are filled in.
+   *
+   * The Reassembler should discard any bytes that lie beyond the stream's available capacity
+   * (i.e., bytes that couldn't be written even if earlier gaps get filled in).
+   *
+   * The Reassembler should close the stream after writing the last byte.
+   */
+  void insert( uint64_t first_index, Buffer data, bool is_last_substring );
+  void insert( uint64_t first_index, std::string data, bool is_last_substring );
+
+  // How many bytes are stored in the Reassembler itself?
+  uint64_t bytes_pending() const { return bytes_pending_; }
+
+  // Call `visit( first_index, end_index )` on each run of contiguous stored bytes, in order
+  template<class Visitor>
+  void for_each_pending_range( Visitor&& visit ) const
+  {
+    auto it = pending_.begin();
+    while ( it != pending_.end() ) {
+      const uint64_t first = it->first;
+      uint64_t end = first + it->second.length;
+      for ( ++it; it != pending_.end() and it->first == end; ++it ) {
+        end += it->second.length;
+      }
+      visit( first, end );
+    }
+  }
+
+  // Access output stream reader
+  Reader& reader() { return output_.reader(); }
+  const Reader& reader() const { return output_.reader(); }
+
+  // Access output stream writer, but const-only (can't write from outside)
+  const Writer& writer() const { return output_.writer(); }
+
+private:
+  // `length` bytes of `data`, starting at `offset`
+  struct Slice
+  {
+    Buffer data {};
+    uint64_t offset {};
+    uint64_t length {};
+  };
+
+  // Keep `length` bytes of `data` from `offset`, copying them out if that lets most of `data` be freed
+  static Slice make_slice( Buffer data, uint64_t offset, uint64_t length );
+
+  // Push the bytes of `pending_` that have become contiguous with the stream
+  void flush();
+
+  // Store [first_index, first_index + length) of `data` (already within capacity and past the stream's end)
+  void store( uint64_t first_index, const Buffer& data, uint64_t offset, uint64_t length );
+
+  // Close the stream once every byte up to the last substring's end has been pushed
+  void check_finished();
+
+  ByteStream output_;
+  std::map<uint64_t, Slice> pending_ {}; // stream index of first byte -> bytes; entries never overlap
+  uint64_t bytes_pending_ {};
+  std::optional<uint64_t> end_index_ {}; // one past the last byte of the stream, once known
+};
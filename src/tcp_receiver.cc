@@ -0,0 +1,173 @@
+#include "tcp_receiver.hh"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+void TCPReceiver::receive( TCPSenderMessage message )
+{
+  if ( message.SYN and not isn_.has_value() ) {
+    isn_ = message.seqno;
+    peer_window_scale_ = message.window_scale;
+    sack_permitted_ = message.SACK_permitted;
+    peer_mss_ = message.MSS;
+    peer_timestamps_ = message.timestamp.has_value();
+  }
+  if ( not isn_.has_value() ) {
+    return; // nothing to acknowledge before the connection starts
+  }
+
+  const uint64_t abs_seqno = message.seqno.unwrap( *isn_, next_abs_seqno() );
+  if ( abs_seqno == 0 and not message.SYN ) {
+    ack_now_ = true; // a payload can't sit where the SYN does; tell the sender what we do expect
+    return;
+  }
+
+  // RFC 7323 4.3: a segment that begins at or before the last ackno sent has the timestamp to echo
+  if ( message.timestamp.has_value() and abs_seqno <= last_ack_sent_
+       and ( not ts_recent_.has_value() or static_cast<int32_t>( *message.timestamp - *ts_recent_ ) >= 0 ) ) {
+    ts_recent_ = message.timestamp;
+  }
+
+  const uint64_t pushed_before = writer().bytes_pushed();
+  const uint64_t pending_before = reassembler_.bytes_pending();
+  const bool closed_before = writer().is_closed();
+  const uint64_t stream_index = abs_seqno + message.SYN - 1;
+  const size_t sequence_length = message.sequence_length();
+
+  reassembler_.insert( stream_index, move( message.payload ), message.FIN );
+
+  const uint64_t advanced = writer().bytes_pushed() - pushed_before;
+  const bool in_order = stream_index == pushed_before;
+
+  if ( message.SYN or writer().is_closed() != closed_before ) {
+    ack_now_ = true; // connection setup and teardown aren't delayed
+  } else if ( sequence_length == 0 ) {
+    // nothing to acknowledge
+  } else if ( not in_order or advanced == 0 or pending_before > 0 ) {
+    ack_now_ = true; // out of order, duplicate, or filling a hole
+    if ( stream_index > pushed_before ) {
+      latest_out_of_order_ = stream_index;
+    }
+  } else {
+    unacked_bytes_ += advanced;
+  }
+}
+
+TCPReceiverMessage TCPReceiver::send( bool SYN ) const
+{
+  TCPReceiverMessage message;
+  message.window_size = window_size( SYN );
+  if ( isn_.has_value() ) {
+    message.ackno = Wrap32::wrap( next_abs_seqno(), *isn_ );
+    if ( sack_ and sack_permitted_ and reassembler_.bytes_pending() > 0 ) {
+      add_sack_blocks( message );
+    }
+    if ( timestamps_ and peer_timestamps_ ) {
+      message.timestamp_echo = ts_recent_;
+    }
+  }
+  return message;
+}
+
+void TCPReceiver::add_sack_blocks( TCPReceiverMessage& message ) const
+{
+  // stream index -> sequence number: the SYN comes first
+  const auto block = [&]( uint64_t first, uint64_t end ) {
+    return SACKBlock { Wrap32::wrap( first + 1, *isn_ ), Wrap32::wrap( end + 1, *isn_ ) };
+  };
+
+  // the run with the latest arrival leads; as many of the lowest others as fit follow
+  optional<SACKBlock> latest;
+  vector<SACKBlock> others;
+  reassembler_.for_each_pending_range( [&]( uint64_t first, uint64_t end ) {
+    if ( latest_out_of_order_.has_value() and first <= *latest_out_of_order_ and *latest_out_of_order_ < end ) {
+      latest = block( first, end );
+    } else if ( others.size() < TCPConfig::MAX_SACK_BLOCKS ) {
+      others.push_back( block( first, end ) );
+    }
+  } );
+
+  message.sack.reserve( TCPConfig::MAX_SACK_BLOCKS );
+  if ( latest.has_value() ) {
+    message.sack.push_back( *latest );
+  }
+  for ( const SACKBlock& b : others ) {
+    if ( message.sack.size() == TCPConfig::MAX_SACK_BLOCKS ) {
+      break;
+    }
+    message.sack.push_back( b );
+  }
+}
+
+bool TCPReceiver::ack_due() const
+{
+  if ( not isn_.has_value() ) {
+    return false;
+  }
+  if ( ack_now_ or unacked_bytes_ >= 2 * segment_size() ) {
+    return true;
+  }
+  if ( unacked_bytes_ > 0 and ms_since_unacked_ >= ack_delay_ ) {
+    return true;
+  }
+
+  // window update, once it is worth one
+  const uint64_t capacity = reader().bytes_buffered() + writer().available_capacity();
+  const uint64_t threshold = max<uint64_t>( 1, min( segment_size(), capacity / 2 ) );
+  return window_bytes() >= advertised_window_ + threshold;
+}
+
+void TCPReceiver::ack_sent()
+{
+  ack_now_ = false;
+  unacked_bytes_ = 0;
+  ms_since_unacked_ = 0;
+  advertised_window_ = window_bytes();
+  last_ack_sent_ = next_abs_seqno();
+}
+
+void TCPReceiver::tick( uint64_t ms_since_last_tick )
+{
+  if ( unacked_bytes_ > 0 ) {
+    ms_since_unacked_ += ms_since_last_tick;
+  }
+}
+
+uint64_t TCPReceiver::next_abs_seqno() const
+{
+  // the SYN, the bytes pushed so far, and the FIN once the stream is complete
+  return 1 + writer().bytes_pushed() + writer().is_closed();
+}
+
+uint64_t TCPReceiver::segment_size() const
+{
+  return min<uint64_t>( mss_, peer_mss_.value_or( TCPConfig::MAX_PAYLOAD_SIZE ) );
+}
+
+uint8_t TCPReceiver::scale_for( uint64_t capacity )
+{
+  uint8_t shift = 0;
+  while ( shift < TCPConfig::MAX_WINDOW_SCALE and ( capacity >> shift ) > numeric_limits<uint16_t>::max() ) {
+    ++shift;
+  }
+  return shift;
+}
+
+uint8_t TCPReceiver::shift() const
+{
+  return window_scale_.has_value() and peer_window_scale_.has_value() ? *window_scale_ : 0;
+}
+
+uint64_t TCPReceiver::window_bytes() const
+{
+  return uint64_t { window_size() } << shift();
+}
+
+uint16_t TCPReceiver::window_size( bool SYN ) const
+{
+  const uint64_t units = writer().available_capacity() >> ( SYN ? 0 : shift() ); // RFC 7323 2.2
+  return static_cast<uint16_t>( min<uint64_t>( units, numeric_limits<uint16_t>::max() ) );
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "reassembler.hh"
+#include "tcp_config.hh"
+#include "tcp_receiver_message.hh"
+#include "tcp_sender_message.hh"
+
+#include <cstdint>
+#include <optional>
+
+/*
+ * TCPReceiver: turns the TCPSenderMessages it receives into a ByteStream (via the Reassembler),
+ * and tells the peer's sender what it has received (the ackno) and how much more it can take (the window).
+ *
+ * send() is the current ackno and window, always up to date, for any segment going out. Whether to send
+ * an ACK on its own is a separate question, answered by ack_due() under a delayed-ACK policy (RFC 1122
+ * 4.2.3.2, RFC 5681 4.2):
+ *
+ *   - in-order data is acknowledged once two full-sized segments' worth is unacknowledged, or once the
+ *     oldest unacknowledged byte has waited `ack_delay` ms (see tick()). A full-sized segment carries the
+ *     smaller of this endpoint's MSS and the one the peer's SYN offered;
+ *   - a SYN, a FIN, and any segment that is out of order, a duplicate, or fills a hole is acknowledged
+ *     immediately, so the sender sees duplicate ACKs and repaired holes without delay;
+ *   - a window update is due only once the window has opened by at least min(one segment, half the
+ *     capacity) since it was last advertised, so small reads don't each cost an ACK.
+ *
+ * Call ack_sent() whenever send() goes out, alone or piggybacked on data; it satisfies anything pending.
+ *
+ * Window scaling (RFC 7323): the receiver picks the smallest shift that lets its whole capacity fit in the
+ * 16-bit window field, and offers it as window_scale(), for its endpoint's SYN. If the peer's SYN carried a
+ * window scale too, every window the receiver advertises from then on is in units of 2^shift bytes (rounded
+ * down, so it never promises more than it can hold); otherwise windows are plain bytes, capped at 65,535.
+ * The window on a segment that carries a SYN is never scaled (RFC 7323 2.2), so send( true ), for this
+ * endpoint's SYN-ACK, advertises plain bytes even once the peer's SYN has offered a scale.
+ *
+ * SACK (RFC 2018): if the peer's SYN permitted it, send() also reports the runs of bytes the Reassembler
+ * holds beyond the ackno, so the sender can retransmit only what is missing.
+ *
+ * Timestamps (RFC 7323): if both SYNs offered them, send() echoes the timestamp of the latest segment to
+ * begin at or before the last ackno sent, so the peer's sender can time each round trip, delays included.
+ */
+class TCPReceiver
+{
+public:
+  // Construct with given Reassembler
+  explicit TCPReceiver( Reassembler&& reassembler, const TCPConfig& config = {} )
+    : reassembler_( std::move( reassembler ) )
+    , ack_delay_( config.ack_delay )
+    , window_scale_( config.window_scaling ? std::optional { scale_for( writer().available_capacity() ) }
+                                           : std::nullopt )
+    , sack_( config.sack )
+    , mss_( config.mss )
+    , timestamps_( config.timestamps )
+  {}
+
+  /*
+   * The TCPReceiver receives TCPSenderMessages, inserting their payload into the Reassembler
+   * at the correct stream index.
+   */
+  void receive( TCPSenderMessage message );
+
+  // The TCPReceiver sends TCPReceiverMessages to the peer's TCPSender.
+  // `SYN`: the message goes out on a segment carrying this endpoint's SYN (a SYN-ACK), whose window is
+  // never scaled
+  TCPReceiverMessage send( bool SYN = false ) const;
+
+  // Should an ACK go out now?
+  bool ack_due() const;
+
+  // Record that send()'s current contents have gone out to the peer
+  void ack_sent();
+
+  // Advance the delayed-ACK timer
+  void tick( uint64_t ms_since_last_tick );
+
+  // Window scale to offer on this endpoint's SYN (empty if scaling is off)
+  std::optional<uint8_t> window_scale() const { return window_scale_; }
+
+  // Window scale the peer offered on its SYN, for this endpoint's TCPSender (empty if none, or no SYN yet)
+  std::optional<uint8_t> peer_window_scale() const { return peer_window_scale_; }
+
+  // MSS the peer offered on its SYN, for this endpoint's TCPSender (empty if none, or no SYN yet)
+  std::optional<uint16_t> peer_mss() const { return peer_mss_; }
+
+  // Whether the peer offered timestamps on its SYN, for this endpoint's TCPSender
+  bool peer_timestamps() const { return peer_timestamps_; }
+
+  // Access the output
+  const Reassembler& reassembler() const { return reassembler_; }
+  Reader& reader() { return reassembler_.reader(); }
+  const Reader& reader() const { return reassembler_.reader(); }
+  const Writer& writer() const { return reassembler_.writer(); }
+
+private:
+  // Absolute sequence number of the next byte needed (SYN counts as one, FIN as one more)
+  uint64_t next_abs_seqno() const;
+
+  // Smallest shift that lets a window of `capacity` bytes be advertised in full
+  static uint8_t scale_for( uint64_t capacity );
+
+  // Shift applied to advertised windows: ours, if both endpoints offered one, else 0
+  uint8_t shift() const;
+
+  // Window the receiver can advertise right now, in bytes and as the 16-bit field (scaled unless on a SYN)
+  uint64_t window_bytes() const;
+  uint16_t window_size( bool SYN = false ) const;
+
+  // Largest payload the peer's sender will put in one segment
+  uint64_t segment_size() const;
+
+  // Add SACK blocks for the bytes held out of order
+  void add_sack_blocks( TCPReceiverMessage& message ) const;
+
+  Reassembler reassembler_;
+  uint64_t ack_delay_;
+  std::optional<Wrap32> isn_ {};
+  std::optional<uint8_t> window_scale_;
+  std::optional<uint8_t> peer_window_scale_ {};
+  bool sack_;                                      // may send SACK blocks, if the peer permits
+  bool sack_permitted_ {};                         // the peer's SYN did
+  std::optional<uint64_t> latest_out_of_order_ {}; // stream index of the latest segment that arrived early
+  uint64_t mss_;                                   // the most payload this endpoint accepts per segment
+  std::optional<uint16_t> peer_mss_ {};
+  bool timestamps_;                      // may echo timestamps, if the peer offers them
+  bool peer_timestamps_ {};              // the peer's SYN did
+  std::optional<uint32_t> ts_recent_ {}; // the timestamp to echo
+  uint64_t last_ack_sent_ {};            // absolute ackno carried by the last ACK sent
+
+  // delayed-ACK state
+  bool ack_now_ {};               // a segment arrived that must be acknowledged right away
+  uint64_t unacked_bytes_ {};     // in-order payload received since the last ACK
+  uint64_t ms_since_unacked_ {};  // how long the oldest of those bytes has waited
+  uint64_t advertised_window_ {}; // window carried by the last ACK sent, in bytes
+};
@@ -0,0 +1,426 @@
+#include "tcp_sender.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+// Pop `len` bytes into one Buffer, with TCPConfig::HEADROOM bytes in front of every `segment_size` of them
+// (and in front of nothing, if `len` is zero)
+Buffer read_with_headroom( Reader& reader, uint64_t len, uint64_t segment_size )
+{
+  string out;
+  out.reserve( len + ( len / segment_size + 1 ) * TCPConfig::HEADROOM );
+  out.append( TCPConfig::HEADROOM, 0 );
+  for ( uint64_t done = 0, segment_left = segment_size; done < len; ) {
+    if ( segment_left == 0 ) {
+      out.append( TCPConfig::HEADROOM, 0 );
+      segment_left = segment_size;
+    }
+    const string_view view = reader.peek().substr( 0, min( len - done, segment_left ) );
+    out += view;
+    reader.pop( view.size() );
+    done += view.size();
+    segment_left -= view.size();
+  }
+  return out;
+}
+
+} // namespace
+
+uint64_t TCPSender::sequence_numbers_in_flight() const
+{
+  return next_abs_seqno_ - acked_abs_seqno_;
+}
+
+uint64_t TCPSender::consecutive_retransmissions() const
+{
+  return consecutive_retransmissions_;
+}
+
+uint64_t TCPSender::mss() const
+{
+  const uint64_t ours = mss_.value_or( TCPConfig::MAX_PAYLOAD_SIZE );
+  const uint64_t peers = peer_mss_.value_or( TCPConfig::MAX_PAYLOAD_SIZE );
+  return max<uint64_t>( min( ours, peers ), 1 );
+}
+
+void TCPSender::offer_mss( optional<uint16_t> size )
+{
+  mss_ = size;
+  if ( congestion_ ) {
+    congestion_->set_mss( mss() );
+  }
+}
+
+void TCPSender::set_peer_mss( optional<uint16_t> size )
+{
+  peer_mss_ = size;
+  if ( congestion_ ) {
+    congestion_->set_mss( mss() );
+  }
+}
+
+void TCPSender::estimate_RTO( uint64_t min_RTO_ms, uint64_t max_RTO_ms )
+{
+  estimate_RTO_ = true;
+  min_RTO_ms_ = min_RTO_ms;
+  max_RTO_ms_ = max( min_RTO_ms, max_RTO_ms );
+}
+
+void TCPSender::sample_RTT( uint64_t rtt_ms )
+{
+  const auto rtt = static_cast<double>( rtt_ms );
+  if ( not SRTT_ms_.has_value() ) {
+    SRTT_ms_ = rtt;
+    RTTVAR_ms_ = rtt / 2;
+  } else {
+    // With a sample on every ACK, each counts for less: the usual gains are per window (RFC 7323 G)
+    const double samples = timestamps_in_use()
+                             ? max( 1.0, static_cast<double>( sequence_numbers_in_flight() ) / ( 2.0 * mss() ) )
+                             : 1.0;
+    const double alpha = 1.0 / 8 / samples;
+    const double beta = 1.0 / 4 / samples;
+    RTTVAR_ms_ = ( 1 - beta ) * RTTVAR_ms_ + beta * abs( *SRTT_ms_ - rtt );
+    SRTT_ms_ = ( 1 - alpha ) * *SRTT_ms_ + alpha * rtt;
+  }
+
+  // RTO = SRTT + max(G, 4 * RTTVAR), for a clock granularity G of 1 ms
+  const auto RTO_ms = static_cast<uint64_t>( ceil( *SRTT_ms_ + max( 1.0, 4 * RTTVAR_ms_ ) ) );
+  RTO_ms_ = clamp( RTO_ms, min_RTO_ms_, max_RTO_ms_ );
+}
+
+uint64_t TCPSender::send_room() const
+{
+  // A zero window is treated as one, so the sender keeps probing for it to open
+  const uint64_t window = max<uint64_t>( window_, 1 );
+  const uint64_t in_flight = sequence_numbers_in_flight();
+  const uint64_t room = window - min( window, in_flight );
+  if ( not congestion_ ) {
+    return room;
+  }
+
+  // Duplicate ACKs and SACKs say some of what's in flight has left the network, though not yet acknowledged
+  const uint64_t left = max( duplicate_acks_ * mss(), sacked_bytes_ + lost_bytes_ );
+  const uint64_t pipe = in_flight - min( in_flight, left );
+  const uint64_t cwnd = congestion_->cwnd();
+  return min( room, cwnd - min( cwnd, pipe ) );
+}
+
+void TCPSender::push( const TransmitFunction& transmit )
+{
+  if ( reader().has_error() ) {
+    return;
+  }
+
+  if ( retransmit_pending_ ) {
+    retransmit_pending_ = false;
+    retransmit_holes( transmit );
+  }
+
+  const bool paced = pacing_rate().has_value();
+  const uint64_t segment_size = mss();
+  const uint64_t max_batch_size = max<uint64_t>( TCPConfig::MAX_SUPER_SEGMENT / segment_size, 1 ) * segment_size;
+
+  while ( not FIN_sent_ and send_room() > 0 ) {
+    const bool SYN = next_abs_seqno_ == 0;
+    const uint64_t room = send_room() - SYN;
+
+    // Read as much as may go out now in one piece (whole segments, if more remains), within the pacer's credit
+    uint64_t batch_size = min( { max_batch_size, room, reader().bytes_buffered() } );
+    if ( batch_size > 0 and paced ) {
+      if ( *pacing_credit_ <= 0 ) {
+        break; // tick() will send more as the pacer allows
+      }
+      const auto segments = static_cast<uint64_t>( ceil( *pacing_credit_ / static_cast<double>( segment_size ) ) );
+      batch_size = min( batch_size, segments * segment_size );
+    }
+    const Buffer batch = read_with_headroom( input_.reader(), batch_size, segment_size );
+    const bool FIN = reader().is_finished() and batch_size < room;
+
+    if ( not SYN and not FIN and batch_size == 0 ) {
+      break;
+    }
+
+    // Split it into messages that share its Buffer, each given the headroom in front of it
+    uint64_t offset = 0;
+    uint64_t position = TCPConfig::HEADROOM;
+    do {
+      TCPSenderMessage message = make_empty_message();
+      message.SYN = next_abs_seqno_ == 0;
+      if ( message.SYN ) {
+        message.window_scale = window_scale_;
+        message.SACK_permitted = true;
+        message.MSS = mss_;
+        message.timestamp = timestamps_ ? optional { static_cast<uint32_t>( now_ms_ ) } : nullopt;
+      }
+      const uint64_t payload_size = min( segment_size, batch_size - offset );
+      message.payload = batch.slice( position, payload_size, TCPConfig::HEADROOM );
+      offset += payload_size;
+      position += payload_size + TCPConfig::HEADROOM;
+      message.FIN = FIN and offset == batch_size;
+      send_new( message, transmit );
+    } while ( offset < batch_size );
+  }
+}
+
+void TCPSender::send_new( const TCPSenderMessage& message, const TransmitFunction& transmit )
+{
+  transmit( message );
+  outstanding_.push_back( { next_abs_seqno_, message, now_ms_, false } );
+  next_abs_seqno_ += message.sequence_length();
+  FIN_sent_ = message.FIN;
+  if ( pacing_credit_.has_value() ) {
+    *pacing_credit_ -= static_cast<double>( message.payload.size() );
+  }
+  if ( not timer_elapsed_ms_.has_value() ) {
+    timer_elapsed_ms_ = 0;
+  }
+}
+
+TCPSenderMessage TCPSender::make_empty_message() const
+{
+  TCPSenderMessage message;
+  message.seqno = Wrap32::wrap( next_abs_seqno_, isn_ );
+  if ( timestamps_in_use() ) {
+    message.timestamp = static_cast<uint32_t>( now_ms_ );
+  }
+  return message;
+}
+
+void TCPSender::receive( const TCPReceiverMessage& msg, bool SYN )
+{
+  if ( msg.ackno.has_value() and msg.ackno->unwrap( isn_, next_abs_seqno_ ) > next_abs_seqno_ ) {
+    return; // acknowledges something not yet sent: ignore the message, window and all
+  }
+
+  const uint64_t previous_window = window_;
+  // RFC 7323 2.2: the window on a SYN or SYN-ACK is in plain bytes
+  const uint8_t shift = not SYN and window_scale_.has_value() and peer_window_scale_.has_value()
+                          ? min( *peer_window_scale_, TCPConfig::MAX_WINDOW_SCALE )
+                          : 0;
+  window_ = uint64_t { msg.window_size } << shift;
+  if ( not msg.ackno.has_value() ) {
+    return;
+  }
+
+  const uint64_t ackno = msg.ackno->unwrap( isn_, next_abs_seqno_ );
+  mark_sacked( msg.sack );
+  if ( ackno <= acked_abs_seqno_ ) {
+    if ( ackno == acked_abs_seqno_ and window_ == previous_window and not outstanding_.empty() ) {
+      on_duplicate_ack();
+    }
+    return;
+  }
+  const uint64_t newly_acked = ackno - acked_abs_seqno_ - ( acked_abs_seqno_ == 0 ); // bytes, not the SYN
+  acked_abs_seqno_ = ackno;
+
+  // Retire whatever is now fully acknowledged, timing the newest of it
+  optional<uint64_t> rtt_ms;
+  while ( not outstanding_.empty()
+          and outstanding_.front().abs_seqno + outstanding_.front().message.sequence_length() <= ackno ) {
+    const Outstanding& oldest = outstanding_.front();
+    rtt_ms = oldest.retransmitted ? nullopt : optional { now_ms_ - oldest.sent_ms };
+    sacked_bytes_ -= oldest.sacked ? oldest.message.sequence_length() : 0;
+    outstanding_.pop_front();
+  }
+
+  // With timestamps, every ACK times the round trip of the copy that arrived
+  if ( timestamps_in_use() and msg.timestamp_echo.has_value() ) {
+    rtt_ms = static_cast<uint32_t>( static_cast<uint32_t>( now_ms_ ) - *msg.timestamp_echo );
+  }
+
+  // Progress: reset the backoff (to the estimate, once there is a new sample) and restart the timer (or stop
+  // it, if nothing is left)
+  if ( not estimate_RTO_ ) {
+    RTO_ms_ = initial_RTO_ms_;
+  } else if ( rtt_ms.has_value() ) {
+    sample_RTT( *rtt_ms );
+  }
+  consecutive_retransmissions_ = 0;
+  timer_elapsed_ms_.reset();
+  if ( not outstanding_.empty() ) {
+    timer_elapsed_ms_ = 0;
+  }
+
+  if ( not congestion_ ) {
+    return;
+  }
+  duplicate_acks_ = 0;
+  if ( not in_recovery_ or after_timeout_ ) { // after a timeout, the window grows again (slow start) at once
+    congestion_->on_ack( now_ms_, newly_acked, rtt_ms, sequence_numbers_in_flight() );
+  }
+  if ( in_recovery_ and ackno >= recovery_point_ ) {
+    in_recovery_ = false;
+    after_timeout_ = false;
+    lost_bytes_ = 0;
+  }
+  if ( in_recovery_ ) {
+    retransmit_pending_ = true; // a partial ACK: the next hole was lost too
+  } else if ( sacked_bytes_ >= DUPLICATE_THRESHOLD * mss() ) {
+    enter_recovery();
+  }
+}
+
+void TCPSender::mark_sacked( const vector<SACKBlock>& blocks )
+{
+  for ( const SACKBlock& block : blocks ) {
+    const uint64_t begin = block.begin.unwrap( isn_, next_abs_seqno_ );
+    const uint64_t end = min( block.end.unwrap( isn_, next_abs_seqno_ ), next_abs_seqno_ );
+    auto it = lower_bound( outstanding_.begin(), outstanding_.end(), begin, []( const Outstanding& o, uint64_t s ) {
+      return o.abs_seqno < s;
+    } );
+    for ( ; it != outstanding_.end() and it->abs_seqno + it->message.sequence_length() <= end; ++it ) {
+      if ( not it->sacked ) {
+        it->sacked = true;
+        sacked_bytes_ += it->message.sequence_length();
+      }
+    }
+  }
+}
+
+void TCPSender::on_duplicate_ack()
+{
+  if ( not congestion_ ) {
+    return;
+  }
+  ++duplicate_acks_;
+  if ( in_recovery_ ) {
+    retransmit_pending_ = true; // more has left the network, and SACKs may show more holes
+  } else if ( duplicate_acks_ >= DUPLICATE_THRESHOLD
+              or sacked_bytes_ >= DUPLICATE_THRESHOLD * mss() ) {
+    enter_recovery();
+  }
+}
+
+void TCPSender::enter_recovery()
+{
+  in_recovery_ = true;
+  recovery_point_ = next_abs_seqno_;
+  high_retransmitted_ = acked_abs_seqno_;
+  retransmit_pending_ = true;
+  congestion_->on_loss( now_ms_, sequence_numbers_in_flight() );
+}
+
+void TCPSender::retransmit_oldest( const TransmitFunction& transmit )
+{
+  if ( outstanding_.empty() ) {
+    return;
+  }
+  Outstanding& oldest = outstanding_.front();
+  retransmit( oldest, transmit );
+  high_retransmitted_ = max( high_retransmitted_, oldest.abs_seqno + oldest.message.sequence_length() );
+}
+
+void TCPSender::retransmit_holes( const TransmitFunction& transmit )
+{
+  if ( not in_recovery_ or not congestion_ ) {
+    return;
+  }
+
+  // A hole (not SACKed, not yet retransmitted in this recovery) is lost if it is the oldest outstanding
+  // message, if a timeout started the recovery, or if at least DUPLICATE_THRESHOLD segments' worth above it
+  // has been SACKed (RFC 6675). Each hole has less SACKed above it than the last, so the lost ones come first.
+  const auto lost_end = [&] {
+    uint64_t sacked_above = sacked_bytes_;
+    lost_bytes_ = 0;
+    auto it = outstanding_.begin();
+    for ( ; it != outstanding_.end() and it->abs_seqno < recovery_point_; ++it ) {
+      const uint64_t length = it->message.sequence_length();
+      if ( it->sacked ) {
+        sacked_above -= length;
+      } else if ( it->abs_seqno >= high_retransmitted_ ) {
+        if ( it != outstanding_.begin() and not after_timeout_
+             and sacked_above < DUPLICATE_THRESHOLD * mss() ) {
+          break;
+        }
+        lost_bytes_ += length;
+      }
+    }
+    return it;
+  }();
+
+  // Retransmit them in order while the congestion window allows, but always at least one
+  const uint64_t in_flight = sequence_numbers_in_flight();
+  uint64_t pipe = in_flight - min( in_flight, sacked_bytes_ + lost_bytes_ );
+  bool sent_any = false;
+  for ( auto it = outstanding_.begin(); it != lost_end; ++it ) {
+    if ( it->sacked or it->abs_seqno < high_retransmitted_ ) {
+      continue;
+    }
+    if ( sent_any and pipe >= congestion_->cwnd() ) {
+      break;
+    }
+    const uint64_t length = it->message.sequence_length();
+    retransmit( *it, transmit );
+    high_retransmitted_ = it->abs_seqno + length;
+    lost_bytes_ -= length;
+    pipe += length;
+    sent_any = true;
+  }
+}
+
+void TCPSender::retransmit( Outstanding& segment, const TransmitFunction& transmit )
+{
+  if ( segment.message.timestamp.has_value() ) {
+    segment.message.timestamp = static_cast<uint32_t>( now_ms_ );
+  }
+  segment.retransmitted = true;
+  transmit( segment.message );
+}
+
+void TCPSender::tick( uint64_t ms_since_last_tick, const TransmitFunction& transmit )
+{
+  now_ms_ += ms_since_last_tick;
+
+  const optional<double> rate = pacing_rate();
+  if ( rate.has_value() ) {
+    const double earned = *rate * static_cast<double>( ms_since_last_tick );
+    pacing_credit_ = min( *pacing_credit_ + earned, max( earned, 2.0 * mss() ) );
+  }
+
+  if ( timer_elapsed_ms_.has_value() ) {
+    *timer_elapsed_ms_ += ms_since_last_tick;
+    if ( *timer_elapsed_ms_ >= RTO_ms_ ) {
+      if ( window_ > 0 ) {
+        if ( consecutive_retransmissions_ >= TCPConfig::MAX_RETX_ATTEMPTS ) {
+          ++consecutive_retransmissions_;
+          timer_elapsed_ms_.reset();
+          input_.writer().set_error(); // give up on the connection
+          return;
+        }
+        ++consecutive_retransmissions_;
+        RTO_ms_ = estimate_RTO_ ? min( 2 * RTO_ms_, max_RTO_ms_ ) : 2 * RTO_ms_;
+        if ( congestion_ ) {
+          congestion_->on_rto( now_ms_, sequence_numbers_in_flight() );
+          // the rest of the window was probably lost too: retransmit each hole as ACKs reveal it
+          in_recovery_ = true;
+          after_timeout_ = true;
+          recovery_point_ = next_abs_seqno_;
+          high_retransmitted_ = acked_abs_seqno_;
+          duplicate_acks_ = 0;
+        }
+      }
+
+      retransmit_oldest( transmit );
+      timer_elapsed_ms_ = 0;
+    }
+  }
+
+  if ( rate.has_value() ) {
+    push( transmit );
+  }
+}
+
+optional<double> TCPSender::pacing_rate()
+{
+  const optional<double> rate = congestion_ ? congestion_->pacing_rate() : nullopt;
+  if ( not rate.has_value() ) {
+    pacing_credit_.reset();
+  } else if ( not pacing_credit_.has_value() ) {
+    pacing_credit_ = 2.0 * mss();
+  }
+  return rate;
+}
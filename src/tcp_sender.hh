@@ -0,0 +1,201 @@
+#pragma once
+
+#include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "tcp_config.hh"
+#include "tcp_receiver_message.hh"
+#include "tcp_sender_message.hh"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+/*
+ * TCPSender: reads the outbound ByteStream into TCPSenderMessages, as many as the receiver's window allows,
+ * and retransmits them until they are acknowledged.
+ *
+ * Payload is copied out of the stream exactly once, in super-segments of up to TCPConfig::MAX_SUPER_SEGMENT
+ * bytes: each is read into one Buffer, then split into MSS-sized messages whose payloads are slices of it.
+ * Every slice has TCPConfig::HEADROOM bytes of its own in front of it, so the headers can be written there
+ * in place when the message goes on the wire (see serialize_tcp_datagram()).
+ * Outstanding messages wait in seqno order in a queue that shares those Buffers, so a retransmission copies
+ * nothing, and a cumulative ACK just pops acknowledged messages off the front (amortized O(1) each).
+ *
+ * There is one retransmission timer for the whole connection, running whenever anything is outstanding.
+ * When it expires, the oldest outstanding message goes out again and (unless the window is zero) the timeout
+ * doubles. After TCPConfig::MAX_RETX_ATTEMPTS consecutive retransmissions without progress, the sender gives
+ * up and sets the error flag on its stream.
+ *
+ * The timeout starts at the initial RTO and returns to it whenever an ACK makes progress, unless the sender
+ * is told to estimate it (RFC 6298): then it follows the smoothed RTT and its variation, within the bounds
+ * given, and a backed-off timeout stands until an ACK brings a new sample. Samples come from messages sent
+ * only once (Karn's rule) or, if both SYNs offered timestamps (RFC 7323), from every ACK that makes
+ * progress, retransmissions included, since each echoes the timestamp of the copy that arrived.
+ *
+ * Window scaling (RFC 7323): the endpoint tells the sender what scale its own receiver offers, which goes
+ * out on the SYN, and what scale the peer's SYN offered. Only if both did are the windows the peer advertises
+ * shifted left by the peer's scale; until then (and otherwise) they are plain bytes.
+ *
+ * The MSS: the endpoint tells the sender its own (TCPConfig::mss), which goes out on the SYN, and the one
+ * the peer's SYN offered. No message carries more payload than the smaller of the two; an endpoint that
+ * offered none counts as offering TCPConfig::MAX_PAYLOAD_SIZE.
+ *
+ * The SYN permits SACK. Outstanding messages the peer SACKs are marked on a scoreboard: they are not
+ * retransmitted, and count as having left the network.
+ *
+ * With a CongestionController, the sender also keeps within its congestion window, paces transmissions if
+ * it asks, and detects loss from three duplicate ACKs (or three segments' worth SACKed): it retransmits the
+ * oldest outstanding message on the next push() without waiting for the timer. Until everything outstanding
+ * at the time of the loss (or of a timeout) has been acknowledged, it then retransmits each hole the
+ * scoreboard shows to be lost, as the congestion window allows; without SACKs, that is (as in NewReno) the
+ * next hole after each partial ACK.
+ */
+class TCPSender
+{
+public:
+  /* Construct TCP sender with given default Retransmission Timeout, possible ISN and congestion control */
+  TCPSender( ByteStream&& input,
+             Wrap32 isn,
+             uint64_t initial_RTO_ms,
+             std::unique_ptr<CongestionController> congestion_control = nullptr )
+    : input_( std::move( input ) )
+    , isn_( isn )
+    , initial_RTO_ms_( initial_RTO_ms )
+    , congestion_( std::move( congestion_control ) )
+    , RTO_ms_( initial_RTO_ms )
+  {}
+
+  /* Generate an empty TCPSenderMessage */
+  TCPSenderMessage make_empty_message() const;
+
+  /* Receive and process a TCPReceiverMessage from the peer's receiver (`SYN`: it arrived on a segment
+   * carrying the peer's SYN, whose window is never scaled) */
+  void receive( const TCPReceiverMessage& msg, bool SYN = false );
+
+  /* Type of the `transmit` function that the push and tick methods can use to send messages */
+  using TransmitFunction = std::function<void( const TCPSenderMessage& )>;
+
+  /* Push bytes from the outbound stream */
+  void push( const TransmitFunction& transmit );
+
+  /* Time has passed by the given # of milliseconds since the last time the tick() method was called */
+  void tick( uint64_t ms_since_last_tick, const TransmitFunction& transmit );
+
+  /* Offer window scaling on the SYN, with this endpoint's receiver's scale (TCPReceiver::window_scale()) */
+  void offer_window_scale( std::optional<uint8_t> shift ) { window_scale_ = shift; }
+
+  /* The scale the peer offered on its SYN (TCPReceiver::peer_window_scale()) */
+  void set_peer_window_scale( std::optional<uint8_t> shift ) { peer_window_scale_ = shift; }
+
+  /* Offer this endpoint's MSS on the SYN (TCPConfig::mss), and send no larger segments */
+  void offer_mss( std::optional<uint16_t> size );
+
+  /* The MSS the peer offered on its SYN (TCPReceiver::peer_mss()) */
+  void set_peer_mss( std::optional<uint16_t> size );
+
+  /* Offer timestamps on the SYN (TCPConfig::timestamps), and whether the peer's SYN did too */
+  void offer_timestamps( bool offer ) { timestamps_ = offer; }
+  void set_peer_timestamps( bool offered ) { peer_timestamps_ = offered; }
+
+  /* Estimate the RTO from round-trip times, between these bounds (TCPConfig::min_RTO_ms and max_RTO_ms) */
+  void estimate_RTO( uint64_t min_RTO_ms, uint64_t max_RTO_ms );
+
+  // Accessors
+  uint64_t sequence_numbers_in_flight() const; // How many sequence numbers are outstanding?
+  uint64_t consecutive_retransmissions() const; // How many consecutive *re*transmissions have happened?
+  uint64_t current_RTO_ms() const { return RTO_ms_; } // Retransmission timeout, after any backoff
+  uint64_t mss() const; // Most payload bytes in one message
+  std::optional<double> smoothed_RTT_ms() const { return SRTT_ms_; } // Empty until the first sample
+  const CongestionController* congestion_control() const { return congestion_.get(); } // nullptr if none
+  bool in_recovery() const { return in_recovery_; } // Repairing a loss (with congestion control only)?
+  Writer& writer() { return input_.writer(); }
+  const Writer& writer() const { return input_.writer(); }
+
+  // Access input stream reader, but const-only (can't read from outside)
+  const Reader& reader() const { return input_.reader(); }
+
+private:
+  struct Outstanding
+  {
+    uint64_t abs_seqno {};
+    TCPSenderMessage message {};
+    uint64_t sent_ms {};   // when first sent, for RTT samples
+    bool retransmitted {}; // if so, an ACK for it gives no RTT sample (Karn's rule)
+    bool sacked {};        // the peer holds it, beyond the ackno
+  };
+
+  static constexpr uint64_t DUPLICATE_THRESHOLD = 3; // duplicate ACKs (or segments SACKed) that signal a loss
+
+  // How many more sequence numbers may be sent now: within the peer's window, and the congestion window
+  uint64_t send_room() const;
+
+  // Send a new message and start tracking it
+  void send_new( const TCPSenderMessage& message, const TransmitFunction& transmit );
+
+  // The controller's pacing rate (bytes/ms), if it paces: the pacer's credit starts at two segments when
+  // pacing begins, and is dropped when it ends, so nothing sent unpaced is owed later
+  std::optional<double> pacing_rate();
+
+  // Send an outstanding message again, with a fresh timestamp
+  void retransmit( Outstanding& segment, const TransmitFunction& transmit );
+
+  // Both SYNs offered timestamps
+  bool timestamps_in_use() const { return timestamps_ and peer_timestamps_; }
+
+  // Fold a round-trip time into the estimate, and set the RTO from it (RFC 6298 2)
+  void sample_RTT( uint64_t rtt_ms );
+
+  void mark_sacked( const std::vector<SACKBlock>& blocks );
+  void on_duplicate_ack();
+  void enter_recovery();
+  void retransmit_oldest( const TransmitFunction& transmit );
+
+  // In recovery, retransmit the holes the scoreboard says were lost
+  void retransmit_holes( const TransmitFunction& transmit );
+
+  ByteStream input_;
+  Wrap32 isn_;
+  uint64_t initial_RTO_ms_;
+  std::unique_ptr<CongestionController> congestion_;
+  uint64_t now_ms_ {}; // sum of all ticks
+
+  uint64_t next_abs_seqno_ {};  // absolute seqno of the next new sequence number to send
+  uint64_t acked_abs_seqno_ {}; // everything before this has been acknowledged
+  uint64_t window_ { 1 };       // receiver's latest window in bytes (assumed 1 until it speaks up)
+  bool FIN_sent_ {};
+  std::deque<Outstanding> outstanding_ {}; // sent but not fully acknowledged, in seqno order
+  std::optional<uint8_t> window_scale_ {};
+  std::optional<uint8_t> peer_window_scale_ {};
+  std::optional<uint16_t> mss_ {};
+  std::optional<uint16_t> peer_mss_ {};
+  bool timestamps_ {};
+  bool peer_timestamps_ {};
+
+  // the retransmission timer
+  uint64_t RTO_ms_;
+  std::optional<uint64_t> timer_elapsed_ms_ {}; // empty when stopped
+  uint64_t consecutive_retransmissions_ {};
+
+  // the RTO estimate (if enabled)
+  bool estimate_RTO_ {};
+  uint64_t min_RTO_ms_ {};
+  uint64_t max_RTO_ms_ {};
+  std::optional<double> SRTT_ms_ {};
+  double RTTVAR_ms_ {};
+
+  // the SACK scoreboard
+  uint64_t sacked_bytes_ {}; // total length of the outstanding messages marked SACKed
+
+  // loss recovery and pacing (with congestion control only)
+  uint64_t duplicate_acks_ {};
+  bool in_recovery_ {};
+  bool after_timeout_ {};          // the recovery began with a timeout: every hole is lost
+  uint64_t recovery_point_ {};     // recovery ends once everything before this is acknowledged
+  uint64_t high_retransmitted_ {}; // holes before this have been retransmitted in this recovery
+  uint64_t lost_bytes_ {};         // holes known lost, but not yet retransmitted
+  bool retransmit_pending_ {};     // push() should retransmit lost holes
+  std::optional<double> pacing_credit_ {}; // bytes the pacer lets go out right now (empty when not pacing)
+};
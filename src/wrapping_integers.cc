@@ -0,0 +1,54 @@
+#include "wrapping_integers.hh"
+
+#include <stdexcept>
+
+#if defined( __x86_64__ )
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+#if defined( __x86_64__ )
+// Four seqnos per iteration: the same arithmetic as Wrap32::unwrap(), in 64-bit lanes
+__attribute__( ( target( "avx2" ) ) ) size_t unwrap_avx2( span<const Wrap32> seqnos,
+                                                          uint32_t base,
+                                                          uint64_t checkpoint,
+                                                          span<uint64_t> absolute )
+{
+  const __m128i vbase = _mm_set1_epi32( static_cast<int>( base ) );
+  const __m256i vcheckpoint = _mm256_set1_epi64x( static_cast<int64_t>( checkpoint ) );
+  size_t i = 0;
+  for ( ; i + 4 <= seqnos.size(); i += 4 ) {
+    const __m128i raw = _mm_loadu_si128( reinterpret_cast<const __m128i*>( &seqnos[i] ) ); // NOLINT(*-cast)
+    const __m256i delta = _mm256_cvtepi32_epi64( _mm_sub_epi32( raw, vbase ) );
+    const __m256i candidate = _mm256_add_epi64( vcheckpoint, delta );
+    const __m256i fix = _mm256_slli_epi64( _mm256_srli_epi64( candidate, 63 ), 32 );
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( &absolute[i] ), // NOLINT(*-reinterpret-cast)
+                         _mm256_add_epi64( candidate, fix ) );
+  }
+  return i;
+}
+#endif
+
+} // namespace
+
+void Wrap32::unwrap( span<const Wrap32> seqnos, Wrap32 zero_point, uint64_t checkpoint, span<uint64_t> absolute )
+{
+  static_assert( sizeof( Wrap32 ) == sizeof( uint32_t ) );
+  if ( absolute.size() < seqnos.size() ) {
+    throw runtime_error( "Wrap32::unwrap: output is smaller than input" );
+  }
+
+  size_t done = 0;
+#if defined( __x86_64__ )
+  static const bool has_avx2 = __builtin_cpu_supports( "avx2" );
+  if ( has_avx2 ) {
+    done = unwrap_avx2( seqnos, zero_point.raw_value_ + static_cast<uint32_t>( checkpoint ), checkpoint, absolute );
+  }
+#endif
+  for ( size_t i = done; i < seqnos.size(); ++i ) {
+    absolute[i] = seqnos[i].unwrap( zero_point, checkpoint );
+  }
+}
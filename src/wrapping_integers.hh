@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+/*
+ * The Wrap32 type represents a 32-bit unsigned integer that:
+ *    - starts at an arbitrary "zero point" (initial value), and
+ *    - wraps back to zero when it reaches 2^32 - 1.
+ *
+ * TCP sequence numbers are Wrap32s. An absolute sequence number (a uint64_t counting from the
+ * zero point, which never wraps in practice) maps to exactly one Wrap32; going back needs a
+ * "checkpoint", a nearby absolute sequence number, to pick which of the many candidates was meant.
+ *
+ * Everything here is constexpr and branch-free: unwrap() is a handful of adds and a shift.
+ */
+class Wrap32
+{
+protected:
+  uint32_t raw_value_ {};
+
+public:
+  explicit constexpr Wrap32( uint32_t raw_value ) : raw_value_( raw_value ) {}
+
+  // Wrap absolute sequence number `n` given the zero point
+  static constexpr Wrap32 wrap( uint64_t n, Wrap32 zero_point )
+  {
+    return Wrap32 { zero_point.raw_value_ + static_cast<uint32_t>( n ) };
+  }
+
+  // The absolute sequence number that wraps to this Wrap32 and is closest to `checkpoint` (ties go to the lower
+  // one). Assumes checkpoint < 2^63.
+  constexpr uint64_t unwrap( Wrap32 zero_point, uint64_t checkpoint ) const
+  {
+    // signed distance from the checkpoint's position in the 32-bit space to this one's
+    const uint32_t offset = raw_value_ - zero_point.raw_value_ - static_cast<uint32_t>( checkpoint );
+    const auto delta = static_cast<int32_t>( offset );
+    const uint64_t candidate = checkpoint + static_cast<uint64_t>( int64_t { delta } );
+    // if that went below zero, the next wrap up is the closest valid answer
+    return candidate + ( ( candidate >> 63 ) << 32 ); // NOLINT(*-bitwise)
+  }
+
+  // Unwrap each of `seqnos` into the corresponding element of `absolute` (e.g., the acknos of a batch of
+  // segments), all relative to the same checkpoint
+  static void unwrap( std::span<const Wrap32> seqnos,
+                      Wrap32 zero_point,
+                      uint64_t checkpoint,
+                      std::span<uint64_t> absolute );
+
+  constexpr uint32_t raw_value() const { return raw_value_; }
+
+  constexpr Wrap32 operator+( uint32_t n ) const { return Wrap32 { raw_value_ + n }; }
+  constexpr Wrap32 operator-( uint32_t n ) const { return Wrap32 { raw_value_ - n }; }
+  constexpr Wrap32& operator+=( uint32_t n ) { return *this = *this + n; }
+  constexpr Wrap32& operator-=( uint32_t n ) { return *this = *this - n; }
+
+  // Signed distance from `other` to this, assuming they are less than 2^31 apart
+  constexpr int32_t operator-( Wrap32 other ) const
+  {
+    return static_cast<int32_t>( raw_value_ - other.raw_value_ );
+  }
+
+  constexpr bool operator==( const Wrap32& other ) const = default;
+
+  // Sequence-space ordering (RFC 1982): a < b if b is less than 2^31 ahead of a. Only meaningful for values
+  // that are close together; it is not transitive across the whole space.
+  constexpr bool operator<( Wrap32 other ) const { return *this - other < 0; }
+  constexpr bool operator>( Wrap32 other ) const { return other < *this; }
+  constexpr bool operator<=( Wrap32 other ) const { return not( other < *this ); }
+  constexpr bool operator>=( Wrap32 other ) const { return not( *this < other ); }
+};
@@ -0,0 +1,179 @@
+#include "exception.hh"
+#include "socket.hh"
+#include "test_should_be.hh"
+
+#include <arpa/inet.h>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Run (by bpf_filter_t.sh) in a network namespace of its own, so only the test's frames cross its loopback
+// interface. Frames are made by hand and sent on it, and a PacketSocket with each filter attached must
+// receive exactly the ones the filter describes.
+
+namespace {
+
+constexpr uint16_t kPort = 5353;
+constexpr uint16_t kOtherPort = 5354;
+constexpr size_t kTagLength = 8;
+
+sockaddr_ll loopback_address( uint16_t protocol )
+{
+  sockaddr_ll addr {};
+  addr.sll_family = AF_PACKET;
+  addr.sll_protocol = htons( protocol );
+  addr.sll_ifindex = static_cast<int>( if_nametoindex( "lo" ) );
+  if ( addr.sll_ifindex == 0 ) {
+    throw runtime_error( "no loopback interface" );
+  }
+  return addr;
+}
+
+Address as_address( const sockaddr_ll& addr )
+{
+  return { reinterpret_cast<const sockaddr*>( &addr ), sizeof( addr ) }; // NOLINT(*-reinterpret-cast)
+}
+
+void put16( string& frame, size_t offset, uint16_t value )
+{
+  frame[offset] = static_cast<char>( value >> 8 ); // NOLINT(*-bitwise)
+  frame[offset + 1] = static_cast<char>( value );
+}
+
+// An Ethernet frame ending with `tag`, so it can be recognized when it arrives
+string ethernet_frame( uint16_t ethertype, const string& payload, const string& tag )
+{
+  string frame( 12, 0 );
+  frame[0] = 0x02; // a locally administered destination
+  frame.append( 2, 0 );
+  put16( frame, 12, ethertype );
+  return frame + payload + tag;
+}
+
+// An IPv4 packet carrying `protocol`, whose transport header starts with the two ports
+string ipv4_frame( uint8_t protocol,
+                   uint16_t source_port,
+                   uint16_t destination_port,
+                   const string& tag,
+                   uint16_t fragment = 0,
+                   size_t option_words = 0 )
+{
+  string ip( 20 + 4 * option_words, 0 );
+  ip[0] = static_cast<char>( 0x40 | ( 5 + option_words ) ); // NOLINT(*-bitwise)
+  put16( ip, 2, static_cast<uint16_t>( ip.size() + 8 + tag.size() ) );
+  put16( ip, 6, fragment );
+  ip[8] = 64;
+  ip[9] = static_cast<char>( protocol );
+  for ( size_t i = 20; i < ip.size(); ++i ) {
+    ip[i] = 1; // NOP options
+  }
+  string transport( 8, 0 );
+  put16( transport, 0, source_port );
+  put16( transport, 2, destination_port );
+  return ethernet_frame( ETH_P_IP, ip + transport, tag );
+}
+
+// Send every frame on the loopback interface, and return the tags of those `receiver` got
+set<string> filtered( PacketSocket& receiver, const vector<string>& frames )
+{
+  PacketSocket sender { SOCK_RAW, 0 };
+  const Address lo = as_address( loopback_address( ETH_P_ALL ) );
+  for ( const auto& frame : frames ) {
+    sender.sendto( lo, frame );
+  }
+
+  set<string> tags;
+  Address source = lo;
+  string frame;
+  pollfd pfd { receiver.fd_num(), POLLIN, 0 };
+  while ( CheckSystemCall( "poll", ::poll( &pfd, 1, 100 ) ) > 0 ) {
+    receiver.recv( source, frame );
+    if ( frame.size() >= kTagLength ) {
+      tags.insert( frame.substr( frame.size() - kTagLength ) );
+    }
+  }
+  return tags;
+}
+
+// A socket for every frame on the loopback interface that passes `filter` (attached before it binds, so
+// nothing unfiltered is queued)
+PacketSocket filtered_socket( const BPFFilter& filter )
+{
+  PacketSocket socket { SOCK_RAW, 0 };
+  socket.attach_filter( filter );
+  socket.bind( as_address( loopback_address( ETH_P_ALL ) ) );
+  return socket;
+}
+
+// TCP or UDP, either port, through IPv4 headers with options; not other ports, protocols or later fragments
+void test_port()
+{
+  const vector<string> frames {
+    ipv4_frame( IPPROTO_UDP, 40000, kPort, "udp-dst " ),
+    ipv4_frame( IPPROTO_UDP, kPort, 40000, "udp-src " ),
+    ipv4_frame( IPPROTO_TCP, 40000, kPort, "tcp-dst " ),
+    ipv4_frame( IPPROTO_TCP, kPort, 40000, "tcp-src " ),
+    ipv4_frame( IPPROTO_UDP, 40000, kPort, "options ", 0, 2 ),
+    ipv4_frame( IPPROTO_UDP, 40000, kPort, "first   ", 0x2000 ), // more fragments follow
+    ipv4_frame( IPPROTO_UDP, 40000, kOtherPort, "other   " ),
+    ipv4_frame( IPPROTO_ICMP, 40000, kPort, "icmp    " ),
+    ipv4_frame( IPPROTO_UDP, 40000, kPort, "later   ", 0x0010 ), // fragment offset 128
+    ethernet_frame( ETH_P_ARP, string( 28, 0 ), "arp     " ),
+  };
+
+  PacketSocket any_port = filtered_socket( BPFFilter {}.port( kPort ) );
+  const set<string> any_port_tags { "udp-dst ", "udp-src ", "tcp-dst ", "tcp-src ", "options ", "first   " };
+  test_should_be( filtered( any_port, frames ) == any_port_tags, true );
+
+  PacketSocket udp_port = filtered_socket( BPFFilter {}.ipv4_protocol( IPPROTO_UDP ).port( kPort ) );
+  const set<string> udp_port_tags { "udp-dst ", "udp-src ", "options ", "first   " };
+  test_should_be( filtered( udp_port, frames ) == udp_port_tags, true );
+}
+
+// Ethertype and destination address conditions; a filter replaced by another; no filter at all
+void test_other_conditions()
+{
+  const vector<string> frames {
+    ethernet_frame( ETH_P_ARP, string( 28, 0 ), "arp     " ),
+    ipv4_frame( IPPROTO_UDP, 1, 2, "ipv4    " ),
+  };
+
+  PacketSocket socket = filtered_socket( BPFFilter::reject_all() );
+  test_should_be( filtered( socket, frames ).empty(), true );
+
+  socket.attach_filter( BPFFilter {}.ethertype( ETH_P_ARP ).destination_mac( { 0x02, 0, 0, 0, 0, 0 } ) );
+  const set<string> arp_tags { "arp     " };
+  test_should_be( filtered( socket, frames ) == arp_tags, true );
+
+  socket.attach_filter( BPFFilter {}.destination_mac( { 0x02, 0, 0, 0, 0, 1 } ) );
+  test_should_be( filtered( socket, frames ).empty(), true );
+
+  socket.detach_filter();
+  const set<string> all_tags { "arp     ", "ipv4    " };
+  test_should_be( filtered( socket, frames ) == all_tags, true );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    test_port();
+    test_other_conditions();
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
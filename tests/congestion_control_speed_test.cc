@@ -0,0 +1,178 @@
+#include "congestion_control.hh"
+#include "simulated_link.hh"
+#include "tcp_receiver.hh"
+#include "tcp_sender.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+struct Scenario
+{
+  TCPConfig::CongestionControl algorithm {};
+  uint64_t mbit_per_s {};
+  uint64_t rtt_ms {};
+  double loss_rate {}; // chance that a data segment starts a loss event
+  unsigned burst = 1;  // data segments lost in each event
+  bool sack = true;
+  std::optional<uint64_t> min_RTO_ms {}; // if set, estimate the RTO (with timestamps) down to this
+  uint64_t jitter_ms {};                 // data segments' extra delay, up to this
+  double reorder_rate {};                // chance that a data segment is overtaken by those one RTT behind it
+};
+
+// Run a bulk transfer for `duration_ms` of simulated time over the scenario's bottleneck, with a queue of one
+// bandwidth-delay product. Both ends buffer twice the bandwidth-delay product, and negotiate window scaling
+// to advertise it.
+void speed_test( const Scenario& scenario, const uint64_t duration_ms, const uint64_t random_seed )
+{
+  const uint64_t bytes_per_ms = scenario.mbit_per_s * 1000 / 8;
+  const uint64_t bdp = bytes_per_ms * scenario.rtt_ms;
+
+  TCPConfig config;
+  config.congestion_control = scenario.algorithm;
+  config.send_capacity = max( config.send_capacity, 2 * bdp );
+  config.recv_capacity = max( config.recv_capacity, 2 * bdp );
+  config.sack = scenario.sack;
+  config.estimate_RTO = scenario.min_RTO_ms.has_value();
+  config.min_RTO_ms = scenario.min_RTO_ms.value_or( config.min_RTO_ms );
+  TCPSender sender { ByteStream { config.send_capacity },
+                     Wrap32 { static_cast<uint32_t>( random_seed ) },
+                     config.rt_timeout,
+                     make_congestion_controller( config.congestion_control ) };
+  TCPReceiver receiver { Reassembler { ByteStream { config.recv_capacity } }, config };
+
+  // what the two SYNs would carry: only the receiving end's scale matters, but both must offer one
+  sender.offer_window_scale( 0 );
+  sender.set_peer_window_scale( receiver.window_scale() );
+  if ( config.estimate_RTO ) {
+    sender.estimate_RTO( config.min_RTO_ms, config.max_RTO_ms );
+    sender.offer_timestamps( true );
+    sender.set_peer_timestamps( config.timestamps );
+  }
+
+  // data segments may be lost on the way; ACKs take no room at the bottleneck
+  SimulatedLink<TCPSenderMessage> data_link { { .bytes_per_ms = bytes_per_ms,
+                                                .queue_limit = bdp,
+                                                .delay_ms = scenario.rtt_ms / 2,
+                                                .jitter_ms = scenario.jitter_ms,
+                                                .loss_rate = scenario.loss_rate,
+                                                .loss_burst = scenario.burst,
+                                                .reorder_rate = scenario.reorder_rate,
+                                                .reorder_ms = scenario.rtt_ms / 4 },
+                                              random_seed };
+  SimulatedLink<TCPReceiverMessage> ack_link { { .delay_ms = scenario.rtt_ms - scenario.rtt_ms / 2 }, random_seed };
+
+  const Buffer data { string( config.send_capacity, 'x' ) };
+  uint64_t delivered = 0;
+  uint64_t recoveries = 0;
+  uint64_t recovery_ms = 0;
+
+  const auto transmit = [&]( const TCPSenderMessage& msg ) { data_link.send( msg, msg.sequence_length() ); };
+  const auto refill = [&] {
+    const uint64_t room = sender.writer().available_capacity();
+    if ( room > 0 ) {
+      sender.writer().push( data, 0, room );
+    }
+  };
+
+  refill();
+  sender.push( transmit );
+  while ( data_link.now_ms() < duration_ms ) {
+    const bool was_recovering = sender.in_recovery();
+    data_link.advance( 1, [&]( TCPSenderMessage&& msg ) { receiver.receive( move( msg ) ); } );
+    ack_link.advance( 1, [&]( TCPReceiverMessage&& msg ) { sender.receive( msg ); } );
+    sender.tick( 1, transmit );
+    receiver.tick( 1 );
+
+    Reader& reader = receiver.reader();
+    delivered += reader.bytes_buffered();
+    reader.pop( reader.bytes_buffered() );
+    if ( receiver.ack_due() ) {
+      ack_link.send( receiver.send(), 0 );
+      receiver.ack_sent();
+    }
+
+    refill();
+    sender.push( transmit );
+
+    recoveries += sender.in_recovery() and not was_recovering;
+    recovery_ms += sender.in_recovery();
+  }
+
+  if ( sender.reader().has_error() ) {
+    throw runtime_error( "TCPSender gave up on the connection" );
+  }
+
+  const double goodput = static_cast<double>( delivered ) * 8.0 / static_cast<double>( duration_ms ) / 1000.0;
+  const double mean_recovery_ms
+    = recoveries ? static_cast<double>( recovery_ms ) / static_cast<double>( recoveries ) : 0;
+  const auto* cc = sender.congestion_control();
+
+  cout << fixed << setprecision( 2 );
+  cout << setw( 7 ) << ( cc ? cc->name() : "None" ) << ( scenario.sack ? "" : " without SACK" ) << " over "
+       << scenario.mbit_per_s << " Mbit/s, " << scenario.rtt_ms << " ms RTT, " << setprecision( 1 )
+       << scenario.loss_rate * 100 << "% loss";
+  if ( scenario.burst > 1 ) {
+    cout << " in bursts of " << scenario.burst;
+  }
+  if ( scenario.jitter_ms > 0 ) {
+    cout << ", " << scenario.jitter_ms << " ms jitter";
+  }
+  if ( scenario.reorder_rate > 0 ) {
+    cout << ", " << scenario.reorder_rate * 100 << "% reordered";
+  }
+  if ( scenario.min_RTO_ms.has_value() ) {
+    cout << " with RTO estimated down to " << *scenario.min_RTO_ms << " ms";
+  }
+  cout << " reached " << setprecision( 2 ) << goodput << " Mbit/s (mean queueing delay "
+       << data_link.stats().mean_queueing_ms() << " ms, mean recovery " << mean_recovery_ms << " ms).\n";
+}
+
+void program_body()
+{
+  using enum TCPConfig::CongestionControl;
+
+  for ( const auto& [mbit_per_s, rtt_ms] : { pair<uint64_t, uint64_t> { 10, 40 }, { 100, 100 } } ) {
+    for ( const double loss_rate : { 0.0, 0.01 } ) {
+      for ( const auto algorithm : { None, NewReno, CUBIC, BBR } ) {
+        speed_test( { algorithm, mbit_per_s, rtt_ms, loss_rate }, 20000, 1729 );
+      }
+    }
+  }
+
+  // bursty loss: how long the sender takes to repair several holes at once, with and without SACK
+  for ( const auto algorithm : { NewReno, CUBIC } ) {
+    for ( const bool sack : { false, true } ) {
+      speed_test( { algorithm, 100, 100, 0.001, 4, sack }, 20000, 1729 );
+    }
+  }
+
+  // a short path: how long recovery takes with the RTO fixed at one second, or following the RTT
+  for ( const optional<uint64_t> min_RTO_ms : { optional<uint64_t> {}, optional<uint64_t> { 5 } } ) {
+    speed_test( { NewReno, 100, 2, 0.01, 4, true, min_RTO_ms }, 20000, 1729 );
+  }
+
+  // jitter and reordering, without loss: what spurious fast retransmits cost
+  for ( const auto algorithm : { NewReno, CUBIC, BBR } ) {
+    speed_test( { algorithm, 100, 40, 0, 1, true, {}, 5, 0.01 }, 20000, 1729 );
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "wrapping_integers.hh"
+
 #include <optional>
 #include <string>
 #include <utility>
@@ -9,6 +11,11 @@
 namespace minnow_conversions {
 using std::to_string;
 
+inline std::string to_string( Wrap32 i )
+{
+  return "Wrap32<" + std::to_string( i.raw_value() ) + ">";
+}
+
 template<typename T>
 std::string to_string( const std::optional<T>& v )
 {
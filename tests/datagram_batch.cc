@@ -0,0 +1,151 @@
+#include "socket.hh"
+#include "test_should_be.hh"
+
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// A pair of UDP sockets on the loopback interface, the sender connected to the receiver
+struct Loopback
+{
+  UDPSocket sender {};
+  UDPSocket receiver {};
+
+  Loopback()
+  {
+    receiver.bind( Address { "127.0.0.1" } );
+    sender.bind( Address { "127.0.0.1" } );
+    sender.connect( receiver.local_address() );
+  }
+};
+
+// Receive into `batch` until `count` datagrams (counting each one a GRO train carries) have arrived
+vector<string> receive( UDPSocket& socket, DatagramBatch& batch, size_t count )
+{
+  vector<string> datagrams;
+  while ( datagrams.size() < count ) {
+    socket.recv_batch( batch );
+    for ( size_t i = 0; i < batch.size(); ++i ) {
+      for ( size_t n = 0; n < batch.datagram_count( i ); ++n ) {
+        datagrams.emplace_back( batch.datagram( i, n ) );
+      }
+    }
+  }
+  return datagrams;
+}
+
+string datagram_contents( size_t i, size_t size )
+{
+  return string( size, static_cast<char>( 'a' + i % 26 ) );
+}
+
+// Several datagrams each way in one syscall, with their addresses
+void test_round_trip()
+{
+  Loopback l;
+  DatagramBatch out { 8 };
+  for ( size_t i = 0; i < out.capacity(); ++i ) {
+    out.push( l.receiver.local_address(), datagram_contents( i, 100 + i ) );
+  }
+  test_should_be( l.sender.send_batch( out ), size_t { 8 } );
+
+  DatagramBatch in { 8 };
+  const vector<string> got = receive( l.receiver, in, 8 );
+  for ( size_t i = 0; i < got.size(); ++i ) {
+    test_should_be( got[i] == datagram_contents( i, 100 + i ), true );
+  }
+  test_should_be( in.address( 0 ) == l.sender.local_address(), true );
+  test_should_be( in.truncated( 0 ), false );
+}
+
+// One slot sent with UDP_SEGMENT arrives as separate datagrams, or (with GRO) as one train again
+void test_gso_and_gro()
+{
+  string train;
+  for ( size_t i = 0; i < 10; ++i ) {
+    train += datagram_contents( i, 100 );
+  }
+
+  Loopback split;
+  DatagramBatch out { 1 };
+  out.push( split.receiver.local_address(), train, 100 );
+  test_should_be( out.datagram_count( 0 ), size_t { 10 } );
+  split.sender.send_batch( out );
+  DatagramBatch in { 16 };
+  const vector<string> got = receive( split.receiver, in, 10 );
+  for ( size_t i = 0; i < got.size(); ++i ) {
+    test_should_be( got[i] == datagram_contents( i, 100 ), true );
+  }
+  test_should_be( in.segment_size( 0 ), uint16_t { 0 } );
+
+  Loopback coalesced;
+  coalesced.receiver.set_gro( true );
+  out.clear();
+  out.push( coalesced.receiver.local_address(), train, 100 );
+  coalesced.sender.send_batch( out );
+  DatagramBatch trains { 4, DatagramBatch::kMaxSlotSize };
+  const vector<string> got_coalesced = receive( coalesced.receiver, trains, 10 );
+  for ( size_t i = 0; i < got_coalesced.size(); ++i ) {
+    test_should_be( got_coalesced[i] == datagram_contents( i, 100 ), true );
+  }
+  test_should_be( trains.segment_size( 0 ), uint16_t { 100 } );
+}
+
+// A datagram too big for its slot is cut short and marked, without losing the others received with it
+void test_truncation()
+{
+  Loopback l;
+  DatagramBatch out { 3 };
+  out.push( l.receiver.local_address(), datagram_contents( 0, 10 ) );
+  out.push( l.receiver.local_address(), datagram_contents( 1, 200 ) );
+  out.push( l.receiver.local_address(), datagram_contents( 2, 10 ) );
+  l.sender.send_batch( out );
+
+  DatagramBatch in { 3, 64 };
+  const vector<string> got = receive( l.receiver, in, 3 );
+  test_should_be( got[0] == datagram_contents( 0, 10 ), true );
+  test_should_be( got[1] == datagram_contents( 1, 64 ), true );
+  test_should_be( got[2] == datagram_contents( 2, 10 ), true );
+  test_should_be( in.size(), size_t { 3 } );
+  test_should_be( in.truncated( 1 ), true );
+  test_should_be( in.truncated( 2 ), false );
+}
+
+// More segments than UDP_SEGMENT allows are refused up front
+void test_segment_limit()
+{
+  DatagramBatch out { 2 };
+  const Address destination { "127.0.0.1", 9 };
+  out.push( destination, string( DatagramBatch::kMaxSegments * 10, 'x' ), 10 );
+  bool threw = false;
+  try {
+    out.push( destination, string( DatagramBatch::kMaxSegments * 10 + 1, 'x' ), 10 );
+  } catch ( const runtime_error& ) {
+    threw = true;
+  }
+  test_should_be( threw, true );
+  test_should_be( out.size(), size_t { 1 } );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    test_round_trip();
+    test_gso_and_gro();
+    test_truncation();
+    test_segment_limit();
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
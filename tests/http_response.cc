@@ -0,0 +1,141 @@
+#include "http_response.hh"
+#include "http_response_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    const string simple = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 5\r\n\r\nhello";
+
+    {
+      HTTPResponseTestHarness test { "content-length" };
+      test.execute( Receive { simple } );
+      test.execute( IsDone { true } );
+      test.execute( StatusCode { 200 } );
+      test.execute( HeaderIs { "content-type", "text/plain" } );
+      test.execute( BodyIs { "hello" } );
+      test.execute( KeepAlive { true } );
+      test.execute( Unconsumed { 0 } );
+    }
+
+    {
+      HTTPResponseTestHarness test { "head parsed in place" };
+      test.execute( ReceiveHead { simple } );
+      test.execute( HeadDone { true } );
+      test.execute( StatusCode { 200 } );
+      test.execute( HeaderIs { "Content-Length", "5" } );
+      test.execute( Unconsumed { simple.size() } );
+      test.execute( Receive { "" } );
+      test.execute( IsDone { true } );
+      test.execute( BodyIs { "hello" } );
+      test.execute( Unconsumed { 0 } );
+    }
+
+    {
+      HTTPResponseTestHarness test { "head split across chunks" };
+      test.execute( ReceiveHead { "HTTP/1.1 200 OK\r\nContent-Type: text/pl" } );
+      test.execute( HeadDone { false } );
+      test.execute( ReceiveHead { "ain; charset=utf-8\r\nX-Long-Header-Name-Spanning-Blocks: padded value \t\r" } );
+      test.execute( HeadDone { false } );
+      test.execute( ReceiveHead { "\nContent-Length: 2\r\n\r\nhi" } );
+      test.execute( HeadDone { true } );
+      test.execute( HeaderIs { "content-type", "text/plain; charset=utf-8" } );
+      test.execute( HeaderIs { "x-long-header-name-spanning-blocks", "padded value" } );
+      test.execute( Unconsumed { 2 } );
+      test.execute( Receive { "" } );
+      test.execute( BodyIs { "hi" } );
+      test.execute( IsDone { true } );
+    }
+
+    {
+      HTTPResponseTestHarness test { "content-length bytewise" };
+      test.execute( ReceiveBytewise { simple.substr( 0, simple.size() - 1 ) } );
+      test.execute( HeaderIs { "Content-Type", "text/plain" } );
+      test.execute( IsDone { false } );
+      test.execute( BodyIs { "hell" } );
+      test.execute( Receive { "o" } );
+      test.execute( IsDone { true } );
+      test.execute( BodyIs { "hello" } );
+    }
+
+    {
+      HTTPResponseTestHarness test { "chunked with extension and trailer" };
+      test.execute( Receive { "HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip, chunked\r\n\r\n" } );
+      test.execute( IsDone { false } );
+      test.execute( Receive { "6;name=value\r\nhello \r\n" } );
+      test.execute( BodyIs { "hello " } );
+      test.execute( ReceiveBytewise { "a\r\nchunked wo\r\n3\r\nrld\r\n0\r\nX-Trailer: yes\r\n" } );
+      test.execute( IsDone { false } );
+      test.execute( Receive { "\r\n" } );
+      test.execute( IsDone { true } );
+      test.execute( BodyIs { "hello chunked world" } );
+      test.execute( KeepAlive { true } );
+    }
+
+    {
+      HTTPResponseTestHarness test { "pipelined responses" };
+      const string second = "HTTP/1.1 404 Not Found\r\nContent-Length: 3\r\nConnection: close\r\n\r\nnah";
+      test.execute( Receive { simple + second } );
+      test.execute( IsDone { true } );
+      test.execute( BodyIs { "hello" } );
+      test.execute( Unconsumed { second.size() } );
+      test.execute( NextResponse {} );
+      test.execute( IsDone { true } );
+      test.execute( StatusCode { 404 } );
+      test.execute( BodyIs { "nah" } );
+      test.execute( KeepAlive { false } );
+      test.execute( Unconsumed { 0 } );
+    }
+
+    {
+      HTTPResponseTestHarness test { "interim 100 Continue" };
+      test.execute( Receive { "HTTP/1.1 100 Continue\r\nX-Interim: yes\r\n\r\nHTTP/1.1 204 No Content\r\n\r\n" } );
+      test.execute( IsDone { true } );
+      test.execute( StatusCode { 204 } );
+      test.execute( KeepAlive { true } );
+      test.execute( BodyIs { "" } );
+    }
+
+    {
+      HTTPResponseTestHarness test { "HEAD response", true };
+      test.execute( Receive { "HTTP/1.1 200 OK\r\nContent-Length: 1000\r\n\r\n" } );
+      test.execute( IsDone { true } );
+      test.execute( BodyIs { "" } );
+      test.execute( KeepAlive { true } );
+    }
+
+    {
+      HTTPResponseTestHarness test { "close-delimited HTTP/1.0" };
+      test.execute( Receive { "HTTP/1.0 200 OK\r\n\r\nuntil " } );
+      test.execute( Receive { "close" } );
+      test.execute( IsDone { false } );
+      test.execute( CloseConnection {} );
+      test.execute( IsDone { true } );
+      test.execute( BodyIs { "until close" } );
+      test.execute( KeepAlive { false } );
+    }
+
+    {
+      HTTPResponseTestHarness test { "bare LF line endings" };
+      test.execute( Receive { "HTTP/1.1 200 OK\nTransfer-Encoding: chunked\n\n3\nabc\n0\n\n" } );
+      test.execute( IsDone { true } );
+      test.execute( BodyIs { "abc" } );
+    }
+
+    {
+      HTTPResponseTestHarness test { "truncated" };
+      test.execute( Receive { "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nshort" } );
+      test.execute( CloseConnection {} );
+      test.execute( IsDone { false } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+#include "byte_stream.hh"
+#include "http_response.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+// A stream of pipelined responses with browser-like heads, alternating Content-Length and chunked bodies
+string make_responses( size_t count, size_t body_size, size_t random_seed, uint64_t& total_body )
+{
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<char> ud { 'a', 'z' };
+  string body( body_size, 0 );
+  for ( auto& ch : body ) {
+    ch = ud( rd );
+  }
+
+  string ret;
+  for ( size_t i = 0; i < count; ++i ) {
+    ret += "HTTP/1.1 200 OK\r\n"
+           "Date: Mon, 19 Oct 2026 12:00:00 GMT\r\n"
+           "Server: Apache/2.4.58 (Unix)\r\n"
+           "Last-Modified: Tue, 01 Sep 2026 08:30:00 GMT\r\n"
+           "ETag: \"2aa6-5f8c0e1b7e4c0\"\r\n"
+           "Accept-Ranges: bytes\r\n"
+           "Cache-Control: max-age=3600, public\r\n"
+           "Vary: Accept-Encoding\r\n"
+           "Content-Type: text/html; charset=UTF-8\r\n";
+    if ( i % 2 ) {
+      ret += "Transfer-Encoding: chunked\r\n\r\n";
+      for ( size_t offset = 0; offset < body.size(); offset += 1000 ) {
+        const string piece = body.substr( offset, 1000 );
+        ret += ( ostringstream {} << hex << piece.size() ).str() + "\r\n" + piece + "\r\n";
+      }
+      ret += "0\r\n\r\n";
+    } else {
+      ret += "Content-Length: " + to_string( body.size() ) + "\r\n\r\n" + body;
+    }
+    total_body += body.size();
+  }
+  return ret;
+}
+
+void speed_test( const size_t count,     // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t body_size, // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t read_size, // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t random_seed )
+{
+  uint64_t expected_body {};
+  const string data = make_responses( count, body_size, random_seed, expected_body );
+
+  ByteStream stream { 1 << 20 };
+  HTTPResponseParser parser;
+  uint64_t body {};
+  size_t responses {};
+  size_t offset {};
+
+  const auto start_time = steady_clock::now();
+  while ( responses < count ) {
+    if ( offset < data.size() and stream.writer().available_capacity() >= read_size ) {
+      stream.writer().push( data.substr( offset, read_size ) );
+      offset += read_size;
+    }
+
+    if ( not parser.head_done() and parser.parse_head( stream.reader() )
+         and parser.head().header( "content-type" ) != "text/html; charset=UTF-8" ) {
+      throw runtime_error( "wrong Content-Type" );
+    }
+    while ( parser.parse( stream.reader(), [&]( string_view s ) { body += s.size(); } ) ) {
+      ++responses;
+      parser.reset();
+    }
+  }
+  const auto stop_time = steady_clock::now();
+
+  if ( body != expected_body or stream.reader().bytes_buffered() ) {
+    throw runtime_error( "parsed body bytes do not match" );
+  }
+
+  const auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  const double responses_per_second = static_cast<double>( count ) / test_duration.count();
+  const double gigabits_per_second = static_cast<double>( data.size() ) * 8 / test_duration.count() / 1e9;
+
+  cout << "HTTPResponseParser with body_size=" << body_size << ", read_size=" << read_size << " reached " << fixed
+       << setprecision( 2 ) << responses_per_second / 1e6 << " M responses/s (" << gigabits_per_second
+       << " Gbit/s).\n";
+
+  if ( gigabits_per_second < 0.1 ) {
+    throw runtime_error( "HTTPResponseParser did not meet minimum speed of 0.1 Gbit/s." );
+  }
+}
+
+void program_body()
+{
+  speed_test( 200000, 0, 16384, 1234 );
+  speed_test( 20000, 10000, 16384, 5678 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "byte_stream.hh"
+#include "common.hh"
+#include "http_response.hh"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// A response parser together with the stream it reads from and everything it has delivered
+struct HTTPResponseParserUnderTest
+{
+  ByteStream stream { 1 << 16 };
+  HTTPResponseParser parser {};
+  std::vector<std::pair<std::string, std::string>> headers {}; // copied while parse_head() made them available
+  std::string body {};
+  bool done {};
+
+  void parse()
+  {
+    if ( not parser.head_done() and parser.parse_head( stream.reader() ) ) {
+      for ( const auto& [name, value] : parser.head().headers ) {
+        headers.emplace_back( name, value );
+      }
+    }
+    done = parser.parse( stream.reader(), [&]( std::string_view s ) { body += s; } );
+  }
+};
+
+class HTTPResponseTestHarness : public TestHarness<HTTPResponseParserUnderTest>
+{
+public:
+  explicit HTTPResponseTestHarness( std::string test_name, bool head_request = false )
+    : TestHarness( move( test_name ),
+                   head_request ? "a HEAD request" : "a GET request",
+                   HTTPResponseParserUnderTest { ByteStream { 1 << 16 }, HTTPResponseParser { head_request } } )
+  {}
+};
+
+/* actions */
+
+struct Receive : public Action<HTTPResponseParserUnderTest>
+{
+  std::string data_;
+
+  explicit Receive( std::string data ) : data_( move( data ) ) {}
+  std::string description() const override
+  {
+    return "receive \"" + Printer::prettify( data_ ) + "\" and parse";
+  }
+  void execute( HTTPResponseParserUnderTest& p ) const override
+  {
+    p.stream.writer().push( data_ );
+    p.parse();
+  }
+};
+
+struct ReceiveBytewise : public Receive
+{
+  using Receive::Receive;
+  std::string description() const override
+  {
+    return "receive \"" + Printer::prettify( data_ ) + "\" one byte at a time";
+  }
+  void execute( HTTPResponseParserUnderTest& p ) const override
+  {
+    for ( const char ch : data_ ) {
+      Receive { std::string( 1, ch ) }.execute( p );
+    }
+  }
+};
+
+struct ReceiveHead : public Receive
+{
+  using Receive::Receive;
+  std::string description() const override
+  {
+    return "receive \"" + Printer::prettify( data_ ) + "\" and parse the head only";
+  }
+  void execute( HTTPResponseParserUnderTest& p ) const override
+  {
+    p.stream.writer().push( data_ );
+    p.done = false;
+    if ( p.parser.parse_head( p.stream.reader() ) ) {
+      for ( const auto& [name, value] : p.parser.head().headers ) {
+        p.headers.emplace_back( name, value );
+      }
+    }
+  }
+};
+
+struct CloseConnection : public Action<HTTPResponseParserUnderTest>
+{
+  std::string description() const override { return "close the connection and parse"; }
+  void execute( HTTPResponseParserUnderTest& p ) const override
+  {
+    p.stream.writer().close();
+    p.parse();
+  }
+};
+
+struct NextResponse : public Action<HTTPResponseParserUnderTest>
+{
+  std::string description() const override { return "reset for the next response"; }
+  void execute( HTTPResponseParserUnderTest& p ) const override
+  {
+    p.parser.reset();
+    p.headers.clear();
+    p.body.clear();
+    p.parse();
+  }
+};
+
+/* expectations */
+
+struct IsDone : public ExpectBool<HTTPResponseParserUnderTest>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "response complete"; }
+  bool value( HTTPResponseParserUnderTest& p ) const override { return p.done; }
+};
+
+struct HeadDone : public ExpectBool<HTTPResponseParserUnderTest>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "head_done"; }
+  bool value( HTTPResponseParserUnderTest& p ) const override { return p.parser.head_done(); }
+};
+
+struct KeepAlive : public ExpectBool<HTTPResponseParserUnderTest>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "keep_alive"; }
+  bool value( HTTPResponseParserUnderTest& p ) const override { return p.parser.keep_alive(); }
+};
+
+struct StatusCode : public ExpectNumber<HTTPResponseParserUnderTest, unsigned>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "status_code"; }
+  unsigned value( HTTPResponseParserUnderTest& p ) const override { return p.parser.head().status_code; }
+};
+
+struct Unconsumed : public ExpectNumber<HTTPResponseParserUnderTest, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "bytes left in stream"; }
+  uint64_t value( HTTPResponseParserUnderTest& p ) const override { return p.stream.reader().bytes_buffered(); }
+};
+
+struct HeaderIs : public Expectation<HTTPResponseParserUnderTest>
+{
+  std::string name_, value_;
+
+  HeaderIs( std::string name, std::string value ) : name_( move( name ) ), value_( move( value ) ) {}
+  std::string description() const override { return "header " + name_ + " = \"" + value_ + "\""; }
+  void execute( HTTPResponseParserUnderTest& p ) const override
+  {
+    HTTPResponseHead copy;
+    for ( const auto& [name, value] : p.headers ) {
+      copy.headers.emplace_back( name, value );
+    }
+    const auto got = copy.header( name_ );
+    if ( not got.has_value() ) {
+      throw ExpectationViolation { "Expected header " + name_ + ", but it was missing" };
+    }
+    if ( *got != value_ ) {
+      throw ExpectationViolation { "Expected header " + name_ + " = \"" + value_ + "\", but found \""
+                                   + std::string( *got ) + "\"" };
+    }
+  }
+};
+
+struct BodyIs : public Expectation<HTTPResponseParserUnderTest>
+{
+  std::string body_;
+
+  explicit BodyIs( std::string body ) : body_( move( body ) ) {}
+  std::string description() const override { return "body is \"" + Printer::prettify( body_ ) + "\""; }
+  void execute( HTTPResponseParserUnderTest& p ) const override
+  {
+    if ( p.body != body_ ) {
+      throw ExpectationViolation { "Expected body \"" + Printer::prettify( body_ ) + "\", but found \""
+                                   + Printer::prettify( p.body ) + "\"" };
+    }
+  }
+};
@@ -0,0 +1,34 @@
+#!/bin/bash
+
+# Serve on a free loopback port, so webget and the load generator can be checked without the Internet.
+OUTPUT=`mktemp`
+${1}/apps/http_server --port 0 --threads 2 > ${OUTPUT} &
+SERVER=$!
+trap "kill ${SERVER}; rm -f ${OUTPUT}" EXIT
+
+for i in `seq 50`; do
+    ADDRESS=`sed -n 's/^listening on //p' ${OUTPUT}`
+    [ -n "${ADDRESS}" ] && break
+    sleep 0.1
+done
+if [ -z "${ADDRESS}" ]; then
+    echo ERROR: http_server did not start
+    exit 1
+fi
+
+WEB_HASH=`${1}/apps/webget --multi http://${ADDRESS}/nph-hasher/xyzzy | tail -n 1`
+CORRECT_HASH="GEhYoA/Xlx+BCEgmbrzs7l6LaZcsX/rtYi9e4HhnGu0"
+if [ "${WEB_HASH}" != "${CORRECT_HASH}" ]; then
+    echo ERROR: webget returned output that did not match the test\'s expectations
+    exit 1
+fi
+
+RANGED_SIZE=`${1}/apps/webget --ranged --chunk 100000 http://${ADDRESS}/bytes/1000000 2>/dev/null | wc -c`
+if [ "${RANGED_SIZE}" != "1000000" ]; then
+    echo ERROR: ranged download returned ${RANGED_SIZE} bytes instead of 1000000
+    exit 1
+fi
+
+${1}/apps/http_load --connections 16 --requests 2000 http://${ADDRESS}/bytes/1000 | tee /dev/stderr \
+    | grep -q "^2000 responses (2000 2xx), 0 failed" || { echo ERROR: load test failed; exit 1; }
+exit 0
@@ -0,0 +1,130 @@
+#include "ipv4_endpoint.hh"
+#include "test_should_be.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <netinet/in.h>
+#include <span>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Dotted quads and ports at their extremes, and formatting into buffers of every size
+void test_format()
+{
+  test_should_be( ( IPv4Endpoint { 0x08080808, 53 }.to_string() == "8.8.8.8:53" ), true );
+  test_should_be( ( IPv4Endpoint { 0, 0 }.to_string() == "0.0.0.0:0" ), true );
+  test_should_be( ( IPv4Endpoint { 0xc0a80107, 443 }.to_string() == "192.168.1.7:443" ), true );
+
+  const IPv4Endpoint longest { 0xffffffff, 65535 };
+  test_should_be( longest.to_string() == "255.255.255.255:65535", true );
+  test_should_be( longest.to_string().size(), IPv4Endpoint::kMaxStringLength );
+
+  array<char, IPv4Endpoint::kMaxStringLength> buf {};
+  test_should_be( longest.format_ip( buf ), size_t { 15 } );
+  test_should_be( string( buf.data(), 15 ) == "255.255.255.255", true );
+
+  // too small a buffer is refused, and one exactly big enough is filled
+  for ( size_t size = 0; size <= buf.size(); ++size ) {
+    bool threw = false;
+    try {
+      test_should_be( longest.format( span( buf ).first( size ) ), size );
+    } catch ( const runtime_error& ) {
+      threw = true;
+    }
+    test_should_be( threw, size < IPv4Endpoint::kMaxStringLength );
+  }
+}
+
+// Endpoints read from Addresses (as made from strings, or filled in by the kernel) and back again
+void test_parse()
+{
+  const Address address { "10.1.2.3", 8080 };
+  const IPv4Endpoint endpoint = IPv4Endpoint::from_address( address );
+  test_should_be( endpoint.ip, uint32_t { 0x0a010203 } );
+  test_should_be( endpoint.port, uint16_t { 8080 } );
+  test_should_be( endpoint.to_address() == address, true );
+  test_should_be( endpoint.to_string() == address.to_string(), true );
+
+  // as recvfrom fills in a sockaddr_storage
+  Address::Raw raw {};
+  memcpy( &raw.storage, static_cast<const sockaddr*>( Address { "255.255.255.255", 65535 } ), sizeof( sockaddr_in ) );
+  test_should_be( ( IPv4Endpoint::from_raw( raw ) == IPv4Endpoint { 0xffffffff, 65535 } ), true );
+
+  raw.storage.ss_family = AF_INET6;
+  bool threw = false;
+  try {
+    IPv4Endpoint::from_raw( raw );
+  } catch ( const runtime_error& ) {
+    threw = true;
+  }
+  test_should_be( threw, true );
+}
+
+// Endpoints order by address and then port, as their packed form does
+void test_order()
+{
+  const vector<IPv4Endpoint> sorted {
+    { 0x0a000001, 0 }, { 0x0a000001, 1 }, { 0x0a000001, 65535 }, { 0x0a000002, 0 }, { 0xffffffff, 0 } };
+  for ( size_t i = 1; i < sorted.size(); ++i ) {
+    test_should_be( sorted[i - 1] < sorted[i], true );
+    test_should_be( sorted[i - 1].packed() < sorted[i].packed(), true );
+  }
+
+  const IPv4FourTuple flow { { 0x0a000001, 40000 }, { 0xc0a80107, 443 } };
+  const IPv4FourTuple reversed { flow.remote, flow.local };
+  test_should_be( flow == IPv4FourTuple { flow }, true );
+  test_should_be( flow == reversed, false );
+}
+
+// Neighbouring endpoints and flows (as a server's connections are) all hash differently, and so do the two
+// directions of a flow
+void test_hash()
+{
+  unordered_set<size_t> endpoint_hashes;
+  unordered_set<size_t> flow_hashes;
+  const IPv4Endpoint server { 0xc0a80107, 443 };
+  for ( uint32_t host = 0; host < 256; ++host ) {
+    for ( uint16_t port = 40000; port < 40256; ++port ) {
+      const IPv4Endpoint client { 0x0a000000 + host, port };
+      endpoint_hashes.insert( hash<IPv4Endpoint> {}( client ) );
+      flow_hashes.insert( hash<IPv4FourTuple> {}( { server, client } ) );
+      flow_hashes.insert( hash<IPv4FourTuple> {}( { client, server } ) );
+    }
+  }
+  test_should_be( endpoint_hashes.size(), size_t { 256 * 256 } );
+  test_should_be( flow_hashes.size(), size_t { 2 * 256 * 256 } );
+
+  // every bit of the endpoint reaches the low bits a hash table indexes by
+  unordered_set<size_t> low_bits;
+  for ( size_t bit = 0; bit < 48; ++bit ) {
+    const uint64_t packed = uint64_t { 1 } << bit; // NOLINT(*-bitwise)
+    const IPv4Endpoint endpoint { static_cast<uint32_t>( packed >> 16 ), static_cast<uint16_t>( packed ) }; // NOLINT
+    low_bits.insert( hash<IPv4Endpoint> {}( endpoint ) & 0xffff ); // NOLINT(*-bitwise)
+  }
+  test_should_be( low_bits.size(), size_t { 48 } );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    test_format();
+    test_parse();
+    test_order();
+    test_hash();
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
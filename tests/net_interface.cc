@@ -0,0 +1,222 @@
+#include "network_interface.hh"
+#include "tcp_config.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+constexpr EthernetAddress our_ethernet { 0x02, 0, 0, 0, 0, 0x01 };
+constexpr uint32_t our_ip = 0x0a000001; // 10.0.0.1
+
+EthernetAddress neighbor_ethernet( uint32_t n )
+{
+  return { 0x02, 0x01, static_cast<uint8_t>( n >> 24 ), static_cast<uint8_t>( n >> 16 ), // NOLINT(*-bitwise)
+           static_cast<uint8_t>( n >> 8 ), static_cast<uint8_t>( n ) };                  // NOLINT(*-bitwise)
+}
+
+uint32_t neighbor_ip( uint32_t n )
+{
+  return 0x0b000000 + n;
+}
+
+// A NetworkInterface whose frames are kept to be checked
+struct Harness
+{
+  vector<Buffer> sent {};
+  NetworkInterface interface;
+
+  explicit Harness( const NetworkInterfaceConfig& config = {} )
+    : interface( our_ethernet, our_ip, [this]( const Buffer& frame ) { sent.push_back( frame ); }, config )
+  {}
+
+  vector<Buffer> take()
+  {
+    vector<Buffer> frames = move( sent );
+    sent.clear();
+    return frames;
+  }
+};
+
+Buffer datagram( const string& contents )
+{
+  return Buffer::with_headroom( TCPConfig::HEADROOM, contents );
+}
+
+Buffer arp_frame( uint16_t opcode, uint32_t n, uint32_t target_ip, const EthernetAddress& destination )
+{
+  return serialize_arp_frame( destination,
+                              neighbor_ethernet( n ),
+                              { opcode, neighbor_ethernet( n ), neighbor_ip( n ), {}, target_ip } );
+}
+
+void expect_arp( const Buffer& frame, uint16_t opcode, const EthernetAddress& destination, uint32_t target_ip )
+{
+  const EthernetHeaderView header { frame };
+  test_should_be( header.destination() == destination, true );
+  test_should_be( header.source() == our_ethernet, true );
+  test_should_be( header.type(), EthernetHeaderView::TYPE_ARP );
+  const optional<ARPMessage> arp = parse_arp( string_view { frame }.substr( EthernetHeaderView::LENGTH ) );
+  test_should_be( arp.has_value(), true );
+  test_should_be( arp->opcode, opcode );
+  test_should_be( arp->sender_ethernet_address == our_ethernet, true );
+  test_should_be( arp->sender_ip_address, our_ip );
+  test_should_be( arp->target_ip_address, target_ip );
+}
+
+void expect_ipv4( const Buffer& frame, const EthernetAddress& destination, const string& contents )
+{
+  const EthernetHeaderView header { frame };
+  test_should_be( header.destination() == destination, true );
+  test_should_be( header.source() == our_ethernet, true );
+  test_should_be( header.type(), EthernetHeaderView::TYPE_IPv4 );
+  test_should_be( string_view { frame }.substr( EthernetHeaderView::LENGTH ) == contents, true );
+}
+
+// One request for an unknown address however many datagrams wait for it; all go out, in order, on the reply
+void test_resolution()
+{
+  Harness h;
+  const Buffer first = datagram( "first" );
+  h.interface.send_datagram( first, neighbor_ip( 1 ) );
+  h.interface.tick( 100 );
+  h.interface.send_datagram( datagram( "second" ), neighbor_ip( 1 ) );
+  vector<Buffer> frames = h.take();
+  test_should_be( frames.size(), size_t { 1 } );
+  expect_arp( frames[0], ARPMessage::OPCODE_REQUEST, ETHERNET_BROADCAST, neighbor_ip( 1 ) );
+  test_should_be( h.interface.lookup( neighbor_ip( 1 ) ).has_value(), false );
+
+  test_should_be( h.interface.recv_frame( arp_frame( ARPMessage::OPCODE_REPLY, 1, our_ip, our_ethernet ) )
+                    .has_value(),
+                  false );
+  frames = h.take();
+  test_should_be( frames.size(), size_t { 2 } );
+  expect_ipv4( frames[0], neighbor_ethernet( 1 ), "first" );
+  expect_ipv4( frames[1], neighbor_ethernet( 1 ), "second" );
+  test_should_be( h.interface.lookup( neighbor_ip( 1 ) ) == neighbor_ethernet( 1 ), true );
+
+  // the header went into the datagram's headroom: the frame shares its storage
+  test_should_be( string_view { frames[0] }.data() + EthernetHeaderView::LENGTH == string_view { first }.data(),
+                  true );
+
+  // later datagrams go straight out, until the mapping expires
+  h.interface.tick( 29999 );
+  h.interface.send_datagram( datagram( "third" ), neighbor_ip( 1 ) );
+  frames = h.take();
+  test_should_be( frames.size(), size_t { 1 } );
+  expect_ipv4( frames[0], neighbor_ethernet( 1 ), "third" );
+  h.interface.tick( 1 );
+  h.interface.send_datagram( datagram( "fourth" ), neighbor_ip( 1 ) );
+  frames = h.take();
+  test_should_be( frames.size(), size_t { 1 } );
+  expect_arp( frames[0], ARPMessage::OPCODE_REQUEST, ETHERNET_BROADCAST, neighbor_ip( 1 ) );
+  test_should_be( h.interface.dropped(), uint64_t { 0 } );
+}
+
+// An unanswered request drops what waits for it; the next datagram asks again
+void test_timeout()
+{
+  Harness h;
+  h.interface.send_datagram( datagram( "lost" ), neighbor_ip( 2 ) );
+  h.interface.tick( 4999 );
+  h.interface.send_datagram( datagram( "also lost" ), neighbor_ip( 2 ) );
+  test_should_be( h.take().size(), size_t { 1 } );
+
+  h.interface.tick( 1 );
+  h.interface.send_datagram( datagram( "found" ), neighbor_ip( 2 ) );
+  test_should_be( h.interface.dropped(), uint64_t { 2 } );
+  test_should_be( h.interface.neighbors(), size_t { 1 } );
+  vector<Buffer> frames = h.take();
+  test_should_be( frames.size(), size_t { 1 } );
+  expect_arp( frames[0], ARPMessage::OPCODE_REQUEST, ETHERNET_BROADCAST, neighbor_ip( 2 ) );
+
+  h.interface.recv_frame( arp_frame( ARPMessage::OPCODE_REPLY, 2, our_ip, our_ethernet ) );
+  frames = h.take();
+  test_should_be( frames.size(), size_t { 1 } );
+  expect_ipv4( frames[0], neighbor_ethernet( 2 ), "found" );
+}
+
+// Requests for our address are answered and learned from; others are learned from only if already cached
+void test_receive()
+{
+  Harness h;
+  h.interface.recv_frame( arp_frame( ARPMessage::OPCODE_REQUEST, 3, our_ip, ETHERNET_BROADCAST ) );
+  vector<Buffer> frames = h.take();
+  test_should_be( frames.size(), size_t { 1 } );
+  expect_arp( frames[0], ARPMessage::OPCODE_REPLY, neighbor_ethernet( 3 ), neighbor_ip( 3 ) );
+  test_should_be( h.interface.lookup( neighbor_ip( 3 ) ) == neighbor_ethernet( 3 ), true );
+
+  h.interface.recv_frame( arp_frame( ARPMessage::OPCODE_REQUEST, 4, our_ip + 1, ETHERNET_BROADCAST ) );
+  test_should_be( h.take().empty(), true );
+  test_should_be( h.interface.lookup( neighbor_ip( 4 ) ).has_value(), false );
+
+  // IPv4 frames for us (or broadcast) give up their datagram, in place; others are ignored
+  const Buffer frame = serialize_ethernet_frame(
+    our_ethernet, neighbor_ethernet( 3 ), EthernetHeaderView::TYPE_IPv4, datagram( "hi" ) );
+  const optional<Buffer> received = h.interface.recv_frame( frame );
+  test_should_be( received.has_value(), true );
+  test_should_be( string_view { *received } == "hi", true );
+  test_should_be( string_view { *received }.data() == string_view { frame }.data() + EthernetHeaderView::LENGTH,
+                  true );
+  const Buffer elsewhere = serialize_ethernet_frame(
+    neighbor_ethernet( 4 ), neighbor_ethernet( 3 ), EthernetHeaderView::TYPE_IPv4, datagram( "hi" ) );
+  test_should_be( h.interface.recv_frame( elsewhere ).has_value(), false );
+}
+
+// Tens of thousands of neighbors, with entries expiring and being replaced in between
+void test_many_neighbors()
+{
+  constexpr uint32_t count = 50000;
+  Harness h { { .max_neighbors = count } };
+  for ( uint32_t n = 0; n < count; ++n ) {
+    h.interface.recv_frame( arp_frame( ARPMessage::OPCODE_REQUEST, n, our_ip, ETHERNET_BROADCAST ) );
+  }
+  test_should_be( h.interface.neighbors(), size_t { count } );
+
+  // full: an unknown address can't be asked for
+  h.take();
+  h.interface.send_datagram( datagram( "nowhere" ), neighbor_ip( count ) );
+  test_should_be( h.take().empty(), true );
+  test_should_be( h.interface.dropped(), uint64_t { 1 } );
+
+  // after half the mappings have been refreshed, the other half expire and are swept
+  h.interface.tick( 15000 );
+  for ( uint32_t n = 0; n < count; n += 2 ) {
+    h.interface.recv_frame( arp_frame( ARPMessage::OPCODE_REPLY, n, our_ip, our_ethernet ) );
+  }
+  for ( uint64_t ms = 0; ms < 15000 + 1000; ms += 10 ) {
+    h.interface.tick( 10 );
+  }
+  test_should_be( h.interface.neighbors(), size_t { count / 2 } );
+  for ( uint32_t n = 0; n < count; ++n ) {
+    const optional<EthernetAddress> found = h.interface.lookup( neighbor_ip( n ) );
+    test_should_be( found.has_value(), n % 2 == 0 );
+    if ( found.has_value() ) {
+      test_should_be( *found == neighbor_ethernet( n ), true );
+    }
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    test_resolution();
+    test_timeout();
+    test_receive();
+    test_many_neighbors();
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
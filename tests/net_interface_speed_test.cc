@@ -0,0 +1,96 @@
+#include "network_interface.hh"
+#include "tcp_config.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// With `neighbors` addresses resolved, send `count` datagrams to next hops chosen at random, and report the
+// rate of frames sent.
+void speed_test( const uint32_t neighbors, const size_t count, const size_t random_seed )
+{
+  constexpr EthernetAddress our_ethernet { 0x02, 0, 0, 0, 0, 0x01 };
+  constexpr uint32_t our_ip = 0x0a000001;
+  constexpr uint32_t first_neighbor = 0x0b000000;
+
+  size_t frames = 0;
+  size_t bytes = 0;
+  NetworkInterface interface { our_ethernet,
+                               our_ip,
+                               [&]( const Buffer& frame ) {
+                                 ++frames;
+                                 bytes += frame.size();
+                               },
+                               { .max_neighbors = neighbors } };
+  for ( uint32_t n = 0; n < neighbors; ++n ) {
+    const EthernetAddress ethernet { 0x02, 0x01, 0, 0, static_cast<uint8_t>( n >> 8 ), static_cast<uint8_t>( n ) };
+    interface.recv_frame( serialize_arp_frame(
+      our_ethernet,
+      ethernet,
+      { ARPMessage::OPCODE_REQUEST, ethernet, first_neighbor + n, EthernetAddress {}, our_ip } ) );
+  }
+
+  // the next hops, and datagrams with headroom for their Ethernet headers (made fresh for each round, outside
+  // the timing: a datagram's headroom goes to the first frame sent from it)
+  constexpr size_t round_size = 4096;
+  const string payload( 1480, 'x' );
+  vector<Buffer> datagrams( round_size );
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<uint32_t> pick { 0, neighbors - 1 };
+  vector<uint32_t> next_hops;
+  next_hops.reserve( count );
+  for ( size_t i = 0; i < count; ++i ) {
+    next_hops.push_back( first_neighbor + pick( rd ) );
+  }
+
+  frames = bytes = 0;
+  steady_clock::duration elapsed {};
+  for ( size_t round = 0; round < count; round += round_size ) {
+    const size_t sends = min( round_size, count - round );
+    for ( size_t i = 0; i < sends; ++i ) {
+      datagrams[i] = Buffer::with_headroom( TCPConfig::HEADROOM, payload );
+    }
+    const auto start_time = steady_clock::now();
+    for ( size_t i = 0; i < sends; ++i ) {
+      interface.send_datagram( move( datagrams[i] ), next_hops[round + i] );
+    }
+    elapsed += steady_clock::now() - start_time;
+  }
+
+  if ( frames != count or bytes != count * ( payload.size() + EthernetHeaderView::LENGTH ) ) {
+    throw runtime_error( "NetworkInterface did not send every datagram at once" );
+  }
+
+  const auto test_duration = duration_cast<duration<double>>( elapsed );
+  cout << "NetworkInterface with " << setw( 5 ) << neighbors << " neighbors sent " << fixed << setprecision( 2 )
+       << static_cast<double>( count ) / test_duration.count() / 1e6 << " M frames/s.\n";
+}
+
+void program_body()
+{
+  for ( const uint32_t neighbors : { 16, 1024, 60000 } ) {
+    speed_test( neighbors, 1 << 20, 1729 );
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
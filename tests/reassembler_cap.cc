@@ -0,0 +1,96 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ReassemblerTestHarness test { "all within capacity", 2 };
+
+      test.execute( Insert { "ab", 0 } );
+      test.execute( BytesPushed( 2 ) );
+      test.execute( ReadAll( "ab" ) );
+
+      test.execute( Insert { "cd", 2 } );
+      test.execute( BytesPushed( 4 ) );
+      test.execute( ReadAll( "cd" ) );
+
+      test.execute( Insert { "ef", 4 } );
+      test.execute( BytesPushed( 6 ) );
+      test.execute( ReadAll( "ef" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "insert beyond capacity", 2 };
+
+      test.execute( Insert { "ab", 0 } );
+      test.execute( BytesPushed( 2 ) );
+
+      test.execute( Insert { "cd", 2 } );
+      test.execute( BytesPushed( 2 ) );
+      test.execute( BytesPending( 0 ) );
+
+      test.execute( ReadAll( "ab" ) );
+      test.execute( BytesPushed( 2 ) );
+
+      test.execute( Insert { "cd", 2 } );
+      test.execute( BytesPushed( 4 ) );
+      test.execute( ReadAll( "cd" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "overflow", 2 };
+
+      test.execute( Insert { "bX", 1 } );
+      test.execute( BytesPending( 1 ) );
+      test.execute( Insert { "a", 0 } );
+
+      test.execute( BytesPushed( 2 ) );
+      test.execute( BytesPending( 0 ) );
+      test.execute( ReadAll( "ab" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "last substring beyond capacity", 3 };
+
+      test.execute( Insert { "bcd", 1 }.is_last() );
+      test.execute( BytesPending( 2 ) );
+      test.execute( Insert { "a", 0 } );
+      test.execute( BytesPushed( 3 ) );
+      test.execute( IsClosed { false } );
+      test.execute( ReadAll( "abc" ) );
+
+      test.execute( Insert { "bcd", 1 }.is_last() );
+      test.execute( BytesPushed( 4 ) );
+      test.execute( ReadAll( "d" ) );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ReassemblerTestHarness test { "pending bytes stay within available capacity", 8 };
+
+      test.execute( Insert { "abc", 0 } );
+      test.execute( AvailableCapacity( 5 ) );
+
+      // only indices 3 through 7 fit
+      test.execute( Insert { "efghijkl", 4 } );
+      test.execute( BytesPending( 4 ) );
+      test.execute( Insert { "zzzzzzzzzzzz", 9 } );
+      test.execute( BytesPending( 4 ) );
+
+      test.execute( Insert { "d", 3 } );
+      test.execute( BytesPushed( 8 ) );
+      test.execute( BytesPending( 0 ) );
+      test.execute( ReadAll( "abcdefgh" ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+#include "random.hh"
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      ReassemblerTestHarness test { "dup 1", 65000 };
+
+      test.execute( Insert { "abcd", 0 } );
+      test.execute( BytesPushed( 4 ) );
+      test.execute( ReadAll( "abcd" ) );
+      test.execute( IsFinished { false } );
+
+      test.execute( Insert { "abcd", 0 } );
+      test.execute( BytesPushed( 4 ) );
+      test.execute( ReadAll( "" ) );
+      test.execute( IsFinished { false } );
+    }
+
+    {
+      ReassemblerTestHarness test { "dup 2", 65000 };
+
+      test.execute( Insert { "abcd", 0 } );
+      test.execute( BytesPushed( 4 ) );
+      test.execute( ReadAll( "abcd" ) );
+      test.execute( IsFinished { false } );
+
+      test.execute( Insert { "abcd", 4 } );
+      test.execute( BytesPushed( 8 ) );
+      test.execute( ReadAll( "abcd" ) );
+      test.execute( IsFinished { false } );
+
+      test.execute( Insert { "abcd", 0 } );
+      test.execute( BytesPushed( 8 ) );
+      test.execute( ReadAll( "" ) );
+      test.execute( IsFinished { false } );
+
+      test.execute( Insert { "abcd", 4 } );
+      test.execute( BytesPushed( 8 ) );
+      test.execute( ReadAll( "" ) );
+      test.execute( IsFinished { false } );
+    }
+
+    {
+      ReassemblerTestHarness test { "dup 3 (random substrings of what was already written)", 65000 };
+
+      test.execute( Insert { "abcdefgh", 0 } );
+      test.execute( BytesPushed( 8 ) );
+      test.execute( ReadAll( "abcdefgh" ) );
+      test.execute( IsFinished { false } );
+      const string data = "abcdefgh";
+
+      for ( size_t i = 0; i < 1000; ++i ) {
+        const size_t start_i = uniform_int_distribution<size_t> { 0, 8 }( rd );
+        const size_t end_i = uniform_int_distribution<size_t> { start_i, 8 }( rd );
+        test.execute( Insert { data.substr( start_i, end_i - start_i ), start_i } );
+        test.execute( BytesPushed( 8 ) );
+        test.execute( ReadAll( "" ) );
+        test.execute( IsFinished { false } );
+      }
+    }
+
+    {
+      ReassemblerTestHarness test { "dup 4 (pending pieces inserted again)", 65000 };
+
+      test.execute( Insert { "cd", 2 } );
+      test.execute( Insert { "gh", 6 } );
+      test.execute( BytesPending( 4 ) );
+
+      test.execute( Insert { "cd", 2 } );
+      test.execute( Insert { "gh", 6 } );
+      test.execute( Insert { "d", 3 } );
+      test.execute( Insert { "g", 6 } );
+      test.execute( BytesPending( 4 ) );
+
+      test.execute( Insert { "abcdefgh", 0 } );
+      test.execute( BytesPending( 0 ) );
+      test.execute( BytesPushed( 8 ) );
+      test.execute( ReadAll( "abcdefgh" ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
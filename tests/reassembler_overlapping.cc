@@ -0,0 +1,142 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ReassemblerTestHarness test { "overlapping assembled (unread) section", 1000 };
+
+      test.execute( Insert { "a", 0 } );
+      test.execute( Insert { "ab", 0 } );
+
+      test.execute( BytesPushed( 2 ) );
+      test.execute( ReadAll( "ab" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "overlapping assembled (read) section", 1000 };
+
+      test.execute( Insert { "a", 0 } );
+      test.execute( ReadAll( "a" ) );
+
+      test.execute( Insert { "ab", 0 } );
+      test.execute( ReadAll( "b" ) );
+      test.execute( BytesPushed( 2 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "overlapping unassembled section, resulting in assembly", 1000 };
+
+      test.execute( Insert { "b", 1 } );
+      test.execute( ReadAll( "" ) );
+
+      test.execute( Insert { "ab", 0 } );
+      test.execute( ReadAll( "ab" ) );
+      test.execute( BytesPending( 0 ) );
+      test.execute( BytesPushed( 2 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "overlapping unassembled section, not resulting in assembly", 1000 };
+
+      test.execute( Insert { "b", 1 } );
+      test.execute( ReadAll( "" ) );
+
+      test.execute( Insert { "bc", 1 } );
+      test.execute( ReadAll( "" ) );
+      test.execute( BytesPending( 2 ) );
+      test.execute( BytesPushed( 0 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "overlapping unassembled section, not resulting in assembly", 1000 };
+
+      test.execute( Insert { "c", 2 } );
+      test.execute( ReadAll( "" ) );
+
+      test.execute( Insert { "bcd", 1 } );
+      test.execute( ReadAll( "" ) );
+      test.execute( BytesPending( 3 ) );
+      test.execute( BytesPushed( 0 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "overlapping multiple unassembled sections", 1000 };
+
+      test.execute( Insert { "b", 1 } );
+      test.execute( Insert { "d", 3 } );
+      test.execute( ReadAll( "" ) );
+
+      test.execute( Insert { "bcde", 1 } );
+      test.execute( ReadAll( "" ) );
+      test.execute( BytesPushed( 0 ) );
+      test.execute( BytesPending( 4 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "insert over existing section", 1000 };
+
+      test.execute( Insert { "c", 2 } );
+      test.execute( Insert { "bcd", 1 } );
+
+      test.execute( ReadAll( "" ) );
+      test.execute( BytesPushed( 0 ) );
+      test.execute( BytesPending( 3 ) );
+
+      test.execute( Insert { "a", 0 } );
+      test.execute( ReadAll( "abcd" ) );
+      test.execute( BytesPushed( 4 ) );
+      test.execute( BytesPending( 0 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "insert within existing section", 1000 };
+
+      test.execute( Insert { "bcd", 1 } );
+      test.execute( Insert { "c", 2 } );
+
+      test.execute( ReadAll( "" ) );
+      test.execute( BytesPushed( 0 ) );
+      test.execute( BytesPending( 3 ) );
+
+      test.execute( Insert { "a", 0 } );
+      test.execute( ReadAll( "abcd" ) );
+      test.execute( BytesPushed( 4 ) );
+      test.execute( BytesPending( 0 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "bridging two pending sections", 1000 };
+
+      test.execute( Insert { "bc", 1 } );
+      test.execute( Insert { "fg", 5 } );
+      test.execute( Insert { "cdef", 2 } );
+      test.execute( BytesPending( 6 ) );
+
+      test.execute( Insert { "ab", 0 } );
+      test.execute( ReadAll( "abcdefg" ) );
+      test.execute( BytesPending( 0 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "assembling partly overlaps a pending section", 1000 };
+
+      test.execute( Insert { "cdef", 2 } );
+      test.execute( Insert { "abcd", 0 } );
+
+      test.execute( ReadAll( "abcdef" ) );
+      test.execute( BytesPushed( 6 ) );
+      test.execute( BytesPending( 0 ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
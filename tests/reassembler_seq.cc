@@ -0,0 +1,104 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+// Inserting a Buffer hands its bytes to the stream by reference
+struct InsertBufferInPlace : public Action<Reassembler>
+{
+  uint64_t first_index_;
+  size_t size_;
+
+  InsertBufferInPlace( uint64_t first_index, size_t size ) : first_index_( first_index ), size_( size ) {}
+
+  std::string description() const override
+  {
+    return "insert a Buffer of " + to_string( size_ ) + " bytes @ index " + to_string( first_index_ )
+           + ", and expect to peek at those same bytes";
+  }
+
+  void execute( Reassembler& r ) const override
+  {
+    const Buffer data { string( size_, 'x' ) };
+    const char* const bytes = string_view { data }.data();
+    r.insert( first_index_, data, false );
+    if ( r.reader().peek().data() != bytes ) {
+      throw ExpectationViolation { "Reassembler copied a Buffer instead of pushing it into the stream" };
+    }
+    r.reader().pop( size_ );
+  }
+};
+
+int main()
+{
+  try {
+    {
+      ReassemblerTestHarness test { "seq 1", 65000 };
+
+      test.execute( Insert { "abcd", 0 } );
+      test.execute( BytesPushed( 4 ) );
+      test.execute( ReadAll( "abcd" ) );
+      test.execute( IsFinished { false } );
+
+      test.execute( Insert { "efgh", 4 } );
+      test.execute( BytesPushed( 8 ) );
+      test.execute( ReadAll( "efgh" ) );
+      test.execute( IsFinished { false } );
+    }
+
+    {
+      ReassemblerTestHarness test { "seq 2", 65000 };
+
+      test.execute( Insert { "abcd", 0 } );
+      test.execute( BytesPushed( 4 ) );
+      test.execute( IsFinished { false } );
+      test.execute( Insert { "efgh", 4 } );
+      test.execute( BytesPushed( 8 ) );
+      test.execute( ReadAll( "abcdefgh" ) );
+      test.execute( IsFinished { false } );
+    }
+
+    {
+      ReassemblerTestHarness test { "seq 3", 65000 };
+      std::ostringstream ss;
+
+      for ( size_t i = 0; i < 100; ++i ) {
+        test.execute( BytesPushed( 4 * i ) );
+        test.execute( Insert { "abcd", 4 * i } );
+        test.execute( IsFinished { false } );
+
+        ss << "abcd";
+      }
+
+      test.execute( ReadAll( ss.str() ) );
+      test.execute( IsFinished { false } );
+    }
+
+    {
+      ReassemblerTestHarness test { "seq 4", 65000 };
+      for ( size_t i = 0; i < 100; ++i ) {
+        test.execute( BytesPushed( 4 * i ) );
+        test.execute( Insert { "abcd", 4 * i } );
+        test.execute( IsFinished { false } );
+        test.execute( ReadAll( "abcd" ) );
+      }
+    }
+
+    {
+      ReassemblerTestHarness test { "in-order Buffers are not copied", 65000 };
+      test.execute( InsertBufferInPlace { 0, 1000 } );
+      test.execute( InsertBufferInPlace { 1000, 1 } );
+      test.execute( InsertBufferInPlace { 1001, 5000 } );
+      test.execute( BytesPushed( 6001 ) );
+      test.execute( BytesPending( 0 ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
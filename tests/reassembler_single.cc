@@ -0,0 +1,86 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ReassemblerTestHarness test { "construction", 65000 };
+
+      test.execute( BytesPushed( 0 ) );
+      test.execute( ReadAll( "" ) );
+      test.execute( IsFinished { false } );
+      test.execute( BytesPending( 0 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "insert a", 65000 };
+
+      test.execute( Insert { "a", 0 } );
+
+      test.execute( BytesPushed( 1 ) );
+      test.execute( ReadAll( "a" ) );
+      test.execute( IsFinished { false } );
+      test.execute( BytesPending( 0 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "insert a (last)", 65000 };
+
+      test.execute( Insert { "a", 0 }.is_last() );
+
+      test.execute( BytesPushed( 1 ) );
+      test.execute( ReadAll( "a" ) );
+      test.execute( IsFinished { true } );
+      test.execute( BytesPending( 0 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "empty stream", 65000 };
+
+      test.execute( Insert { "", 0 }.is_last() );
+
+      test.execute( BytesPushed( 0 ) );
+      test.execute( ReadAll( "" ) );
+      test.execute( IsFinished { true } );
+      test.execute( BytesPending( 0 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "empty substring then data", 65000 };
+
+      test.execute( Insert { "", 0 } );
+      test.execute( IsClosed { false } );
+      test.execute( Insert { "b", 0 }.is_last() );
+
+      test.execute( BytesPushed( 1 ) );
+      test.execute( ReadAll( "b" ) );
+      test.execute( IsFinished { true } );
+      test.execute( BytesPending( 0 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "last substring arrives first", 65000 };
+
+      test.execute( Insert { "c", 2 }.is_last() );
+      test.execute( BytesPushed( 0 ) );
+      test.execute( BytesPending( 1 ) );
+      test.execute( IsClosed { false } );
+
+      test.execute( Insert { "ab", 0 } );
+      test.execute( BytesPushed( 3 ) );
+      test.execute( BytesPending( 0 ) );
+      test.execute( ReadAll( "abc" ) );
+      test.execute( IsFinished { true } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+#include "reassembler.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+struct Segment
+{
+  uint64_t first_index {};
+  Buffer data {};
+  bool is_last {};
+};
+
+// Deliver `input_len` bytes in `segment_size` pieces, shuffled within windows of `reorder_window` segments,
+// with every `dup_every`th segment arriving a second time
+void speed_test( const size_t input_len,      // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t segment_size,   // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t reorder_window, // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t dup_every,      // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t random_seed )   // NOLINT(bugprone-easily-swappable-parameters)
+{
+  default_random_engine rd { random_seed };
+
+  // Generate the data to be written
+  string data( input_len, 0 );
+  generate( data.begin(), data.end(), [&] { return rd(); } );
+
+  // Split it into segments, and scramble their order
+  vector<Segment> segments;
+  for ( size_t i = 0; i < data.size(); i += segment_size ) {
+    segments.push_back( { i, Buffer { data.substr( i, segment_size ) }, i + segment_size >= data.size() } );
+    if ( segments.size() % dup_every == 0 ) {
+      segments.push_back( segments.back() );
+    }
+  }
+  for ( size_t i = 0; i < segments.size(); i += reorder_window ) {
+    shuffle( segments.begin() + static_cast<ptrdiff_t>( i ),
+             segments.begin() + static_cast<ptrdiff_t>( min( i + reorder_window, segments.size() ) ),
+             rd );
+  }
+
+  Reassembler reassembler { ByteStream { 2 * reorder_window * segment_size } };
+  string output_data;
+  output_data.reserve( data.size() );
+
+  const auto start_time = steady_clock::now();
+  for ( const auto& seg : segments ) {
+    reassembler.insert( seg.first_index, seg.data, seg.is_last );
+    Reader& reader = reassembler.reader();
+    while ( reader.bytes_buffered() ) {
+      const auto peeked = reader.peek();
+      output_data += peeked;
+      reader.pop( peeked.size() );
+    }
+  }
+  const auto stop_time = steady_clock::now();
+
+  if ( not reassembler.reader().is_finished() ) {
+    throw runtime_error( "Reassembler did not close the stream" );
+  }
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+
+  const auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  const auto gigabits_per_second = static_cast<double>( data.size() ) * 8.0 / test_duration.count() / 1e9;
+
+  cout << fixed << setprecision( 2 );
+  cout << "Reassembler with segment_size=" << segment_size << ", reorder_window=" << reorder_window
+       << " reached " << gigabits_per_second << " Gbit/s.\n";
+}
+
+void program_body()
+{
+  speed_test( 1 << 26, 1460, 1, 1 << 30, 789 );
+  speed_test( 1 << 26, 1460, 64, 20, 789 );
+  speed_test( 1 << 26, 1460, 4096, 20, 789 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "byte_stream_test_harness.hh"
+#include "reassembler.hh"
+
+#include <sstream>
+#include <utility>
+
+// Run a ByteStream test step against a Reassembler's output stream
+struct ReassemblerStreamStep : public TestStep<Reassembler>
+{
+  const TestStep<ByteStream>& step_;
+
+  explicit ReassemblerStreamStep( const TestStep<ByteStream>& step ) : step_( step ) {}
+  std::string str() const override { return step_.str(); }
+  uint8_t color() const override { return step_.color(); }
+  void execute( Reassembler& r ) const override { step_.execute( r.reader() ); }
+};
+
+class ReassemblerTestHarness : public TestHarness<Reassembler>
+{
+public:
+  ReassemblerTestHarness( std::string test_name, uint64_t capacity )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity ),
+                   Reassembler { ByteStream { capacity } } )
+  {}
+
+  uint64_t bytes_pushed() const { return object().writer().bytes_pushed(); }
+  uint64_t bytes_held() const { return object().reader().bytes_buffered() + object().bytes_pending(); }
+
+  using TestHarness::execute;
+  void execute( const TestStep<ByteStream>& step ) { execute( ReassemblerStreamStep { step } ); }
+};
+
+/* actions */
+
+struct Insert : public Action<Reassembler>
+{
+  std::string data_;
+  uint64_t first_index_;
+  bool is_last_substring_ {};
+
+  Insert( std::string data, uint64_t first_index ) : data_( move( data ) ), first_index_( first_index ) {}
+
+  Insert& is_last( bool status = true )
+  {
+    is_last_substring_ = status;
+    return *this;
+  }
+
+  std::string description() const override
+  {
+    std::ostringstream ss;
+    ss << "insert \"" << Printer::prettify( data_ ) << "\" @ index " << first_index_;
+    if ( is_last_substring_ ) {
+      ss << " [last substring]";
+    }
+    return ss.str();
+  }
+
+  void execute( Reassembler& r ) const override { r.insert( first_index_, data_, is_last_substring_ ); }
+};
+
+/* expectations */
+
+struct BytesPending : public ExpectNumber<Reassembler, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "bytes_pending"; }
+  uint64_t value( Reassembler& r ) const override { return r.bytes_pending(); }
+};
@@ -0,0 +1,81 @@
+#include "random.hh"
+#include "reassembler_test_harness.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <tuple>
+
+using namespace std;
+
+static constexpr size_t NREPS = 32;
+static constexpr size_t NSEGS = 128;
+static constexpr size_t MAX_SEG_LEN = 2048;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    // overlapping segments, shuffled
+    for ( unsigned rep_no = 0; rep_no < NREPS; ++rep_no ) {
+      ReassemblerTestHarness sr { "win test " + to_string( rep_no ), NSEGS * MAX_SEG_LEN };
+
+      vector<tuple<size_t, size_t>> seq_size;
+      size_t offset { 0 };
+      for ( unsigned i = 0; i < NSEGS; ++i ) {
+        const size_t size { 1 + ( rd() % ( MAX_SEG_LEN - 1 ) ) };
+        const size_t offs { min( offset, 1 + ( static_cast<size_t>( rd() ) % 1023 ) ) };
+        seq_size.emplace_back( offset - offs, size + offs );
+        offset += size;
+      }
+      shuffle( seq_size.begin(), seq_size.end(), rd );
+
+      string d( offset, 0 );
+      generate( d.begin(), d.end(), [&] { return rd(); } );
+
+      for ( auto [off, sz] : seq_size ) {
+        sr.execute( Insert { d.substr( off, sz ), off }.is_last( off + sz == offset ) );
+      }
+
+      sr.execute( ReadAll { d } );
+      sr.execute( BytesPending( 0 ) );
+      sr.execute( IsFinished { true } );
+    }
+
+    // a small capacity, with segments arriving out of order and dropped when they don't fit
+    for ( unsigned rep_no = 0; rep_no < NREPS / 4; ++rep_no ) {
+      const size_t capacity = 4096;
+      ReassemblerTestHarness sr { "small-window test " + to_string( rep_no ), capacity };
+
+      string d( NSEGS * MAX_SEG_LEN / 8, 0 );
+      generate( d.begin(), d.end(), [&] { return rd(); } );
+
+      string got;
+      while ( got.size() < d.size() ) {
+        const size_t first = sr.bytes_pushed();
+        const size_t start = first + rd() % ( 2 * capacity );
+        const size_t size = min<size_t>( 1 + rd() % 1500, d.size() - min( start, d.size() ) );
+        if ( start < d.size() ) {
+          sr.execute( Insert { d.substr( start, size ), start }.is_last( start + size == d.size() ) );
+        }
+        if ( rd() % 8 == 0 ) {
+          sr.execute( Insert { d.substr( first, 1 ), first }.is_last( first + 1 == d.size() ) );
+        }
+        if ( sr.bytes_held() > capacity ) {
+          throw runtime_error( "Reassembler holds more than the stream's capacity" );
+        }
+        const size_t n = sr.bytes_pushed() - got.size();
+        sr.execute( ReadAll { d.substr( got.size(), n ) } );
+        got += d.substr( got.size(), n );
+      }
+      sr.execute( IsFinished { true } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
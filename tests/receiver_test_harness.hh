@@ -0,0 +1,212 @@
+#pragma once
+
+#include "reassembler_test_harness.hh"
+#include "tcp_receiver.hh"
+
+#include <algorithm>
+#include <optional>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+// Run a ByteStream test step against a TCPReceiver's output stream
+struct ReceiverStreamStep : public TestStep<TCPReceiver>
+{
+  const TestStep<ByteStream>& step_;
+
+  explicit ReceiverStreamStep( const TestStep<ByteStream>& step ) : step_( step ) {}
+  std::string str() const override { return step_.str(); }
+  uint8_t color() const override { return step_.color(); }
+  void execute( TCPReceiver& r ) const override { step_.execute( r.reader() ); }
+};
+
+class TCPReceiverTestHarness : public TestHarness<TCPReceiver>
+{
+public:
+  TCPReceiverTestHarness( std::string test_name, uint64_t capacity, const TCPConfig& config = {} )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity ) + ", ack_delay=" + std::to_string( config.ack_delay ),
+                   TCPReceiver { Reassembler { ByteStream { capacity } }, config } )
+  {}
+
+  bool ack_due() const { return object().ack_due(); }
+
+  using TestHarness::execute;
+  void execute( const TestStep<ByteStream>& step ) { execute( ReceiverStreamStep { step } ); }
+};
+
+/* actions */
+
+struct SegmentArrives : public Action<TCPReceiver>
+{
+  TCPSenderMessage msg_ {};
+
+  SegmentArrives& with_syn()
+  {
+    msg_.SYN = true;
+    return *this;
+  }
+
+  SegmentArrives& with_fin()
+  {
+    msg_.FIN = true;
+    return *this;
+  }
+
+  SegmentArrives& with_seqno( Wrap32 seqno )
+  {
+    msg_.seqno = seqno;
+    return *this;
+  }
+
+  SegmentArrives& with_seqno( uint32_t seqno ) { return with_seqno( Wrap32 { seqno } ); }
+
+  SegmentArrives& with_data( std::string data )
+  {
+    msg_.payload = std::move( data );
+    return *this;
+  }
+
+  SegmentArrives& with_window_scale( uint8_t shift )
+  {
+    msg_.window_scale = shift;
+    return *this;
+  }
+
+  SegmentArrives& with_mss( uint16_t size )
+  {
+    msg_.MSS = size;
+    return *this;
+  }
+
+  SegmentArrives& with_timestamp( uint32_t timestamp )
+  {
+    msg_.timestamp = timestamp;
+    return *this;
+  }
+
+  SegmentArrives& with_sack_permitted()
+  {
+    msg_.SACK_permitted = true;
+    return *this;
+  }
+
+  std::string description() const override
+  {
+    std::ostringstream ss;
+    ss << "receive segment (" << ( msg_.SYN ? "SYN " : "" ) << "seqno=" << msg_.seqno.raw_value();
+    if ( msg_.payload.size() ) {
+      ss << ", payload=\"" << Printer::prettify( msg_.payload ) << "\"";
+    }
+    if ( msg_.window_scale.has_value() ) {
+      ss << ", window_scale=" << unsigned { *msg_.window_scale };
+    }
+    if ( msg_.MSS.has_value() ) {
+      ss << ", MSS=" << *msg_.MSS;
+    }
+    if ( msg_.timestamp.has_value() ) {
+      ss << ", TSval=" << *msg_.timestamp;
+    }
+    ss << ( msg_.FIN ? " FIN" : "" ) << ")";
+    return ss.str();
+  }
+
+  void execute( TCPReceiver& r ) const override { r.receive( msg_ ); }
+};
+
+struct Tick : public Action<TCPReceiver>
+{
+  uint64_t ms_;
+
+  explicit Tick( uint64_t ms ) : ms_( ms ) {}
+  std::string description() const override { return "tick " + std::to_string( ms_ ) + " ms"; }
+  void execute( TCPReceiver& r ) const override { r.tick( ms_ ); }
+};
+
+struct AckSent : public Action<TCPReceiver>
+{
+  std::string description() const override { return "ACK sent"; }
+  void execute( TCPReceiver& r ) const override { r.ack_sent(); }
+};
+
+/* expectations */
+
+struct ExpectAckno : public ExpectNumber<TCPReceiver, std::optional<Wrap32>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "ackno"; }
+  std::optional<Wrap32> value( TCPReceiver& r ) const override { return r.send().ackno; }
+};
+
+struct ExpectWindow : public ExpectNumber<TCPReceiver, uint16_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "window_size"; }
+  uint16_t value( TCPReceiver& r ) const override { return r.send().window_size; }
+};
+
+struct ExpectSYNWindow : public ExpectNumber<TCPReceiver, uint16_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "window_size on a SYN-ACK"; }
+  uint16_t value( TCPReceiver& r ) const override { return r.send( true ).window_size; }
+};
+
+struct ExpectTimestampEcho : public ExpectNumber<TCPReceiver, std::optional<uint32_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "timestamp_echo"; }
+  std::optional<uint32_t> value( TCPReceiver& r ) const override { return r.send().timestamp_echo; }
+};
+
+inline std::string describe( const std::vector<SACKBlock>& blocks )
+{
+  std::string ret = "[";
+  for ( const SACKBlock& b : blocks ) {
+    ret += ( ret.size() > 1 ? ", " : "" ) + std::to_string( b.begin.raw_value() ) + "-"
+           + std::to_string( b.end.raw_value() );
+  }
+  return ret + "]";
+}
+
+// The SACK blocks, as [begin, end) sequence numbers in the order sent
+struct ExpectSACK : public Expectation<TCPReceiver>
+{
+  std::vector<SACKBlock> blocks_ {};
+
+  explicit ExpectSACK( std::vector<std::pair<uint32_t, uint32_t>> blocks )
+  {
+    for ( const auto& [begin, end] : blocks ) {
+      blocks_.push_back( { Wrap32 { begin }, Wrap32 { end } } );
+    }
+  }
+
+  std::string description() const override { return "SACK blocks " + describe( blocks_ ); }
+
+  void execute( TCPReceiver& r ) const override
+  {
+    const std::vector<SACKBlock> actual = r.send().sack;
+    const bool same = std::equal(
+      actual.begin(), actual.end(), blocks_.begin(), blocks_.end(), []( const SACKBlock& a, const SACKBlock& b ) {
+        return a.begin == b.begin and a.end == b.end;
+      } );
+    if ( not same ) {
+      throw ExpectationViolation { "The TCPReceiver should have sent SACK blocks " + describe( blocks_ )
+                                   + ", but instead sent " + describe( actual ) + "." };
+    }
+  }
+};
+
+struct ExpectAckDue : public ExpectBool<TCPReceiver>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "ack_due"; }
+  bool value( TCPReceiver& r ) const override { return r.ack_due(); }
+};
+
+struct ExpectBytesPending : public ExpectNumber<TCPReceiver, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "bytes_pending"; }
+  uint64_t value( TCPReceiver& r ) const override { return r.reassembler().bytes_pending(); }
+};
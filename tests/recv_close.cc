@@ -0,0 +1,64 @@
+#include "receiver_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      const uint32_t isn = 4000;
+      TCPReceiverTestHarness test { "close 1", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( IsClosed { false } );
+      test.execute( SegmentArrives {}.with_fin().with_seqno( isn + 1 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 2 } } );
+      test.execute( ExpectAckDue { true } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      const uint32_t isn = 4000;
+      TCPReceiverTestHarness test { "close 2", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_fin().with_seqno( isn + 1 ).with_data( "a" ) );
+      test.execute( IsClosed { true } );
+      test.execute( ExpectAckno { Wrap32 { isn + 3 } } );
+      test.execute( ReadAll { "a" } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      const uint32_t isn = 4000;
+      TCPReceiverTestHarness test { "FIN before the data", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_fin().with_seqno( isn + 5 ).with_data( "efgh" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( IsClosed { false } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 10 } } );
+      test.execute( IsClosed { true } );
+      test.execute( ReadAll { "abcdefgh" } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      const uint32_t isn = 4000;
+      TCPReceiverTestHarness test { "retransmitted FIN is acknowledged again", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_fin().with_seqno( isn + 1 ) );
+      test.execute( AckSent {} );
+      test.execute( ExpectAckDue { false } );
+      test.execute( SegmentArrives {}.with_fin().with_seqno( isn + 1 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 2 } } );
+      test.execute( ExpectAckDue { true } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,74 @@
+#include "receiver_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      TCPReceiverTestHarness test { "connect 1", 4000 };
+      test.execute( ExpectWindow { 4000 } );
+      test.execute( ExpectAckno { optional<Wrap32> {} } );
+      test.execute( ExpectAckDue { false } );
+      test.execute( BytesPushed { 0 } );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( 0 ) );
+      test.execute( ExpectAckno { Wrap32 { 1 } } );
+      test.execute( ExpectAckDue { true } );
+      test.execute( BytesPushed { 0 } );
+    }
+
+    {
+      TCPReceiverTestHarness test { "connect 2", 5435 };
+      test.execute( ExpectAckno { optional<Wrap32> {} } );
+      test.execute( BytesPushed { 0 } );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( 89347598 ) );
+      test.execute( ExpectAckno { Wrap32 { 89347599 } } );
+      test.execute( BytesPushed { 0 } );
+    }
+
+    {
+      TCPReceiverTestHarness test { "connect 3", 5435 };
+      test.execute( ExpectAckno { optional<Wrap32> {} } );
+      test.execute( BytesPushed { 0 } );
+      test.execute( SegmentArrives {}.with_seqno( 893475 ) );
+      test.execute( ExpectAckno { optional<Wrap32> {} } );
+      test.execute( ExpectAckDue { false } );
+      test.execute( BytesPushed { 0 } );
+    }
+
+    {
+      TCPReceiverTestHarness test { "connect 4", 5435 };
+      test.execute( ExpectAckno { optional<Wrap32> {} } );
+      test.execute( BytesPushed { 0 } );
+      test.execute( SegmentArrives {}.with_fin().with_seqno( 893475 ) );
+      test.execute( ExpectAckno { optional<Wrap32> {} } );
+      test.execute( BytesPushed { 0 } );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( 89347598 ) );
+      test.execute( ExpectAckno { Wrap32 { 89347599 } } );
+      test.execute( BytesPushed { 0 } );
+    }
+
+    {
+      TCPReceiverTestHarness test { "connect 5", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( 5 ).with_fin() );
+      test.execute( IsClosed { true } );
+      test.execute( ExpectAckno { Wrap32 { 7 } } );
+      test.execute( BytesPushed { 0 } );
+    }
+
+    {
+      // Window overflow
+      const size_t cap = static_cast<size_t>( UINT16_MAX ) + 5;
+      TCPReceiverTestHarness test { "window size is capped", cap };
+      test.execute( ExpectWindow { UINT16_MAX } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+#include "random.hh"
+#include "receiver_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    const string full( TCPConfig::MAX_PAYLOAD_SIZE, 'x' );
+
+    {
+      const uint32_t isn = 100;
+      TCPReceiverTestHarness test { "ACK every second full segment", 64000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectAckDue { true } );
+      test.execute( AckSent {} );
+      test.execute( ExpectAckDue { false } );
+
+      for ( uint32_t i = 0; i < 3; ++i ) {
+        const uint32_t seqno = isn + 1 + 2 * i * static_cast<uint32_t>( full.size() );
+        test.execute( SegmentArrives {}.with_seqno( seqno ).with_data( full ) );
+        test.execute( ExpectAckDue { false } );
+        test.execute( SegmentArrives {}.with_seqno( seqno + full.size() ).with_data( full ) );
+        test.execute( ExpectAckDue { true } );
+        test.execute( AckSent {} );
+      }
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.mss = 9000;
+      const uint32_t isn = 100;
+      const string segment( 1460, 'x' );
+      TCPReceiverTestHarness test { "Full segments are the smaller of the two MSSes", 64000, cfg };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_mss( 1460 ) );
+      test.execute( AckSent {} );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( full ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 + full.size() ).with_data( full ) );
+      test.execute( ExpectAckDue { false } ); // 2000 bytes: less than two 1460-byte segments
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 + 2 * full.size() ).with_data( segment ) );
+      test.execute( ExpectAckDue { true } );
+    }
+
+    {
+      const uint32_t isn = 100;
+      TCPReceiverTestHarness test { "ACK after the delay", 64000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( AckSent {} );
+      test.execute( Tick { 1000 } );
+      test.execute( ExpectAckDue { false } );
+
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "hello" ) );
+      test.execute( ExpectAckDue { false } );
+      test.execute( Tick { TCPConfig::ACK_DELAY_DFLT - 1 } );
+      test.execute( ExpectAckDue { false } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 6 ).with_data( "world" ) );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectAckDue { true } );
+      test.execute( ExpectAckno { Wrap32 { isn + 11 } } );
+      test.execute( AckSent {} );
+      test.execute( Tick { 1000 } );
+      test.execute( ExpectAckDue { false } );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.ack_delay = 0;
+      const uint32_t isn = 100;
+      TCPReceiverTestHarness test { "no delay", 64000, cfg };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( AckSent {} );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "a" ) );
+      test.execute( ExpectAckDue { true } );
+    }
+
+    {
+      const uint32_t isn = 100;
+      TCPReceiverTestHarness test { "immediate ACK for out-of-order data and holes", 64000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( AckSent {} );
+
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ) );
+      test.execute( ExpectAckDue { true } );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( AckSent {} );
+
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "ab" ) );
+      test.execute( ExpectAckDue { true } );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+      test.execute( AckSent {} );
+
+      // a duplicate of something already acknowledged
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "ab" ) );
+      test.execute( ExpectAckDue { true } );
+      test.execute( AckSent {} );
+
+      // in order again: back to delaying
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "ef" ) );
+      test.execute( ExpectAckDue { false } );
+    }
+
+    {
+      // A bulk transfer of full segments in order needs half as many ACKs as segments
+      const uint32_t isn = 100;
+      TCPReceiverTestHarness test { "bulk transfer", 64000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( AckSent {} );
+      const size_t nsegs = 1000;
+      size_t acks = 0;
+      for ( size_t i = 0; i < nsegs; ++i ) {
+        test.execute(
+          SegmentArrives {}.with_seqno( Wrap32::wrap( 1 + i * full.size(), Wrap32 { isn } ) ).with_data( full ) );
+        test.execute( ReadAll { full } );
+        if ( test.ack_due() ) {
+          test.execute( AckSent {} );
+          ++acks;
+        }
+      }
+      if ( acks != nsegs / 2 ) {
+        throw runtime_error( "expected " + to_string( nsegs / 2 ) + " ACKs, but " + to_string( acks )
+                             + " were due" );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,87 @@
+#include "random.hh"
+#include "receiver_test_harness.hh"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <tuple>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = 1023;
+      TCPReceiverTestHarness test { "reorder 1", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 10 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( ReadAll { "" } );
+      test.execute( ExpectBytesPending { 4 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+      test.execute( ReadAll { "abcd" } );
+      test.execute( ExpectBytesPending { 4 } );
+    }
+
+    {
+      const uint32_t isn = 1023;
+      TCPReceiverTestHarness test { "reorder 2", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efgh" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 9 } } );
+      test.execute( ReadAll { "abcdefgh" } );
+      test.execute( ExpectBytesPending { 0 } );
+    }
+
+    {
+      const uint32_t isn = 1023;
+      TCPReceiverTestHarness test { "reorder 3 (an old segment)", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ReadAll { "abcd" } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+      test.execute( ReadAll { "" } );
+    }
+
+    // many segments with random overlaps, arriving shuffled
+    for ( unsigned rep = 0; rep < 16; ++rep ) {
+      const uint32_t isn = static_cast<uint32_t>( rd() );
+      const size_t nsegs = 64;
+      TCPReceiverTestHarness test { "reorder random", 65000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+
+      vector<tuple<size_t, size_t>> seq_size;
+      size_t offset = 0;
+      for ( size_t i = 0; i < nsegs; ++i ) {
+        const size_t size = 1 + rd() % 800;
+        const size_t back = min( offset, static_cast<size_t>( rd() % 100 ) );
+        seq_size.emplace_back( offset - back, size + back );
+        offset += size;
+      }
+      shuffle( seq_size.begin(), seq_size.end(), rd );
+
+      string data( offset, 0 );
+      generate( data.begin(), data.end(), [&] { return static_cast<char>( rd() ); } );
+
+      for ( const auto& [off, sz] : seq_size ) {
+        test.execute( SegmentArrives {}
+                        .with_seqno( Wrap32::wrap( off + 1, Wrap32 { isn } ) )
+                        .with_data( data.substr( off, sz ) ) );
+      }
+      test.execute( ExpectAckno { Wrap32::wrap( offset + 1, Wrap32 { isn } ) } );
+      test.execute( ReadAll { data } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,72 @@
+#include "receiver_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      const uint32_t isn = 5000;
+      TCPReceiverTestHarness test { "no SACK unless the sender permits it", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ) );
+      test.execute( ExpectBytesPending { 2 } );
+      test.execute( ExpectSACK { {} } );
+    }
+
+    {
+      const uint32_t isn = 5000;
+      TCPConfig config;
+      config.sack = false;
+      TCPReceiverTestHarness test { "no SACK if the receiver doesn't want to", 4000, config };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ) );
+      test.execute( ExpectSACK { {} } );
+    }
+
+    {
+      const uint32_t isn = 5000;
+      TCPReceiverTestHarness test { "SACK blocks follow the holes", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      test.execute( ExpectSACK { {} } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSACK { { { isn + 3, isn + 5 } } } );
+
+      // the block with the latest arrival comes first
+      test.execute( SegmentArrives {}.with_seqno( isn + 7 ).with_data( "gh" ) );
+      test.execute( ExpectSACK { { { isn + 7, isn + 9 }, { isn + 3, isn + 5 } } } );
+
+      // filling the gap between them merges the blocks
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "ef" ) );
+      test.execute( ExpectSACK { { { isn + 3, isn + 9 } } } );
+
+      // and filling the first hole leaves nothing to SACK
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "ab" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 9 } } );
+      test.execute( ExpectSACK { {} } );
+      test.execute( ReadAll { "abcdefgh" } );
+    }
+
+    {
+      const uint32_t isn = 5000;
+      TCPReceiverTestHarness test { "at most three SACK blocks: the latest, then the lowest", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 11 ).with_data( "kl" ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 15 ).with_data( "op" ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 7 ).with_data( "gh" ) );
+      test.execute( ExpectSACK { { { isn + 7, isn + 9 }, { isn + 3, isn + 5 }, { isn + 11, isn + 13 } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 15 ).with_data( "op" ) );
+      test.execute( ExpectSACK { { { isn + 15, isn + 17 }, { isn + 3, isn + 5 }, { isn + 7, isn + 9 } } } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
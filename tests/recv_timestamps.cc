@@ -0,0 +1,62 @@
+#include "receiver_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      const uint32_t isn = 5000;
+      TCPReceiverTestHarness test { "no echo unless the sender offers timestamps", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "ab" ).with_timestamp( 10 ) );
+      test.execute( ExpectTimestampEcho { {} } );
+    }
+
+    {
+      const uint32_t isn = 5000;
+      TCPConfig config;
+      config.timestamps = false;
+      TCPReceiverTestHarness test { "no echo if the receiver doesn't want to", 4000, config };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_timestamp( 5 ) );
+      test.execute( ExpectTimestampEcho { {} } );
+    }
+
+    {
+      const uint32_t isn = 5000;
+      TCPReceiverTestHarness test { "echo the segment that begins at the last ackno sent", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_timestamp( 5 ) );
+      test.execute( ExpectTimestampEcho { 5 } );
+      test.execute( AckSent {} );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "ab" ).with_timestamp( 10 ) );
+      test.execute( ExpectTimestampEcho { 10 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ).with_timestamp( 20 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+      test.execute( ExpectTimestampEcho { 10 } ); // a delayed ACK times the oldest segment it covers
+      test.execute( AckSent {} );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "ef" ).with_timestamp( 30 ) );
+      test.execute( ExpectTimestampEcho { 30 } );
+    }
+
+    {
+      const uint32_t isn = 5000;
+      TCPReceiverTestHarness test { "out-of-order segments aren't echoed; the one filling the hole is", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_timestamp( 5 ) );
+      test.execute( AckSent {} );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ).with_timestamp( 10 ) );
+      test.execute( ExpectTimestampEcho { 5 } );
+      test.execute( AckSent {} );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "ab" ).with_timestamp( 20 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+      test.execute( ExpectTimestampEcho { 20 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+#include "random.hh"
+#include "receiver_test_harness.hh"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPReceiverTestHarness test { "transmit 1", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( 0 ) );
+      test.execute( SegmentArrives {}.with_seqno( 1 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { 5 } } );
+      test.execute( ReadAll { "abcd" } );
+      test.execute( ExpectBytesPending { 0 } );
+      test.execute( BytesPushed { 4 } );
+    }
+
+    {
+      const uint32_t isn = 384678;
+      TCPReceiverTestHarness test { "transmit 2", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+      test.execute( ReadAll { "abcd" } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efgh" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 9 } } );
+      test.execute( ReadAll { "efgh" } );
+      test.execute( BytesPushed { 8 } );
+    }
+
+    {
+      const uint32_t isn = 5;
+      TCPReceiverTestHarness test { "payload in the SYN segment", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_data( "Hello, CS144!" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 14 } } );
+      test.execute( ReadAll { "Hello, CS144!" } );
+    }
+
+    {
+      const uint32_t isn = 5;
+      TCPReceiverTestHarness test { "a payload where the SYN was is ignored", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( AckSent {} );
+      test.execute( SegmentArrives {}.with_seqno( isn ).with_data( "oops" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( ExpectAckDue { true } );
+      test.execute( BytesPushed { 0 } );
+    }
+
+    // long stream, crossing the 32-bit wrap
+    for ( unsigned rep = 0; rep < 8; ++rep ) {
+      const uint32_t isn = UINT32_MAX - 5000 + static_cast<uint32_t>( rd() % 2000 );
+      TCPReceiverTestHarness test { "transmit across the wrap", 65000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      string data;
+      uint64_t next = 0;
+      while ( next < 20000 ) {
+        const size_t len = 1 + rd() % 1000;
+        string chunk( len, 0 );
+        generate( chunk.begin(), chunk.end(), [&] { return static_cast<char>( rd() ); } );
+        test.execute( SegmentArrives {}.with_seqno( Wrap32::wrap( next + 1, Wrap32 { isn } ) ).with_data( chunk ) );
+        data += chunk;
+        next += len;
+        test.execute( ExpectAckno { Wrap32::wrap( next + 1, Wrap32 { isn } ) } );
+      }
+      test.execute( ReadAll { data } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+#include "receiver_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "window shrinks as data arrives", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectWindow { 4000 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectWindow { 3996 } );
+      test.execute( ReadAll { "abcd" } );
+      test.execute( ExpectWindow { 4000 } );
+    }
+
+    {
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "data beyond the window is dropped", 2 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 2 ).with_data( "bc" ) );
+      test.execute( ExpectBytesPending { 1 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "ab" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 3 } } );
+      test.execute( ExpectWindow { 0 } );
+      test.execute( ExpectBytesPending { 0 } );
+      test.execute( ReadAll { "ab" } );
+      test.execute( ExpectWindow { 2 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+      test.execute( ReadAll { "cd" } );
+    }
+
+    {
+      const uint32_t isn = 1000;
+      TCPReceiverTestHarness test { "small window updates are suppressed", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 3000, 'x' ) ) );
+      test.execute( ExpectAckDue { true } );
+      test.execute( AckSent {} );
+      test.execute( ExpectWindow { 1000 } );
+      test.execute( ExpectAckDue { false } );
+
+      // a few small reads open the window, but not by a whole segment
+      test.execute( Pop { 100 } );
+      test.execute( ExpectAckDue { false } );
+      test.execute( Pop { 899 } );
+      test.execute( ExpectWindow { 1999 } );
+      test.execute( ExpectAckDue { false } );
+
+      // one more byte, and the window has opened by a full segment
+      test.execute( Pop { 1 } );
+      test.execute( ExpectAckDue { true } );
+      test.execute( AckSent {} );
+      test.execute( ExpectAckDue { false } );
+    }
+
+    {
+      const uint32_t isn = 1000;
+      TCPReceiverTestHarness test { "a small receiver updates after half its capacity", 10 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_data( "0123456789" ) );
+      test.execute( AckSent {} );
+      test.execute( ExpectWindow { 0 } );
+      test.execute( Pop { 4 } );
+      test.execute( ExpectAckDue { false } );
+      test.execute( Pop { 1 } );
+      test.execute( ExpectAckDue { true } );
+    }
+    {
+      const uint32_t isn = 9000;
+      TCPReceiverTestHarness test { "window scaling advertises a large capacity in full", 4'000'000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_window_scale( 2 ) );
+      test.execute( ExpectWindow { 62500 } ); // 4,000,000 >> 6
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 1000, 'x' ) ) );
+      test.execute( ExpectWindow { 62484 } ); // rounded down: never more than it can hold
+      test.execute( ReadAll { string( 1000, 'x' ) } );
+      test.execute( ExpectWindow { 62500 } );
+    }
+
+    {
+      const uint32_t isn = 9000;
+      TCPReceiverTestHarness test { "the window on a SYN-ACK is never scaled", 4'000'000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_window_scale( 2 ) );
+      test.execute( ExpectSYNWindow { 65535 } );
+      test.execute( ExpectWindow { 62500 } );
+      test.execute( AckSent {} );
+      test.execute( ExpectAckDue { false } ); // what follows the SYN-ACK is scaled anyway
+    }
+
+    {
+      const uint32_t isn = 9000;
+      TCPReceiverTestHarness test { "no window scaling unless the peer offers it", 4'000'000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectWindow { 65535 } );
+    }
+
+    {
+      const uint32_t isn = 9000;
+      TCPConfig config;
+      config.window_scaling = false;
+      TCPReceiverTestHarness test { "no window scaling unless the receiver offers it", 4'000'000, config };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_window_scale( 2 ) );
+      test.execute( ExpectWindow { 65535 } );
+    }
+
+    {
+      const uint32_t isn = 9000;
+      TCPReceiverTestHarness test { "a window that fits needs no scale", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_window_scale( 7 ) );
+      test.execute( ExpectWindow { 4000 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+#include "resolver.hh"
+#include "test_should_be.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Numeric names and an unknown service resolve (or fail) from local files alone, so no network is needed.
+
+namespace {
+
+constexpr milliseconds kShortTTL { 50 };
+
+bool resolve_fails( Resolver& resolver, const string& hostname, const string& service )
+{
+  try {
+    resolver.resolve( hostname, service );
+  } catch ( const exception& ) {
+    return true;
+  }
+  return false;
+}
+
+// A second request for a name is answered from the cache, without another lookup, until the cache is cleared
+void test_cache_hit()
+{
+  Resolver resolver;
+  const Address first = resolver.resolve( "127.0.0.1", "80" );
+  test_should_be( first == Address( "127.0.0.1", 80 ), true );
+  test_should_be( resolver.resolve( "127.0.0.1", "80" ) == first, true );
+  test_should_be( resolver.resolve_async( "127.0.0.1", "80" ).get() == first, true );
+  test_should_be( resolver.lookups(), size_t { 1 } );
+  test_should_be( resolver.size(), size_t { 1 } );
+
+  // a callback for a cached name runs before resolve_async() returns, on the calling thread
+  thread::id caller {};
+  resolver.resolve_async( "127.0.0.1", "80", [&]( const shared_future<Address>& result ) {
+    result.get();
+    caller = this_thread::get_id();
+  } );
+  test_should_be( caller == this_thread::get_id(), true );
+
+  // another service is another name
+  resolver.resolve( "127.0.0.1", "443" );
+  test_should_be( resolver.lookups(), size_t { 2 } );
+
+  resolver.clear();
+  test_should_be( resolver.size(), size_t { 0 } );
+  resolver.resolve( "127.0.0.1", "80" );
+  test_should_be( resolver.lookups(), size_t { 3 } );
+}
+
+// Results, and failures, are reused until their TTL runs out, then looked up again
+void test_ttl_expiry()
+{
+  Resolver resolver { 1, kShortTTL, kShortTTL };
+  resolver.resolve( "127.0.0.1", "80" );
+  resolver.resolve( "127.0.0.1", "80" );
+  test_should_be( resolver.lookups(), size_t { 1 } );
+
+  test_should_be( resolve_fails( resolver, "127.0.0.1", "no-such-service" ), true );
+  test_should_be( resolve_fails( resolver, "127.0.0.1", "no-such-service" ), true );
+  test_should_be( resolver.lookups(), size_t { 2 } );
+
+  this_thread::sleep_for( 2 * kShortTTL );
+  test_should_be( resolver.resolve( "127.0.0.1", "80" ) == Address( "127.0.0.1", 80 ), true );
+  test_should_be( resolve_fails( resolver, "127.0.0.1", "no-such-service" ), true );
+  test_should_be( resolver.lookups(), size_t { 4 } );
+  test_should_be( resolver.size(), size_t { 2 } );
+}
+
+// Requests for a name whose lookup is still in flight, from any thread, all wait on that one lookup
+void test_coalescing()
+{
+  constexpr size_t threads = 4;
+  constexpr size_t requests_per_thread = 8;
+
+  vector<shared_future<Address>> results( threads * requests_per_thread );
+  atomic<size_t> callbacks_run {};
+  bool any_ready = false;
+  {
+    Resolver resolver { 1 };
+
+    // hold the only worker thread, so the next lookup can't start until released
+    promise<void> release;
+    const shared_future<void> released = release.get_future().share();
+    resolver.resolve_async( "127.0.0.1", "80", [released]( const shared_future<Address>& ) { released.wait(); } );
+
+    vector<thread> requesters;
+    for ( size_t t = 0; t < threads; ++t ) {
+      requesters.emplace_back( [&, t] {
+        for ( size_t i = 0; i < requests_per_thread; ++i ) {
+          results[t * requests_per_thread + i] = resolver.resolve_async( "127.0.0.1", "443" );
+          resolver.resolve_async( "127.0.0.1", "443", [&]( const shared_future<Address>& ) { ++callbacks_run; } );
+        }
+      } );
+    }
+    for ( auto& requester : requesters ) {
+      requester.join();
+    }
+
+    for ( const auto& result : results ) {
+      any_ready = any_ready or result.wait_for( seconds { 0 } ) == future_status::ready;
+    }
+    const size_t in_flight = resolver.size();
+    release.set_value();
+
+    test_should_be( any_ready, false );
+    test_should_be( in_flight, size_t { 2 } );
+    for ( const auto& result : results ) {
+      test_should_be( result.get() == Address( "127.0.0.1", 443 ), true );
+    }
+    test_should_be( resolver.lookups(), size_t { 2 } );
+  } // the destructor waits for the worker, and so for the callbacks
+
+  test_should_be( callbacks_run.load(), threads * requests_per_thread );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    test_cache_hit();
+    test_ttl_expiry();
+    test_coalescing();
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+#include "resolver.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+void report( const string& what, size_t count, duration<double> elapsed )
+{
+  cout << "Resolver " << what << ": " << fixed << setprecision( 1 )
+       << elapsed.count() * 1e9 / static_cast<double>( count ) << " ns each.\n";
+}
+
+// Repeated requests for `names` names already in the cache (numeric, so filling it needs no network)
+void speed_test( size_t names, size_t count )
+{
+  Resolver resolver;
+  vector<string> hosts;
+  for ( size_t i = 0; i < names; ++i ) {
+    hosts.push_back( "127.0." + to_string( i / 256 ) + "." + to_string( i % 256 ) );
+    resolver.resolve( hosts.back(), "80" );
+  }
+
+  size_t checksum = 0;
+  auto start_time = steady_clock::now();
+  for ( size_t i = 0; i < count; ++i ) {
+    checksum += resolver.resolve( hosts[i % names], "80" ).size();
+  }
+  report( "cache hit (resolve)", count, steady_clock::now() - start_time );
+
+  start_time = steady_clock::now();
+  for ( size_t i = 0; i < count; ++i ) {
+    checksum += resolver.resolve_async( hosts[i % names], "80" ).valid();
+  }
+  report( "cache hit (resolve_async)", count, steady_clock::now() - start_time );
+
+  if ( resolver.lookups() != names or checksum == 0 ) {
+    throw runtime_error( "cache hits should not have started lookups" );
+  }
+}
+
+int main()
+{
+  try {
+    speed_test( 1000, 4000000 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,266 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+namespace {
+
+constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+constexpr uint16_t WIN = 60000;
+
+// Open the connection with a large peer window, then send ten full segments (the initial window)
+void send_initial_window( TCPSenderTestHarness& test, Wrap32 isn )
+{
+  test.execute( Push {} );
+  test.execute( ExpectMessage {}.with_syn( true ) );
+  test.execute( AckReceived { isn + 1 }.with_win( WIN ) );
+  test.execute( Push { string( 10 * MSS, 'x' ) } );
+  for ( unsigned i = 0; i < 10; ++i ) {
+    test.execute( ExpectMessage {}.with_no_flags().with_payload_size( MSS ).with_seqno( isn + 1 + i * MSS ) );
+  }
+  test.execute( ExpectNoSegment {} );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.send_capacity = 20 * MSS;
+      cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "NewReno: initial window, then slow start", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ) );
+      test.execute( ExpectCwnd { 10 * MSS } );
+      test.execute( Push { string( 20 * MSS, 'x' ) } );
+      for ( unsigned i = 0; i < 10; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 10 * MSS } );
+
+      // each ACK of two segments grows the window by two, so four segments go out
+      test.execute( AckReceived { isn + 1 + 2 * MSS }.with_win( WIN ) );
+      test.execute( ExpectCwnd { 12 * MSS } );
+      for ( unsigned i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 12 * MSS } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "NewReno: the peer's window still applies", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 1500 ) );
+      test.execute( Push { string( 10 * MSS, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( 500 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "NewReno: fast retransmit and recovery", cfg };
+      send_initial_window( test, isn );
+
+      // two duplicate ACKs aren't enough
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ) );
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ) );
+      test.execute( ExpectNoSegment {} );
+
+      // the third retransmits the oldest segment at once, and halves the window
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectCwnd { 5 * MSS } );
+      test.execute( ExpectConsecutiveRetx { 0 } );
+
+      // more duplicates don't start another recovery
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectCwnd { 5 * MSS } );
+
+      // a partial ACK means the next segment was lost too
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + MSS ) );
+      test.execute( ExpectNoSegment {} );
+
+      // and a full ACK ends recovery
+      test.execute( AckReceived { isn + 1 + 10 * MSS }.with_win( WIN ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectCwnd { 5 * MSS } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Without congestion control, duplicate ACKs are ignored", cfg };
+      send_initial_window( test, isn );
+      for ( unsigned i = 0; i < 5; ++i ) {
+        test.execute( AckReceived { isn + 1 }.with_win( WIN ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "NewReno: a timeout collapses the window to one segment", cfg };
+      send_initial_window( test, isn );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectCwnd { MSS } );
+
+      // slow start again from one segment: the ACK lets three go
+      test.execute( Push { string( 3 * MSS, 'y' ) } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 1 + 10 * MSS }.with_win( WIN ) );
+      test.execute( ExpectCwnd { 3 * MSS } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + 10 * MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "NewReno: after a timeout, partial ACKs retransmit holes in slow start", cfg };
+      send_initial_window( test, isn );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ) );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ) );
+      test.execute( ExpectCwnd { 2 * MSS } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 + MSS ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 + 2 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 1 + 5 * MSS }.with_win( WIN ) );
+      test.execute( ExpectCwnd { 4 * MSS } );
+      for ( unsigned i = 5; i < 9; ++i ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + i * MSS ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectConsecutiveRetx { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::CUBIC;
+
+      TCPSenderTestHarness test { "CUBIC: multiplicative decrease by 0.7", cfg };
+      send_initial_window( test, isn );
+      test.execute( ExpectCwnd { 10 * MSS } );
+      for ( unsigned i = 0; i < 3; ++i ) {
+        test.execute( AckReceived { isn + 1 }.with_win( WIN ) );
+      }
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 ) );
+      test.execute( ExpectCwnd { 7 * MSS } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::BBR;
+
+      TCPSenderTestHarness test { "BBR: loss is retransmitted, but doesn't shrink the window", cfg };
+      send_initial_window( test, isn );
+      for ( unsigned i = 0; i < 3; ++i ) {
+        test.execute( AckReceived { isn + 1 }.with_win( WIN ) );
+      }
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 ) );
+      test.execute( ExpectCwnd { 10 * MSS } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::BBR;
+
+      TCPSenderTestHarness test { "BBR: paces once it has measured the bandwidth", cfg };
+      send_initial_window( test, isn );
+
+      // two segments delivered every 5 ms: 400 bytes/ms, with a 5 ms RTT. The bandwidth stops growing, so
+      // BBR leaves Startup and settles into ProbeBW at a pacing gain of 1.
+      for ( unsigned i = 1; i <= 5; ++i ) {
+        test.execute( Tick { 5 } );
+        test.execute( AckReceived { isn + 1 + 2 * i * MSS }.with_win( WIN ).without_push() );
+      }
+      test.execute( ExpectSeqnosInFlight { 0 } );
+
+      // a burst of two segments, then one more whenever the pacer has earned it
+      test.execute( Tick { 1 } );
+      test.execute( Push { string( 30 * MSS, 'z' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::BBR;
+
+      TCPSenderTestHarness test { "BBR: the unpaced initial window isn't owed to the pacer", cfg };
+      send_initial_window( test, isn );
+
+      // the second ACK gives BBR a bandwidth sample, and it starts pacing: with a burst, not a debt
+      for ( unsigned i = 1; i <= 2; ++i ) {
+        test.execute( Tick { 5 } );
+        test.execute( AckReceived { isn + 1 + 5 * i * MSS }.with_win( WIN ).without_push() );
+      }
+      test.execute( Push { string( 2 * MSS, 'y' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + 10 * MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + 11 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
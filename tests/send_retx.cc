@@ -0,0 +1,327 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+// A retransmission carries the very bytes of the original message, not a copy
+struct ExpectRetxSharesPayload : public Expectation<SenderAndOutput>
+{
+  uint64_t rto_;
+
+  explicit ExpectRetxSharesPayload( uint64_t rto ) : rto_( rto ) {}
+  std::string description() const override { return "retransmission shares the original payload"; }
+
+  void execute( SenderAndOutput& s ) const override
+  {
+    if ( s.output.empty() ) {
+      throw ExpectationViolation { "TCPSender was expected to send a message, but did not" };
+    }
+    const TCPSenderMessage original = s.output.front();
+    s.output.pop();
+    s.sender.tick( rto_, s.transmit() );
+    if ( s.output.empty() ) {
+      throw ExpectationViolation { "TCPSender was expected to retransmit, but did not" };
+    }
+    if ( string_view { s.output.front().payload }.data() != string_view { original.payload }.data() ) {
+      throw ExpectationViolation { "the retransmitted payload was copied" };
+    }
+    s.output.pop();
+  }
+};
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      const uint64_t retx_timeout = uniform_int_distribution<uint16_t> { 10, 10000 }( rd );
+      cfg.fixed_isn = isn;
+      cfg.rt_timeout = retx_timeout;
+
+      TCPSenderTestHarness test { "Retx SYN twice at the right times, then ack", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 1 } );
+      test.execute( Tick { retx_timeout - 1U } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( ExpectSeqnosInFlight { 1 } );
+      // Wait twice as long b/c exponential back-off
+      test.execute( Tick { 2 * retx_timeout - 1U } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( ExpectSeqnosInFlight { 1 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectRTO { retx_timeout } );
+      test.execute( ExpectConsecutiveRetx { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      const uint64_t retx_timeout = uniform_int_distribution<uint16_t> { 10, 10000 }( rd );
+      cfg.fixed_isn = isn;
+      cfg.rt_timeout = retx_timeout;
+
+      TCPSenderTestHarness test { "Retx SYN until too many retransmissions", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 1 } );
+      for ( size_t attempt_no = 0; attempt_no < TCPConfig::MAX_RETX_ATTEMPTS; attempt_no++ ) {
+        test.execute( Tick { ( retx_timeout << attempt_no ) - 1U }.with_max_retx_exceeded( false ) );
+        test.execute( ExpectNoSegment {} );
+        test.execute( Tick { 1 }.with_max_retx_exceeded( false ) );
+        test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+        test.execute( ExpectSeqnosInFlight { 1 } );
+        test.execute( ExpectConsecutiveRetx { attempt_no + 1 } );
+      }
+      test.execute( ExpectError { false } );
+      test.execute(
+        Tick { ( retx_timeout << TCPConfig::MAX_RETX_ATTEMPTS ) - 1U }.with_max_retx_exceeded( false ) );
+      test.execute( Tick { 1 }.with_max_retx_exceeded( true ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectError { true } );
+
+      // having given up, the sender stays quiet
+      test.execute( Tick { 10 * ( retx_timeout << TCPConfig::MAX_RETX_ATTEMPTS ) } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      const uint64_t retx_timeout = uniform_int_distribution<uint16_t> { 10, 10000 }( rd );
+      cfg.fixed_isn = isn;
+      cfg.rt_timeout = retx_timeout;
+
+      TCPSenderTestHarness test { "Send some data, the retx and succeed, then retx till limit", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( Push { "abcd" } );
+      test.execute( ExpectMessage {}.with_payload_size( 4 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 5 } } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( Push { "efgh" } );
+      test.execute( ExpectMessage {}.with_payload_size( 4 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { retx_timeout }.with_max_retx_exceeded( false ) );
+      test.execute( ExpectMessage {}.with_payload_size( 4 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 9 } } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( Push { "ijkl" } );
+      test.execute( ExpectMessage {}.with_payload_size( 4 ).with_seqno( isn + 9 ) );
+      for ( size_t attempt_no = 0; attempt_no < TCPConfig::MAX_RETX_ATTEMPTS; attempt_no++ ) {
+        test.execute( Tick { ( retx_timeout << attempt_no ) - 1U }.with_max_retx_exceeded( false ) );
+        test.execute( ExpectNoSegment {} );
+        test.execute( Tick { 1 }.with_max_retx_exceeded( false ) );
+        test.execute( ExpectMessage {}.with_payload_size( 4 ).with_seqno( isn + 9 ) );
+        test.execute( ExpectNoSegment {} );
+        test.execute( ExpectSeqnosInFlight { 4 } );
+      }
+      test.execute(
+        Tick { ( retx_timeout << TCPConfig::MAX_RETX_ATTEMPTS ) - 1U }.with_max_retx_exceeded( false ) );
+      test.execute( Tick { 1 }.with_max_retx_exceeded( true ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "One timer for the connection: only the oldest segment is retransmitted", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1000 ) );
+      test.execute( Push { "a" } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( Tick { cfg.rt_timeout / 2U } );
+      test.execute( Push { "b" } );
+      test.execute( ExpectMessage {}.with_data( "b" ) );
+      test.execute( Tick { cfg.rt_timeout / 2U } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectRTO { 2U * cfg.rt_timeout } );
+
+      // an ACK for "a" restarts the timer at the initial RTO, for "b"
+      test.execute( AckReceived { Wrap32 { isn + 2 } }.with_win( 1000 ) );
+      test.execute( ExpectRTO { cfg.rt_timeout } );
+      test.execute( Tick { cfg.rt_timeout - 1U } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "b" ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "No backoff while probing a zero window", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 0 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( ExpectNoSegment {} );
+      for ( unsigned i = 0; i < 2 * TCPConfig::MAX_RETX_ATTEMPTS; ++i ) {
+        test.execute( Tick { cfg.rt_timeout }.with_max_retx_exceeded( false ) );
+        test.execute( ExpectMessage {}.with_data( "a" ) );
+        test.execute( ExpectConsecutiveRetx { 0 } );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 2 } }.with_win( 10 ) );
+      test.execute( ExpectMessage {}.with_data( "bc" ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Retransmission copies nothing", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1000 ) );
+      test.execute( Push { string( 1000, 'z' ) } );
+      test.execute( ExpectRetxSharesPayload { cfg.rt_timeout } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.estimate_RTO = true;
+      cfg.min_RTO_ms = 1;
+
+      TCPSenderTestHarness test { "Estimated RTO follows the RTT (RFC 6298)", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1000 ) );
+      test.execute( ExpectRTO { 300 } ); // SRTT = 100, RTTVAR = 50
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 4 } }.with_win( 1000 ) );
+      test.execute( ExpectRTO { 250 } ); // SRTT = 100, RTTVAR = 37.5
+      test.execute( Push { "d" } );
+      test.execute( ExpectMessage {}.with_data( "d" ) );
+      test.execute( Tick { 249 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "d" ) );
+      test.execute( ExpectRTO { 500 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.estimate_RTO = true;
+      cfg.min_RTO_ms = 1;
+
+      TCPSenderTestHarness test { "Karn's rule: no sample from a retransmission, and the backoff stands", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1000 ) );
+      test.execute( ExpectRTO { 300 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 300 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( ExpectRTO { 600 } );
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { Wrap32 { isn + 4 } }.with_win( 1000 ) );
+      test.execute( ExpectRTO { 600 } );
+      test.execute( Push { "def" } );
+      test.execute( ExpectMessage {}.with_data( "def" ) );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { Wrap32 { isn + 7 } }.with_win( 1000 ) );
+      test.execute( ExpectRTO { 294 } ); // SRTT = 93.75, RTTVAR = 50
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.estimate_RTO = true;
+      cfg.min_RTO_ms = 200;
+      cfg.max_RTO_ms = 1000;
+
+      TCPSenderTestHarness test { "Estimated RTO stays within its bounds, backoff included", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 2 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1000 ) );
+      test.execute( ExpectRTO { 200 } );
+      test.execute( Push { "a" } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      for ( const uint64_t rto : { 200, 400, 800, 1000 } ) {
+        test.execute( Tick { rto - 1 } );
+        test.execute( ExpectNoSegment {} );
+        test.execute( Tick { 1 } );
+        test.execute( ExpectMessage {}.with_data( "a" ) );
+      }
+      test.execute( ExpectRTO { 1000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.estimate_RTO = true;
+      cfg.min_RTO_ms = 1;
+
+      TCPSenderTestHarness test { "With timestamps, a retransmission's ACK is a sample too", cfg };
+      test.execute( Timestamps { true, true } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1000 ).with_timestamp_echo( 0 ) );
+      test.execute( ExpectRTO { 300 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( 100 ) );
+      test.execute( Tick { 300 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( 400 ) );
+      test.execute( Tick { 20 } );
+      test.execute( AckReceived { Wrap32 { isn + 4 } }.with_win( 1000 ).with_timestamp_echo( 400 ) );
+      test.execute( ExpectRTO { 320 } ); // SRTT = 90, RTTVAR = 57.5
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Timestamps go only on the SYN unless the peer offered them too", cfg };
+      test.execute( Timestamps { true, false } );
+      test.execute( Tick { 7 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 7 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1000 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( {} ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+    constexpr uint16_t WIN = 60000;
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "The SYN permits SACK", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectSACKPermitted { true } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "SACK recovery repairs a burst of losses in one round trip", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ) );
+      test.execute( Push { string( 10 * MSS, 'x' ) } );
+      for ( unsigned i = 0; i < 10; ++i ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + i * MSS ) );
+      }
+
+      // the first three segments are lost; the rest arrive, and are SACKed one by one
+      const Wrap32 first_sacked = isn + 1 + 3 * MSS;
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ).with_sack( first_sacked, isn + 1 + 4 * MSS ) );
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ).with_sack( first_sacked, isn + 1 + 5 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+
+      // three duplicates: the oldest is lost, and so is every hole with three segments SACKed above it
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ).with_sack( first_sacked, isn + 1 + 6 * MSS ) );
+      test.execute( ExpectCwnd { 5 * MSS } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} ); // the congestion window holds the others back for now...
+
+      // ...but each SACK means another segment has left the network
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ).with_sack( first_sacked, isn + 1 + 7 * MSS ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 + MSS ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ).with_sack( first_sacked, isn + 1 + 8 * MSS ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 + 2 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+
+      // SACKed segments are never retransmitted
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ).with_sack( first_sacked, isn + 1 + 10 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+
+      test.execute( AckReceived { isn + 1 + 10 * MSS }.with_win( WIN ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectConsecutiveRetx { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "After a timeout, only the unSACKed holes are retransmitted", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ) );
+      test.execute( Push { string( 6 * MSS, 'x' ) } );
+      for ( unsigned i = 0; i < 6; ++i ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + i * MSS ) );
+      }
+
+      // segments 1 and 3 arrive: not enough to call anything lost
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ).with_sack( isn + 1 + MSS, isn + 1 + 2 * MSS ) );
+      test.execute( AckReceived { isn + 1 }
+                      .with_win( WIN )
+                      .with_sack( isn + 1 + 3 * MSS, isn + 1 + 4 * MSS )
+                      .with_sack( isn + 1 + MSS, isn + 1 + 2 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 1 + 2 * MSS }
+                      .with_win( WIN )
+                      .with_sack( isn + 1 + 3 * MSS, isn + 1 + 4 * MSS ) );
+      test.execute( ExpectCwnd { 3 * MSS } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 + 2 * MSS ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 + 4 * MSS ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 + 5 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,162 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Three short writes", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1000 ) );
+      test.execute( Push { "ab" } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_seqno( isn + 1 ) );
+      test.execute( Push { "cd" } );
+      test.execute( ExpectMessage {}.with_data( "cd" ).with_seqno( isn + 3 ) );
+      test.execute( Push { "abcd" } );
+      test.execute( ExpectMessage {}.with_data( "abcd" ).with_seqno( isn + 5 ) );
+      test.execute( ExpectSeqno { isn + 9 } );
+      test.execute( ExpectSeqnosInFlight { 8 } );
+      test.execute( AckReceived { Wrap32 { isn + 9 } }.with_win( 1000 ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Writes are split into MAX_PAYLOAD_SIZE messages", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 3000 ) );
+      const string data( 2500, 'x' );
+      test.execute( Push { data } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 500 ).with_seqno( isn + 2001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 2500 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Segments carry the smaller of the two MSSes", cfg };
+      test.execute( MaxSegmentSizes { 9000, 1460 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ).with_mss( 9000 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 5000 ) );
+      test.execute( Push { string( 5000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ).with_seqno( isn + 1461 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ).with_seqno( isn + 2921 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 620 ).with_seqno( isn + 4381 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "A peer that offers no MSS gets MAX_PAYLOAD_SIZE messages", cfg };
+      test.execute( MaxSegmentSizes { 9000, {} } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_mss( 9000 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 3000 ) );
+      test.execute( Push { string( 2500, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 500 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.send_capacity = 200000;
+
+      TCPSenderTestHarness test { "Writes larger than a super-segment are still split into full segments", cfg };
+      test.execute( MaxSegmentSizes { 9000, 9000 } );
+      test.execute( WindowScales { 0, 2 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 50000 ) );
+      string data( 150000, 0 );
+      generate( data.begin(), data.end(), [&] { return static_cast<char>( rd() ); } );
+      test.execute( Push { data } );
+      for ( size_t offset = 0; offset < data.size(); offset += 9000 ) {
+        test.execute(
+          ExpectMessage {}.with_data( data.substr( offset, 9000 ) ).with_seqno( isn + 1 + offset ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 150000 } );
+    }
+
+    // Many short writes, continuous acks
+    for ( unsigned rep = 0; rep < 4; ++rep ) {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Many short writes, continuous acks", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( UINT16_MAX ) );
+      uint64_t bytes_sent = 0;
+      for ( unsigned i = 0; i < 200; ++i ) {
+        const size_t size = 1 + rd() % 900;
+        string data( size, 0 );
+        generate( data.begin(), data.end(), [&] { return static_cast<char>( rd() ); } );
+        test.execute( Push { data } );
+        test.execute( ExpectMessage {}.with_data( data ).with_seqno( isn + 1 + bytes_sent ) );
+        bytes_sent += size;
+        test.execute( ExpectSeqnosInFlight { size } );
+        test.execute( AckReceived { isn + 1 + bytes_sent }.with_win( UINT16_MAX ) );
+        test.execute( ExpectSeqnosInFlight { 0 } );
+      }
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Partial ACKs retire whole segments only", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 3000 ) );
+      test.execute( Push { string( 2000, 'y' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1500 } }.with_win( 3000 ) );
+      test.execute( ExpectSeqnosInFlight { 501 } );
+
+      // the timer restarted on the partial ACK; when it fires, the second segment goes out whole
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,191 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Initial receiver advertised window is respected", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 4 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { "abcdefg" } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "abcd" ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Immediate window is respected", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 6 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { "abcdefg" } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "abcdef" ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const size_t MIN_WIN = 5;
+      const size_t MAX_WIN = 100;
+      const size_t N_REPS = 1000;
+      for ( size_t i = 0; i < N_REPS; ++i ) {
+        TCPConfig cfg;
+        const Wrap32 isn( rd() );
+        const size_t len = MIN_WIN + rd() % ( MAX_WIN - MIN_WIN );
+        cfg.fixed_isn = isn;
+
+        TCPSenderTestHarness test { "Window " + to_string( i ), cfg };
+        test.execute( Push {} );
+        test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+        test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( len ) );
+        test.execute( ExpectNoSegment {} );
+        test.execute( Push { string( 2 * N_REPS, 'a' ) } );
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( len ) );
+        test.execute( ExpectNoSegment {} );
+      }
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Window growth is exploited", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 4 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { "0123456789" } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "0123" ) );
+      test.execute( AckReceived { Wrap32 { isn + 5 } }.with_win( 5 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "45678" ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "FIN flag occupies space in window", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 7 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { "1234567" }.with_close() );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "1234567" ) );
+      test.execute( ExpectNoSegment {} ); // window is full
+      test.execute( AckReceived { Wrap32 { isn + 8 } }.with_win( 1 ) );
+      test.execute( ExpectMessage {}.with_fin( true ).with_data( "" ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Zero window is probed with one byte", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 0 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "a" ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 2 } }.with_win( 0 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_data( "b" ) );
+      test.execute( ExpectNoSegment {} );
+    }
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Scaled windows, once both endpoints offer a scale", cfg };
+      test.execute( WindowScales { 0, 6 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_window_scale( 0 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 40 ) );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 560 ) ); // 40 << 6 = 2560
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 2560 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "An ACK of something not yet sent leaves the window alone", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1000 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( AckReceived { Wrap32 { isn + 100 } }.with_win( 0 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { "def" } );
+      test.execute( ExpectMessage {}.with_data( "def" ) );
+      test.execute( ExpectSeqnosInFlight { 6 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "The window on a SYN-ACK is never scaled", cfg };
+      test.execute( WindowScales { 0, 6 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 2000 ).with_syn() );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 2001 } }.with_win( 40 ) ); // 40 << 6 = 2560
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "The peer's scale means nothing if we didn't offer one", cfg };
+      test.execute( WindowScales { {}, 6 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_window_scale( {} ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 40 ) );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 40 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,460 @@
+#pragma once
+
+#include "common.hh"
+#include "tcp_sender.hh"
+
+#include <optional>
+#include <queue>
+#include <sstream>
+#include <utility>
+
+// A TCPSender, plus the messages it has transmitted that the test hasn't looked at yet
+struct SenderAndOutput
+{
+  TCPSender sender;
+  std::queue<TCPSenderMessage> output {};
+
+  TCPSender::TransmitFunction transmit()
+  {
+    return [this]( const TCPSenderMessage& msg ) { output.push( msg ); };
+  }
+};
+
+class TCPSenderTestHarness : public TestHarness<SenderAndOutput>
+{
+  static TCPSender make_sender( const TCPConfig& config )
+  {
+    TCPSender sender { ByteStream { config.send_capacity },
+                       config.fixed_isn.value_or( Wrap32 { 0 } ),
+                       config.rt_timeout,
+                       make_congestion_controller( config.congestion_control ) };
+    if ( config.estimate_RTO ) {
+      sender.estimate_RTO( config.min_RTO_ms, config.max_RTO_ms );
+    }
+    return sender;
+  }
+
+public:
+  TCPSenderTestHarness( std::string test_name, const TCPConfig& config )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( config.send_capacity )
+                     + ", retx_timeout=" + std::to_string( config.rt_timeout ),
+                   SenderAndOutput { make_sender( config ) } )
+  {}
+};
+
+inline std::string describe( const TCPSenderMessage& msg )
+{
+  std::ostringstream ss;
+  ss << "(" << ( msg.SYN ? "SYN " : "" ) << "seqno=" << msg.seqno.raw_value();
+  if ( msg.payload.size() ) {
+    ss << ", payload=\"" << Printer::prettify( msg.payload ) << "\"";
+  }
+  ss << ( msg.FIN ? " FIN" : "" ) << ")";
+  return ss.str();
+}
+
+/* actions */
+
+struct Push : public Action<SenderAndOutput>
+{
+  std::string data_;
+  bool close_ {};
+
+  explicit Push( std::string data = {} ) : data_( move( data ) ) {}
+
+  Push& with_close()
+  {
+    close_ = true;
+    return *this;
+  }
+
+  std::string description() const override
+  {
+    std::string ret = "push";
+    if ( not data_.empty() ) {
+      ret += " \"" + Printer::prettify( data_ ) + "\"";
+    }
+    return ret + ( close_ ? " and close" : "" );
+  }
+
+  void execute( SenderAndOutput& s ) const override
+  {
+    if ( not data_.empty() ) {
+      s.sender.writer().push( data_ );
+    }
+    if ( close_ ) {
+      s.sender.writer().close();
+    }
+    s.sender.push( s.transmit() );
+  }
+};
+
+// Tell the sender what window scales its endpoint and the peer offered (as their SYNs would)
+struct WindowScales : public Action<SenderAndOutput>
+{
+  std::optional<uint8_t> ours_;
+  std::optional<uint8_t> peers_;
+
+  WindowScales( std::optional<uint8_t> ours, std::optional<uint8_t> peers ) : ours_( ours ), peers_( peers ) {}
+
+  std::string description() const override
+  {
+    const auto str = []( std::optional<uint8_t> s ) { return s ? std::to_string( *s ) : std::string { "none" }; };
+    return "window scales: ours=" + str( ours_ ) + ", peer's=" + str( peers_ );
+  }
+
+  void execute( SenderAndOutput& s ) const override
+  {
+    s.sender.offer_window_scale( ours_ );
+    s.sender.set_peer_window_scale( peers_ );
+  }
+};
+
+// Tell the sender what MSSes its endpoint and the peer offered (as their SYNs would)
+struct MaxSegmentSizes : public Action<SenderAndOutput>
+{
+  std::optional<uint16_t> ours_;
+  std::optional<uint16_t> peers_;
+
+  MaxSegmentSizes( std::optional<uint16_t> ours, std::optional<uint16_t> peers ) : ours_( ours ), peers_( peers )
+  {}
+
+  std::string description() const override
+  {
+    const auto str = []( std::optional<uint16_t> s ) { return s ? std::to_string( *s ) : std::string { "none" }; };
+    return "MSSes: ours=" + str( ours_ ) + ", peer's=" + str( peers_ );
+  }
+
+  void execute( SenderAndOutput& s ) const override
+  {
+    s.sender.offer_mss( ours_ );
+    s.sender.set_peer_mss( peers_ );
+  }
+};
+
+// Tell the sender whether its endpoint and the peer offered timestamps (as their SYNs would)
+struct Timestamps : public Action<SenderAndOutput>
+{
+  bool ours_;
+  bool peers_;
+
+  Timestamps( bool ours, bool peers ) : ours_( ours ), peers_( peers ) {}
+
+  std::string description() const override
+  {
+    return "timestamps: ours=" + ExpectationViolation::boolstr( ours_ )
+           + ", peer's=" + ExpectationViolation::boolstr( peers_ );
+  }
+
+  void execute( SenderAndOutput& s ) const override
+  {
+    s.sender.offer_timestamps( ours_ );
+    s.sender.set_peer_timestamps( peers_ );
+  }
+};
+
+struct Tick : public Action<SenderAndOutput>
+{
+  uint64_t ms_;
+  std::optional<bool> max_retx_exceeded_ {};
+
+  explicit Tick( uint64_t ms ) : ms_( ms ) {}
+
+  Tick& with_max_retx_exceeded( bool val )
+  {
+    max_retx_exceeded_ = val;
+    return *this;
+  }
+
+  std::string description() const override { return std::to_string( ms_ ) + " ms pass"; }
+
+  void execute( SenderAndOutput& s ) const override
+  {
+    s.sender.tick( ms_, s.transmit() );
+    const bool exceeded = s.sender.consecutive_retransmissions() > TCPConfig::MAX_RETX_ATTEMPTS;
+    if ( max_retx_exceeded_.has_value() and *max_retx_exceeded_ != exceeded ) {
+      throw ExpectationViolation { "max_retx_exceeded", *max_retx_exceeded_, exceeded };
+    }
+  }
+};
+
+struct AckReceived : public Action<SenderAndOutput>
+{
+  TCPReceiverMessage msg_ {};
+  bool SYN_ {};
+  bool push_ { true };
+
+  explicit AckReceived( std::optional<Wrap32> ackno )
+  {
+    msg_.ackno = ackno;
+    msg_.window_size = 137;
+  }
+
+  AckReceived& with_win( uint16_t win )
+  {
+    msg_.window_size = win;
+    return *this;
+  }
+
+  AckReceived& with_sack( Wrap32 begin, Wrap32 end )
+  {
+    msg_.sack.push_back( { begin, end } );
+    return *this;
+  }
+
+  AckReceived& with_timestamp_echo( uint32_t timestamp )
+  {
+    msg_.timestamp_echo = timestamp;
+    return *this;
+  }
+
+  AckReceived& with_syn()
+  {
+    SYN_ = true;
+    return *this;
+  }
+
+  AckReceived& without_push()
+  {
+    push_ = false;
+    return *this;
+  }
+
+  std::string description() const override
+  {
+    std::string ret
+      = "receive ack (ackno=" + to_string( msg_.ackno ) + ", window_size=" + std::to_string( msg_.window_size );
+    if ( SYN_ ) {
+      ret += ", on a SYN";
+    }
+    for ( const SACKBlock& b : msg_.sack ) {
+      ret += ", SACK " + std::to_string( b.begin.raw_value() ) + "-" + std::to_string( b.end.raw_value() );
+    }
+    if ( msg_.timestamp_echo.has_value() ) {
+      ret += ", TSecr=" + std::to_string( *msg_.timestamp_echo );
+    }
+    return ret + ")";
+  }
+
+  void execute( SenderAndOutput& s ) const override
+  {
+    s.sender.receive( msg_, SYN_ );
+    if ( push_ ) {
+      s.sender.push( s.transmit() );
+    }
+  }
+};
+
+/* expectations */
+
+struct ExpectMessage : public Expectation<SenderAndOutput>
+{
+  std::optional<bool> syn_ {};
+  std::optional<bool> fin_ {};
+  std::optional<Wrap32> seqno_ {};
+  std::optional<std::string> data_ {};
+  std::optional<size_t> payload_size_ {};
+  std::optional<std::optional<uint8_t>> window_scale_ {};
+  std::optional<std::optional<uint16_t>> mss_ {};
+  std::optional<std::optional<uint32_t>> timestamp_ {};
+
+  ExpectMessage& with_syn( bool syn )
+  {
+    syn_ = syn;
+    return *this;
+  }
+
+  ExpectMessage& with_fin( bool fin )
+  {
+    fin_ = fin;
+    return *this;
+  }
+
+  ExpectMessage& with_no_flags() { return with_syn( false ).with_fin( false ); }
+
+  ExpectMessage& with_seqno( Wrap32 seqno )
+  {
+    seqno_ = seqno;
+    return *this;
+  }
+
+  ExpectMessage& with_seqno( uint32_t seqno ) { return with_seqno( Wrap32 { seqno } ); }
+
+  ExpectMessage& with_data( std::string data )
+  {
+    data_ = std::move( data );
+    return *this;
+  }
+
+  ExpectMessage& with_payload_size( size_t size )
+  {
+    payload_size_ = size;
+    return *this;
+  }
+
+  ExpectMessage& with_window_scale( std::optional<uint8_t> shift )
+  {
+    window_scale_ = shift;
+    return *this;
+  }
+
+  ExpectMessage& with_mss( std::optional<uint16_t> size )
+  {
+    mss_ = size;
+    return *this;
+  }
+
+  ExpectMessage& with_timestamp( std::optional<uint32_t> timestamp )
+  {
+    timestamp_ = timestamp;
+    return *this;
+  }
+
+  std::string description() const override
+  {
+    std::ostringstream ss;
+    ss << "message sent with";
+    if ( syn_.has_value() ) {
+      ss << " SYN=" << ExpectationViolation::boolstr( *syn_ );
+    }
+    if ( fin_.has_value() ) {
+      ss << " FIN=" << ExpectationViolation::boolstr( *fin_ );
+    }
+    if ( seqno_.has_value() ) {
+      ss << " seqno=" << seqno_->raw_value();
+    }
+    if ( payload_size_.has_value() ) {
+      ss << " payload_size=" << *payload_size_;
+    }
+    if ( data_.has_value() ) {
+      ss << " payload=\"" << Printer::prettify( *data_ ) << "\"";
+    }
+    if ( window_scale_.has_value() ) {
+      ss << " window_scale=" << ( window_scale_->has_value() ? std::to_string( **window_scale_ ) : "none" );
+    }
+    if ( mss_.has_value() ) {
+      ss << " MSS=" << ( mss_->has_value() ? std::to_string( **mss_ ) : "none" );
+    }
+    if ( timestamp_.has_value() ) {
+      ss << " TSval=" << ( timestamp_->has_value() ? std::to_string( **timestamp_ ) : "none" );
+    }
+    return ss.str();
+  }
+
+  void execute( SenderAndOutput& s ) const override
+  {
+    if ( s.output.empty() ) {
+      throw ExpectationViolation { "TCPSender was expected to send a message, but did not" };
+    }
+    const TCPSenderMessage msg = std::move( s.output.front() );
+    s.output.pop();
+
+    if ( syn_.has_value() and msg.SYN != *syn_ ) {
+      throw ExpectationViolation { "SYN flag", *syn_, msg.SYN };
+    }
+    if ( fin_.has_value() and msg.FIN != *fin_ ) {
+      throw ExpectationViolation { "FIN flag", *fin_, msg.FIN };
+    }
+    if ( seqno_.has_value() and msg.seqno != *seqno_ ) {
+      throw ExpectationViolation { "seqno", *seqno_, msg.seqno };
+    }
+    if ( payload_size_.has_value() and msg.payload.size() != *payload_size_ ) {
+      throw ExpectationViolation { "payload_size", *payload_size_, msg.payload.size() };
+    }
+    if ( window_scale_.has_value() and msg.window_scale != *window_scale_ ) {
+      throw ExpectationViolation { "The message should have had window_scale "
+                                   + ( window_scale_->has_value() ? std::to_string( **window_scale_ ) : "none" )
+                                   + ", but it had "
+                                   + ( msg.window_scale ? std::to_string( *msg.window_scale ) : "none" ) };
+    }
+    if ( mss_.has_value() and msg.MSS != *mss_ ) {
+      throw ExpectationViolation { "The message should have had MSS "
+                                   + ( mss_->has_value() ? std::to_string( **mss_ ) : "none" ) + ", but it had "
+                                   + ( msg.MSS ? std::to_string( *msg.MSS ) : "none" ) };
+    }
+    if ( timestamp_.has_value() and msg.timestamp != *timestamp_ ) {
+      throw ExpectationViolation { "TSval", *timestamp_, msg.timestamp };
+    }
+    if ( data_.has_value() and std::string_view { msg.payload } != *data_ ) {
+      throw ExpectationViolation { "The message should have had payload \"" + Printer::prettify( *data_ )
+                                   + "\", but instead it was \"" + Printer::prettify( msg.payload ) + "\"." };
+    }
+  }
+};
+
+struct ExpectNoSegment : public Expectation<SenderAndOutput>
+{
+  std::string description() const override { return "no (more) segments sent"; }
+  void execute( SenderAndOutput& s ) const override
+  {
+    if ( not s.output.empty() ) {
+      throw ExpectationViolation { "TCPSender sent an unexpected segment: " + describe( s.output.front() ) };
+    }
+  }
+};
+
+struct ExpectSeqno : public ExpectNumber<SenderAndOutput, Wrap32>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "seqno of make_empty_message()"; }
+  Wrap32 value( SenderAndOutput& s ) const override { return s.sender.make_empty_message().seqno; }
+};
+
+struct ExpectSeqnosInFlight : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "sequence_numbers_in_flight"; }
+  uint64_t value( SenderAndOutput& s ) const override { return s.sender.sequence_numbers_in_flight(); }
+};
+
+struct ExpectConsecutiveRetx : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "consecutive_retransmissions"; }
+  uint64_t value( SenderAndOutput& s ) const override { return s.sender.consecutive_retransmissions(); }
+};
+
+struct ExpectRTO : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "current_RTO_ms"; }
+  uint64_t value( SenderAndOutput& s ) const override { return s.sender.current_RTO_ms(); }
+};
+
+struct ExpectCwnd : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion window"; }
+  uint64_t value( SenderAndOutput& s ) const override
+  {
+    const CongestionController* cc = s.sender.congestion_control();
+    if ( cc == nullptr ) {
+      throw ExpectationViolation { "TCPSender has no congestion control" };
+    }
+    return cc->cwnd();
+  }
+};
+
+// Whether the next message (a SYN) permits SACK; consumes it
+struct ExpectSACKPermitted : public ExpectBool<SenderAndOutput>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "SYN permits SACK"; }
+  bool value( SenderAndOutput& s ) const override
+  {
+    if ( s.output.empty() ) {
+      throw ExpectationViolation { "TCPSender was expected to send a message, but did not" };
+    }
+    const bool permitted = s.output.front().SACK_permitted;
+    s.output.pop();
+    return permitted;
+  }
+};
+
+struct ExpectError : public ExpectBool<SenderAndOutput>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "stream has_error"; }
+  bool value( SenderAndOutput& s ) const override { return s.sender.reader().has_error(); }
+};
@@ -0,0 +1,184 @@
+#include "sha256.hh"
+#include "test_should_be.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+using Kernel = SHA256::Kernel;
+
+string kernel_name( Kernel kernel )
+{
+  switch ( kernel ) {
+    case Kernel::Scalar:
+      return "scalar";
+    case Kernel::SHANI:
+      return "SHA-NI";
+    case Kernel::AVX2:
+      return "AVX2";
+  }
+  return "?";
+}
+
+vector<Kernel> supported_kernels()
+{
+  vector<Kernel> ret;
+  for ( const Kernel k : { Kernel::Scalar, Kernel::SHANI, Kernel::AVX2 } ) {
+    if ( SHA256::supported( k ) ) {
+      ret.push_back( k );
+    }
+  }
+  return ret;
+}
+
+string hex( const SHA256::Digest& digest )
+{
+  static constexpr string_view digits = "0123456789abcdef";
+  string ret;
+  for ( const uint8_t byte : digest ) {
+    ret += digits[byte >> 4];  // NOLINT(*-bitwise)
+    ret += digits[byte & 0xf];  // NOLINT(*-bitwise)
+  }
+  return ret;
+}
+
+// `size` bytes that differ from one position to the next
+string pattern( size_t size )
+{
+  string ret( size, 0 );
+  for ( size_t i = 0; i < size; ++i ) {
+    ret[i] = static_cast<char>( i * 7 + 1 );
+  }
+  return ret;
+}
+
+struct KnownAnswer
+{
+  string input;
+  string digest;
+};
+
+// FIPS 180-4 examples, then lengths either side of where the padding spills into another block (the length
+// field needs 9 bytes after the message), and more than one block
+const vector<KnownAnswer>& known_answers()
+{
+  static const vector<KnownAnswer> answers {
+    { "", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+    { "abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+    { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+    { "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+      "hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+      "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1" },
+    { string( 1000000, 'a' ), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+    { pattern( 55 ), "16fa57a0a3423a715d594516339f36189d6b5f93754a9714fef202616a9fabfe" },
+    { pattern( 56 ), "c37b44e5f1b18554b36966f4f8e08bfbf3164c4b6c10374d12d89850892073c5" },
+    { pattern( 63 ), "bbba992d2c85af960fb2987a1fd05e0aa82a3db3c740dd8982a9e273b75e36a3" },
+    { pattern( 64 ), "66bd4633ed6f71c4ecfa4763bf7ba1c8ec7612de9aa6c0578a7b675207c71e0b" },
+    { pattern( 119 ), "a3ed307b730fa77c07531300c6e4a282330011d4d4caf6bb7b63ae05950f4b66" },
+    { pattern( 120 ), "8e3b15d9fea7472655aa069620b7f8c2e55ee1499f763200a7515fe826e99d20" },
+    { pattern( 1000 ), "095ecb62e30793ab4b954cd6a0586d0cc91f7ea5b1332694d8da780e98676d78" },
+  };
+  return answers;
+}
+
+void check( Kernel kernel, const string& what, const SHA256::Digest& digest, const KnownAnswer& answer )
+{
+  if ( hex( digest ) != answer.digest ) {
+    throw runtime_error( kernel_name( kernel ) + ": " + what + " of " + to_string( answer.input.size() )
+                         + " bytes should be " + answer.digest + ", not " + hex( digest ) );
+  }
+}
+
+// Each known answer, hashed whole and fed in pieces of every size from 1 to 65 bytes (with empty pieces
+// between), on every kernel a stream can use
+void test_streams()
+{
+  for ( const Kernel kernel : supported_kernels() ) {
+    for ( const auto& answer : known_answers() ) {
+      check( kernel, "hash", SHA256::hash( answer.input, kernel ), answer );
+
+      const size_t max_piece = answer.input.size() > 4096 ? 1 : 65;
+      for ( size_t piece = 1; piece <= max_piece; ++piece ) {
+        SHA256 hasher { kernel };
+        hasher.update( string_view {} );
+        for ( size_t i = 0; i < answer.input.size(); i += piece ) {
+          hasher.update( string_view( answer.input ).substr( i, piece ) );
+          hasher.update( "" );
+        }
+        test_should_be( hasher.bytes_hashed(), uint64_t { answer.input.size() } );
+        check( kernel, "update() in pieces of " + to_string( piece ), hasher.digest(), answer );
+      }
+    }
+
+    // a hasher is reusable after reset()
+    SHA256 hasher { kernel };
+    hasher.update( "something else entirely" );
+    hasher.digest();
+    hasher.reset();
+    hasher.update( "abc" );
+    check( kernel, "update() after reset()", hasher.digest(), known_answers().at( 1 ) );
+  }
+}
+
+// All the known answers at once (more than one AVX2 batch of eight, with lanes of different lengths), on
+// every kernel
+void test_batch()
+{
+  vector<KnownAnswer> answers = known_answers();
+  answers.insert( answers.end(), known_answers().begin(), known_answers().end() );
+  vector<string_view> inputs;
+  for ( const auto& answer : answers ) {
+    inputs.emplace_back( answer.input );
+  }
+
+  for ( const Kernel kernel : supported_kernels() ) {
+    vector<SHA256::Digest> digests( inputs.size() );
+    SHA256::hash_batch( inputs, digests, kernel );
+    for ( size_t i = 0; i < answers.size(); ++i ) {
+      check( kernel, "hash_batch()", digests[i], answers[i] );
+    }
+  }
+}
+
+// RFC 4648 section 10
+void test_base64()
+{
+  const vector<pair<string_view, string>> examples {
+    { "", "" },         { "f", "Zg==" },        { "fo", "Zm8=" },         { "foo", "Zm9v" },
+    { "foob", "Zm9vYg==" }, { "fooba", "Zm9vYmE=" }, { "foobar", "Zm9vYmFy" },
+  };
+  for ( const auto& [input, encoded] : examples ) {
+    const span<const uint8_t> bytes { reinterpret_cast<const uint8_t*>( input.data() ), input.size() }; // NOLINT
+    test_should_be( base64_encode( bytes ) == encoded, true );
+  }
+  const string_view foob = "foob";
+  const span<const uint8_t> bytes { reinterpret_cast<const uint8_t*>( foob.data() ), foob.size() }; // NOLINT
+  test_should_be( base64_encode( bytes, false ) == "Zm9vYg", true );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    test_streams();
+    test_batch();
+    test_base64();
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+#include "byte_stream.hh"
+#include "sha256.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+using Kernel = SHA256::Kernel;
+
+string kernel_name( Kernel kernel )
+{
+  switch ( kernel ) {
+    case Kernel::Scalar:
+      return "scalar";
+    case Kernel::SHANI:
+      return "SHA-NI";
+    case Kernel::AVX2:
+      return "AVX2 x8";
+  }
+  return "?";
+}
+
+vector<Kernel> supported_kernels()
+{
+  vector<Kernel> ret;
+  for ( const Kernel k : { Kernel::Scalar, Kernel::SHANI, Kernel::AVX2 } ) {
+    if ( SHA256::supported( k ) ) {
+      ret.push_back( k );
+    }
+  }
+  return ret;
+}
+
+string random_string( size_t size, default_random_engine& rd )
+{
+  uniform_int_distribution<char> ud;
+  string ret( size, 0 );
+  for ( auto& ch : ret ) {
+    ch = ud( rd );
+  }
+  return ret;
+}
+
+// `size` bytes of a repeated random megabyte (the hash's speed doesn't depend on the contents)
+string repeated_random_string( size_t size, default_random_engine& rd )
+{
+  const string block = random_string( min( size, size_t { 1 } << 20 ), rd );
+  string ret;
+  ret.reserve( size );
+  while ( ret.size() < size ) {
+    ret.append( block, 0, size - ret.size() );
+  }
+  return ret;
+}
+
+// Hash `size` bytes as they pass through a ByteStream in `read_size` chunks, never joining them
+void stream_speed_test( Kernel kernel, size_t size, size_t read_size, size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  const string data = repeated_random_string( size, rd );
+  const SHA256::Digest expected = SHA256::hash( data, kernel );
+
+  ByteStream stream { 1 << 20 };
+  SHA256 hasher { kernel };
+  size_t offset = 0;
+
+  const auto start_time = steady_clock::now();
+  while ( offset < data.size() ) {
+    while ( offset < data.size() and stream.writer().available_capacity() >= read_size ) {
+      stream.writer().push( data.substr( offset, read_size ) );
+      offset += read_size;
+    }
+    hasher.update_from( stream.reader() );
+  }
+  const SHA256::Digest digest = hasher.digest();
+  const auto stop_time = steady_clock::now();
+
+  if ( digest != expected ) {
+    throw runtime_error( "hash of ByteStream contents differs" );
+  }
+
+  const auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  const double gigabytes_per_second = static_cast<double>( size ) / test_duration.count() / 1e9;
+  cout << "SHA-256 (" << kernel_name( kernel ) << ") over ByteStream chunks of " << read_size << " bytes reached "
+       << fixed << setprecision( 2 ) << gigabytes_per_second << " GB/s.\n";
+}
+
+// Hash `count` separate messages of `size` bytes each
+void batch_speed_test( Kernel kernel, size_t count, size_t size, size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  const string data = repeated_random_string( count * size, rd );
+  vector<string_view> messages;
+  for ( size_t i = 0; i < count; ++i ) {
+    messages.push_back( string_view( data ).substr( i * size, size ) );
+  }
+  vector<SHA256::Digest> digests( count );
+
+  const auto start_time = steady_clock::now();
+  SHA256::hash_batch( messages, digests, kernel );
+  const auto stop_time = steady_clock::now();
+
+  if ( digests.back() != SHA256::hash( messages.back(), Kernel::Scalar ) ) {
+    throw runtime_error( "batch hash differs" );
+  }
+
+  const auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  const double gigabytes_per_second = static_cast<double>( data.size() ) / test_duration.count() / 1e9;
+  cout << "SHA-256 (" << kernel_name( kernel ) << ") of " << count << " messages of " << size << " bytes reached "
+       << fixed << setprecision( 2 ) << gigabytes_per_second << " GB/s.\n";
+}
+
+void program_body()
+{
+  for ( const Kernel kernel : supported_kernels() ) {
+    if ( kernel != Kernel::AVX2 ) {
+      stream_speed_test( kernel, 1 << 26, 16384, 654 );
+    }
+  }
+  for ( const Kernel kernel : supported_kernels() ) {
+    batch_speed_test( kernel, 8192, 4096, 987 );
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
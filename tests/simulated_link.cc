@@ -0,0 +1,103 @@
+#include "simulated_link.hh"
+#include "test_should_be.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Advance `link` by `ms`, returning what arrived
+vector<int> advance( SimulatedLink<int>& link, uint64_t ms )
+{
+  vector<int> arrived;
+  link.advance( ms, [&]( int&& msg ) { arrived.push_back( msg ); } );
+  return arrived;
+}
+
+// Delay, and the bottleneck's rate and queue
+void test_timing()
+{
+  SimulatedLink<int> link { { .bytes_per_ms = 100, .queue_limit = 250, .delay_ms = 10 }, 1 };
+  test_should_be( link.send( 1, 100 ), true );
+  test_should_be( link.send( 2, 100 ), true );
+  test_should_be( link.send( 3, 100 ), false ); // 300 bytes would be waiting
+  test_should_be( link.stats().overflowed, uint64_t { 1 } );
+  test_should_be( link.next_delivery_ms(), optional<uint64_t> { 11 } );
+
+  test_should_be( advance( link, 10 ).empty(), true );
+  test_should_be( advance( link, 1 ) == vector { 1 }, true ); // 1 ms to send, then 10 ms on the wire
+  test_should_be( link.send( 4, 0 ), true );                   // the queue has emptied by now
+  test_should_be( advance( link, 1 ) == vector { 2 }, true );
+  test_should_be( advance( link, 8 ).empty(), true );
+  test_should_be( advance( link, 1 ) == vector { 4 }, true );
+  test_should_be( link.next_delivery_ms(), optional<uint64_t> {} );
+  test_should_be( link.now_ms(), uint64_t { 21 } );
+
+  // 1 was not delayed by the queue; 2 waited 1 ms behind it; 4 was sent once the bottleneck was free
+  test_should_be( link.stats().queueing_us, uint64_t { 1000 } );
+  test_should_be( link.stats().delivered, uint64_t { 3 } );
+}
+
+// Jitter never reorders; reordering does, but delivers everything
+void test_order()
+{
+  SimulatedLink<int> jittery { { .delay_ms = 5, .jitter_ms = 20 }, 2 };
+  SimulatedLink<int> reordering { { .delay_ms = 5, .reorder_rate = 0.1, .reorder_ms = 3 }, 2 };
+  vector<int> from_jittery;
+  vector<int> from_reordering;
+  for ( int i = 0; i < 1000; ++i ) {
+    jittery.send( i, 0 );
+    reordering.send( i, 0 );
+    jittery.advance( 1, [&]( int&& msg ) { from_jittery.push_back( msg ); } );
+    reordering.advance( 1, [&]( int&& msg ) { from_reordering.push_back( msg ); } );
+  }
+  jittery.advance( 100, [&]( int&& msg ) { from_jittery.push_back( msg ); } );
+  reordering.advance( 100, [&]( int&& msg ) { from_reordering.push_back( msg ); } );
+
+  test_should_be( from_jittery.size(), size_t { 1000 } );
+  test_should_be( is_sorted( from_jittery.begin(), from_jittery.end() ), true );
+  test_should_be( from_reordering.size(), size_t { 1000 } );
+  test_should_be( is_sorted( from_reordering.begin(), from_reordering.end() ), false );
+  test_should_be( reordering.stats().reordered > 50 and reordering.stats().reordered < 150, true );
+}
+
+// Losses come in bursts, at about the configured rate, and the same seed loses the same messages
+void test_loss()
+{
+  const LinkConfig config { .loss_rate = 0.01, .loss_burst = 3 };
+  SimulatedLink<int> first { config, 1729 };
+  SimulatedLink<int> second { config, 1729 };
+  SimulatedLink<int> other { config, 1730 };
+  vector<bool> first_kept;
+  vector<bool> other_kept;
+  for ( int i = 0; i < 100000; ++i ) {
+    first_kept.push_back( first.send( i, 0 ) );
+    test_should_be( second.send( i, 0 ), bool { first_kept.back() } );
+    other_kept.push_back( other.send( i, 0 ) );
+  }
+  test_should_be( first_kept != other_kept, true );
+  test_should_be( first.stats().lost % 3, uint64_t { 0 } );
+  test_should_be( first.stats().lost > 2000 and first.stats().lost < 4000, true ); // about 3 per 100 (3%)
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    test_timing();
+    test_order();
+    test_loss();
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+#include "exception.hh"
+#include "socket.hh"
+#include "test_should_be.hh"
+
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <poll.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Wait (up to a second) until `socket` is writable, as a connection in progress becomes when it completes
+bool wait_writable( const TCPSocket& socket )
+{
+  pollfd pfd { socket.fd_num(), POLLOUT, 0 };
+  return ::poll( &pfd, 1, 1000 ) == 1;
+}
+
+TCPSocket make_listener()
+{
+  TCPSocket listener;
+  listener.set_reuseaddr();
+  listener.bind( Address { "127.0.0.1" } );
+  listener.listen( 64 );
+  return listener;
+}
+
+// Connections started without blocking complete once writable; one non-blocking accept_batch() takes them all
+void test_connect_and_accept()
+{
+  TCPSocket listener = make_listener();
+  listener.set_blocking( false );
+  test_should_be( listener.accept_batch().empty(), true );
+
+  constexpr size_t count = 5;
+  vector<TCPSocket> clients( count );
+  for ( auto& client : clients ) {
+    if ( not client.connect_nonblocking( listener.local_address() ) ) {
+      test_should_be( wait_writable( client ), true );
+    }
+    client.throw_if_error();
+    test_should_be( client.non_blocking(), true );
+    test_should_be( client.peer_address() == listener.local_address(), true );
+  }
+
+  vector<TCPSocket> accepted = listener.accept_batch();
+  test_should_be( accepted.size(), count );
+  for ( size_t i = 0; i < count; ++i ) {
+    test_should_be( accepted[i].non_blocking(), true );
+    test_should_be( accepted[i].peer_address() == clients[i].local_address(), true );
+  }
+  test_should_be( listener.accept_batch().empty(), true );
+
+  // at most `max_connections` at a time
+  vector<TCPSocket> more( 3 );
+  for ( auto& client : more ) {
+    if ( not client.connect_nonblocking( listener.local_address() ) ) {
+      wait_writable( client );
+    }
+  }
+  test_should_be( listener.accept_batch( 2 ).size(), size_t { 2 } );
+  test_should_be( listener.accept_batch( 2 ).size(), size_t { 1 } );
+
+  // the new sockets carry data both ways
+  clients[0].set_blocking( true );
+  accepted[0].set_blocking( true );
+  clients[0].write( "ping" );
+  string got;
+  accepted[0].read( got );
+  test_should_be( got == "ping", true );
+}
+
+// A blocking listener's accept_batch() returns the first connection alone
+void test_blocking_accept_batch()
+{
+  TCPSocket listener = make_listener();
+  vector<TCPSocket> clients( 2 );
+  for ( auto& client : clients ) {
+    client.connect( listener.local_address() );
+  }
+  test_should_be( listener.accept_batch().size(), size_t { 1 } );
+  test_should_be( listener.accept_batch().size(), size_t { 1 } );
+}
+
+// A refused connection completes with an error, reported by throw_if_error()
+void test_refused()
+{
+  Address closed { "127.0.0.1" };
+  {
+    TCPSocket unused = make_listener();
+    closed = unused.local_address();
+  }
+
+  TCPSocket client;
+  bool threw = false;
+  try {
+    if ( not client.connect_nonblocking( closed ) ) {
+      test_should_be( wait_writable( client ), true );
+      client.throw_if_error();
+    }
+  } catch ( const unix_error& ) {
+    threw = true;
+  }
+  test_should_be( threw, true );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    test_connect_and_accept();
+    test_blocking_accept_batch();
+    test_refused();
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,212 @@
+#include "checksum.hh"
+#include "random.hh"
+#include "tcp_config.hh"
+#include "tcp_segment.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+const IPv4FourTuple flow { { 0x0a000001, 40000 }, { 0xc0a80107, 443 } };
+
+ParsedTCPDatagram parse_or_throw( const Buffer& datagram )
+{
+  auto parsed = parse_tcp_datagram( datagram );
+  if ( not parsed.has_value() ) {
+    throw runtime_error( "parse_tcp_datagram() rejected a datagram serialize_tcp_datagram() wrote" );
+  }
+  return *parsed;
+}
+
+void check_segment( const TCPSegment& got, const TCPSegment& expected )
+{
+  const TCPSenderMessage& sent = got.sender_message;
+  test_should_be( sent.seqno, expected.sender_message.seqno );
+  test_should_be( sent.SYN, expected.sender_message.SYN );
+  test_should_be( sent.FIN, expected.sender_message.FIN );
+  test_should_be( string_view { sent.payload } == string_view { expected.sender_message.payload }, true );
+  test_should_be( sent.MSS, expected.sender_message.MSS );
+  test_should_be( sent.window_scale, expected.sender_message.window_scale );
+  test_should_be( sent.SACK_permitted, expected.sender_message.SACK_permitted );
+  test_should_be( sent.timestamp, expected.sender_message.timestamp );
+
+  const TCPReceiverMessage& received = got.receiver_message;
+  test_should_be( received.ackno, expected.receiver_message.ackno );
+  test_should_be( received.window_size, expected.receiver_message.window_size );
+  test_should_be( received.timestamp_echo, expected.receiver_message.timestamp_echo );
+  test_should_be( received.sack.size(), expected.receiver_message.sack.size() );
+  for ( size_t i = 0; i < received.sack.size(); ++i ) {
+    test_should_be( received.sack[i].begin, expected.receiver_message.sack[i].begin );
+    test_should_be( received.sack[i].end, expected.receiver_message.sack[i].end );
+  }
+  test_should_be( got.reset, expected.reset );
+}
+
+// The worked example from RFC 1071 4.1, and an IPv4 header whose checksum is well known
+void test_checksum()
+{
+  const string rfc1071 { "\x00\x01\xf2\x03\xf4\xf5\xf6\xf7", 8 };
+  InternetChecksum whole;
+  whole.add( rfc1071 );
+  test_should_be( whole.value(), static_cast<uint16_t>( ~0xddf2 & 0xffff ) ); // NOLINT(*-bitwise)
+
+  // the same sum, in pieces that split words and start at odd offsets
+  InternetChecksum pieces;
+  pieces.add( rfc1071.substr( 0, 1 ) );
+  pieces.add( rfc1071.substr( 1, 4 ) );
+  pieces.add( rfc1071.substr( 5 ) );
+  test_should_be( pieces.value(), whole.value() );
+
+  const string header { "\x45\x00\x00\x73\x00\x00\x40\x00\x40\x11\x00\x00\xc0\xa8\x00\x01\xc0\xa8\x00\xc7", 20 };
+  InternetChecksum ip;
+  ip.add( header );
+  test_should_be( ip.value(), uint16_t { 0xb861 } );
+}
+
+// A SYN with every option, and a data segment carrying SACK blocks and timestamps
+void test_roundtrip()
+{
+  TCPSegment syn;
+  syn.sender_message.seqno = Wrap32 { 0xfffffff0 };
+  syn.sender_message.SYN = true;
+  syn.sender_message.MSS = 1460;
+  syn.sender_message.window_scale = 7;
+  syn.sender_message.SACK_permitted = true;
+  syn.sender_message.timestamp = 123456;
+  syn.receiver_message.window_size = 65535;
+
+  const Buffer syn_datagram = serialize_tcp_datagram( flow, syn );
+  const ParsedTCPDatagram parsed_syn = parse_or_throw( syn_datagram );
+  check_segment( parsed_syn.segment, syn );
+  test_should_be( parsed_syn.flow.local.packed(), flow.remote.packed() );
+  test_should_be( parsed_syn.flow.remote.packed(), flow.local.packed() );
+  test_should_be( size_t { parsed_syn.ip.total_length() }, syn_datagram.size() );
+  test_should_be( parsed_syn.tcp.syn(), true );
+  test_should_be( parsed_syn.tcp.ack(), false );
+
+  TCPSegment data;
+  data.sender_message.seqno = Wrap32 { 17 };
+  data.sender_message.FIN = true;
+  data.sender_message.payload = Buffer::with_headroom( TCPConfig::HEADROOM, "odd-length payload!" );
+  data.sender_message.timestamp = 99;
+  data.receiver_message.ackno = Wrap32 { 1000 };
+  data.receiver_message.window_size = 512;
+  data.receiver_message.sack = { { Wrap32 { 2000 }, Wrap32 { 3000 } },
+                                 { Wrap32 { 4000 }, Wrap32 { 4500 } },
+                                 { Wrap32 { 0xffffff00 }, Wrap32 { 16 } } };
+  data.receiver_message.timestamp_echo = 7;
+
+  // the headers go into the payload's headroom: the datagram and its parsed payload share its storage
+  const char* payload_bytes = string_view { data.sender_message.payload }.data();
+  const Buffer datagram = serialize_tcp_datagram( flow, data );
+  test_should_be( string_view { datagram }.end() - data.sender_message.payload.size() == payload_bytes, true );
+  const ParsedTCPDatagram parsed = parse_or_throw( datagram );
+  check_segment( parsed.segment, data );
+  test_should_be( string_view { parsed.segment.sender_message.payload }.data() == payload_bytes, true );
+  test_should_be( parsed.tcp.header_length(), TCPHeaderView::MAX_LENGTH );
+
+  // a payload without headroom is copied, not refused
+  TCPSegment reset;
+  reset.sender_message.seqno = Wrap32 { 5 };
+  reset.sender_message.payload = string { "no headroom" };
+  reset.reset = true;
+  check_segment( parse_or_throw( serialize_tcp_datagram( flow, reset ) ).segment, reset );
+}
+
+// A SYN/ACK with every option leaves room for only one SACK block: the rest are dropped, not overflowed into
+// the data offset
+void test_option_space()
+{
+  TCPSegment syn_ack;
+  syn_ack.sender_message.seqno = Wrap32 { 1 };
+  syn_ack.sender_message.SYN = true;
+  syn_ack.sender_message.MSS = 1460;
+  syn_ack.sender_message.window_scale = 7;
+  syn_ack.sender_message.SACK_permitted = true;
+  syn_ack.sender_message.timestamp = 5;
+  syn_ack.receiver_message.ackno = Wrap32 { 100 };
+  syn_ack.receiver_message.window_size = 65535;
+  syn_ack.receiver_message.timestamp_echo = 4;
+  syn_ack.receiver_message.sack = { { Wrap32 { 200 }, Wrap32 { 300 } },
+                                    { Wrap32 { 400 }, Wrap32 { 500 } },
+                                    { Wrap32 { 600 }, Wrap32 { 700 } } };
+
+  const ParsedTCPDatagram parsed = parse_or_throw( serialize_tcp_datagram( flow, syn_ack ) );
+  test_should_be( parsed.tcp.header_length(), TCPHeaderView::MIN_LENGTH + 24 + 12 ); // the others, then 1 block
+  TCPSegment expected = syn_ack;
+  expected.receiver_message.sack.resize( 1 );
+  check_segment( parsed.segment, expected );
+}
+
+// A segment sent again (say, retransmitted with other SACK blocks) while its first datagram is still held
+// doesn't write over that datagram's headers: the first takes the payload's headroom, and the second copies
+void test_resend()
+{
+  TCPSegment data;
+  data.sender_message.seqno = Wrap32 { 1 };
+  data.sender_message.payload = Buffer::with_headroom( TCPConfig::HEADROOM, "sent twice" );
+  data.receiver_message.ackno = Wrap32 { 1 };
+  data.receiver_message.sack = { { Wrap32 { 100 }, Wrap32 { 200 } } };
+  const Buffer first = serialize_tcp_datagram( flow, data );
+  const string first_bytes { string_view { first } };
+
+  TCPSegment again = data;
+  again.receiver_message.sack = { { Wrap32 { 100 }, Wrap32 { 200 } }, { Wrap32 { 300 }, Wrap32 { 400 } } };
+  const Buffer second = serialize_tcp_datagram( flow, again );
+  check_segment( parse_or_throw( second ).segment, again );
+  test_should_be( string_view { first } == first_bytes, true );
+  check_segment( parse_or_throw( first ).segment, data );
+  test_should_be( string_view { second }.data() != string_view { first }.data(), true );
+
+  // the first datagram's remaining headroom is still its own, for a link-layer header
+  test_should_be( first.headroom(), TCPConfig::HEADROOM - ( first.size() - data.sender_message.payload.size() ) );
+}
+
+// Any single corrupted byte fails one of the checksums (or the header checks before them)
+void test_corruption()
+{
+  TCPSegment data;
+  data.sender_message.seqno = Wrap32 { 1 };
+  data.sender_message.payload = string( 100, 'x' );
+  data.receiver_message.ackno = Wrap32 { 1 };
+  const string good { string_view { serialize_tcp_datagram( flow, data ) } };
+
+  auto rd = get_random_engine();
+  uniform_int_distribution<unsigned> flip { 1, 255 };
+  for ( size_t i = 0; i < good.size(); ++i ) {
+    string bad = good;
+    bad[i] = static_cast<char>( bad[i] ^ flip( rd ) ); // NOLINT(*-bitwise)
+    if ( parse_tcp_datagram( Buffer { bad } ).has_value() ) {
+      throw runtime_error( "parse_tcp_datagram() accepted a datagram with byte " + to_string( i ) + " corrupted" );
+    }
+  }
+
+  // link-layer padding past the total length is ignored; a truncated datagram is rejected
+  test_should_be( parse_tcp_datagram( Buffer { good + string( 6, 0 ) } ).has_value(), true );
+  test_should_be( parse_tcp_datagram( Buffer { good.substr( 0, good.size() - 1 ) } ).has_value(), false );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    test_checksum();
+    test_roundtrip();
+    test_option_space();
+    test_resend();
+    test_corruption();
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
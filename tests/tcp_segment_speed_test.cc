@@ -0,0 +1,91 @@
+#include "tcp_config.hh"
+#include "tcp_segment.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Serialize `count` data segments of `payload_size` bytes (with timestamps and an ACK, as a sender would send
+// them), then parse them all back, and report both rates.
+void speed_test( const size_t payload_size, const size_t count )
+{
+  const IPv4FourTuple flow { { 0x0a000001, 40000 }, { 0xc0a80107, 443 } };
+
+  // one segment per payload slice, each with headroom of its own, as TCPSender lays them out
+  vector<TCPSegment> segments( count );
+  string storage;
+  storage.reserve( count * ( payload_size + TCPConfig::HEADROOM ) );
+  for ( size_t i = 0; i < count; ++i ) {
+    storage.append( TCPConfig::HEADROOM, 0 );
+    storage.append( payload_size, static_cast<char>( 'a' + i % 26 ) );
+  }
+  const Buffer batch { move( storage ) };
+  for ( size_t i = 0; i < count; ++i ) {
+    TCPSegment& segment = segments[i];
+    segment.sender_message.seqno = Wrap32 { static_cast<uint32_t>( i * payload_size ) };
+    const size_t offset = i * ( payload_size + TCPConfig::HEADROOM ) + TCPConfig::HEADROOM;
+    segment.sender_message.payload = batch.slice( offset, payload_size, TCPConfig::HEADROOM );
+    segment.sender_message.timestamp = static_cast<uint32_t>( i );
+    segment.receiver_message.ackno = Wrap32 { 1 };
+    segment.receiver_message.window_size = 65535;
+    segment.receiver_message.timestamp_echo = 1;
+  }
+
+  vector<Buffer> datagrams;
+  datagrams.reserve( count );
+  const auto serialize_start = steady_clock::now();
+  for ( const auto& segment : segments ) {
+    datagrams.push_back( serialize_tcp_datagram( flow, segment ) );
+  }
+  const auto serialize_stop = steady_clock::now();
+
+  size_t payload_bytes = 0;
+  const auto parse_start = steady_clock::now();
+  for ( const auto& datagram : datagrams ) {
+    const auto parsed = parse_tcp_datagram( datagram );
+    if ( not parsed.has_value() ) {
+      throw runtime_error( "parse_tcp_datagram() rejected a datagram serialize_tcp_datagram() wrote" );
+    }
+    payload_bytes += parsed->segment.sender_message.payload.size();
+  }
+  const auto parse_stop = steady_clock::now();
+
+  if ( payload_bytes != payload_size * count ) {
+    throw runtime_error( "Mismatch between payload serialized and parsed" );
+  }
+
+  const auto mpps = [&]( auto start, auto stop ) {
+    return static_cast<double>( count ) / duration_cast<duration<double>>( stop - start ).count() / 1e6;
+  };
+  cout << "TCP/IPv4 with " << setw( 4 ) << payload_size << "-byte payloads: serialized at " << fixed
+       << setprecision( 2 ) << mpps( serialize_start, serialize_stop ) << " Mpps, parsed at "
+       << mpps( parse_start, parse_stop ) << " Mpps.\n";
+}
+
+void program_body()
+{
+  for ( const auto& [payload_size, count] :
+        { pair<size_t, size_t> { 0, 1 << 20 }, { 64, 1 << 20 }, { 1460, 1 << 18 }, { 8960, 1 << 16 } } ) {
+    speed_test( payload_size, count );
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
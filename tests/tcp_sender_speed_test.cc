@@ -0,0 +1,107 @@
+#include "tcp_receiver.hh"
+#include "tcp_sender.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Move `input_len` bytes from a TCPSender to a TCPReceiver over a lossless, instant path, with both ends
+// offering `mss`, and report the rate.
+void speed_test( const uint16_t mss, const size_t input_len, const size_t random_seed )
+{
+  const string data = [&] {
+    default_random_engine rd { random_seed };
+    uniform_int_distribution<char> ud;
+    string ret( input_len, 0 );
+    for ( auto& c : ret ) {
+      c = ud( rd );
+    }
+    return ret;
+  }();
+  const Buffer input { data };
+
+  TCPConfig config;
+  config.mss = mss;
+  config.send_capacity = config.recv_capacity = 1 << 20;
+  TCPSender sender { ByteStream { config.send_capacity }, Wrap32 { 0 }, config.rt_timeout };
+  TCPReceiver receiver { Reassembler { ByteStream { config.recv_capacity } }, config };
+
+  // what the two SYNs would carry
+  sender.offer_mss( config.mss );
+  sender.set_peer_mss( config.mss );
+  sender.offer_window_scale( receiver.window_scale() );
+  sender.set_peer_window_scale( receiver.window_scale() );
+
+  vector<TCPSenderMessage> wire;
+  const auto transmit = [&]( const TCPSenderMessage& msg ) { wire.push_back( msg ); };
+  string output;
+  output.reserve( input_len );
+  uint64_t written = 0;
+  uint64_t segments = 0;
+
+  const auto start_time = steady_clock::now();
+  while ( not receiver.reader().is_finished() ) {
+    const uint64_t length = min( sender.writer().available_capacity(), input_len - written );
+    sender.writer().push( input, written, length );
+    written += length;
+    if ( written == input_len and not sender.writer().is_closed() ) {
+      sender.writer().close();
+    }
+
+    sender.push( transmit );
+    segments += wire.size();
+    for ( auto& msg : wire ) {
+      receiver.receive( move( msg ) );
+    }
+    wire.clear();
+
+    Reader& reader = receiver.reader();
+    while ( reader.bytes_buffered() ) {
+      const string_view peeked = reader.peek();
+      output += peeked;
+      reader.pop( peeked.size() );
+    }
+    sender.receive( receiver.send() );
+    receiver.ack_sent();
+  }
+  const auto stop_time = steady_clock::now();
+
+  if ( output != data ) {
+    throw runtime_error( "Mismatch between data sent and received" );
+  }
+
+  const auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  const double gigabits_per_second = 8 * static_cast<double>( input_len ) / test_duration.count() / 1e9;
+  const double segments_per_second = static_cast<double>( segments ) / test_duration.count();
+
+  cout << "TCPSender -> TCPReceiver with MSS=" << setw( 5 ) << mss << " reached " << fixed << setprecision( 2 )
+       << gigabits_per_second << " Gbit/s (" << setprecision( 2 ) << segments_per_second / 1e6
+       << " M segments/s).\n";
+}
+
+void program_body()
+{
+  for ( const uint16_t mss : { 1000, 1460, 9000, 65000 } ) {
+    speed_test( mss, 1 << 26, 1729 );
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "conversions.hh"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#define test_should_be( act, exp ) test_should_be_impl( act, exp, #act, #exp, __LINE__ )
+
+template<typename T>
+void test_should_be_impl( const T& actual,
+                          const T& expected,
+                          const char* actual_s,
+                          const char* expected_s,
+                          const int lineno )
+{
+  if ( actual != expected ) {
+    std::ostringstream ss;
+    ss << "`" << actual_s << "` should have been `" << expected_s << "`, but the former is\n\t"
+       << to_string( actual ) << "\nand the latter is\n\t" << to_string( expected ) << " (at line " << lineno
+       << ")\n";
+    throw std::runtime_error( ss.str() );
+  }
+}
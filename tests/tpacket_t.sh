@@ -0,0 +1,10 @@
+#!/bin/bash
+
+# Run in a fresh network namespace (as root, or inside an unprivileged user namespace)
+# so that only the test's own frames cross the loopback interface.
+if ! unshare -rn true 2>/dev/null; then
+    echo "skipping: cannot create a network namespace"
+    exit 77
+fi
+
+unshare -rn sh -c "ip link set lo up && ${1}/apps/tpacket_loopback lo 10000"
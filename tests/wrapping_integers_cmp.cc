@@ -0,0 +1,52 @@
+#include "wrapping_integers.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+// Comparisons and arithmetic are usable at compile time
+static_assert( Wrap32 { UINT32_MAX } + 2 == Wrap32 { 1 } );
+static_assert( Wrap32 { UINT32_MAX } < Wrap32 { 1 } );
+static_assert( Wrap32 { 1 } - Wrap32 { UINT32_MAX } == 2 );
+
+int main()
+{
+  try {
+    // Equality
+    test_should_be( Wrap32( 3 ) != Wrap32( 1 ), true );
+    test_should_be( Wrap32( 3 ) == Wrap32( 1 ), false );
+    test_should_be( Wrap32( 7 ) == Wrap32( 7 ), true );
+
+    // Arithmetic wraps around
+    test_should_be( Wrap32( UINT32_MAX ) + 1, Wrap32( 0 ) );
+    test_should_be( Wrap32( 0 ) - 1, Wrap32( UINT32_MAX ) );
+    Wrap32 seqno { UINT32_MAX - 5 };
+    seqno += 10;
+    test_should_be( seqno, Wrap32( 4 ) );
+    seqno -= 5;
+    test_should_be( seqno, Wrap32( UINT32_MAX ) );
+
+    // Signed distance
+    test_should_be( Wrap32( 10 ) - Wrap32( 3 ), 7 );
+    test_should_be( Wrap32( 3 ) - Wrap32( 10 ), -7 );
+    test_should_be( Wrap32( 2 ) - Wrap32( UINT32_MAX - 1 ), 4 );
+
+    // Sequence-space ordering follows the shorter way around
+    test_should_be( Wrap32( 3 ) < Wrap32( 10 ), true );
+    test_should_be( Wrap32( 10 ) < Wrap32( 3 ), false );
+    test_should_be( Wrap32( UINT32_MAX - 1 ) < Wrap32( 2 ), true );
+    test_should_be( Wrap32( 2 ) > Wrap32( UINT32_MAX - 1 ), true );
+    test_should_be( Wrap32( 5 ) <= Wrap32( 5 ), true );
+    test_should_be( Wrap32( 5 ) >= Wrap32( 5 ), true );
+    test_should_be( Wrap32( 5 ) < Wrap32( 5 ), false );
+    test_should_be( Wrap32( 0 ) < Wrap32( ( 1U << 31 ) - 1 ), true );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+#include "random.hh"
+#include "wrapping_integers.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+void check_roundtrip( const Wrap32 isn, const uint64_t value, const uint64_t checkpoint )
+{
+  if ( Wrap32::wrap( value, isn ).unwrap( isn, checkpoint ) != value ) {
+    ostringstream ss;
+    ss << "Expected unwrap(wrap()) to recover same value, and it didn't!\n";
+    ss << "  unwrap(wrap(value, isn), isn, checkpoint) != value\n";
+    ss << "    where value = " << value << ", isn = " << to_string( isn ) << ", and checkpoint = " << checkpoint
+       << "\n";
+    ss << "    (Difference between value and checkpoint is " << value - checkpoint << ".)\n";
+    throw runtime_error( ss.str() );
+  }
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    uniform_int_distribution<uint32_t> dist31minus1 { 0, ( 1UL << 31 ) - 1 };
+    uniform_int_distribution<uint32_t> dist32 { 0, UINT32_MAX };
+    uniform_int_distribution<uint64_t> dist63 { 0, 1ULL << 63 };
+
+    const uint64_t big_offset = ( 1ULL << 31 ) - 1;
+
+    for ( unsigned int i = 0; i < 1000000; i++ ) {
+      const Wrap32 isn { dist32( rd ) };
+      const uint64_t val { dist63( rd ) };
+      const uint64_t offset { dist31minus1( rd ) };
+
+      check_roundtrip( isn, val, val );
+      check_roundtrip( isn, val + 1, val );
+      check_roundtrip( isn, val - 1, val );
+      check_roundtrip( isn, val + offset, val );
+      check_roundtrip( isn, val - offset, val );
+      check_roundtrip( isn, val + big_offset, val );
+      check_roundtrip( isn, val - big_offset, val );
+    }
+
+    // The batch form agrees with one-at-a-time unwrapping (including an odd-sized tail, and checkpoints near zero)
+    const Wrap32 isn { dist32( rd ) };
+    vector<Wrap32> seqnos;
+    for ( unsigned int i = 0; i < 10003; i++ ) {
+      seqnos.push_back( Wrap32 { dist32( rd ) } );
+    }
+    vector<uint64_t> absolute( seqnos.size() );
+    for ( const uint64_t checkpoint : { dist63( rd ), uint64_t { 0 }, uint64_t { 1 } << 31 } ) {
+      Wrap32::unwrap( seqnos, isn, checkpoint, absolute );
+      for ( size_t i = 0; i < seqnos.size(); ++i ) {
+        test_should_be( absolute[i], seqnos[i].unwrap( isn, checkpoint ) );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
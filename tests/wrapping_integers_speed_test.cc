@@ -0,0 +1,106 @@
+#include "wrapping_integers.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Seqnos of `count` segments arriving slightly out of order from a stream `start` bytes in
+vector<Wrap32> make_seqnos( size_t count, uint64_t start, Wrap32 isn, size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<uint64_t> jitter { 0, 64 * 1460 };
+  vector<Wrap32> ret;
+  ret.reserve( count );
+  for ( size_t i = 0; i < count; ++i ) {
+    ret.push_back( Wrap32::wrap( start + i * 1460 + jitter( rd ), isn ) );
+  }
+  return ret;
+}
+
+void report( const string& what, size_t count, duration<double> elapsed, uint64_t checksum )
+{
+  const double per_second = static_cast<double>( count ) / elapsed.count();
+  cout << "Wrap32 " << what << ": " << fixed << setprecision( 2 ) << 1e9 / per_second << " ns each ("
+       << per_second / 1e6 << " M/s, checksum " << checksum << ").\n";
+}
+
+void speed_test( size_t count, size_t rounds, size_t random_seed )
+{
+  const Wrap32 isn { 0xdeadbeef };
+  const uint64_t start = ( 5ULL << 32 ) - 1000000; // crosses a wrap partway through
+  const vector<Wrap32> seqnos = make_seqnos( count, start, isn, random_seed );
+
+  // One at a time, each result the next checkpoint, as a receiver tracks its stream
+  uint64_t checksum = 0;
+  auto start_time = steady_clock::now();
+  for ( size_t round = 0; round < rounds; ++round ) {
+    uint64_t checkpoint = start;
+    for ( const Wrap32 seqno : seqnos ) {
+      checkpoint = seqno.unwrap( isn, checkpoint );
+      checksum += checkpoint;
+    }
+  }
+  report( "unwrap (dependent chain)", count * rounds, steady_clock::now() - start_time, checksum );
+  const uint64_t expected = checksum;
+
+  // Batches against one checkpoint each, as for the ACKs that arrive in one read
+  constexpr size_t batch = 64;
+  vector<uint64_t> absolute( count );
+  checksum = 0;
+  start_time = steady_clock::now();
+  for ( size_t round = 0; round < rounds; ++round ) {
+    for ( size_t i = 0; i < count; i += batch ) {
+      const size_t n = min( batch, count - i );
+      const uint64_t checkpoint = i ? absolute[i - 1] : start;
+      Wrap32::unwrap( span( seqnos ).subspan( i, n ), isn, checkpoint, span( absolute ).subspan( i, n ) );
+    }
+    for ( const uint64_t a : absolute ) {
+      checksum += a;
+    }
+  }
+  report( "unwrap (batches of 64)", count * rounds, steady_clock::now() - start_time, checksum );
+
+  if ( checksum != expected ) {
+    throw runtime_error( "batch unwrap disagrees with one-at-a-time unwrap" );
+  }
+
+  vector<Wrap32> wrapped( count, Wrap32 { 0 } );
+  start_time = steady_clock::now();
+  for ( size_t round = 0; round < rounds; ++round ) {
+    for ( size_t i = 0; i < count; ++i ) {
+      wrapped[i] = Wrap32::wrap( absolute[i] + round, isn );
+    }
+    checksum += wrapped.back().raw_value();
+  }
+  report( "wrap", count * rounds, steady_clock::now() - start_time, checksum );
+
+  for ( size_t i = 0; i < count; ++i ) {
+    if ( wrapped[i] != seqnos[i] + ( rounds - 1 ) ) {
+      throw runtime_error( "wrap did not invert unwrap" );
+    }
+  }
+}
+
+void program_body()
+{
+  speed_test( 1 << 14, 2000, 1234 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,60 @@
+#include "wrapping_integers.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// unwrap() is usable at compile time
+static_assert( Wrap32 { 1 }.unwrap( Wrap32 { 0 }, UINT32_MAX ) == ( 1UL << 32 ) + 1 );
+static_assert( Wrap32 { 15 }.unwrap( Wrap32 { 16 }, 0 ) == UINT32_MAX );
+
+int main()
+{
+  try {
+    // Unwrap the first byte after ISN
+    test_should_be( Wrap32( 1 ).unwrap( Wrap32( 0 ), 0 ), 1UL );
+    // Unwrap the first byte after the first wrap
+    test_should_be( Wrap32( 1 ).unwrap( Wrap32( 0 ), UINT32_MAX ), ( 1UL << 32 ) + 1 );
+    // Unwrap the last byte before the third wrap
+    test_should_be( Wrap32( UINT32_MAX - 1 ).unwrap( Wrap32( 0 ), 3 * ( 1UL << 32 ) ), 3 * ( 1UL << 32 ) - 2 );
+    // Unwrap the 10th from last byte before the third wrap
+    test_should_be( Wrap32( UINT32_MAX - 10 ).unwrap( Wrap32( 0 ), 3 * ( 1UL << 32 ) ), 3 * ( 1UL << 32 ) - 11 );
+    // Non-zero ISN
+    test_should_be( Wrap32( UINT32_MAX ).unwrap( Wrap32( 10 ), 3 * ( 1UL << 32 ) ), 3 * ( 1UL << 32 ) - 11 );
+    // Big unwrap
+    test_should_be( Wrap32( UINT32_MAX ).unwrap( Wrap32( 0 ), 0 ), static_cast<uint64_t>( UINT32_MAX ) );
+    // Unwrap a non-zero ISN
+    test_should_be( Wrap32( 16 ).unwrap( Wrap32( 16 ), 0 ), 0UL );
+    // Big unwrap with non-zero ISN
+    test_should_be( Wrap32( 15 ).unwrap( Wrap32( 16 ), 0 ), static_cast<uint64_t>( UINT32_MAX ) );
+    // Big unwrap with non-zero ISN
+    test_should_be( Wrap32( 0 ).unwrap( Wrap32( INT32_MAX ), 0 ), static_cast<uint64_t>( INT32_MAX ) + 2 );
+    // Barely big unwrap with non-zero ISN
+    test_should_be( Wrap32( UINT32_MAX ).unwrap( Wrap32( INT32_MAX ), 0 ), static_cast<uint64_t>( 1UL << 31 ) );
+    // Nearly big unwrap with non-zero ISN
+    test_should_be( Wrap32( UINT32_MAX ).unwrap( Wrap32( 1UL << 31 ), 0 ),
+                    static_cast<uint64_t>( UINT32_MAX ) >> 1 );
+    // A checkpoint far into the stream
+    test_should_be( Wrap32( 5 ).unwrap( Wrap32( 0 ), ( 1UL << 40 ) + 3 ), ( 1UL << 40 ) + 5 );
+    test_should_be( Wrap32( UINT32_MAX ).unwrap( Wrap32( 0 ), 1UL << 40 ), ( 1UL << 40 ) - 1 );
+
+    // The batch form gives the same answers
+    const vector<Wrap32> seqnos { Wrap32( 1 ), Wrap32( UINT32_MAX ), Wrap32( 7 ), Wrap32( 1U << 31 ), Wrap32( 0 ) };
+    for ( const uint64_t checkpoint : { 0UL, 5UL, UINT32_MAX + 3UL, 7UL << 33 } ) {
+      vector<uint64_t> absolute( seqnos.size() );
+      Wrap32::unwrap( seqnos, Wrap32( 3 ), checkpoint, absolute );
+      for ( size_t i = 0; i < seqnos.size(); ++i ) {
+        test_should_be( absolute[i], seqnos[i].unwrap( Wrap32( 3 ), checkpoint ) );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
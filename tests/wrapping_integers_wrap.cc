@@ -0,0 +1,28 @@
+#include "wrapping_integers.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+// wrap() is usable at compile time
+static_assert( Wrap32::wrap( 3ULL << 32, Wrap32 { 0 } ) == Wrap32 { 0 } );
+static_assert( Wrap32::wrap( 17, Wrap32 { 15 } ) == Wrap32 { 32 } );
+
+int main()
+{
+  try {
+    test_should_be( Wrap32::wrap( 3 * ( 1LL << 32 ), Wrap32 { 0 } ), Wrap32 { 0 } );
+    test_should_be( Wrap32::wrap( 3 * ( 1LL << 32 ) + 17, Wrap32 { 15 } ), Wrap32 { 32 } );
+    test_should_be( Wrap32::wrap( 7 * ( 1LL << 32 ) - 2, Wrap32 { 15 } ), Wrap32 { 13 } );
+    test_should_be( Wrap32::wrap( UINT32_MAX, Wrap32 { 1 } ), Wrap32 { 0 } );
+    test_should_be( Wrap32::wrap( 1ULL << 63, Wrap32 { 7 } ), Wrap32 { 7 } );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -1,6 +1,7 @@
 #include "address.hh"
 
 #include "exception.hh"
+#include "ipv4_endpoint.hh"
 
 #include <arpa/inet.h>
 #include <array>
@@ -104,6 +105,13 @@ Address::Address( const string& ip, const uint16_t port )
 // accessors
 pair<string, uint16_t> Address::ip_port() const
 {
+  // IPv4 is formatted directly, without a trip through getnameinfo
+  if ( _address.storage.ss_family == AF_INET ) {
+    const IPv4Endpoint endpoint = IPv4Endpoint::from_raw( _address );
+    array<char, IPv4Endpoint::kMaxStringLength> ip {};
+    return { { ip.data(), endpoint.format_ip( ip ) }, endpoint.port };
+  }
+
   array<char, NI_MAXHOST> ip {};
   array<char, NI_MAXSERV> port {};
 
@@ -121,8 +129,20 @@ pair<string, uint16_t> Address::ip_port() const
   return { ip.data(), stoi( port.data() ) };
 }
 
+uint16_t Address::port() const
+{
+  if ( _address.storage.ss_family == AF_INET ) {
+    return IPv4Endpoint::from_raw( _address ).port;
+  }
+  return ip_port().second;
+}
+
 string Address::to_string() const
 {
+  if ( _address.storage.ss_family == AF_INET ) {
+    return IPv4Endpoint::from_raw( _address ).to_string();
+  }
+
   const auto ip_and_port = ip_port();
   return ip_and_port.first + ":" + ::to_string( ip_and_port.second );
 }
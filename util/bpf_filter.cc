@@ -0,0 +1,119 @@
+#include "bpf_filter.hh"
+
+#include <linux/if_ether.h>
+#include <netinet/in.h>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+// Ethernet and IPv4 header offsets used by the filters
+constexpr uint32_t kEthertypeOffset = 12;
+constexpr uint32_t kIPv4Offset = 14;
+constexpr uint32_t kIPv4ProtocolOffset = kIPv4Offset + 9;
+constexpr uint32_t kIPv4FragmentOffset = kIPv4Offset + 6;
+constexpr uint32_t kIPv4FragmentMask = 0x1fff;
+} // namespace
+
+void BPFFilter::add( const uint16_t code,
+                     const uint32_t k,
+                     const uint8_t jt,
+                     const uint8_t jf,
+                     const bool jt_reject,
+                     const bool jf_reject )
+{
+  code_.push_back( { { code, jt, jf, k }, jt_reject, jf_reject } );
+}
+
+void BPFFilter::require_equal( const uint32_t k )
+{
+  add( BPF_JMP | BPF_JEQ | BPF_K, k, 0, 0, false, true ); // NOLINT(*-bitwise)
+}
+
+BPFFilter& BPFFilter::ethertype( const uint16_t ethertype )
+{
+  add( BPF_LD | BPF_H | BPF_ABS, kEthertypeOffset ); // NOLINT(*-bitwise)
+  require_equal( ethertype );
+  return *this;
+}
+
+BPFFilter& BPFFilter::ipv4_protocol( const uint8_t protocol )
+{
+  ethertype( ETH_P_IP );
+  add( BPF_LD | BPF_B | BPF_ABS, kIPv4ProtocolOffset ); // NOLINT(*-bitwise)
+  require_equal( protocol );
+  return *this;
+}
+
+BPFFilter& BPFFilter::port( const uint16_t port )
+{
+  ethertype( ETH_P_IP );
+
+  // TCP or UDP
+  add( BPF_LD | BPF_B | BPF_ABS, kIPv4ProtocolOffset );             // NOLINT(*-bitwise)
+  add( BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_TCP, 1, 0 );              // NOLINT(*-bitwise)
+  add( BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_UDP, 0, 0, false, true ); // NOLINT(*-bitwise)
+
+  // later fragments carry no ports
+  add( BPF_LD | BPF_H | BPF_ABS, kIPv4FragmentOffset );                    // NOLINT(*-bitwise)
+  add( BPF_JMP | BPF_JSET | BPF_K, kIPv4FragmentMask, 0, 0, true, false ); // NOLINT(*-bitwise)
+
+  // X = IPv4 header length; ports are the first two halfwords after it
+  add( BPF_LDX | BPF_B | BPF_MSH, kIPv4Offset );    // NOLINT(*-bitwise)
+  add( BPF_LD | BPF_H | BPF_IND, kIPv4Offset );     // NOLINT(*-bitwise)
+  add( BPF_JMP | BPF_JEQ | BPF_K, port, 2, 0 );     // NOLINT(*-bitwise)
+  add( BPF_LD | BPF_H | BPF_IND, kIPv4Offset + 2 ); // NOLINT(*-bitwise)
+  require_equal( port );
+  return *this;
+}
+
+BPFFilter& BPFFilter::destination_mac( const array<uint8_t, 6>& mac )
+{
+  const uint32_t high = ( uint32_t { mac[0] } << 24 ) | ( uint32_t { mac[1] } << 16 ) // NOLINT(*-bitwise)
+                        | ( uint32_t { mac[2] } << 8 ) | mac[3];                      // NOLINT(*-bitwise)
+  const uint32_t low = ( uint32_t { mac[4] } << 8 ) | mac[5];                         // NOLINT(*-bitwise)
+
+  add( BPF_LD | BPF_W | BPF_ABS, 0 ); // NOLINT(*-bitwise)
+  require_equal( high );
+  add( BPF_LD | BPF_H | BPF_ABS, 4 ); // NOLINT(*-bitwise)
+  require_equal( low );
+  return *this;
+}
+
+BPFFilter BPFFilter::reject_all()
+{
+  BPFFilter ret;
+  ret.reject_all_ = true;
+  return ret;
+}
+
+vector<sock_filter> BPFFilter::program( const uint32_t snaplen ) const
+{
+  if ( reject_all_ ) {
+    return { { BPF_RET | BPF_K, 0, 0, 0 } }; // NOLINT(*-bitwise)
+  }
+
+  // layout: the conditions, then "accept", then "reject"
+  const size_t reject_index = code_.size() + 1;
+
+  vector<sock_filter> ret;
+  ret.reserve( code_.size() + 2 );
+  for ( size_t i = 0; i < code_.size(); ++i ) {
+    sock_filter insn = code_[i].insn;
+    const size_t to_reject = reject_index - ( i + 1 );
+    if ( to_reject > UINT8_MAX ) {
+      throw runtime_error( "BPFFilter: program too long for conditional jumps" );
+    }
+    if ( code_[i].jt_reject ) {
+      insn.jt = to_reject;
+    }
+    if ( code_[i].jf_reject ) {
+      insn.jf = to_reject;
+    }
+    ret.push_back( insn );
+  }
+
+  ret.push_back( { BPF_RET | BPF_K, 0, 0, snaplen } ); // NOLINT(*-bitwise)
+  ret.push_back( { BPF_RET | BPF_K, 0, 0, 0 } );       // NOLINT(*-bitwise)
+  return ret;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <linux/filter.h>
+#include <vector>
+
+//! \brief Builder for classic [BPF](\ref man7::socket) programs that run in the kernel on each received frame
+//! \details Each added condition must hold for a frame to be accepted (they are ANDed in the order added).
+//! Offsets assume frames start at the Ethernet header, as on a `SOCK_RAW` PacketSocket.
+//!
+//!     PacketSocket sock { SOCK_RAW, htons( ETH_P_ALL ) };
+//!     sock.attach_filter( BPFFilter {}.ipv4_protocol( IPPROTO_UDP ).port( 53 ) );
+class BPFFilter
+{
+  //! An instruction whose conditional jumps may target the final "reject" instruction
+  struct Instruction
+  {
+    sock_filter insn;
+    bool jt_reject;
+    bool jf_reject;
+  };
+
+  std::vector<Instruction> code_ {};
+  bool reject_all_ {};
+
+  void add( uint16_t code,
+            uint32_t k,
+            uint8_t jt = 0,
+            uint8_t jf = 0,
+            bool jt_reject = false,
+            bool jf_reject = false );
+
+  //! accumulator == k, else reject
+  void require_equal( uint32_t k );
+
+public:
+  //! Accept frames whose EtherType (host byte order, e.g. ETH_P_IP) is `ethertype`
+  BPFFilter& ethertype( uint16_t ethertype );
+
+  //! Accept IPv4 packets carrying `protocol` (e.g. IPPROTO_UDP)
+  BPFFilter& ipv4_protocol( uint8_t protocol );
+
+  //! Accept unfragmented (or first-fragment) IPv4 TCP or UDP packets with source or destination port `port`
+  BPFFilter& port( uint16_t port );
+
+  //! Accept frames addressed to Ethernet address `mac`
+  BPFFilter& destination_mac( const std::array<uint8_t, 6>& mac );
+
+  //! A filter that accepts nothing (e.g. to hold a socket quiet while it is being set up)
+  static BPFFilter reject_all();
+
+  //! \brief Assemble the program
+  //! \param[in] snaplen is the number of bytes of each accepted frame to deliver
+  std::vector<sock_filter> program( uint32_t snaplen = UINT32_MAX ) const;
+};
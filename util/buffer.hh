@@ -1,23 +1,93 @@
 #pragma once
 
 #include <memory>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 
 class Buffer
 {
   std::shared_ptr<std::string> buffer_;
+  size_t offset_ {};                    // a slice sees only `length_` bytes from `offset_`...
+  size_t length_ { std::string::npos }; // ... or, if npos, the whole string from `offset_`
+  size_t headroom_ {};                  // bytes just before `offset_` that are free for prepend()...
+  std::shared_ptr<size_t> front_ {};    // ... while this is `offset_`: copies share it, the first prepend() moves it
+
+  bool is_slice() const { return offset_ != 0 or length_ != std::string::npos; }
 
 public:
   // NOLINTBEGIN(*-explicit-*)
 
   Buffer( std::string str = {} ) : buffer_( make_shared<std::string>( std::move( str ) ) ) {}
-  operator std::string_view() const { return *buffer_; }
-  operator std::string&() { return *buffer_; }
+  operator std::string_view() const { return std::string_view { *buffer_ }.substr( offset_, length_ ); }
+
+  // A slice is copied into a string of its own first, so writing to it never touches the bytes it shared
+  operator std::string&()
+  {
+    if ( is_slice() ) {
+      buffer_ = std::make_shared<std::string>( std::string_view { *this } );
+      offset_ = 0;
+      length_ = std::string::npos;
+      headroom_ = 0;
+      front_.reset();
+    }
+    return *buffer_;
+  }
 
   // NOLINTEND(*-explicit-*)
 
-  std::string&& release() { return std::move( *buffer_ ); }
-  size_t size() const { return buffer_->size(); }
-  size_t length() const { return buffer_->length(); }
-  bool empty() const { return buffer_->empty(); }
+  // A copy of `data` with `headroom` free bytes in front of it, for headers to be prepended in place
+  static Buffer with_headroom( size_t headroom, std::string_view data )
+  {
+    std::string str;
+    str.reserve( headroom + data.size() );
+    str.append( headroom, 0 );
+    str.append( data );
+    Buffer ret { std::move( str ) };
+    ret.offset_ = headroom;
+    ret.headroom_ = headroom;
+    ret.front_ = std::make_shared<size_t>( headroom );
+    return ret;
+  }
+
+  // `length` bytes from `offset`, sharing (not copying) this Buffer's string. The caller may give the slice
+  // the `headroom` bytes in front of it (only if no other slice uses them), up to any this Buffer had.
+  Buffer slice( size_t offset, size_t length, size_t headroom = 0 ) const
+  {
+    if ( offset + length > size() or headroom > offset + this->headroom() ) {
+      throw std::out_of_range( "Buffer::slice extends past the end of the Buffer" );
+    }
+    Buffer ret = *this;
+    ret.offset_ += offset;
+    ret.length_ = length;
+    ret.headroom_ = headroom;
+    ret.front_ = headroom > 0 ? std::make_shared<size_t>( ret.offset_ ) : nullptr;
+    return ret;
+  }
+
+  // Grow the front by `length` bytes of headroom, and return them to be written. This claims the headroom:
+  // other copies of this Buffer made before now have none left (see headroom()), so the bytes can't be
+  // overwritten through them; copies of the result share what remains.
+  std::span<char> prepend( size_t length )
+  {
+    if ( length > headroom() ) {
+      throw std::out_of_range( "Buffer::prepend needs more headroom than the Buffer has" );
+    }
+    offset_ -= length;
+    headroom_ -= length;
+    if ( front_ ) {
+      *front_ = offset_;
+    }
+    if ( length_ != std::string::npos ) {
+      length_ += length;
+    }
+    return { buffer_->data() + offset_, length };
+  }
+
+  std::string&& release() { return std::move( static_cast<std::string&>( *this ) ); }
+  size_t size() const { return std::string_view { *this }.size(); }
+  size_t length() const { return size(); }
+  size_t headroom() const { return front_ and *front_ == offset_ ? headroom_ : 0; }
+  bool empty() const { return size() == 0; }
 };
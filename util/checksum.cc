@@ -0,0 +1,57 @@
+#include "checksum.hh"
+
+#include <bit>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+// Fold a ones'-complement sum to 16 bits
+uint16_t fold( uint64_t sum )
+{
+  sum = ( sum & 0xffffffff ) + ( sum >> 32 ); // NOLINT(*-bitwise)
+  sum = ( sum & 0xffffffff ) + ( sum >> 32 ); // NOLINT(*-bitwise)
+  sum = ( sum & 0xffff ) + ( sum >> 16 );     // NOLINT(*-bitwise)
+  sum = ( sum & 0xffff ) + ( sum >> 16 );     // NOLINT(*-bitwise)
+  return static_cast<uint16_t>( sum );
+}
+
+uint16_t swap_bytes( uint16_t word )
+{
+  return static_cast<uint16_t>( ( word << 8 ) | ( word >> 8 ) ); // NOLINT(*-bitwise)
+}
+
+} // namespace
+
+void InternetChecksum::add( string_view data )
+{
+  // Sum host-order 64-bit words with end-around carry; byte order only matters once folded (RFC 1071 2(B))
+  uint64_t sum = 0;
+  const char* p = data.data();
+  size_t n = data.size();
+  for ( ; n >= 8; p += 8, n -= 8 ) {
+    uint64_t word {};
+    memcpy( &word, p, 8 );
+    sum += word;
+    sum += sum < word;
+  }
+  if ( n > 0 ) {
+    uint64_t word {};
+    memcpy( &word, p, n );
+    sum += word;
+    sum += sum < word;
+  }
+
+  uint16_t folded = fold( sum );
+  if constexpr ( endian::native == endian::little ) {
+    folded = swap_bytes( folded );
+  }
+  sum_ += odd_ ? swap_bytes( folded ) : folded;
+  odd_ ^= ( data.size() % 2 ) != 0;
+}
+
+uint16_t InternetChecksum::value() const
+{
+  return static_cast<uint16_t>( ~fold( sum_ ) );
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+//! \brief The Internet checksum (RFC 1071): the ones'-complement sum of 16-bit big-endian words
+//! \details Data may be added in pieces of any length, each continuing where the last left off (a piece
+//! that starts at an odd offset is summed as if byte-swapped). Sums eight bytes at a time in host order.
+class InternetChecksum
+{
+  uint64_t sum_ {};
+  bool odd_ {}; // an odd number of bytes so far
+
+public:
+  //! Add one or two 16-bit words in host order (e.g. pseudo-header fields), at an even offset
+  void add_u16( uint16_t word ) { sum_ += word; }
+  void add_u32( uint32_t words ) { sum_ += ( words >> 16 ) + ( words & 0xffff ); } // NOLINT(*-bitwise)
+
+  //! Add the next bytes
+  void add( std::string_view data );
+
+  //! The checksum of everything added: zero if that included a correct checksum
+  uint16_t value() const;
+};
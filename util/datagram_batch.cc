@@ -0,0 +1,171 @@
+#include "datagram_batch.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <netinet/udp.h>
+#include <stdexcept>
+
+using namespace std;
+
+//! \param[in] capacity is the maximum number of datagrams (or GSO/GRO trains) in the batch
+//! \param[in] slot_size is the largest payload each slot can hold (at most kMaxSlotSize)
+DatagramBatch::DatagramBatch( const size_t capacity, const size_t slot_size )
+  : slot_size_( slot_size )
+  , storage_( capacity * slot_size, 0 )
+  , lengths_( capacity )
+  , segment_sizes_( capacity )
+  , truncated_( capacity )
+  , addresses_( capacity )
+  , address_lengths_( capacity )
+  , headers_( capacity )
+  , iovecs_( capacity )
+  , controls_( capacity )
+{
+  if ( capacity == 0 or slot_size == 0 or slot_size > kMaxSlotSize ) {
+    throw runtime_error( "DatagramBatch: invalid capacity or slot size" );
+  }
+}
+
+void DatagramBatch::push( const Address& destination, const string_view payload, const uint16_t segment_size )
+{
+  if ( full() ) {
+    throw runtime_error( "DatagramBatch::push: batch is full" );
+  }
+
+  if ( payload.size() > slot_size_ ) {
+    throw runtime_error( "DatagramBatch::push: payload larger than slot" );
+  }
+
+  if ( segment_size and ( payload.size() + segment_size - 1 ) / segment_size > kMaxSegments ) {
+    throw runtime_error( "DatagramBatch::push: payload would be split into more than kMaxSegments datagrams" );
+  }
+
+  memcpy( slot( count_ ), payload.data(), payload.size() );
+  lengths_[count_] = payload.size();
+  segment_sizes_[count_] = ( segment_size and segment_size < payload.size() ) ? segment_size : 0;
+  truncated_[count_] = false;
+  memcpy( &addresses_[count_].storage, static_cast<const sockaddr*>( destination ), destination.size() );
+  address_lengths_[count_] = destination.size();
+  ++count_;
+}
+
+string_view DatagramBatch::payload( const size_t index ) const
+{
+  if ( index >= count_ ) {
+    throw out_of_range( "DatagramBatch::payload" );
+  }
+  return { slot( index ), lengths_[index] };
+}
+
+Address DatagramBatch::address( const size_t index ) const
+{
+  if ( index >= count_ ) {
+    throw out_of_range( "DatagramBatch::address" );
+  }
+  return { addresses_[index], address_lengths_[index] };
+}
+
+uint16_t DatagramBatch::segment_size( const size_t index ) const
+{
+  if ( index >= count_ ) {
+    throw out_of_range( "DatagramBatch::segment_size" );
+  }
+  return segment_sizes_[index];
+}
+
+bool DatagramBatch::truncated( const size_t index ) const
+{
+  if ( index >= count_ ) {
+    throw out_of_range( "DatagramBatch::truncated" );
+  }
+  return truncated_[index];
+}
+
+size_t DatagramBatch::datagram_count( const size_t index ) const
+{
+  const size_t seg = segment_size( index );
+  if ( seg == 0 ) {
+    return 1;
+  }
+  return ( lengths_[index] + seg - 1 ) / seg;
+}
+
+string_view DatagramBatch::datagram( const size_t index, const size_t n ) const
+{
+  const string_view whole = payload( index );
+  const size_t seg = segment_sizes_[index];
+  if ( seg == 0 ) {
+    if ( n != 0 ) {
+      throw out_of_range( "DatagramBatch::datagram" );
+    }
+    return whole;
+  }
+
+  if ( n * seg >= whole.size() ) {
+    throw out_of_range( "DatagramBatch::datagram" );
+  }
+  return whole.substr( n * seg, seg );
+}
+
+// point every header at its slot, address and control buffer, ready for recvmmsg
+span<mmsghdr> DatagramBatch::prepare_recv()
+{
+  for ( size_t i = 0; i < capacity(); ++i ) {
+    iovecs_[i] = { slot( i ), slot_size_ };
+    headers_[i] = {};
+    headers_[i].msg_hdr.msg_name = &addresses_[i].storage;
+    headers_[i].msg_hdr.msg_namelen = sizeof( addresses_[i].storage );
+    headers_[i].msg_hdr.msg_iov = &iovecs_[i];
+    headers_[i].msg_hdr.msg_iovlen = 1;
+    headers_[i].msg_hdr.msg_control = controls_[i].data.data();
+    headers_[i].msg_hdr.msg_controllen = controls_[i].data.size();
+  }
+  count_ = 0;
+  return headers_;
+}
+
+void DatagramBatch::finish_recv( const size_t count )
+{
+  for ( size_t i = 0; i < count; ++i ) {
+    msghdr& hdr = headers_[i].msg_hdr;
+    truncated_[i] = hdr.msg_flags & MSG_TRUNC; // NOLINT(*-bitwise)
+    lengths_[i] = min<size_t>( headers_[i].msg_len, slot_size_ );
+    address_lengths_[i] = hdr.msg_namelen;
+    segment_sizes_[i] = 0;
+
+    for ( cmsghdr* cmsg = CMSG_FIRSTHDR( &hdr ); cmsg != nullptr; cmsg = CMSG_NXTHDR( &hdr, cmsg ) ) {
+      if ( cmsg->cmsg_level == SOL_UDP and cmsg->cmsg_type == UDP_GRO ) {
+        int gso_size {};
+        memcpy( &gso_size, CMSG_DATA( cmsg ), sizeof( gso_size ) );
+        if ( gso_size > 0 and static_cast<size_t>( gso_size ) < lengths_[i] ) {
+          segment_sizes_[i] = gso_size;
+        }
+      }
+    }
+  }
+  count_ = count;
+}
+
+// point the headers for slots [first, size()) at their payloads, adding UDP_SEGMENT where requested
+span<mmsghdr> DatagramBatch::prepare_send( const size_t first )
+{
+  for ( size_t i = first; i < count_; ++i ) {
+    iovecs_[i] = { slot( i ), lengths_[i] };
+    headers_[i] = {};
+    headers_[i].msg_hdr.msg_name = &addresses_[i].storage;
+    headers_[i].msg_hdr.msg_namelen = address_lengths_[i];
+    headers_[i].msg_hdr.msg_iov = &iovecs_[i];
+    headers_[i].msg_hdr.msg_iovlen = 1;
+
+    if ( segment_sizes_[i] ) {
+      headers_[i].msg_hdr.msg_control = controls_[i].data.data();
+      headers_[i].msg_hdr.msg_controllen = CMSG_SPACE( sizeof( uint16_t ) );
+      cmsghdr* cmsg = CMSG_FIRSTHDR( &headers_[i].msg_hdr );
+      cmsg->cmsg_level = SOL_UDP;
+      cmsg->cmsg_type = UDP_SEGMENT;
+      cmsg->cmsg_len = CMSG_LEN( sizeof( uint16_t ) );
+      memcpy( CMSG_DATA( cmsg ), &segment_sizes_[i], sizeof( uint16_t ) );
+    }
+  }
+  return span<mmsghdr>( headers_ ).subspan( first, count_ - first );
+}
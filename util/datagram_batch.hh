@@ -0,0 +1,99 @@
+#pragma once
+
+#include "address.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <vector>
+
+//! \brief Pooled storage for moving many datagrams per syscall.
+//! \details A DatagramBatch owns a fixed number of equally-sized slots, allocated once. It is filled by
+//! DatagramSocket::recv_batch() via [recvmmsg(2)](\ref man2::recvmmsg), or filled with push() and drained by
+//! DatagramSocket::send_batch() via [sendmmsg(2)](\ref man2::sendmmsg).
+//!
+//! With UDP generic segmentation offload, one slot may carry several same-size datagrams: on send, a nonzero
+//! `segment_size` asks the kernel to split the slot (UDP_SEGMENT); on receive from a socket with
+//! UDPSocket::set_gro() enabled, segment_size() reports the size of each coalesced datagram (UDP_GRO). The
+//! kernel coalesces up to 64 KiB into one slot, so a batch received with GRO needs slots of kMaxSlotSize.
+class DatagramBatch
+{
+  friend class DatagramSocket;
+
+  size_t slot_size_;
+  size_t count_ {};
+
+  std::string storage_;                    // capacity * slot_size_ bytes, one slot per datagram
+  std::vector<size_t> lengths_;            // bytes used in each slot
+  std::vector<uint16_t> segment_sizes_;    // GSO/GRO segment size of each slot (0 = single datagram)
+  std::vector<bool> truncated_;            // recv: the datagram (or train) didn't fit in its slot
+  std::vector<Address::Raw> addresses_;    // source (recv) or destination (send) of each slot
+  std::vector<socklen_t> address_lengths_; // length of each address
+
+  // scratch space for the syscalls, rebuilt on each call so the batch can be moved freely
+  std::vector<mmsghdr> headers_;
+  std::vector<iovec> iovecs_;
+
+  // ancillary data carrying the UDP_SEGMENT (send) or UDP_GRO (recv) segment size
+  struct alignas( cmsghdr ) Control
+  {
+    std::array<char, CMSG_SPACE( sizeof( int ) )> data;
+  };
+  std::vector<Control> controls_;
+
+  char* slot( size_t index ) { return storage_.data() + index * slot_size_; }
+  const char* slot( size_t index ) const { return storage_.data() + index * slot_size_; }
+
+  // prepare headers for recvmmsg/sendmmsg starting at slot `first`
+  std::span<mmsghdr> prepare_recv();
+  std::span<mmsghdr> prepare_send( size_t first );
+
+  // record the results of a successful recvmmsg
+  void finish_recv( size_t count );
+
+public:
+  //! Large enough for any UDP datagram, or for a GRO-coalesced train of datagrams
+  static constexpr size_t kMaxSlotSize = 65535;
+  //! Matches the buffer used by DatagramSocket::recv()
+  static constexpr size_t kDefaultSlotSize = 16384;
+  //! Most datagrams the kernel will split one slot into (UDP_MAX_SEGMENTS)
+  static constexpr size_t kMaxSegments = 64;
+
+  //! \param[in] capacity is the maximum number of datagrams (or GSO/GRO trains) in the batch
+  //! \param[in] slot_size is the largest payload each slot can hold
+  explicit DatagramBatch( size_t capacity, size_t slot_size = kDefaultSlotSize );
+
+  size_t capacity() const { return lengths_.size(); } //!< maximum number of slots
+  size_t slot_size() const { return slot_size_; }      //!< bytes per slot
+  size_t size() const { return count_; }               //!< number of slots in use
+  bool empty() const { return count_ == 0; }           //!< no slots in use
+  bool full() const { return count_ == capacity(); }   //!< all slots in use
+
+  //! Forget all datagrams (the storage is kept for reuse)
+  void clear() { count_ = 0; }
+
+  //! \brief Queue a datagram to be sent with DatagramSocket::send_batch()
+  //! \param[in] destination is ignored by the kernel when the socket is connected
+  //! \param[in] payload is copied into the next free slot
+  //! \param[in] segment_size, if nonzero, asks the kernel to split `payload` into datagrams of this size
+  //! (into at most kMaxSegments of them)
+  void push( const Address& destination, std::string_view payload, uint16_t segment_size = 0 );
+
+  //! Contents of slot `index`
+  std::string_view payload( size_t index ) const;
+  //! Source (after recv_batch) or destination (after push) of slot `index`
+  Address address( size_t index ) const;
+  //! Size of each datagram coalesced into slot `index`, or 0 if the slot holds a single datagram
+  uint16_t segment_size( size_t index ) const;
+  //! Whether slot `index` holds only the first slot_size() bytes of what arrived (the rest was lost)
+  bool truncated( size_t index ) const;
+
+  //! Number of datagrams carried by slot `index` (more than one only with GSO/GRO)
+  size_t datagram_count( size_t index ) const;
+  //! The `n`th datagram carried by slot `index`
+  std::string_view datagram( size_t index, size_t n ) const;
+};
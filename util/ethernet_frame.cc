@@ -0,0 +1,102 @@
+#include "ethernet_frame.hh"
+#include "wire_io.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <span>
+
+using namespace std;
+
+namespace {
+
+// ARP's hardware and protocol types (RFC 826) for IPv4 over Ethernet
+constexpr uint16_t ARP_HARDWARE_ETHERNET = 1;
+
+using wire::get16;
+using wire::get32;
+using wire::Writer;
+
+EthernetAddress get_address( string_view bytes, size_t offset )
+{
+  EthernetAddress address {};
+  copy_n( bytes.begin() + static_cast<ptrdiff_t>( offset ), address.size(), address.begin() );
+  return address;
+}
+
+} // namespace
+
+string to_string( const EthernetAddress& address )
+{
+  array<char, 18> out {};
+  snprintf( out.data(),
+            out.size(),
+            "%02x:%02x:%02x:%02x:%02x:%02x",
+            address[0],
+            address[1],
+            address[2],
+            address[3],
+            address[4],
+            address[5] );
+  return out.data();
+}
+
+EthernetAddress EthernetHeaderView::destination() const
+{
+  return get_address( bytes_, 0 );
+}
+
+EthernetAddress EthernetHeaderView::source() const
+{
+  return get_address( bytes_, 6 );
+}
+
+uint16_t EthernetHeaderView::type() const
+{
+  return get16( bytes_, 12 );
+}
+
+optional<ARPMessage> parse_arp( string_view payload )
+{
+  if ( payload.size() < ARPMessage::LENGTH or get16( payload, 0 ) != ARP_HARDWARE_ETHERNET
+       or get16( payload, 2 ) != EthernetHeaderView::TYPE_IPv4 or payload[4] != 6 or payload[5] != 4 ) {
+    return {};
+  }
+  return ARPMessage { get16( payload, 6 ),
+                      get_address( payload, 8 ),
+                      get32( payload, 14 ),
+                      get_address( payload, 18 ),
+                      get32( payload, 24 ) };
+}
+
+Buffer serialize_arp_frame( const EthernetAddress& destination,
+                            const EthernetAddress& source,
+                            const ARPMessage& arp )
+{
+  string message( ARPMessage::LENGTH, 0 );
+  Writer out { message };
+  out.u16( ARP_HARDWARE_ETHERNET );
+  out.u16( EthernetHeaderView::TYPE_IPv4 );
+  out.u16( 6 << 8 | 4 ); // NOLINT(*-bitwise): hardware and protocol address lengths
+  out.u16( arp.opcode );
+  out.bytes( arp.sender_ethernet_address );
+  out.u32( arp.sender_ip_address );
+  out.bytes( arp.target_ethernet_address );
+  out.u32( arp.target_ip_address );
+  Buffer payload = Buffer::with_headroom( EthernetHeaderView::LENGTH, message );
+  return serialize_ethernet_frame( destination, source, EthernetHeaderView::TYPE_ARP, move( payload ) );
+}
+
+Buffer serialize_ethernet_frame( const EthernetAddress& destination,
+                                 const EthernetAddress& source,
+                                 uint16_t type,
+                                 Buffer payload )
+{
+  if ( payload.headroom() < EthernetHeaderView::LENGTH ) {
+    payload = Buffer::with_headroom( EthernetHeaderView::LENGTH, payload );
+  }
+  Writer out { payload.prepend( EthernetHeaderView::LENGTH ) };
+  out.bytes( destination );
+  out.bytes( source );
+  out.u16( type );
+  return payload;
+}
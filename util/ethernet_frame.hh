@@ -0,0 +1,68 @@
+#pragma once
+
+#include "buffer.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+//! A 48-bit Ethernet (MAC) address
+using EthernetAddress = std::array<uint8_t, 6>;
+
+//! The address every station on the link receives
+constexpr EthernetAddress ETHERNET_BROADCAST = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+//! Human-readable string, e.g., "02:00:00:00:00:01"
+std::string to_string( const EthernetAddress& address );
+
+//! A read-only view of an Ethernet II header, decoding fields on access
+class EthernetHeaderView
+{
+  std::string_view bytes_;
+
+public:
+  static constexpr size_t LENGTH = 14;          //!< destination, source, type
+  static constexpr uint16_t TYPE_IPv4 = 0x0800; //!< type() of a frame carrying an IPv4 datagram
+  static constexpr uint16_t TYPE_ARP = 0x0806;  //!< type() of a frame carrying an ARP message
+
+  explicit EthernetHeaderView( std::string_view bytes ) : bytes_( bytes ) {}
+
+  EthernetAddress destination() const;
+  EthernetAddress source() const;
+  uint16_t type() const;
+};
+
+//! An ARP message (RFC 826) for IPv4 over Ethernet, the only kind this stack speaks
+struct ARPMessage
+{
+  static constexpr size_t LENGTH = 28;
+  static constexpr uint16_t OPCODE_REQUEST = 1;
+  static constexpr uint16_t OPCODE_REPLY = 2;
+
+  uint16_t opcode {};
+  EthernetAddress sender_ethernet_address {};
+  uint32_t sender_ip_address {}; //!< host byte order
+  EthernetAddress target_ethernet_address {};
+  uint32_t target_ip_address {}; //!< host byte order
+};
+
+//! \brief Parse an ARP message from the payload of an Ethernet frame
+//! \returns empty if it is truncated, or not for IPv4 over Ethernet
+std::optional<ARPMessage> parse_arp( std::string_view payload );
+
+//! An Ethernet frame carrying `arp`
+Buffer serialize_arp_frame( const EthernetAddress& destination,
+                            const EthernetAddress& source,
+                            const ARPMessage& arp );
+
+//! \brief The Ethernet frame carrying `payload` from `source` to `destination`
+//! \details The header is written into the payload's headroom (see Buffer::with_headroom()), so the frame shares
+//! the payload's storage; a payload without enough headroom (or whose headroom another frame has taken) is
+//! copied once into a Buffer that has it.
+Buffer serialize_ethernet_frame( const EthernetAddress& destination,
+                                 const EthernetAddress& source,
+                                 uint16_t type,
+                                 Buffer payload );
@@ -0,0 +1,139 @@
+#include "event_loop.hh"
+
+#include "exception.hh"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+// epoll_event::data carries the descriptor number and the generation of its registration
+uint64_t tag( int fd, uint32_t generation )
+{
+  return ( uint64_t { generation } << 32 ) | static_cast<uint32_t>( fd ); // NOLINT(*-bitwise)
+}
+
+int tag_fd( uint64_t tag )
+{
+  return static_cast<int>( static_cast<uint32_t>( tag ) );
+}
+
+uint32_t tag_generation( uint64_t tag )
+{
+  return static_cast<uint32_t>( tag >> 32 ); // NOLINT(*-bitwise)
+}
+} // namespace
+
+EventLoop::EventLoop()
+  : epoll_( CheckSystemCall( "epoll_create1", epoll_create1( EPOLL_CLOEXEC ) ) )
+  , wakeup_( CheckSystemCall( "eventfd", eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ), true ) // NOLINT(*-bitwise)
+  , events_( kMaxEvents )
+{
+  epoll_event event {};
+  event.events = EPOLLIN;
+  event.data.u64 = tag( wakeup_.fd_num(), 0 );
+  CheckSystemCall( "epoll_ctl", epoll_ctl( epoll_.fd_num(), EPOLL_CTL_ADD, wakeup_.fd_num(), &event ) );
+}
+
+void EventLoop::add( const FileDescriptor& fd, uint32_t events, Handler handler )
+{
+  if ( handlers_.contains( fd.fd_num() ) ) {
+    throw runtime_error( "EventLoop: descriptor " + to_string( fd.fd_num() ) + " is already registered" );
+  }
+
+  const uint32_t generation = ++next_generation_;
+  epoll_event event {};
+  event.events = events;
+  event.data.u64 = tag( fd.fd_num(), generation );
+  CheckSystemCall( "epoll_ctl", epoll_ctl( epoll_.fd_num(), EPOLL_CTL_ADD, fd.fd_num(), &event ) );
+  handlers_.emplace( fd.fd_num(), Registration { generation, make_unique<Handler>( move( handler ) ) } );
+}
+
+void EventLoop::modify( const FileDescriptor& fd, uint32_t events )
+{
+  const auto it = handlers_.find( fd.fd_num() );
+  if ( it == handlers_.end() ) {
+    throw runtime_error( "EventLoop: descriptor " + to_string( fd.fd_num() ) + " is not registered" );
+  }
+
+  epoll_event event {};
+  event.events = events;
+  event.data.u64 = tag( fd.fd_num(), it->second.generation );
+  CheckSystemCall( "epoll_ctl", epoll_ctl( epoll_.fd_num(), EPOLL_CTL_MOD, fd.fd_num(), &event ) );
+}
+
+void EventLoop::remove( const FileDescriptor& fd )
+{
+  const auto it = handlers_.find( fd.fd_num() );
+  if ( it == handlers_.end() ) {
+    return;
+  }
+
+  CheckSystemCall( "epoll_ctl", epoll_ctl( epoll_.fd_num(), EPOLL_CTL_DEL, fd.fd_num(), nullptr ) );
+  // the handler may be the one running now, so keep it alive until dispatch finishes
+  retired_.push_back( move( it->second.handler ) );
+  handlers_.erase( it );
+}
+
+void EventLoop::post( Task task )
+{
+  bool was_empty {};
+  {
+    const lock_guard lock { posted_mutex_ };
+    was_empty = posted_.empty();
+    posted_.push_back( move( task ) );
+  }
+
+  if ( was_empty ) {
+    const uint64_t one = 1;
+    CheckSystemCall( "write", static_cast<int>( ::write( wakeup_.fd_num(), &one, sizeof( one ) ) ) );
+  }
+}
+
+void EventLoop::run_posted()
+{
+  uint64_t count {};
+  if ( ::read( wakeup_.fd_num(), &count, sizeof( count ) ) < 0 and errno != EAGAIN ) {
+    throw unix_error { "read" };
+  }
+
+  vector<Task> tasks;
+  {
+    const lock_guard lock { posted_mutex_ };
+    tasks.swap( posted_ );
+  }
+  for ( auto& task : tasks ) {
+    task();
+  }
+}
+
+bool EventLoop::wait_next_event( int timeout_ms )
+{
+  const int count = epoll_wait( epoll_.fd_num(), events_.data(), static_cast<int>( events_.size() ), timeout_ms );
+  if ( count < 0 ) {
+    if ( errno == EINTR ) {
+      return true;
+    }
+    throw unix_error { "epoll_wait" };
+  }
+
+  for ( int i = 0; i < count; ++i ) {
+    const epoll_event& event = events_.at( i );
+    const int fd = tag_fd( event.data.u64 );
+    if ( fd == wakeup_.fd_num() ) {
+      run_posted();
+      continue;
+    }
+
+    // skip events for registrations removed (or replaced) by an earlier handler in this batch
+    const auto it = handlers_.find( fd );
+    if ( it == handlers_.end() or it->second.generation != tag_generation( event.data.u64 ) ) {
+      continue;
+    }
+    ( *it->second.handler )( event.events );
+  }
+
+  retired_.clear();
+  return count > 0;
+}
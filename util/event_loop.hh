@@ -0,0 +1,72 @@
+#pragma once
+
+#include "file_descriptor.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sys/epoll.h>
+#include <unordered_map>
+#include <vector>
+
+//! \brief Single-threaded readiness loop over [epoll(7)](\ref man7::epoll)
+//! \details Register each non-blocking descriptor with the events of interest (EPOLLIN, EPOLLOUT, ...);
+//! wait_next_event() calls the handlers of those that are ready. Handlers may add, modify or remove any
+//! registration, including their own. Other threads hand work to the loop with post().
+//!
+//!     EventLoop loop;
+//!     loop.add( socket, EPOLLIN, [&]( uint32_t ) { socket.read( buffer ); } );
+//!     while ( loop.size() ) {
+//!       loop.wait_next_event( -1 );
+//!     }
+class EventLoop
+{
+public:
+  //! Called with the ready events (which may include EPOLLERR or EPOLLHUP even if not requested)
+  using Handler = std::function<void( uint32_t events )>;
+  using Task = std::function<void()>;
+
+  EventLoop();
+
+  //! Watch `fd` for `events`; the loop does not keep `fd` open, so remove() it before closing it
+  void add( const FileDescriptor& fd, uint32_t events, Handler handler );
+
+  //! Change the events watched on `fd`
+  void modify( const FileDescriptor& fd, uint32_t events );
+
+  //! Stop watching `fd` (pending events for it are dropped)
+  void remove( const FileDescriptor& fd );
+
+  //! Run `task` on the loop thread during the next wait_next_event(); safe to call from any thread
+  void post( Task task );
+
+  //! \brief Wait up to `timeout_ms` (-1 = forever) for ready descriptors or posted tasks, then run them
+  //! \returns false if the wait timed out with nothing to do
+  bool wait_next_event( int timeout_ms );
+
+  //! Number of registered descriptors
+  size_t size() const { return handlers_.size(); }
+
+private:
+  struct Registration
+  {
+    uint32_t generation {}; // distinguishes reuses of the same descriptor number
+    std::unique_ptr<Handler> handler {}; // on the heap, so it stays put if removed while running
+  };
+
+  static constexpr size_t kMaxEvents = 256;
+
+  FileDescriptor epoll_;
+  FileDescriptor wakeup_; // eventfd, readable while tasks are posted
+  std::unordered_map<int, Registration> handlers_ {};
+  std::vector<std::unique_ptr<Handler>> retired_ {}; // handlers removed during dispatch, destroyed afterwards
+  std::vector<epoll_event> events_;
+  uint32_t next_generation_ {};
+
+  std::mutex posted_mutex_ {};
+  std::vector<Task> posted_ {};
+
+  void run_posted();
+};
@@ -47,6 +47,13 @@ FileDescriptor::FDWrapper::FDWrapper( int fd ) : fd_( fd )
   non_blocking_ = flags & O_NONBLOCK;                                 // NOLINT(*-bitwise)
 }
 
+FileDescriptor::FDWrapper::FDWrapper( int fd, bool non_blocking ) : fd_( fd ), non_blocking_( non_blocking )
+{
+  if ( fd < 0 ) {
+    throw runtime_error( "invalid fd number:" + to_string( fd ) );
+  }
+}
+
 void FileDescriptor::FDWrapper::close()
 {
   CheckSystemCall( "close", ::close( fd_ ) );
@@ -69,6 +76,11 @@ FileDescriptor::FDWrapper::~FDWrapper()
 // fd is the file descriptor number returned by [open(2)](\ref man2::open) or similar
 FileDescriptor::FileDescriptor( int fd ) : internal_fd_( make_shared<FDWrapper>( fd ) ) {}
 
+// fd is a file descriptor whose O_NONBLOCK flag is already known to be `non_blocking`
+FileDescriptor::FileDescriptor( int fd, bool non_blocking )
+  : internal_fd_( make_shared<FDWrapper>( fd, non_blocking ) )
+{}
+
 // Private constructor used by duplicate()
 FileDescriptor::FileDescriptor( shared_ptr<FDWrapper> other_shared_ptr ) : internal_fd_( move( other_shared_ptr ) )
 {}
@@ -88,6 +100,7 @@ void FileDescriptor::read( string& buffer )
   const ssize_t bytes_read = ::read( fd_num(), buffer.data(), buffer.size() );
   if ( bytes_read < 0 ) {
     if ( internal_fd_->non_blocking_ and ( errno == EAGAIN or errno == EINPROGRESS ) ) {
+      buffer.clear(); // nothing available yet
       return;
     }
     throw unix_error { "read" };
@@ -169,7 +182,7 @@ size_t FileDescriptor::write( const vector<string_view>& buffers )
     = CheckSystemCall( "writev", ::writev( fd_num(), iovecs.data(), static_cast<int>( iovecs.size() ) ) );
   register_write();
 
-  if ( bytes_written == 0 and total_size != 0 ) {
+  if ( bytes_written == 0 and total_size != 0 and not internal_fd_->non_blocking_ ) {
     throw runtime_error( "write returned 0 given non-empty input buffer" );
   }
 
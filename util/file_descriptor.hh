@@ -22,6 +22,8 @@ class FileDescriptor
 
     // Construct from a file descriptor number returned by the kernel
     explicit FDWrapper( int fd );
+    // Construct when the O_NONBLOCK state is already known (skips the fcntl)
+    FDWrapper( int fd, bool non_blocking );
     // Closes the file descriptor upon destruction
     ~FDWrapper();
     // Calls [close(2)](\ref man2::close) on FDWrapper::fd_
@@ -58,6 +60,9 @@ public:
   // Construct from a file descriptor number returned by the kernel
   explicit FileDescriptor( int fd );
 
+  // Construct from a file descriptor whose blocking mode is known, e.g. from accept4(SOCK_NONBLOCK)
+  FileDescriptor( int fd, bool non_blocking );
+
   // Free the std::shared_ptr; the FDWrapper destructor calls close() when the refcount goes to zero.
   ~FileDescriptor() = default;
 
@@ -66,7 +71,7 @@ public:
   void read( std::vector<std::unique_ptr<std::string>>& buffers );
 
   // Attempt to write a buffer
-  // returns number of bytes written
+  // returns number of bytes written (0 if a non-blocking descriptor would block)
   size_t write( std::string_view buffer );
   size_t write( const std::vector<std::string_view>& buffers );
 
@@ -86,6 +91,7 @@ public:
   int fd_num() const { return internal_fd_->fd_; }                        // underlying descriptor number
   bool eof() const { return internal_fd_->eof_; }                         // EOF flag state
   bool closed() const { return internal_fd_->closed_; }                   // closed flag state
+  bool non_blocking() const { return internal_fd_->non_blocking_; }       // non-blocking flag state
   unsigned int read_count() const { return internal_fd_->read_count_; }   // number of reads
   unsigned int write_count() const { return internal_fd_->write_count_; } // number of writes
 
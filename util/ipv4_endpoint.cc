@@ -0,0 +1,74 @@
+#include "ipv4_endpoint.hh"
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <netinet/in.h>
+#include <stdexcept>
+
+using namespace std;
+
+IPv4Endpoint IPv4Endpoint::from_address( const Address& address )
+{
+  const sockaddr_in* const sin = address.as<sockaddr_in>();
+  return { be32toh( sin->sin_addr.s_addr ), be16toh( sin->sin_port ) };
+}
+
+IPv4Endpoint IPv4Endpoint::from_raw( const Address::Raw& raw )
+{
+  if ( raw.storage.ss_family != AF_INET ) {
+    throw runtime_error( "IPv4Endpoint::from_raw called on non-IPv4 address" );
+  }
+
+  sockaddr_in sin {};
+  memcpy( &sin, &raw.storage, sizeof( sin ) );
+  return { be32toh( sin.sin_addr.s_addr ), be16toh( sin.sin_port ) };
+}
+
+Address IPv4Endpoint::to_address() const
+{
+  sockaddr_in sin {};
+  sin.sin_family = AF_INET;
+  sin.sin_addr.s_addr = htobe32( ip );
+  sin.sin_port = htobe16( port );
+  return { reinterpret_cast<const sockaddr*>( &sin ), sizeof( sin ) }; // NOLINT(*-reinterpret-cast)
+}
+
+size_t IPv4Endpoint::format_ip( span<char> out ) const
+{
+  array<char, kMaxStringLength> buf {};
+  char* p = buf.data();
+  for ( int shift = 24; shift >= 0; shift -= 8 ) {
+    p = to_chars( p, buf.data() + buf.size(), ( ip >> shift ) & 0xff ).ptr; // NOLINT(*-bitwise)
+    if ( shift ) {
+      *p++ = '.';
+    }
+  }
+
+  const size_t len = p - buf.data();
+  if ( out.size() < len ) {
+    throw runtime_error( "IPv4Endpoint::format_ip: output buffer too small" );
+  }
+  memcpy( out.data(), buf.data(), len );
+  return len;
+}
+
+size_t IPv4Endpoint::format( span<char> out ) const
+{
+  array<char, kMaxStringLength> buf {};
+  size_t len = format_ip( buf );
+  buf.at( len++ ) = ':';
+  len = to_chars( buf.data() + len, buf.data() + buf.size(), port ).ptr - buf.data();
+
+  if ( out.size() < len ) {
+    throw runtime_error( "IPv4Endpoint::format: output buffer too small" );
+  }
+  memcpy( out.data(), buf.data(), len );
+  return len;
+}
+
+string IPv4Endpoint::to_string() const
+{
+  array<char, kMaxStringLength> buf {};
+  return { buf.data(), format( buf ) };
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "address.hh"
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+
+//! \brief A trivially copyable IPv4 address and port, cheap to hash, compare and format
+//! \details Suitable as a key in connection tables. Both fields are in host byte order.
+struct IPv4Endpoint
+{
+  uint32_t ip {};   //!< numeric IPv4 address
+  uint16_t port {}; //!< port number
+
+  //! Longest formatted endpoint, "255.255.255.255:65535"
+  static constexpr size_t kMaxStringLength = 21;
+
+  //! Extract from an IPv4 Address (reads the sockaddr_in directly; no resolver calls)
+  static IPv4Endpoint from_address( const Address& address );
+  //! Extract from raw socket address storage, e.g. as filled in by recvfrom
+  static IPv4Endpoint from_raw( const Address::Raw& raw );
+
+  //! Convert back to an Address
+  Address to_address() const;
+
+  //! All 48 bits in one integer (ip in the high bits), preserving the ordering
+  uint64_t packed() const { return ( uint64_t { ip } << 16 ) | port; } // NOLINT(*-bitwise)
+
+  auto operator<=>( const IPv4Endpoint& other ) const = default;
+  bool operator==( const IPv4Endpoint& other ) const = default;
+
+  //! \brief Write the dotted-quad address into `out` without allocating
+  //! \returns the number of characters written (at most 15); `out` must hold at least that many
+  size_t format_ip( std::span<char> out ) const;
+
+  //! \brief Write "a.b.c.d:port" into `out` without allocating
+  //! \returns the number of characters written (at most kMaxStringLength)
+  size_t format( std::span<char> out ) const;
+
+  //! Human-readable string, e.g., "8.8.8.8:53"
+  std::string to_string() const;
+};
+
+//! The (local, remote) endpoints identifying a TCP connection or UDP flow
+struct IPv4FourTuple
+{
+  IPv4Endpoint local {};
+  IPv4Endpoint remote {};
+
+  auto operator<=>( const IPv4FourTuple& other ) const = default;
+  bool operator==( const IPv4FourTuple& other ) const = default;
+};
+
+//! 64-bit mixing function (the SplitMix64 finalizer): every input bit affects every output bit
+constexpr uint64_t mix64( uint64_t x )
+{
+  x ^= x >> 30; // NOLINT(*-bitwise)
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27; // NOLINT(*-bitwise)
+  x *= 0x94d049bb133111ebULL;
+  return x ^ ( x >> 31 ); // NOLINT(*-bitwise)
+}
+
+template<>
+struct std::hash<IPv4Endpoint>
+{
+  size_t operator()( const IPv4Endpoint& endpoint ) const noexcept { return mix64( endpoint.packed() ); }
+};
+
+template<>
+struct std::hash<IPv4FourTuple>
+{
+  size_t operator()( const IPv4FourTuple& tuple ) const noexcept
+  {
+    return mix64( tuple.local.packed() ^ mix64( tuple.remote.packed() ) ); // NOLINT(*-bitwise)
+  }
+};
@@ -0,0 +1,143 @@
+#include "packet_ring.hh"
+
+#include "exception.hh"
+
+#include <cstring>
+#include <linux/if_packet.h>
+#include <stdexcept>
+#include <sys/mman.h>
+
+using namespace std;
+
+namespace {
+// bytes of ring described by a config
+size_t ring_size( const optional<PacketRingConfig>& config )
+{
+  return config.has_value() ? size_t { config->block_size } * config->block_count : 0;
+}
+
+// TX frames start with a tpacket3_hdr; the kernel expects the payload right after it
+constexpr size_t kTxDataOffset = TPACKET_ALIGN( sizeof( tpacket3_hdr ) );
+
+// status words are shared with the kernel
+uint32_t load_status( const uint32_t& status )
+{
+  return __atomic_load_n( &status, __ATOMIC_ACQUIRE );
+}
+
+void store_status( uint32_t& status, uint32_t value )
+{
+  __atomic_store_n( &status, value, __ATOMIC_RELEASE );
+}
+} // namespace
+
+PacketRing::PacketRing( const int fd,
+                        const optional<PacketRingConfig>& rx,
+                        const optional<PacketRingConfig>& tx )
+  : map_( nullptr ), map_size_( ring_size( rx ) + ring_size( tx ) ), rx_( rx ), tx_( tx )
+{
+  if ( map_size_ == 0 ) {
+    throw runtime_error( "PacketRing: no RX or TX ring requested" );
+  }
+
+  void* const map = mmap( nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0 );
+  if ( map == MAP_FAILED ) {
+    throw unix_error { "mmap" };
+  }
+  map_ = static_cast<char*>( map );
+}
+
+PacketRing::~PacketRing()
+{
+  munmap( map_, map_size_ );
+}
+
+char* PacketRing::rx_block( const size_t index ) const
+{
+  return map_ + index * rx_->block_size;
+}
+
+size_t PacketRing::tx_frame_count() const
+{
+  return ring_size( tx_ ) / tx_->frame_size;
+}
+
+char* PacketRing::tx_frame( const size_t index ) const
+{
+  // frames never straddle blocks because block_size is a multiple of frame_size
+  return map_ + ring_size( rx_ ) + index * tx_->frame_size;
+}
+
+size_t PacketRing::max_tx_frame() const
+{
+  return tx_.has_value() ? tx_->frame_size - kTxDataOffset : 0;
+}
+
+size_t PacketRing::frames( vector<string_view>& out )
+{
+  if ( not rx_.has_value() ) {
+    throw runtime_error( "PacketRing::frames: no RX ring" );
+  }
+
+  size_t count = 0;
+  while ( rx_held_blocks_ < rx_->block_count ) {
+    char* const block = rx_block( rx_next_block_ );
+    auto* const desc = reinterpret_cast<tpacket_block_desc*>( block ); // NOLINT(*-reinterpret-cast)
+    if ( not( load_status( desc->hdr.bh1.block_status ) & TP_STATUS_USER ) ) { // NOLINT(*-bitwise)
+      break;
+    }
+
+    char* frame = block + desc->hdr.bh1.offset_to_first_pkt;
+    for ( uint32_t i = 0; i < desc->hdr.bh1.num_pkts; ++i ) {
+      const auto* const hdr = reinterpret_cast<const tpacket3_hdr*>( frame ); // NOLINT(*-reinterpret-cast)
+      out.emplace_back( frame + hdr->tp_mac, hdr->tp_snaplen );
+      frame += hdr->tp_next_offset;
+    }
+    count += desc->hdr.bh1.num_pkts;
+
+    ++rx_held_blocks_;
+    rx_next_block_ = ( rx_next_block_ + 1 ) % rx_->block_count;
+  }
+
+  return count;
+}
+
+void PacketRing::release()
+{
+  // the held blocks are the ones just behind rx_next_block_
+  size_t index = ( rx_next_block_ + rx_->block_count - rx_held_blocks_ ) % rx_->block_count;
+  for ( ; rx_held_blocks_ > 0; --rx_held_blocks_ ) {
+    auto* const desc = reinterpret_cast<tpacket_block_desc*>( rx_block( index ) ); // NOLINT(*-reinterpret-cast)
+    store_status( desc->hdr.bh1.block_status, TP_STATUS_KERNEL );
+    index = ( index + 1 ) % rx_->block_count;
+  }
+}
+
+bool PacketRing::queue( const string_view frame )
+{
+  if ( not tx_.has_value() ) {
+    throw runtime_error( "PacketRing::queue: no TX ring" );
+  }
+
+  if ( frame.size() > max_tx_frame() ) {
+    throw runtime_error( "PacketRing::queue: frame larger than TX slot" );
+  }
+
+  char* const slot = tx_frame( tx_next_frame_ );
+  auto* const hdr = reinterpret_cast<tpacket3_hdr*>( slot ); // NOLINT(*-reinterpret-cast)
+  const uint32_t status = load_status( hdr->tp_status );
+  if ( status == TP_STATUS_WRONG_FORMAT ) {
+    ++tx_rejected_frames_; // the kernel refused the frame last sent from this slot
+  } else if ( status != TP_STATUS_AVAILABLE ) {
+    return false;
+  }
+
+  memcpy( slot + kTxDataOffset, frame.data(), frame.size() );
+  hdr->tp_len = frame.size();
+  hdr->tp_snaplen = frame.size();
+  store_status( hdr->tp_status, TP_STATUS_SEND_REQUEST );
+
+  tx_next_frame_ = ( tx_next_frame_ + 1 ) % tx_frame_count();
+  ++tx_queued_frames_;
+  return true;
+}
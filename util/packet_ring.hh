@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+//! Geometry of a [TPACKET_V3](\ref man7::packet) ring
+struct PacketRingConfig
+{
+  uint32_t block_size = 1 << 20;  //!< bytes per block (a multiple of the page size)
+  uint32_t block_count = 16;      //!< number of blocks in the ring
+  uint32_t frame_size = 2048;     //!< bytes per frame slot (a multiple of 16 dividing block_size, for TX)
+  uint32_t block_timeout_ms = 10; //!< RX: hand a partly filled block to user space after this long
+};
+
+//! \brief A memory-mapped TPACKET_V3 RX and/or TX ring shared with the kernel
+//! \details Built by PacketSocket::enable_rings() after the rings have been requested with setsockopt.
+//! RX frames are read in place; TX frames are copied into free slots and sent with one syscall per flush.
+class PacketRing
+{
+  char* map_;
+  size_t map_size_;
+
+  std::optional<PacketRingConfig> rx_;
+  std::optional<PacketRingConfig> tx_;
+
+  size_t rx_next_block_ {};      // next block to examine
+  size_t rx_held_blocks_ {};     // blocks handed to user space and not yet released
+  size_t tx_next_frame_ {};      // next TX slot to fill
+  size_t tx_queued_frames_ {};   // slots marked SEND_REQUEST since the last flush
+  size_t tx_rejected_frames_ {}; // slots found in TP_STATUS_WRONG_FORMAT when reused
+
+  char* rx_block( size_t index ) const;
+  char* tx_frame( size_t index ) const;
+  size_t tx_frame_count() const;
+
+public:
+  //! mmap the rings already configured on `fd` (RX first, then TX, as the kernel lays them out)
+  PacketRing( int fd, const std::optional<PacketRingConfig>& rx, const std::optional<PacketRingConfig>& tx );
+  ~PacketRing();
+
+  PacketRing( const PacketRing& other ) = delete;
+  PacketRing& operator=( const PacketRing& other ) = delete;
+  PacketRing( PacketRing&& other ) = delete;
+  PacketRing& operator=( PacketRing&& other ) = delete;
+
+  //! \brief Append a view of every frame in every block the kernel has handed to user space
+  //! \details Never blocks (poll the socket for POLLIN to wait). The views stay valid until release().
+  //! \returns the number of frames appended
+  size_t frames( std::vector<std::string_view>& out );
+
+  //! Return all blocks consumed by frames() to the kernel at once
+  void release();
+
+  //! \brief Copy `frame` into the next free TX slot and mark it for sending
+  //! \returns false if the TX ring is full (flush and retry)
+  bool queue( std::string_view frame );
+
+  //! Number of frames queued since the last flush
+  size_t queued() const { return tx_queued_frames_; }
+
+  //! \brief Number of queued frames the kernel refused to send (TP_STATUS_WRONG_FORMAT)
+  //! \details Each is counted when queue() reuses its slot, so the count can trail the flush that failed.
+  size_t rejected() const { return tx_rejected_frames_; }
+
+  //! The caller has asked the kernel to transmit all queued frames
+  void mark_flushed() { tx_queued_frames_ = 0; }
+
+  //! Largest frame that fits in a TX slot
+  size_t max_tx_frame() const;
+};
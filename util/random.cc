@@ -13,3 +13,9 @@ default_random_engine get_random_engine()
   seed_seq seed( seed_data.begin(), seed_data.end() );
   return default_random_engine( seed );
 }
+
+default_random_engine get_random_engine( uint64_t seed )
+{
+  seed_seq seq { static_cast<uint32_t>( seed ), static_cast<uint32_t>( seed >> 32 ) }; // NOLINT(*-bitwise)
+  return default_random_engine( seq );
+}
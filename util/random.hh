@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <random>
 
 std::default_random_engine get_random_engine();
+
+// The same engine every time for the same seed, for reproducible runs (e.g. of a SimulatedLink)
+std::default_random_engine get_random_engine( uint64_t seed );
@@ -0,0 +1,192 @@
+#include "resolver.hh"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+using namespace std;
+
+size_t Resolver::KeyHash::operator()( const KeyView& key ) const
+{
+  const size_t h = hash<string_view> {}( key.hostname );
+  return h ^ ( hash<string_view> {}( key.service ) + 0x9e3779b97f4a7c15ULL + ( h << 6 ) + ( h >> 2 ) ); // NOLINT
+}
+
+Resolver::Resolver( const size_t threads, const Clock::duration positive_ttl, const Clock::duration negative_ttl )
+  : num_threads_( max( threads, size_t { 1 } ) ), positive_ttl_( positive_ttl ), negative_ttl_( negative_ttl )
+{}
+
+Resolver::~Resolver()
+{
+  {
+    const lock_guard lock { mutex_ };
+    stopping_ = true;
+  }
+  jobs_ready_.notify_all();
+  for ( auto& thread : threads_ ) {
+    thread.join();
+  }
+}
+
+Resolver& Resolver::global()
+{
+  static Resolver resolver;
+  return resolver;
+}
+
+const Resolver::Entry* Resolver::find_locked( const KeyView& key ) const
+{
+  const auto it = cache_.find( key );
+  if ( it == cache_.end() or it->second.expiry <= Clock::now() ) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+shared_future<Address> Resolver::begin_locked( const Key& key, promise<Address>& promise )
+{
+  if ( cache_.size() >= kSweepThreshold ) {
+    const auto now = Clock::now();
+    erase_if( cache_, [&]( const auto& entry ) { return entry.second.expiry <= now; } );
+  }
+
+  shared_future<Address> result = promise.get_future().share();
+  cache_.insert_or_assign( key, Entry { result, {}, Clock::time_point::max() } );
+  return result;
+}
+
+shared_future<Address> Resolver::resolve_async( const string_view hostname, const string_view service )
+{
+  const lock_guard lock { mutex_ };
+  if ( const Entry* entry = find_locked( { hostname, service } ) ) {
+    return entry->result;
+  }
+
+  Job job { { string( hostname ), string( service ) }, {} };
+  shared_future<Address> result = begin_locked( job.key, job.promise );
+  jobs_.push_back( move( job ) );
+  start_threads_locked();
+  jobs_ready_.notify_one();
+  return result;
+}
+
+void Resolver::resolve_async( const string_view hostname,
+                              const string_view service,
+                              function<void( const shared_future<Address>& )> callback )
+{
+  unique_lock lock { mutex_ };
+  if ( const Entry* entry = find_locked( { hostname, service } ) ) {
+    if ( entry->expiry != Clock::time_point::max() ) {
+      // already resolved
+      const shared_future<Address> result = entry->result;
+      lock.unlock();
+      callback( result );
+      return;
+    }
+  } else {
+    Job job { { string( hostname ), string( service ) }, {} };
+    begin_locked( job.key, job.promise );
+    jobs_.push_back( move( job ) );
+    start_threads_locked();
+    jobs_ready_.notify_one();
+  }
+
+  // run when the in-flight lookup completes
+  const KeyView key { hostname, service };
+  auto it = callbacks_.find( key );
+  if ( it == callbacks_.end() ) {
+    it = callbacks_.emplace( Key { string( hostname ), string( service ) }, decltype( it->second ) {} ).first;
+  }
+  it->second.push_back( move( callback ) );
+}
+
+Address Resolver::resolve( const string_view hostname, const string_view service )
+{
+  unique_lock lock { mutex_ };
+  if ( const Entry* entry = find_locked( { hostname, service } ) ) {
+    if ( entry->address.has_value() ) {
+      return *entry->address;
+    }
+    const shared_future<Address> result = entry->result;
+    lock.unlock();
+    return result.get();
+  }
+
+  const Key key { string( hostname ), string( service ) };
+  promise<Address> promise;
+  const shared_future<Address> result = begin_locked( key, promise );
+  lock.unlock();
+
+  complete( key, promise );
+  return result.get();
+}
+
+void Resolver::complete( const Key& key, promise<Address>& promise )
+{
+  ++lookups_;
+  optional<Address> address;
+  try {
+    address.emplace( key.hostname, key.service );
+    promise.set_value( *address );
+  } catch ( ... ) {
+    promise.set_exception( current_exception() );
+  }
+
+  vector<function<void( const shared_future<Address>& )>> callbacks;
+  shared_future<Address> result;
+  {
+    const lock_guard lock { mutex_ };
+    const auto it = cache_.find( key );
+    if ( it != cache_.end() and it->second.expiry == Clock::time_point::max() ) {
+      it->second.expiry = Clock::now() + ( address.has_value() ? positive_ttl_ : negative_ttl_ );
+      it->second.address = address;
+      result = it->second.result;
+    }
+
+    const auto cb = callbacks_.find( key );
+    if ( cb != callbacks_.end() ) {
+      callbacks = move( cb->second );
+      callbacks_.erase( cb );
+    }
+  }
+
+  for ( const auto& callback : callbacks ) {
+    callback( result );
+  }
+}
+
+void Resolver::clear()
+{
+  const lock_guard lock { mutex_ };
+  erase_if( cache_, []( const auto& entry ) { return entry.second.expiry != Clock::time_point::max(); } );
+}
+
+size_t Resolver::size() const
+{
+  const lock_guard lock { mutex_ };
+  return cache_.size();
+}
+
+void Resolver::start_threads_locked()
+{
+  while ( threads_.size() < min( num_threads_, jobs_.size() + threads_.size() ) ) {
+    threads_.emplace_back( &Resolver::worker, this );
+  }
+}
+
+void Resolver::worker()
+{
+  while ( true ) {
+    Job job;
+    {
+      unique_lock lock { mutex_ };
+      jobs_ready_.wait( lock, [&] { return stopping_ or not jobs_.empty(); } );
+      if ( jobs_.empty() ) {
+        return;
+      }
+      job = move( jobs_.front() );
+      jobs_.pop_front();
+    }
+    complete( job.key, job.promise );
+  }
+}
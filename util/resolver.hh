@@ -0,0 +1,148 @@
+#pragma once
+
+#include "address.hh"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//! \brief Asynchronous, caching wrapper around Address( hostname, service )
+//! \details Successful lookups are cached for `positive_ttl` and failures for `negative_ttl`; concurrent
+//! requests for the same name share one lookup. Cache hits take a lock and a hash lookup, with no allocation.
+//! Asynchronous lookups run on a small pool of threads started on first use.
+class Resolver
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr size_t kDefaultThreads = 4;
+  static constexpr std::chrono::seconds kDefaultPositiveTTL { 60 };
+  static constexpr std::chrono::seconds kDefaultNegativeTTL { 5 };
+
+  //! \param[in] threads is the number of lookups that may run concurrently
+  //! \param[in] positive_ttl is how long a successful lookup is reused
+  //! \param[in] negative_ttl is how long a failed lookup is reused
+  explicit Resolver( size_t threads = kDefaultThreads,
+                     Clock::duration positive_ttl = kDefaultPositiveTTL,
+                     Clock::duration negative_ttl = kDefaultNegativeTTL );
+
+  //! Stops the worker threads (waiting for lookups in progress)
+  ~Resolver();
+
+  Resolver( const Resolver& other ) = delete;
+  Resolver& operator=( const Resolver& other ) = delete;
+  Resolver( Resolver&& other ) = delete;
+  Resolver& operator=( Resolver&& other ) = delete;
+
+  //! The process-wide resolver
+  static Resolver& global();
+
+  //! \brief Start resolving (or reuse a cached or in-flight result); never blocks on the network
+  //! \returns a future holding the Address, or the exception Address( hostname, service ) threw
+  std::shared_future<Address> resolve_async( std::string_view hostname, std::string_view service );
+
+  //! \brief Resolve with a callback, invoked on a resolver thread (or immediately on a cache hit)
+  //! \details On failure, the callback receives the exception in place of an address.
+  void resolve_async( std::string_view hostname,
+                      std::string_view service,
+                      std::function<void( const std::shared_future<Address>& )> callback );
+
+  //! \brief Resolve, blocking if the name is not cached (the lookup then runs on the calling thread)
+  //! \throws the same exceptions as Address( hostname, service )
+  Address resolve( std::string_view hostname, std::string_view service );
+
+  //! Forget all cached results (in-flight lookups still complete)
+  void clear();
+
+  //! Number of cached or in-flight names
+  size_t size() const;
+
+  //! Number of lookups started so far (requests answered from the cache or an in-flight lookup don't count)
+  size_t lookups() const { return lookups_; }
+
+private:
+  struct Key
+  {
+    std::string hostname {};
+    std::string service {};
+  };
+
+  struct KeyView
+  {
+    std::string_view hostname;
+    std::string_view service;
+  };
+
+  // transparent hash and equality so that lookups by KeyView don't allocate
+  struct KeyHash
+  {
+    using is_transparent = void;
+    size_t operator()( const KeyView& key ) const;
+    size_t operator()( const Key& key ) const { return operator()( KeyView { key.hostname, key.service } ); }
+  };
+
+  struct KeyEqual
+  {
+    using is_transparent = void;
+    static KeyView view( const Key& key ) { return { key.hostname, key.service }; }
+    static KeyView view( const KeyView& key ) { return key; }
+    template<typename A, typename B>
+    bool operator()( const A& a, const B& b ) const
+    {
+      return view( a ).hostname == view( b ).hostname and view( a ).service == view( b ).service;
+    }
+  };
+
+  struct Entry
+  {
+    std::shared_future<Address> result {};
+    std::optional<Address> address {}; //!< copy of a successful result, so hits skip the future
+    Clock::time_point expiry {};       //!< Clock::time_point::max() while the lookup is in flight
+  };
+
+  // a lookup for a worker thread to run
+  struct Job
+  {
+    Key key {};
+    std::promise<Address> promise {};
+  };
+
+  static constexpr size_t kSweepThreshold = 4096;
+
+  size_t num_threads_;
+  Clock::duration positive_ttl_;
+  Clock::duration negative_ttl_;
+
+  mutable std::mutex mutex_ {};
+  std::condition_variable jobs_ready_ {};
+  std::unordered_map<Key, Entry, KeyHash, KeyEqual> cache_ {};
+  std::unordered_map<Key, std::vector<std::function<void( const std::shared_future<Address>& )>>, KeyHash, KeyEqual>
+    callbacks_ {};
+  std::deque<Job> jobs_ {};
+  std::vector<std::thread> threads_ {};
+  bool stopping_ {};
+  std::atomic<size_t> lookups_ {};
+
+  // the cached or in-flight result for `key`, if any; caller holds mutex_
+  const Entry* find_locked( const KeyView& key ) const;
+
+  // record a new in-flight lookup for `key` and return its future; caller holds mutex_
+  std::shared_future<Address> begin_locked( const Key& key, std::promise<Address>& promise );
+
+  // run one lookup and publish its result to the cache, the future and any callbacks
+  void complete( const Key& key, std::promise<Address>& promise );
+
+  void start_threads_locked();
+  void worker();
+};
@@ -0,0 +1,515 @@
+#include "sha256.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+#if defined( __x86_64__ )
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+using State = array<uint32_t, 8>;
+
+constexpr State kInitialState
+  = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+alignas( 16 ) constexpr array<uint32_t, 64> kRoundConstants
+  = { 0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+      0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+      0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+      0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2 };
+
+uint32_t load_be32( const uint8_t* p )
+{
+  uint32_t x {};
+  memcpy( &x, p, sizeof( x ) );
+  return std::endian::native == std::endian::little ? __builtin_bswap32( x ) : x;
+}
+
+void store_be32( uint8_t* p, uint32_t x )
+{
+  if constexpr ( std::endian::native == std::endian::little ) {
+    x = __builtin_bswap32( x );
+  }
+  memcpy( p, &x, sizeof( x ) );
+}
+
+// Write the final block(s) of a message into `out`: the last `size` (< 64) bytes of the message, then 0x80,
+// zeros, and the message length in bits. Returns the number of blocks (1 or 2).
+size_t pad_tail( const uint8_t* rest, size_t size, uint64_t message_length, span<uint8_t, 128> out )
+{
+  const size_t blocks = size + 1 + sizeof( uint64_t ) > SHA256::kBlockSize ? 2 : 1;
+  const size_t end = blocks * SHA256::kBlockSize;
+  memcpy( out.data(), rest, size );
+  out[size] = 0x80;
+  fill( out.begin() + static_cast<ptrdiff_t>( size + 1 ), out.begin() + static_cast<ptrdiff_t>( end - 8 ), 0 );
+  const uint64_t bits = message_length * 8;
+  store_be32( out.data() + end - 8, static_cast<uint32_t>( bits >> 32 ) ); // NOLINT(*-bitwise)
+  store_be32( out.data() + end - 4, static_cast<uint32_t>( bits ) );
+  return blocks;
+}
+
+SHA256::Digest to_digest( const State& state )
+{
+  SHA256::Digest out {};
+  for ( size_t i = 0; i < state.size(); ++i ) {
+    store_be32( out.data() + 4 * i, state.at( i ) );
+  }
+  return out;
+}
+
+// NOLINTBEGIN(*-bitwise)
+
+void compress_scalar( State& state, const uint8_t* blocks, size_t count )
+{
+  for ( ; count > 0; --count, blocks += SHA256::kBlockSize ) {
+    array<uint32_t, 64> w {};
+    for ( size_t i = 0; i < 16; ++i ) {
+      w[i] = load_be32( blocks + 4 * i );
+    }
+    for ( size_t i = 16; i < 64; ++i ) {
+      const uint32_t s0 = rotr( w[i - 15], 7 ) ^ rotr( w[i - 15], 18 ) ^ ( w[i - 15] >> 3 );
+      const uint32_t s1 = rotr( w[i - 2], 17 ) ^ rotr( w[i - 2], 19 ) ^ ( w[i - 2] >> 10 );
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    auto [a, b, c, d, e, f, g, h] = state;
+    for ( size_t i = 0; i < 64; ++i ) {
+      const uint32_t sigma1 = rotr( e, 6 ) ^ rotr( e, 11 ) ^ rotr( e, 25 );
+      const uint32_t choose = ( e & f ) ^ ( ~e & g );
+      const uint32_t t1 = h + sigma1 + choose + kRoundConstants[i] + w[i];
+      const uint32_t sigma0 = rotr( a, 2 ) ^ rotr( a, 13 ) ^ rotr( a, 22 );
+      const uint32_t majority = ( a & b ) ^ ( a & c ) ^ ( b & c );
+      const uint32_t t2 = sigma0 + majority;
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+  }
+}
+
+#if defined( __x86_64__ )
+
+// NOLINTBEGIN(*-reinterpret-cast)
+
+bool cpu_has_sha()
+{
+  unsigned eax {}, ebx {}, ecx {}, edx {};
+  if ( not __get_cpuid( 1, &eax, &ebx, &ecx, &edx ) or not( ecx & bit_SSSE3 ) or not( ecx & bit_SSE4_1 ) ) {
+    return false;
+  }
+  return __get_cpuid_count( 7, 0, &eax, &ebx, &ecx, &edx ) and ( ebx & bit_SHA );
+}
+
+// The SHA extensions keep the state as two vectors, ABEF and CDGH, and do two rounds per instruction
+__attribute__( ( target( "sha,sse4.1" ) ) ) void compress_shani( State& state,
+                                                                const uint8_t* blocks,
+                                                                size_t count )
+{
+  const __m128i byteswap = _mm_set_epi64x( 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL );
+
+  const __m128i dcba = _mm_shuffle_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( &state[0] ) ), 0xB1 );
+  const __m128i efgh = _mm_shuffle_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( &state[4] ) ), 0x1B );
+  __m128i abef = _mm_alignr_epi8( dcba, efgh, 8 );
+  __m128i cdgh = _mm_blend_epi16( efgh, dcba, 0xF0 );
+
+  for ( ; count > 0; --count, blocks += SHA256::kBlockSize ) {
+    const __m128i abef_before = abef;
+    const __m128i cdgh_before = cdgh;
+
+    // w[j] holds the four message words for rounds 4i..4i+3, for the i with i % 4 == j
+    __m128i w[4]; // NOLINT(*-avoid-c-arrays)
+    for ( size_t j = 0; j < 4; ++j ) {
+      w[j] = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( blocks + 16 * j ) ), byteswap );
+    }
+
+#pragma GCC unroll 16
+    for ( size_t i = 0; i < 16; ++i ) {
+      const __m128i k = _mm_load_si128( reinterpret_cast<const __m128i*>( &kRoundConstants[4 * i] ) );
+      const __m128i wk = _mm_add_epi32( w[i % 4], k );
+      cdgh = _mm_sha256rnds2_epu32( cdgh, abef, wk );
+      abef = _mm_sha256rnds2_epu32( abef, cdgh, _mm_shuffle_epi32( wk, 0x0E ) );
+
+      if ( i < 12 ) { // schedule the words for rounds 4(i+4)..4(i+4)+3
+        const __m128i w_minus_7 = _mm_alignr_epi8( w[( i + 3 ) % 4], w[( i + 2 ) % 4], 4 );
+        const __m128i partial = _mm_add_epi32( _mm_sha256msg1_epu32( w[i % 4], w[( i + 1 ) % 4] ), w_minus_7 );
+        w[i % 4] = _mm_sha256msg2_epu32( partial, w[( i + 3 ) % 4] );
+      }
+    }
+
+    abef = _mm_add_epi32( abef, abef_before );
+    cdgh = _mm_add_epi32( cdgh, cdgh_before );
+  }
+
+  const __m128i feba = _mm_shuffle_epi32( abef, 0x1B );
+  const __m128i dchg = _mm_shuffle_epi32( cdgh, 0xB1 );
+  _mm_storeu_si128( reinterpret_cast<__m128i*>( &state[0] ), _mm_blend_epi16( feba, dchg, 0xF0 ) );
+  _mm_storeu_si128( reinterpret_cast<__m128i*>( &state[4] ), _mm_alignr_epi8( dchg, feba, 8 ) );
+}
+
+// Eight-lane AVX2 kernel: vector i holds word i of all eight lanes' states or message blocks
+
+#define AVX2_TARGET __attribute__( ( target( "avx2" ) ) )
+
+AVX2_TARGET inline __m256i rotr8( __m256i x, int n )
+{
+  return _mm256_or_si256( _mm256_srli_epi32( x, n ), _mm256_slli_epi32( x, 32 - n ) );
+}
+
+// Transpose an 8x8 matrix of 32-bit words held as eight row vectors
+AVX2_TARGET void transpose8( __m256i ( &r )[8] ) // NOLINT(*-avoid-c-arrays)
+{
+  const __m256i t0 = _mm256_unpacklo_epi32( r[0], r[1] );
+  const __m256i t1 = _mm256_unpackhi_epi32( r[0], r[1] );
+  const __m256i t2 = _mm256_unpacklo_epi32( r[2], r[3] );
+  const __m256i t3 = _mm256_unpackhi_epi32( r[2], r[3] );
+  const __m256i t4 = _mm256_unpacklo_epi32( r[4], r[5] );
+  const __m256i t5 = _mm256_unpackhi_epi32( r[4], r[5] );
+  const __m256i t6 = _mm256_unpacklo_epi32( r[6], r[7] );
+  const __m256i t7 = _mm256_unpackhi_epi32( r[6], r[7] );
+  const __m256i u0 = _mm256_unpacklo_epi64( t0, t2 );
+  const __m256i u1 = _mm256_unpackhi_epi64( t0, t2 );
+  const __m256i u2 = _mm256_unpacklo_epi64( t1, t3 );
+  const __m256i u3 = _mm256_unpackhi_epi64( t1, t3 );
+  const __m256i u4 = _mm256_unpacklo_epi64( t4, t6 );
+  const __m256i u5 = _mm256_unpackhi_epi64( t4, t6 );
+  const __m256i u6 = _mm256_unpacklo_epi64( t5, t7 );
+  const __m256i u7 = _mm256_unpackhi_epi64( t5, t7 );
+  r[0] = _mm256_permute2x128_si256( u0, u4, 0x20 );
+  r[1] = _mm256_permute2x128_si256( u1, u5, 0x20 );
+  r[2] = _mm256_permute2x128_si256( u2, u6, 0x20 );
+  r[3] = _mm256_permute2x128_si256( u3, u7, 0x20 );
+  r[4] = _mm256_permute2x128_si256( u0, u4, 0x31 );
+  r[5] = _mm256_permute2x128_si256( u1, u5, 0x31 );
+  r[6] = _mm256_permute2x128_si256( u2, u6, 0x31 );
+  r[7] = _mm256_permute2x128_si256( u3, u7, 0x31 );
+}
+
+// Hash `count` blocks of each of eight messages, starting at blocks[lane], into states[lane]
+AVX2_TARGET void compress_avx2_x8( array<State*, 8> states, array<const uint8_t*, 8> blocks, size_t count )
+{
+  const __m256i byteswap = _mm256_set_epi64x(
+    0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL, 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL );
+
+  __m256i s[8]; // NOLINT(*-avoid-c-arrays)
+  for ( size_t lane = 0; lane < 8; ++lane ) {
+    s[lane] = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( states[lane]->data() ) );
+  }
+  transpose8( s );
+
+  for ( size_t offset = 0; offset < count * SHA256::kBlockSize; offset += SHA256::kBlockSize ) {
+    __m256i w[16]; // NOLINT(*-avoid-c-arrays)
+    for ( size_t half = 0; half < 2; ++half ) {
+      __m256i rows[8]; // NOLINT(*-avoid-c-arrays)
+      for ( size_t lane = 0; lane < 8; ++lane ) {
+        const auto* p = blocks[lane] + offset + 32 * half;
+        rows[lane] = _mm256_shuffle_epi8( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( p ) ), byteswap );
+      }
+      transpose8( rows );
+      copy( begin( rows ), end( rows ), w + 8 * half );
+    }
+
+    auto [a, b, c, d, e, f, g, h] = s;
+    for ( size_t i = 0; i < 64; ++i ) {
+      if ( i >= 16 ) { // w is a ring of the last sixteen message words
+        const __m256i w15 = w[( i - 15 ) % 16];
+        const __m256i w2 = w[( i - 2 ) % 16];
+        const __m256i s0 = _mm256_xor_si256( _mm256_xor_si256( rotr8( w15, 7 ), rotr8( w15, 18 ) ),
+                                             _mm256_srli_epi32( w15, 3 ) );
+        const __m256i s1 = _mm256_xor_si256( _mm256_xor_si256( rotr8( w2, 17 ), rotr8( w2, 19 ) ),
+                                             _mm256_srli_epi32( w2, 10 ) );
+        const __m256i w7 = w[( i - 7 ) % 16];
+        w[i % 16] = _mm256_add_epi32( _mm256_add_epi32( w[i % 16], s0 ), _mm256_add_epi32( w7, s1 ) );
+      }
+
+      const __m256i sigma1 = _mm256_xor_si256( _mm256_xor_si256( rotr8( e, 6 ), rotr8( e, 11 ) ), rotr8( e, 25 ) );
+      const __m256i choose = _mm256_xor_si256( _mm256_and_si256( e, f ), _mm256_andnot_si256( e, g ) );
+      const __m256i k = _mm256_set1_epi32( static_cast<int>( kRoundConstants[i] ) );
+      const __m256i t1 = _mm256_add_epi32( _mm256_add_epi32( _mm256_add_epi32( h, sigma1 ), choose ),
+                                           _mm256_add_epi32( k, w[i % 16] ) );
+      const __m256i sigma0 = _mm256_xor_si256( _mm256_xor_si256( rotr8( a, 2 ), rotr8( a, 13 ) ), rotr8( a, 22 ) );
+      const __m256i majority
+        = _mm256_or_si256( _mm256_and_si256( a, b ), _mm256_and_si256( c, _mm256_or_si256( a, b ) ) );
+      const __m256i t2 = _mm256_add_epi32( sigma0, majority );
+      h = g;
+      g = f;
+      f = e;
+      e = _mm256_add_epi32( d, t1 );
+      d = c;
+      c = b;
+      b = a;
+      a = _mm256_add_epi32( t1, t2 );
+    }
+
+    const __m256i round_output[8] { a, b, c, d, e, f, g, h }; // NOLINT(*-avoid-c-arrays)
+    for ( size_t i = 0; i < 8; ++i ) {
+      s[i] = _mm256_add_epi32( s[i], round_output[i] );
+    }
+  }
+
+  transpose8( s );
+  for ( size_t lane = 0; lane < 8; ++lane ) {
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( states[lane]->data() ), s[lane] );
+  }
+}
+
+#undef AVX2_TARGET
+
+// NOLINTEND(*-reinterpret-cast)
+
+#endif
+
+// NOLINTEND(*-bitwise)
+
+using Compressor = void ( * )( State&, const uint8_t*, size_t );
+
+Compressor compressor( SHA256::Kernel kernel )
+{
+  if ( not SHA256::supported( kernel ) ) {
+    throw runtime_error( "SHA-256 kernel not supported on this CPU" );
+  }
+#if defined( __x86_64__ )
+  if ( kernel == SHA256::Kernel::SHANI ) {
+    return compress_shani;
+  }
+#endif
+  return compress_scalar;
+}
+} // namespace
+
+bool SHA256::supported( Kernel kernel )
+{
+  switch ( kernel ) {
+    case Kernel::Scalar:
+      return true;
+#if defined( __x86_64__ )
+    case Kernel::SHANI: {
+      static const bool has_sha = cpu_has_sha();
+      return has_sha;
+    }
+    case Kernel::AVX2:
+      return __builtin_cpu_supports( "avx2" );
+#endif
+    default:
+      return false;
+  }
+}
+
+SHA256::Kernel SHA256::best_kernel()
+{
+  return supported( Kernel::SHANI ) ? Kernel::SHANI : Kernel::Scalar;
+}
+
+SHA256::Kernel SHA256::best_batch_kernel()
+{
+  if ( supported( Kernel::SHANI ) ) {
+    return Kernel::SHANI; // one message at a time with the SHA extensions still beats eight AVX2 lanes
+  }
+  return supported( Kernel::AVX2 ) ? Kernel::AVX2 : Kernel::Scalar;
+}
+
+SHA256::SHA256( Kernel kernel ) : compress_( compressor( kernel ) )
+{
+  reset();
+}
+
+void SHA256::reset()
+{
+  state_ = kInitialState;
+  buffered_ = 0;
+  length_ = 0;
+}
+
+void SHA256::update( string_view data )
+{
+  const auto* p = reinterpret_cast<const uint8_t*>( data.data() ); // NOLINT(*-reinterpret-cast)
+  size_t size = data.size();
+  if ( size == 0 ) {
+    return; // (`p` may be null, which memcpy() must not see even for no bytes)
+  }
+  length_ += size;
+
+  // top up a partial block first
+  if ( buffered_ ) {
+    const size_t take = min( size, kBlockSize - buffered_ );
+    memcpy( buffer_.data() + buffered_, p, take );
+    buffered_ += take;
+    p += take;
+    size -= take;
+    if ( buffered_ < kBlockSize ) {
+      return;
+    }
+    compress_( state_, buffer_.data(), 1 );
+    buffered_ = 0;
+  }
+
+  // then hash whole blocks straight from the input
+  const size_t whole = size / kBlockSize;
+  compress_( state_, p, whole );
+  p += whole * kBlockSize;
+  size -= whole * kBlockSize;
+
+  memcpy( buffer_.data(), p, size );
+  buffered_ = size;
+}
+
+SHA256::Digest SHA256::digest()
+{
+  array<uint8_t, 2 * kBlockSize> tail {};
+  compress_( state_, tail.data(), pad_tail( buffer_.data(), buffered_, length_, tail ) );
+  buffered_ = 0;
+  return to_digest( state_ );
+}
+
+SHA256::Digest SHA256::hash( string_view data, Kernel kernel )
+{
+  SHA256 hasher { kernel };
+  hasher.update( data );
+  return hasher.digest();
+}
+
+void SHA256::hash_batch( span<const string_view> inputs, span<Digest> digests, Kernel kernel )
+{
+  if ( digests.size() < inputs.size() ) {
+    throw runtime_error( "SHA256::hash_batch: fewer digests than inputs" );
+  }
+
+#if defined( __x86_64__ )
+  if ( kernel == Kernel::AVX2 and supported( kernel ) ) {
+    // Each lane works through one message's whole blocks, then its padded tail, then takes the next message.
+    // Once the messages run out, idle lanes shadow a busy one and their results are discarded.
+    struct Lane
+    {
+      size_t input { SIZE_MAX }; // SIZE_MAX = idle
+      const uint8_t* data {};
+      size_t blocks {};
+      bool padded {};
+      alignas( 32 ) array<uint8_t, 2 * kBlockSize> tail {};
+      State state {};
+    };
+    array<Lane, 8> lanes {};
+    State scratch {};
+    size_t next = 0;
+
+    while ( true ) {
+      size_t busy = 0;
+      size_t count = SIZE_MAX;
+      for ( auto& lane : lanes ) {
+        while ( true ) {
+          if ( lane.input == SIZE_MAX ) {
+            if ( next == inputs.size() ) {
+              break;
+            }
+            lane.input = next++;
+            lane.data = reinterpret_cast<const uint8_t*>( inputs[lane.input].data() ); // NOLINT(*-reinterpret-cast)
+            lane.blocks = inputs[lane.input].size() / kBlockSize;
+            lane.padded = false;
+            lane.state = kInitialState;
+          }
+          if ( lane.blocks > 0 ) {
+            break;
+          }
+          const string_view message = inputs[lane.input];
+          if ( lane.padded ) {
+            digests[lane.input] = to_digest( lane.state );
+            lane.input = SIZE_MAX;
+          } else {
+            const size_t whole = message.size() / kBlockSize * kBlockSize;
+            // NOLINTNEXTLINE(*-reinterpret-cast)
+            const auto* rest = reinterpret_cast<const uint8_t*>( message.data() ) + whole;
+            lane.blocks = pad_tail( rest, message.size() - whole, message.size(), lane.tail );
+            lane.data = lane.tail.data();
+            lane.padded = true;
+          }
+        }
+        if ( lane.input != SIZE_MAX ) {
+          ++busy;
+          count = min( count, lane.blocks );
+        }
+      }
+
+      if ( busy == 0 ) {
+        return;
+      }
+
+      const Lane* leader = &*ranges::find_if( lanes, []( const Lane& l ) { return l.input != SIZE_MAX; } );
+      array<State*, 8> states {};
+      array<const uint8_t*, 8> blocks {};
+      for ( size_t i = 0; i < lanes.size(); ++i ) {
+        const bool idle = lanes[i].input == SIZE_MAX;
+        states[i] = idle ? &scratch : &lanes[i].state;
+        blocks[i] = idle ? leader->data : lanes[i].data;
+      }
+      compress_avx2_x8( states, blocks, count );
+      for ( auto& lane : lanes ) {
+        if ( lane.input != SIZE_MAX ) {
+          lane.data += count * kBlockSize;
+          lane.blocks -= count;
+        }
+      }
+    }
+  }
+#endif
+
+  SHA256 hasher { kernel == Kernel::AVX2 ? Kernel::Scalar : kernel };
+  for ( size_t i = 0; i < inputs.size(); ++i ) {
+    hasher.reset();
+    hasher.update( inputs[i] );
+    digests[i] = hasher.digest();
+  }
+}
+
+string base64_encode( span<const uint8_t> data, bool pad )
+{
+  static constexpr string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  string out;
+  out.reserve( ( data.size() + 2 ) / 3 * 4 );
+  size_t i = 0;
+  for ( ; i + 3 <= data.size(); i += 3 ) {
+    // NOLINTNEXTLINE(*-bitwise)
+    const uint32_t n = ( uint32_t { data[i] } << 16 ) | ( uint32_t { data[i + 1] } << 8 ) | data[i + 2];
+    out += alphabet[( n >> 18 ) & 63]; // NOLINT(*-bitwise)
+    out += alphabet[( n >> 12 ) & 63]; // NOLINT(*-bitwise)
+    out += alphabet[( n >> 6 ) & 63];  // NOLINT(*-bitwise)
+    out += alphabet[n & 63];           // NOLINT(*-bitwise)
+  }
+
+  const size_t rest = data.size() - i;
+  if ( rest ) {
+    // NOLINTNEXTLINE(*-bitwise)
+    const uint32_t n = ( uint32_t { data[i] } << 16 ) | ( rest == 2 ? uint32_t { data[i + 1] } << 8 : 0 );
+    out += alphabet[( n >> 18 ) & 63]; // NOLINT(*-bitwise)
+    out += alphabet[( n >> 12 ) & 63]; // NOLINT(*-bitwise)
+    if ( rest == 2 ) {
+      out += alphabet[( n >> 6 ) & 63]; // NOLINT(*-bitwise)
+    }
+    if ( pad ) {
+      out.append( 3 - rest, '=' );
+    }
+  }
+  return out;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+//! \brief Incremental [SHA-256](https://csrc.nist.gov/pubs/fips/180-4/upd1/final) hasher
+//! \details Input may arrive in pieces of any size; whole blocks are hashed straight from the caller's memory,
+//! so a stream of chunks (e.g., a ByteStream's, or Buffers) is never gathered into one string. The
+//! compression function uses the x86 SHA extensions when the CPU has them.
+//!
+//!     SHA256 hasher;
+//!     hasher.update_from( stream.reader() ); // hashes and pops everything buffered
+//!     const std::string b64 = base64_encode( hasher.digest() );
+class SHA256
+{
+public:
+  static constexpr size_t kBlockSize = 64;
+  static constexpr size_t kDigestSize = 32;
+  using Digest = std::array<uint8_t, kDigestSize>;
+
+  //! Implementations of the compression function
+  enum class Kernel
+  {
+    Scalar, //!< portable C++
+    SHANI,  //!< x86 SHA extensions (one message at a time)
+    AVX2    //!< eight messages at once in AVX2 lanes; used only by hash_batch() (streams use Scalar)
+  };
+
+  //! Does this CPU support `kernel`?
+  static bool supported( Kernel kernel );
+
+  //! The fastest supported kernel for hashing a single stream
+  static Kernel best_kernel();
+
+  explicit SHA256( Kernel kernel = best_kernel() );
+
+  //! Hash `data` after everything passed to update() so far
+  void update( std::string_view data );
+
+  //! Hash each of `pieces` (e.g., a container of strings or Buffers) in order
+  template<class Pieces>
+  void update_all( const Pieces& pieces )
+  {
+    for ( const auto& piece : pieces ) {
+      update( piece );
+    }
+  }
+
+  //! \brief Hash and pop everything buffered in `reader`, one chunk at a time
+  //! \details `reader` is anything with `bytes_buffered()`, `peek()` and `pop()`, like a ByteStream's Reader.
+  template<class Reader>
+  void update_from( Reader& reader )
+  {
+    while ( reader.bytes_buffered() > 0 ) {
+      const std::string_view chunk = reader.peek();
+      update( chunk );
+      reader.pop( chunk.size() );
+    }
+  }
+
+  //! Finish and return the hash of everything passed to update(); call reset() before hashing anything else
+  Digest digest();
+
+  //! Start over, as if newly constructed
+  void reset();
+
+  //! Total bytes hashed since the last reset()
+  uint64_t bytes_hashed() const { return length_; }
+
+  //! Hash of `data`
+  static Digest hash( std::string_view data, Kernel kernel = best_kernel() );
+
+  //! \brief Hash each of `inputs` into the corresponding element of `digests`
+  //! \details With the AVX2 kernel, eight messages are hashed side by side, which beats one-at-a-time
+  //! scalar hashing on CPUs without the SHA extensions.
+  static void hash_batch( std::span<const std::string_view> inputs,
+                          std::span<Digest> digests,
+                          Kernel kernel = best_batch_kernel() );
+
+  //! The fastest supported kernel for hash_batch()
+  static Kernel best_batch_kernel();
+
+private:
+  using State = std::array<uint32_t, 8>;
+
+  void ( *compress_ )( State& state, const uint8_t* blocks, size_t count );
+  State state_ {};
+  std::array<uint8_t, kBlockSize> buffer_ {}; //!< partial block awaiting more input
+  size_t buffered_ {};                         //!< bytes of buffer_ in use
+  uint64_t length_ {};                         //!< total bytes hashed
+};
+
+//! \brief Encode `data` as base64 (RFC 4648, standard alphabet)
+//! \param[in] pad selects whether to append '=' to a multiple of four characters
+std::string base64_encode( std::span<const uint8_t> data, bool pad = true );
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "random.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <map>
+#include <optional>
+#include <random>
+#include <utility>
+
+//! What a SimulatedLink does to the messages it carries
+struct LinkConfig
+{
+  static constexpr uint64_t UNLIMITED = std::numeric_limits<uint64_t>::max();
+
+  uint64_t bytes_per_ms = 0;        //!< bottleneck rate (1 Mbit/s is 125 bytes/ms); 0 for no bottleneck
+  uint64_t queue_limit = UNLIMITED; //!< bytes waiting for the bottleneck, beyond which it drops (drop-tail)
+  uint64_t delay_ms = 0;            //!< one-way propagation delay
+  uint64_t jitter_ms = 0;           //!< up to this much more delay, uniformly at random (order is kept)
+  double loss_rate = 0;             //!< chance that a message starts a loss event
+  unsigned loss_burst = 1;          //!< messages lost in each loss event
+  double reorder_rate = 0;          //!< chance that a message is held back, letting later ones overtake it
+  uint64_t reorder_ms = 0;          //!< how long a held-back message waits, on top of its delay
+};
+
+//! Counts of what a SimulatedLink has done
+struct LinkStats
+{
+  uint64_t sent {};        //!< messages offered to send()
+  uint64_t lost {};        //!< dropped at random
+  uint64_t overflowed {};  //!< dropped because the queue was full
+  uint64_t reordered {};   //!< held back to be overtaken
+  uint64_t delivered {};   //!< handed over by advance()
+  uint64_t queueing_us {}; //!< total time delivered messages waited for the bottleneck
+
+  double mean_queueing_ms() const
+  {
+    return delivered ? static_cast<double>( queueing_us ) / 1000.0 / static_cast<double>( delivered ) : 0;
+  }
+};
+
+//! \brief A one-way link, simulated in memory on a virtual clock
+//! \details Messages (e.g. TCPSenderMessage, TCPReceiverMessage, or a Buffer holding a datagram) go through,
+//! in order: random loss; a drop-tail queue in front of a bottleneck that sends `bytes_per_ms`; then the
+//! propagation delay, plus jitter, plus (now and then) the extra wait that reorders them. A bidirectional path
+//! is two links, one each way, which may differ.
+//!
+//! Time only passes when advance() is called, and the bottleneck is modelled exactly (in microseconds) rather
+//! than step by step, so a driver can jump straight to next_delivery_ms(): a minute of transfer simulates in
+//! milliseconds. All randomness comes from one engine seeded at construction, so a run with the same seed and
+//! the same sends is the same run.
+template<class Message>
+class SimulatedLink
+{
+public:
+  SimulatedLink( const LinkConfig& config, uint64_t seed ) : config_( config ), rng_( get_random_engine( seed ) )
+  {}
+
+  //! The virtual clock
+  uint64_t now_ms() const { return now_us_ / 1000; }
+
+  //! \brief Offer a message that takes `size` bytes on the wire, at the current time
+  //! \returns false if it was dropped (at random, or because the queue was full)
+  bool send( Message msg, size_t size )
+  {
+    ++stats_.sent;
+    if ( burst_left_ == 0 and config_.loss_rate > 0
+         and std::bernoulli_distribution { config_.loss_rate }( rng_ ) ) {
+      burst_left_ = config_.loss_burst;
+    }
+    if ( burst_left_ > 0 ) {
+      --burst_left_;
+      ++stats_.lost;
+      return false;
+    }
+
+    // the bottleneck: wait for whatever is ahead in the queue, then take size / rate to send
+    while ( not queue_.empty() and queue_.front().first <= now_us_ ) {
+      queued_bytes_ -= queue_.front().second;
+      queue_.pop_front();
+    }
+    if ( queued_bytes_ + size > config_.queue_limit ) {
+      ++stats_.overflowed;
+      return false;
+    }
+    uint64_t sent_us = now_us_;
+    uint64_t queueing_us = 0;
+    if ( config_.bytes_per_ms > 0 ) {
+      const uint64_t start_us = std::max( now_us_, bottleneck_free_us_ );
+      queueing_us = start_us - now_us_;
+      bottleneck_free_us_ = start_us + ( size * 1000 + config_.bytes_per_ms - 1 ) / config_.bytes_per_ms;
+      sent_us = bottleneck_free_us_;
+      queued_bytes_ += size;
+      queue_.emplace_back( sent_us, size );
+    }
+
+    // the wire: delay and jitter keep messages in order; only a reordered message may be overtaken
+    uint64_t arrival_us = sent_us + config_.delay_ms * 1000;
+    if ( config_.jitter_ms > 0 ) {
+      arrival_us += std::uniform_int_distribution<uint64_t> { 0, config_.jitter_ms * 1000 }( rng_ );
+    }
+    if ( config_.reorder_rate > 0 and std::bernoulli_distribution { config_.reorder_rate }( rng_ ) ) {
+      ++stats_.reordered;
+      arrival_us += config_.reorder_ms * 1000;
+    } else {
+      arrival_us = std::max( arrival_us, last_in_order_us_ );
+      last_in_order_us_ = arrival_us;
+    }
+
+    in_flight_.emplace( std::pair { arrival_us, next_id_++ }, InFlight { std::move( msg ), queueing_us } );
+    return true;
+  }
+
+  //! Advance the clock by `ms`, handing each message that has arrived by then to `deliver`, in arrival order
+  template<class F>
+  void advance( uint64_t ms, F&& deliver )
+  {
+    now_us_ += ms * 1000;
+    while ( not in_flight_.empty() and in_flight_.begin()->first.first <= now_us_ ) {
+      auto node = in_flight_.extract( in_flight_.begin() );
+      ++stats_.delivered;
+      stats_.queueing_us += node.mapped().queueing_us;
+      deliver( std::move( node.mapped().msg ) );
+    }
+  }
+
+  //! When the next message arrives (rounded up to a whole ms), if any is in flight
+  std::optional<uint64_t> next_delivery_ms() const
+  {
+    if ( in_flight_.empty() ) {
+      return {};
+    }
+    return ( in_flight_.begin()->first.first + 999 ) / 1000;
+  }
+
+  size_t in_flight() const { return in_flight_.size(); }
+  const LinkStats& stats() const { return stats_; }
+  const LinkConfig& config() const { return config_; }
+
+private:
+  struct InFlight
+  {
+    Message msg;
+    uint64_t queueing_us; // time it waited for the bottleneck to send what was ahead of it
+  };
+
+  LinkConfig config_;
+  std::default_random_engine rng_;
+  uint64_t now_us_ {};
+  unsigned burst_left_ {};
+
+  uint64_t bottleneck_free_us_ {};                   // when the bottleneck finishes what it has queued
+  std::deque<std::pair<uint64_t, size_t>> queue_ {}; // (when it will have been sent, size) of each queued message
+  uint64_t queued_bytes_ {};
+
+  uint64_t last_in_order_us_ {};                                  // the latest arrival not reordered
+  uint64_t next_id_ {};                                           // ties arrivals in the order they were sent
+  std::map<std::pair<uint64_t, uint64_t>, InFlight> in_flight_ {}; // by (arrival time, id)
+  LinkStats stats_ {};
+};
@@ -2,9 +2,14 @@
 
 #include "exception.hh"
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstring>
+#include <linux/errqueue.h>
 #include <linux/if_packet.h>
 #include <net/if.h>
+#include <netinet/udp.h>
 #include <stdexcept>
 #include <sys/ioctl.h>
 #include <unistd.h>
@@ -94,6 +99,26 @@ void Socket::connect( const Address& address )
   CheckSystemCall( "connect", ::connect( fd_num(), address, address.size() ) );
 }
 
+// start a connection without blocking
+//! \param[in] address is the peer's Address
+//! \returns true if already connected, false if the connection is in progress
+bool Socket::connect_nonblocking( const Address& address )
+{
+  if ( not non_blocking() ) {
+    set_blocking( false );
+  }
+
+  if ( ::connect( fd_num(), address, address.size() ) == 0 ) {
+    return true;
+  }
+
+  if ( errno == EINPROGRESS ) {
+    return false;
+  }
+
+  throw unix_error { "connect" };
+}
+
 // shut down a socket in the specified way
 //! \param[in] how can be `SHUT_RD`, `SHUT_WR`, or `SHUT_RDWR`; see [shutdown(2)](\ref man2::shutdown)
 void Socket::shutdown( const int how )
@@ -151,6 +176,47 @@ void DatagramSocket::send( const string_view payload )
   register_write();
 }
 
+//! \note A datagram too large for its slot is cut short, and marked (see DatagramBatch::truncated())
+size_t DatagramSocket::recv_batch( DatagramBatch& batch )
+{
+  const span<mmsghdr> headers = batch.prepare_recv();
+
+  const int count = CheckSystemCall(
+    "recvmmsg",
+    ::recvmmsg( fd_num(), headers.data(), static_cast<unsigned>( headers.size() ), MSG_WAITFORONE, nullptr ) );
+
+  register_read();
+  batch.finish_recv( count );
+  return count;
+}
+
+size_t DatagramSocket::send_batch( DatagramBatch& batch )
+{
+  // sendmmsg may stop early (e.g., when the socket buffer fills); keep going unless it would block
+  size_t sent = 0;
+  while ( sent < batch.size() ) {
+    const span<mmsghdr> headers = batch.prepare_send( sent );
+    const int count = CheckSystemCall(
+      "sendmmsg", ::sendmmsg( fd_num(), headers.data(), static_cast<unsigned>( headers.size() ), 0 ) );
+    register_write();
+    if ( count == 0 ) {
+      break;
+    }
+    sent += count;
+  }
+  return sent;
+}
+
+void UDPSocket::set_gro( const bool enabled )
+{
+  setsockopt( SOL_UDP, UDP_GRO, int { enabled } );
+}
+
+void UDPSocket::set_gso_segment_size( const uint16_t segment_size )
+{
+  setsockopt( SOL_UDP, UDP_SEGMENT, int { segment_size } );
+}
+
 // mark the socket as listening for incoming connections
 //! \param[in] backlog is the number of waiting connections to queue (see [listen(2)](\ref man2::listen))
 void TCPSocket::listen( const int backlog )
@@ -167,6 +233,128 @@ TCPSocket TCPSocket::accept()
   return TCPSocket( FileDescriptor( CheckSystemCall( "accept", ::accept( fd_num(), nullptr, nullptr ) ) ) );
 }
 
+void TCPSocket::set_zerocopy( const size_t threshold )
+{
+  setsockopt( SOL_SOCKET, SO_ZEROCOPY, int { true } );
+  zerocopy_threshold_ = max( threshold, size_t { 1 } );
+}
+
+size_t TCPSocket::write_zerocopy( const Buffer& buffer, const size_t offset )
+{
+  const string_view payload = string_view( buffer ).substr( offset );
+
+  // reap opportunistically so the pending queue (and the kernel's optmem budget) stays small
+  if ( not zerocopy_pending_.empty() ) {
+    reap_zerocopy_completions();
+  }
+
+  if ( zerocopy_threshold_ == 0 or payload.size() < zerocopy_threshold_ ) {
+    return write( payload );
+  }
+
+  const ssize_t bytes_sent = ::send( fd_num(), payload.data(), payload.size(), MSG_ZEROCOPY );
+  if ( bytes_sent < 0 ) {
+    if ( errno == ENOBUFS ) {
+      // too many pages pinned: copy this one
+      return write( payload );
+    }
+    return CheckSystemCall( "send", bytes_sent );
+  }
+
+  register_write();
+  zerocopy_pending_.push_back( { zerocopy_next_id_++, buffer, false } );
+  return bytes_sent;
+}
+
+size_t TCPSocket::reap_zerocopy_completions()
+{
+  size_t completed = 0;
+
+  while ( not zerocopy_pending_.empty() ) {
+    struct alignas( cmsghdr ) Control
+    {
+      array<char, CMSG_SPACE( sizeof( sock_extended_err ) + sizeof( sockaddr_storage ) )> data;
+    } control {};
+
+    msghdr msg {};
+    msg.msg_control = control.data.data();
+    msg.msg_controllen = control.data.size();
+
+    if ( ::recvmsg( fd_num(), &msg, MSG_ERRQUEUE | MSG_DONTWAIT ) < 0 ) { // NOLINT(*-bitwise)
+      if ( errno == EAGAIN ) {
+        break;
+      }
+      throw unix_error { "recvmsg(MSG_ERRQUEUE)" };
+    }
+
+    for ( cmsghdr* cmsg = CMSG_FIRSTHDR( &msg ); cmsg != nullptr; cmsg = CMSG_NXTHDR( &msg, cmsg ) ) {
+      if ( cmsg->cmsg_level != SOL_IP or cmsg->cmsg_type != IP_RECVERR ) {
+        continue;
+      }
+
+      sock_extended_err err {};
+      memcpy( &err, CMSG_DATA( cmsg ), sizeof( err ) );
+      if ( err.ee_errno != 0 or err.ee_origin != SO_EE_ORIGIN_ZEROCOPY ) {
+        continue;
+      }
+
+      if ( err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED ) { // NOLINT(*-bitwise)
+        // the kernel copied anyway, so pinning only adds cost
+        zerocopy_threshold_ = 0;
+      }
+
+      // the notification covers the inclusive id range [ee_info, ee_data]
+      const uint32_t first_id = zerocopy_pending_.front().id;
+      const size_t begin = err.ee_info - first_id;
+      const size_t end = min( size_t { err.ee_data - first_id } + 1, zerocopy_pending_.size() );
+      for ( size_t index = begin; index < end; ++index ) {
+        if ( not zerocopy_pending_[index].done ) {
+          zerocopy_pending_[index].done = true;
+          ++completed;
+        }
+      }
+    }
+
+    while ( not zerocopy_pending_.empty() and zerocopy_pending_.front().done ) {
+      zerocopy_pending_.pop_front();
+    }
+  }
+
+  return completed;
+}
+
+// accept pending connections until the backlog is empty or `max_connections` is reached
+//! \returns new non-blocking, close-on-exec TCPSockets connected to their peers
+std::vector<TCPSocket> TCPSocket::accept_batch( const size_t max_connections )
+{
+  vector<TCPSocket> ret;
+
+  while ( ret.size() < max_connections ) {
+    const int fd = ::accept4( fd_num(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC ); // NOLINT(*-bitwise)
+    if ( fd < 0 ) {
+      if ( errno == EAGAIN or errno == EWOULDBLOCK ) {
+        break;
+      }
+      if ( errno == ECONNABORTED or errno == EINTR ) {
+        continue; // the peer gave up while queued; keep draining
+      }
+      if ( not ret.empty() ) {
+        break; // hand back what we have; the error will recur on the next call
+      }
+      throw unix_error { "accept4" };
+    }
+
+    register_read();
+    ret.push_back( TCPSocket( FileDescriptor( fd, true ) ) );
+
+    if ( not non_blocking() ) {
+      break;
+    }
+  }
+
+  return ret;
+}
+
 // get socket option
 template<typename option_type>
 socklen_t Socket::getsockopt( const int level, const int option, option_type& option_value ) const
@@ -200,6 +388,12 @@ void Socket::set_reuseaddr()
   setsockopt( SOL_SOCKET, SO_REUSEADDR, int { true } );
 }
 
+// let several sockets (e.g., one listener per thread) bind the same address and port
+void Socket::set_reuseport()
+{
+  setsockopt( SOL_SOCKET, SO_REUSEPORT, int { true } );
+}
+
 void Socket::throw_if_error() const
 {
   int socket_error = 0;
@@ -219,3 +413,96 @@ void PacketSocket::set_promiscuous()
               PACKET_ADD_MEMBERSHIP,
               packet_mreq { local_address().as<sockaddr_ll>()->sll_ifindex, PACKET_MR_PROMISC, {}, {} } );
 }
+
+void PacketSocket::attach_filter( const BPFFilter& filter )
+{
+  vector<sock_filter> program = filter.program();
+  const sock_fprog fprog { static_cast<unsigned short>( program.size() ), program.data() };
+  setsockopt( SOL_SOCKET, SO_ATTACH_FILTER, fprog );
+}
+
+void PacketSocket::detach_filter()
+{
+  setsockopt( SOL_SOCKET, SO_DETACH_FILTER, int {} );
+}
+
+PacketRing& PacketSocket::ring()
+{
+  if ( not ring_ ) {
+    throw runtime_error( "PacketSocket: rings not enabled" );
+  }
+  return *ring_;
+}
+
+// request the rings with setsockopt, then map them
+//! \param[in] rx is the RX ring geometry (or empty for none)
+//! \param[in] tx is the TX ring geometry (or empty for none)
+void PacketSocket::enable_rings( const optional<PacketRingConfig>& rx, const optional<PacketRingConfig>& tx )
+{
+  if ( ring_ ) {
+    throw runtime_error( "PacketSocket::enable_rings called twice" );
+  }
+
+  // PacketRing finds TX frame i at i * frame_size, which is only right if frames tile each block exactly
+  if ( tx.has_value() and ( tx->frame_size == 0 or tx->block_size % tx->frame_size != 0 ) ) {
+    throw runtime_error( "PacketSocket::enable_rings: TX block_size must be a multiple of frame_size" );
+  }
+
+  setsockopt( SOL_PACKET, PACKET_VERSION, int { TPACKET_V3 } );
+
+  if ( rx.has_value() ) {
+    tpacket_req3 req {};
+    req.tp_block_size = rx->block_size;
+    req.tp_block_nr = rx->block_count;
+    req.tp_frame_size = rx->frame_size;
+    req.tp_frame_nr = rx->block_size / rx->frame_size * rx->block_count;
+    req.tp_retire_blk_tov = rx->block_timeout_ms;
+    setsockopt( SOL_PACKET, PACKET_RX_RING, req );
+  }
+
+  if ( tx.has_value() ) {
+    tpacket_req3 req {};
+    req.tp_block_size = tx->block_size;
+    req.tp_block_nr = tx->block_count;
+    req.tp_frame_size = tx->frame_size;
+    req.tp_frame_nr = tx->block_size / tx->frame_size * tx->block_count;
+    setsockopt( SOL_PACKET, PACKET_TX_RING, req );
+  }
+
+  ring_ = make_unique<PacketRing>( fd_num(), rx, tx );
+}
+
+size_t PacketSocket::recv_frames( vector<string_view>& frames )
+{
+  const size_t count = ring().frames( frames );
+  if ( count ) {
+    register_read();
+  }
+  return count;
+}
+
+void PacketSocket::release_frames()
+{
+  ring().release();
+}
+
+bool PacketSocket::queue_frame( const string_view frame )
+{
+  return ring().queue( frame );
+}
+
+void PacketSocket::flush_frames()
+{
+  if ( ring().queued() == 0 ) {
+    return;
+  }
+
+  CheckSystemCall( "send", ::send( fd_num(), nullptr, 0, 0 ) );
+  register_write();
+  ring().mark_flushed();
+}
+
+size_t PacketSocket::rejected_frames()
+{
+  return ring().rejected();
+}
@@ -1,11 +1,19 @@
 #pragma once
 
 #include "address.hh"
+#include "bpf_filter.hh"
+#include "buffer.hh"
+#include "datagram_batch.hh"
 #include "file_descriptor.hh"
+#include "packet_ring.hh"
 
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <sys/socket.h>
+#include <vector>
 
 //! \brief Base class for network sockets (TCP, UDP, etc.)
 //! \details Socket is generally used via a subclass. See TCPSocket and UDPSocket for usage examples.
@@ -23,6 +31,9 @@ protected:
   //! Construct from a file descriptor.
   Socket( FileDescriptor&& fd, int domain, int type, int protocol = 0 );
 
+  //! Construct from a file descriptor the kernel created as this kind of socket (e.g., by accept4), unverified.
+  explicit Socket( FileDescriptor&& fd ) : FileDescriptor( std::move( fd ) ) {}
+
   //! Wrapper around [getsockopt(2)](\ref man2::getsockopt)
   template<typename option_type>
   socklen_t getsockopt( int level, int option, option_type& option_value ) const;
@@ -43,6 +54,11 @@ public:
   //! Connect a socket to a specified peer address with [connect(2)](\ref man2::connect)
   void connect( const Address& address );
 
+  //! \brief Start connecting to a peer without blocking (makes the socket non-blocking)
+  //! \returns true if the connection completed immediately. Otherwise it is in progress: wait until the socket
+  //! is writable, then call throw_if_error() to learn whether it succeeded.
+  bool connect_nonblocking( const Address& address );
+
   //! Shut down a socket via [shutdown(2)](\ref man2::shutdown)
   void shutdown( int how );
 
@@ -54,6 +70,10 @@ public:
   //! Allow local address to be reused sooner via [SO_REUSEADDR](\ref man7::socket)
   void set_reuseaddr();
 
+  //! Let several sockets bind the same address and port via [SO_REUSEPORT](\ref man7::socket)
+  //! (the kernel spreads incoming connections across their listeners)
+  void set_reuseport();
+
   //! Check for errors (will be seen on non-blocking sockets)
   void throw_if_error() const;
 };
@@ -71,6 +91,15 @@ public:
 
   //! Send datagram to the socket's connected address (must call connect() first)
   void send( std::string_view payload );
+
+  //! \brief Receive up to `batch.capacity()` datagrams with one [recvmmsg(2)](\ref man2::recvmmsg)
+  //! \details Blocks (on a blocking socket) until at least one datagram is available.
+  //! \returns the number of datagrams received, also available as `batch.size()`
+  size_t recv_batch( DatagramBatch& batch );
+
+  //! \brief Send the datagrams queued in `batch` with [sendmmsg(2)](\ref man2::sendmmsg)
+  //! \returns the number of datagrams sent; fewer than `batch.size()` only on a non-blocking socket
+  size_t send_batch( DatagramBatch& batch );
 };
 
 //! A wrapper around [UDP sockets](\ref man7::udp)
@@ -82,17 +111,40 @@ class UDPSocket : public DatagramSocket
 public:
   //! Default: construct an unbound, unconnected UDP socket
   UDPSocket() : DatagramSocket( AF_INET, SOCK_DGRAM ) {}
+
+  //! \brief Let the kernel coalesce same-size incoming datagrams into one buffer ([UDP_GRO](\ref man7::udp))
+  //! \details Receive with a DatagramBatch of DatagramBatch::kMaxSlotSize slots, or trains will be truncated.
+  void set_gro( bool enabled );
+
+  //! Split every outgoing payload into datagrams of `segment_size` bytes ([UDP_SEGMENT](\ref man7::udp))
+  void set_gso_segment_size( uint16_t segment_size );
 };
 
 //! A wrapper around [TCP sockets](\ref man7::tcp)
 class TCPSocket : public Socket
 {
 private:
-  //! \brief Construct from FileDescriptor (used by accept())
+  //! \brief Construct from FileDescriptor (used by accept() and accept_batch())
+  //! \details The kernel made `fd` from a TCP listener, so the domain/type/protocol checks are skipped.
   //! \param[in] fd is the FileDescriptor from which to construct
-  explicit TCPSocket( FileDescriptor&& fd ) : Socket( std::move( fd ), AF_INET, SOCK_STREAM ) {}
+  explicit TCPSocket( FileDescriptor&& fd ) : Socket( std::move( fd ) ) {}
+
+  //! A zero-copy send whose Buffer must stay alive until the kernel reports completion
+  struct ZeroCopySend
+  {
+    uint32_t id;   //!< notification counter value assigned by the kernel
+    Buffer buffer; //!< reference keeping the payload alive
+    bool done;     //!< completion reported (possibly out of order)
+  };
+
+  size_t zerocopy_threshold_ {};                 //!< smallest write sent with MSG_ZEROCOPY (0 = disabled)
+  uint32_t zerocopy_next_id_ {};                 //!< id the kernel will assign to the next zero-copy send
+  std::deque<ZeroCopySend> zerocopy_pending_ {}; //!< zero-copy sends awaiting completion, in id order
 
 public:
+  //! Writes smaller than this are copied: pinning pages and reaping a completion costs more than a memcpy
+  static constexpr size_t kZeroCopyThreshold = 16384;
+
   //! Default: construct an unbound, unconnected TCP socket
   TCPSocket() : Socket( AF_INET, SOCK_STREAM ) {}
 
@@ -101,13 +153,78 @@ public:
 
   //! Accept a new incoming connection
   TCPSocket accept();
+
+  //! Default upper bound on connections accepted per accept_batch() call
+  static constexpr size_t kMaxAcceptBatch = 256;
+
+  //! \brief Accept every pending connection with [accept4(2)](\ref man2::accept4), up to `max_connections`
+  //! \details New sockets are created non-blocking and close-on-exec. On a non-blocking listener this drains
+  //! the backlog and may return an empty batch; on a blocking listener it waits for the first connection and
+  //! returns only that one.
+  std::vector<TCPSocket> accept_batch( size_t max_connections = kMaxAcceptBatch );
+
+  //! \brief Enable [MSG_ZEROCOPY](\ref man7::socket) sends for writes of at least `threshold` bytes
+  //! \details Sets SO_ZEROCOPY. Smaller writes, and all writes after the kernel reports that it had to copy
+  //! anyway (as on loopback), fall back to an ordinary copying write.
+  void set_zerocopy( size_t threshold = kZeroCopyThreshold );
+
+  //! \brief Write `buffer` starting at `offset`, without copying if zero-copy is enabled and worthwhile
+  //! \details The socket keeps a reference to `buffer` until the kernel has finished with its pages, so its
+  //! contents must not be modified until zerocopy_pending() no longer includes it.
+  //! \returns number of bytes written
+  size_t write_zerocopy( const Buffer& buffer, size_t offset = 0 );
+
+  //! \brief Drain completion notifications from the error queue and release finished Buffers
+  //! \details Never blocks. Each notification may cover a range of sends.
+  //! \returns the number of sends completed
+  size_t reap_zerocopy_completions();
+
+  //! Number of zero-copy sends whose Buffers are still held
+  size_t zerocopy_pending() const { return zerocopy_pending_.size(); }
 };
 
 //! A wrapper around [packet sockets](\ref man7:packet)
 class PacketSocket : public DatagramSocket
 {
+  std::unique_ptr<PacketRing> ring_ {}; //!< mmap'd TPACKET_V3 rings, if enabled
+
+  PacketRing& ring();
+
 public:
   PacketSocket( const int type, const int protocol ) : DatagramSocket( AF_PACKET, type, protocol ) {}
 
   void set_promiscuous();
+
+  //! \brief Attach a kernel-side filter with [SO_ATTACH_FILTER](\ref man7::socket), replacing any current one
+  //! \details Replacement is atomic: each frame is judged by either the old or the new filter, never neither.
+  //! Frames queued before the first filter is attached are not re-filtered, so to keep unwanted frames out
+  //! entirely, construct the socket with protocol 0 (which receives nothing) and bind() to the protocol
+  //! after attaching.
+  void attach_filter( const BPFFilter& filter );
+
+  //! Remove the kernel-side filter, so every frame is delivered again
+  void detach_filter();
+
+  //! \brief Switch to TPACKET_V3 and map an RX ring, a TX ring, or both, shared with the kernel
+  //! \details Must be called at most once, before bind() for best results. A TX ring's block_size must be a
+  //! multiple of its frame_size, so that no frame straddles two blocks.
+  void enable_rings( const std::optional<PacketRingConfig>& rx, const std::optional<PacketRingConfig>& tx = {} );
+
+  //! \brief Append zero-copy views of all frames waiting in the RX ring (never blocks)
+  //! \details The views stay valid until release_frames(), which returns their blocks to the kernel in bulk.
+  //! \returns the number of frames appended
+  size_t recv_frames( std::vector<std::string_view>& frames );
+
+  //! Return every RX block consumed by recv_frames() to the kernel
+  void release_frames();
+
+  //! \brief Copy a frame into the TX ring without a syscall
+  //! \returns false if the ring is full; call flush_frames() and retry
+  bool queue_frame( std::string_view frame );
+
+  //! Ask the kernel to transmit all queued frames with one [send(2)](\ref man2::send)
+  void flush_frames();
+
+  //! Number of frames from the TX ring the kernel refused to send (see PacketRing::rejected())
+  size_t rejected_frames();
 };
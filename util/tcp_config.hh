@@ -10,13 +10,38 @@
 class TCPConfig
 {
 public:
-  static constexpr size_t DEFAULT_CAPACITY = 64000; //!< Default capacity
-  static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Conservative max payload size for real Internet
-  static constexpr uint16_t TIMEOUT_DFLT = 1000;    //!< Default re-transmit timeout is 1 second
-  static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
+  //! Congestion-control algorithms for the sender
+  enum class CongestionControl : uint8_t
+  {
+    None,    //!< limited by the peer's window alone
+    NewReno, //!< RFC 5681 / RFC 6582
+    CUBIC,   //!< RFC 9438
+    BBR      //!< model-based: paces at the estimated bottleneck bandwidth (simplified BBRv1)
+  };
+
+  static constexpr size_t DEFAULT_CAPACITY = 64000;  //!< Default capacity
+  static constexpr size_t MAX_PAYLOAD_SIZE = 1000;   //!< Default MSS, conservative for the real Internet
+  static constexpr uint16_t TIMEOUT_DFLT = 1000;     //!< Default re-transmit timeout is 1 second
+  static constexpr unsigned MAX_RETX_ATTEMPTS = 8;   //!< Maximum re-transmit attempts before giving up
+  static constexpr uint16_t ACK_DELAY_DFLT = 40;     //!< Default delayed-ACK timeout is 40 milliseconds
+  static constexpr uint8_t MAX_WINDOW_SCALE = 14;    //!< Largest window shift allowed (RFC 7323 2.3)
+  static constexpr size_t MAX_SACK_BLOCKS = 3;       //!< Most SACK blocks an ACK carries (RFC 2018 3)
+  static constexpr size_t MAX_SUPER_SEGMENT = 65536; //!< Most bytes the sender reads at once, then splits up
+  static constexpr uint64_t MIN_RTO_DFLT = 200;      //!< Default floor of an estimated RTO, in milliseconds
+  static constexpr uint64_t MAX_RTO_DFLT = 60000;    //!< Default ceiling of an estimated RTO (RFC 6298 2.5)
+  static constexpr size_t HEADROOM = 96;             //!< Room before a payload for Ethernet+IPv4+TCP (14+20+60)
 
   uint16_t rt_timeout = TIMEOUT_DFLT;      //!< Initial value of the retransmission timeout, in milliseconds
   size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
   size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
+  uint16_t mss = MAX_PAYLOAD_SIZE;         //!< Largest payload to send or accept; offered on the SYN
+  uint16_t ack_delay = ACK_DELAY_DFLT;     //!< Longest an ACK may be held back, in milliseconds (0: never delay)
+  CongestionControl congestion_control = CongestionControl::None; //!< Sender's congestion control
+  bool window_scaling = true;                                     //!< Offer RFC 7323 window scaling on the SYN
+  bool sack = true;                                               //!< Send SACK blocks, if the peer permits
+  bool timestamps = true;                                         //!< Offer RFC 7323 timestamps on the SYN
+  bool estimate_RTO = false;                                      //!< Adapt the RTO to measured RTTs (RFC 6298)
+  uint64_t min_RTO_ms = MIN_RTO_DFLT;                             //!< Least the estimated RTO may be
+  uint64_t max_RTO_ms = MAX_RTO_DFLT;                             //!< Most the estimated RTO may be, backed off
   std::optional<Wrap32> fixed_isn {};
 };
@@ -2,23 +2,43 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstdint>
 #include <optional>
+#include <vector>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
  *
- * It contains two fields:
+ * It contains four fields:
  *
  * 1) The acknowledgment number (ackno): the *next* sequence number needed by the TCP Receiver.
  *    This is an optional field that is empty if the TCPReceiver hasn't yet received the Initial Sequence Number.
  *
  * 2) The window size. This is the number of sequence numbers that the TCP receiver is interested
  *    to receive, starting from the ackno if present. The maximum value is 65,535 (UINT16_MAX from
- *    the <cstdint> header).
+ *    the <cstdint> header). If the two endpoints negotiated window scaling on their SYNs, it is in
+ *    units of 2^shift bytes, for the shift the receiver's endpoint offered, except on a segment that
+ *    carries a SYN (RFC 7323 2.2).
+ *
+ * 3) SACK blocks (RFC 2018), if the sender's SYN permitted them: up to TCPConfig::MAX_SACK_BLOCKS runs of
+ *    sequence numbers the receiver holds beyond the ackno. The first is the run containing the most recently
+ *    received segment; the rest follow in sequence order.
+ *
+ * 4) The timestamp echo (RFC 7323 TSecr), if both endpoints' SYNs offered timestamps: the timestamp of the
+ *    latest segment to begin at or before the ackno last sent (RFC 7323 4.3): with delayed ACKs, the oldest
+ *    segment acknowledged, so the sample covers the delay.
  */
 
+struct SACKBlock
+{
+  Wrap32 begin { 0 }; // first sequence number held
+  Wrap32 end { 0 };   // one past the last
+};
+
 struct TCPReceiverMessage
 {
   std::optional<Wrap32> ackno {};
   uint16_t window_size {};
+  std::vector<SACKBlock> sack {};
+  std::optional<uint32_t> timestamp_echo {};
 };
@@ -0,0 +1,397 @@
+#include "tcp_segment.hh"
+#include "checksum.hh"
+#include "tcp_config.hh"
+#include "wire_io.hh"
+
+#include <algorithm>
+#include <span>
+
+using namespace std;
+
+namespace {
+
+// TCP option kinds (RFC 9293 3.1, RFC 7323, RFC 2018)
+constexpr uint8_t OPTION_END = 0;
+constexpr uint8_t OPTION_NOP = 1;
+constexpr uint8_t OPTION_MSS = 2;
+constexpr uint8_t OPTION_WINDOW_SCALE = 3;
+constexpr uint8_t OPTION_SACK_PERMITTED = 4;
+constexpr uint8_t OPTION_SACK = 5;
+constexpr uint8_t OPTION_TIMESTAMPS = 8;
+
+// TCP flags, in the low byte of the flags field
+constexpr uint8_t FLAG_FIN = 0x01;
+constexpr uint8_t FLAG_SYN = 0x02;
+constexpr uint8_t FLAG_RST = 0x04;
+constexpr uint8_t FLAG_ACK = 0x10;
+
+constexpr uint16_t IPV4_DONT_FRAGMENT = 0x4000;
+constexpr uint16_t IPV4_FRAGMENT_MASK = 0x3fff; // more-fragments flag and fragment offset
+constexpr uint8_t IPV4_DEFAULT_TTL = 64;
+
+static_assert( IPv4HeaderView::MIN_LENGTH + TCPHeaderView::MAX_LENGTH <= TCPConfig::HEADROOM );
+
+using wire::get16;
+using wire::get32;
+using wire::get8;
+using wire::put16;
+using wire::Writer;
+
+// Length of the options other than SACK that serialize_tcp_datagram() writes for `segment`
+size_t fixed_options_length( const TCPSegment& segment )
+{
+  const TCPSenderMessage& sent = segment.sender_message;
+
+  size_t length = 0;
+  if ( sent.SYN ) {
+    length += sent.MSS.has_value() ? 4 : 0;
+    length += sent.window_scale.has_value() ? 4 : 0; // NOP, then 3 bytes
+    length += sent.SACK_permitted ? 4 : 0;           // NOP, NOP, then 2 bytes
+  }
+  if ( sent.timestamp.has_value() or segment.receiver_message.timestamp_echo.has_value() ) {
+    length += 12; // NOP, NOP, then 10 bytes
+  }
+  return length;
+}
+
+// SACK blocks to send: the first ones, as many as fit in the option space the other options leave
+size_t sack_blocks( const TCPSegment& segment )
+{
+  const size_t room = TCPHeaderView::MAX_LENGTH - TCPHeaderView::MIN_LENGTH - fixed_options_length( segment );
+  const size_t fit = room >= 4 ? ( room - 4 ) / 8 : 0; // NOP, NOP, then 2 + 8 per block
+  return min( { segment.receiver_message.sack.size(), TCPConfig::MAX_SACK_BLOCKS, fit } );
+}
+
+// Length of the options serialize_tcp_datagram() writes for `segment`, padded to whole 32-bit words
+size_t options_length( const TCPSegment& segment )
+{
+  const size_t blocks = sack_blocks( segment );
+  return fixed_options_length( segment ) + ( blocks > 0 ? 4 + 8 * blocks : 0 );
+}
+
+void write_options( Writer& out, const TCPSegment& segment )
+{
+  const TCPSenderMessage& sent = segment.sender_message;
+  const TCPReceiverMessage& received = segment.receiver_message;
+
+  if ( sent.SYN and sent.MSS.has_value() ) {
+    out.u8( OPTION_MSS );
+    out.u8( 4 );
+    out.u16( *sent.MSS );
+  }
+  if ( sent.SYN and sent.window_scale.has_value() ) {
+    out.u8( OPTION_NOP );
+    out.u8( OPTION_WINDOW_SCALE );
+    out.u8( 3 );
+    out.u8( *sent.window_scale );
+  }
+  if ( sent.SYN and sent.SACK_permitted ) {
+    out.u8( OPTION_NOP );
+    out.u8( OPTION_NOP );
+    out.u8( OPTION_SACK_PERMITTED );
+    out.u8( 2 );
+  }
+  if ( sent.timestamp.has_value() or received.timestamp_echo.has_value() ) {
+    out.u8( OPTION_NOP );
+    out.u8( OPTION_NOP );
+    out.u8( OPTION_TIMESTAMPS );
+    out.u8( 10 );
+    out.u32( sent.timestamp.value_or( 0 ) );
+    out.u32( received.timestamp_echo.value_or( 0 ) );
+  }
+  const size_t blocks = sack_blocks( segment );
+  if ( blocks > 0 ) {
+    out.u8( OPTION_NOP );
+    out.u8( OPTION_NOP );
+    out.u8( OPTION_SACK );
+    out.u8( static_cast<uint8_t>( 2 + 8 * blocks ) );
+    for ( size_t i = 0; i < blocks; ++i ) {
+      out.u32( received.sack[i].begin.raw_value() );
+      out.u32( received.sack[i].end.raw_value() );
+    }
+  }
+}
+
+// Fill in the segment's fields from the options; false if they are malformed
+bool parse_options( string_view options, TCPSegment& segment )
+{
+  TCPSenderMessage& sent = segment.sender_message;
+  TCPReceiverMessage& received = segment.receiver_message;
+
+  while ( not options.empty() ) {
+    const uint8_t kind = get8( options, 0 );
+    if ( kind == OPTION_END ) {
+      break;
+    }
+    if ( kind == OPTION_NOP ) {
+      options.remove_prefix( 1 );
+      continue;
+    }
+    if ( options.size() < 2 or get8( options, 1 ) < 2 or get8( options, 1 ) > options.size() ) {
+      return false;
+    }
+    const string_view option = options.substr( 0, get8( options, 1 ) );
+    options.remove_prefix( option.size() );
+
+    switch ( kind ) {
+      case OPTION_MSS:
+        if ( option.size() == 4 and sent.SYN ) {
+          sent.MSS = get16( option, 2 );
+        }
+        break;
+      case OPTION_WINDOW_SCALE:
+        if ( option.size() == 3 and sent.SYN ) {
+          sent.window_scale = get8( option, 2 );
+        }
+        break;
+      case OPTION_SACK_PERMITTED:
+        sent.SACK_permitted = option.size() == 2 and sent.SYN;
+        break;
+      case OPTION_TIMESTAMPS:
+        if ( option.size() == 10 ) {
+          sent.timestamp = get32( option, 2 );
+          if ( received.ackno.has_value() ) { // TSecr is only valid on an ACK (RFC 7323 3.2)
+            received.timestamp_echo = get32( option, 6 );
+          }
+        }
+        break;
+      case OPTION_SACK:
+        if ( option.size() % 8 != 2 ) {
+          return false;
+        }
+        for ( size_t offset = 2; offset < option.size(); offset += 8 ) {
+          received.sack.push_back( { Wrap32 { get32( option, offset ) }, Wrap32 { get32( option, offset + 4 ) } } );
+        }
+        break;
+      default:
+        break; // unknown options are skipped
+    }
+  }
+  return true;
+}
+
+// The sum of the TCP pseudo-header (RFC 9293 3.1)
+InternetChecksum pseudo_header( uint32_t source, uint32_t destination, size_t tcp_length )
+{
+  InternetChecksum sum;
+  sum.add_u32( source );
+  sum.add_u32( destination );
+  sum.add_u16( IPv4HeaderView::PROTOCOL_TCP );
+  sum.add_u16( static_cast<uint16_t>( tcp_length ) );
+  return sum;
+}
+
+} // namespace
+
+/* IPv4HeaderView */
+
+uint8_t IPv4HeaderView::version() const
+{
+  return static_cast<uint8_t>( get8( bytes_, 0 ) >> 4 ); // NOLINT(*-bitwise)
+}
+
+size_t IPv4HeaderView::header_length() const
+{
+  return size_t { get8( bytes_, 0 ) & 0x0fU } * 4; // NOLINT(*-bitwise)
+}
+
+uint16_t IPv4HeaderView::total_length() const
+{
+  return get16( bytes_, 2 );
+}
+
+uint16_t IPv4HeaderView::id() const
+{
+  return get16( bytes_, 4 );
+}
+
+uint8_t IPv4HeaderView::ttl() const
+{
+  return get8( bytes_, 8 );
+}
+
+uint8_t IPv4HeaderView::protocol() const
+{
+  return get8( bytes_, 9 );
+}
+
+uint16_t IPv4HeaderView::checksum() const
+{
+  return get16( bytes_, 10 );
+}
+
+uint32_t IPv4HeaderView::source() const
+{
+  return get32( bytes_, 12 );
+}
+
+uint32_t IPv4HeaderView::destination() const
+{
+  return get32( bytes_, 16 );
+}
+
+/* TCPHeaderView */
+
+uint16_t TCPHeaderView::source_port() const
+{
+  return get16( bytes_, 0 );
+}
+
+uint16_t TCPHeaderView::destination_port() const
+{
+  return get16( bytes_, 2 );
+}
+
+Wrap32 TCPHeaderView::seqno() const
+{
+  return Wrap32 { get32( bytes_, 4 ) };
+}
+
+Wrap32 TCPHeaderView::ackno() const
+{
+  return Wrap32 { get32( bytes_, 8 ) };
+}
+
+size_t TCPHeaderView::header_length() const
+{
+  return static_cast<size_t>( get8( bytes_, 12 ) >> 4 ) * 4; // NOLINT(*-bitwise)
+}
+
+bool TCPHeaderView::fin() const
+{
+  return ( get8( bytes_, 13 ) & FLAG_FIN ) != 0; // NOLINT(*-bitwise)
+}
+
+bool TCPHeaderView::syn() const
+{
+  return ( get8( bytes_, 13 ) & FLAG_SYN ) != 0; // NOLINT(*-bitwise)
+}
+
+bool TCPHeaderView::rst() const
+{
+  return ( get8( bytes_, 13 ) & FLAG_RST ) != 0; // NOLINT(*-bitwise)
+}
+
+bool TCPHeaderView::ack() const
+{
+  return ( get8( bytes_, 13 ) & FLAG_ACK ) != 0; // NOLINT(*-bitwise)
+}
+
+uint16_t TCPHeaderView::window() const
+{
+  return get16( bytes_, 14 );
+}
+
+uint16_t TCPHeaderView::checksum() const
+{
+  return get16( bytes_, 16 );
+}
+
+/* parsing and serializing */
+
+optional<ParsedTCPDatagram> parse_tcp_datagram( const Buffer& datagram )
+{
+  const string_view bytes = datagram;
+
+  // IPv4: a whole, unfragmented datagram carrying TCP, with a good header checksum
+  if ( bytes.size() < IPv4HeaderView::MIN_LENGTH ) {
+    return {};
+  }
+  const IPv4HeaderView probe { bytes };
+  const size_t ip_length = probe.header_length();
+  if ( probe.version() != 4 or ip_length < IPv4HeaderView::MIN_LENGTH or probe.total_length() > bytes.size()
+       or probe.total_length() < ip_length + TCPHeaderView::MIN_LENGTH
+       or ( get16( bytes, 6 ) & IPV4_FRAGMENT_MASK ) != 0 // NOLINT(*-bitwise)
+       or probe.protocol() != IPv4HeaderView::PROTOCOL_TCP ) {
+    return {};
+  }
+  const IPv4HeaderView ip { bytes.substr( 0, ip_length ) };
+  InternetChecksum ip_sum;
+  ip_sum.add( ip.bytes() );
+  if ( ip_sum.value() != 0 ) {
+    return {};
+  }
+
+  // TCP: a header that fits, and a good checksum over the pseudo-header, header and payload
+  const string_view tcp_bytes = bytes.substr( ip_length, probe.total_length() - ip_length );
+  const size_t tcp_length = TCPHeaderView { tcp_bytes }.header_length();
+  if ( tcp_length < TCPHeaderView::MIN_LENGTH or tcp_length > tcp_bytes.size() ) {
+    return {};
+  }
+  InternetChecksum tcp_sum = pseudo_header( ip.source(), ip.destination(), tcp_bytes.size() );
+  tcp_sum.add( tcp_bytes );
+  if ( tcp_sum.value() != 0 ) {
+    return {};
+  }
+
+  const TCPHeaderView tcp { tcp_bytes.substr( 0, tcp_length ) };
+  ParsedTCPDatagram parsed { ip,
+                             tcp,
+                             { { ip.destination(), tcp.destination_port() }, { ip.source(), tcp.source_port() } },
+                             {} };
+  TCPSegment& segment = parsed.segment;
+  segment.sender_message.seqno = tcp.seqno();
+  segment.sender_message.SYN = tcp.syn();
+  segment.sender_message.FIN = tcp.fin();
+  segment.sender_message.payload = datagram.slice( ip_length + tcp_length, tcp_bytes.size() - tcp_length );
+  segment.receiver_message.ackno = tcp.ack() ? optional { tcp.ackno() } : nullopt;
+  segment.receiver_message.window_size = tcp.window();
+  segment.reset = tcp.rst();
+  if ( not parse_options( tcp.options(), segment ) ) {
+    return {};
+  }
+  return parsed;
+}
+
+Buffer serialize_tcp_datagram( const IPv4FourTuple& flow, const TCPSegment& segment )
+{
+  const TCPSenderMessage& sent = segment.sender_message;
+  const TCPReceiverMessage& received = segment.receiver_message;
+
+  const size_t tcp_header_length = TCPHeaderView::MIN_LENGTH + options_length( segment );
+  const size_t header_length = IPv4HeaderView::MIN_LENGTH + tcp_header_length;
+  Buffer datagram = sent.payload.headroom() >= header_length
+                      ? sent.payload
+                      : Buffer::with_headroom( TCPConfig::HEADROOM, sent.payload );
+  const size_t tcp_length = tcp_header_length + datagram.size();
+  const span<char> headers = datagram.prepend( header_length );
+
+  // IPv4 header
+  Writer ip { headers };
+  ip.u8( 0x45 ); // version 4, 5 words
+  ip.u8( 0 );    // DSCP and ECN
+  ip.u16( static_cast<uint16_t>( IPv4HeaderView::MIN_LENGTH + tcp_length ) );
+  ip.u16( 0 ); // id: unused, as the datagram may not be fragmented (RFC 6864)
+  ip.u16( IPV4_DONT_FRAGMENT );
+  ip.u8( IPV4_DEFAULT_TTL );
+  ip.u8( IPv4HeaderView::PROTOCOL_TCP );
+  ip.u16( 0 ); // checksum, filled in below
+  ip.u32( flow.local.ip );
+  ip.u32( flow.remote.ip );
+
+  // TCP header
+  Writer tcp { headers.subspan( IPv4HeaderView::MIN_LENGTH ) };
+  tcp.u16( flow.local.port );
+  tcp.u16( flow.remote.port );
+  tcp.u32( sent.seqno.raw_value() );
+  tcp.u32( received.ackno.value_or( Wrap32 { 0 } ).raw_value() );
+  tcp.u8( static_cast<uint8_t>( tcp_header_length / 4 << 4 ) ); // NOLINT(*-bitwise)
+  tcp.u8( static_cast<uint8_t>( ( sent.FIN ? FLAG_FIN : 0 ) | ( sent.SYN ? FLAG_SYN : 0 )       // NOLINT(*-bitwise)
+                                | ( segment.reset ? FLAG_RST : 0 )                              // NOLINT(*-bitwise)
+                                | ( received.ackno.has_value() ? FLAG_ACK : 0 ) ) );            // NOLINT(*-bitwise)
+  tcp.u16( received.window_size );
+  tcp.u16( 0 ); // checksum, filled in below
+  tcp.u16( 0 ); // urgent pointer
+  write_options( tcp, segment );
+
+  // Checksums: the IPv4 header's, then the TCP segment's, over its pseudo-header and the payload in place
+  InternetChecksum ip_sum;
+  ip_sum.add( { headers.data(), IPv4HeaderView::MIN_LENGTH } );
+  put16( headers, 10, ip_sum.value() );
+
+  InternetChecksum tcp_sum = pseudo_header( flow.local.ip, flow.remote.ip, tcp_length );
+  tcp_sum.add( string_view { datagram }.substr( IPv4HeaderView::MIN_LENGTH ) );
+  put16( headers, IPv4HeaderView::MIN_LENGTH + 16, tcp_sum.value() );
+
+  return datagram;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "buffer.hh"
+#include "ipv4_endpoint.hh"
+#include "tcp_receiver_message.hh"
+#include "tcp_sender_message.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+//! \brief What one TCP segment carries: a TCPSender's message, its endpoint's TCPReceiver's message, and RST
+//! \details On the wire, the receiver's half is the ACK flag and ackno, the window, and the SACK option; the
+//! sender's is everything else, with the SYN's options (MSS, window scale, SACK-permitted). The timestamp
+//! option carries both halves (the sender's TSval, the receiver's TSecr) whenever either has a value.
+struct TCPSegment
+{
+  TCPSenderMessage sender_message {};
+  TCPReceiverMessage receiver_message {};
+  bool reset {}; //!< RST flag
+};
+
+//! A read-only view of an IPv4 header, decoding fields on access
+class IPv4HeaderView
+{
+  std::string_view bytes_;
+
+public:
+  static constexpr size_t MIN_LENGTH = 20;  //!< without options
+  static constexpr uint8_t PROTOCOL_TCP = 6; //!< protocol() of a datagram carrying TCP
+
+  explicit IPv4HeaderView( std::string_view bytes ) : bytes_( bytes ) {}
+
+  uint8_t version() const;
+  size_t header_length() const; //!< in bytes, options included
+  uint16_t total_length() const;
+  uint16_t id() const;
+  uint8_t ttl() const;
+  uint8_t protocol() const;
+  uint16_t checksum() const;
+  uint32_t source() const;      //!< host byte order
+  uint32_t destination() const; //!< host byte order
+
+  std::string_view bytes() const { return bytes_; } //!< the header, options included
+};
+
+//! A read-only view of a TCP header, decoding fields on access
+class TCPHeaderView
+{
+  std::string_view bytes_;
+
+public:
+  static constexpr size_t MIN_LENGTH = 20; //!< without options
+  static constexpr size_t MAX_LENGTH = 60; //!< with 40 bytes of options
+
+  explicit TCPHeaderView( std::string_view bytes ) : bytes_( bytes ) {}
+
+  uint16_t source_port() const;
+  uint16_t destination_port() const;
+  Wrap32 seqno() const;
+  Wrap32 ackno() const;
+  size_t header_length() const; //!< in bytes, options included
+  bool fin() const;
+  bool syn() const;
+  bool rst() const;
+  bool ack() const;
+  uint16_t window() const;
+  uint16_t checksum() const;
+
+  std::string_view options() const { return bytes_.substr( MIN_LENGTH ); }
+  std::string_view bytes() const { return bytes_; } //!< the header, options included
+};
+
+//! A received IPv4 datagram carrying TCP, parsed in place
+struct ParsedTCPDatagram
+{
+  IPv4HeaderView ip;
+  TCPHeaderView tcp;
+  IPv4FourTuple flow;  //!< from the receiving end's point of view: `remote` sent it to `local`
+  TCPSegment segment; //!< its payload is a slice of the datagram, which it keeps alive (and the views valid)
+};
+
+//! \brief Parse an IPv4 datagram carrying a TCP segment, without copying the payload
+//! \details Bytes past the IPv4 total length (link-layer padding) are ignored.
+//! \returns empty if the datagram is malformed, fragmented, not TCP, or fails either checksum
+std::optional<ParsedTCPDatagram> parse_tcp_datagram( const Buffer& datagram );
+
+//! \brief The IPv4 datagram carrying `segment` from `flow.local` to `flow.remote`, checksums filled in
+//! \details The headers are written into the headroom in front of the payload (see Buffer::with_headroom()
+//! and TCPConfig::HEADROOM), so the datagram shares the payload's storage. Only the first datagram serialized
+//! from a payload gets its headroom (see Buffer::prepend()); a payload without enough headroom, like one sent
+//! again, is copied once into a Buffer that has it. SACK blocks that don't fit in the 40 bytes of options the
+//! others leave are left out, last first, as other stacks do.
+Buffer serialize_tcp_datagram( const IPv4FourTuple& flow, const TCPSegment& segment );
@@ -3,12 +3,14 @@
 #include "buffer.hh"
 #include "wrapping_integers.hh"
 
+#include <cstdint>
+#include <optional>
 #include <string>
 
 /*
  * The TCPSenderMessage structure contains the information sent from a TCP sender to its receiver.
  *
- * It contains four fields:
+ * It contains eight fields:
  *
  * 1) The sequence number (seqno) of the beginning of the segment. If the SYN flag is set, this is the
  *    sequence number of the SYN flag. Otherwise, it's the sequence number of the beginning of the payload.
@@ -19,6 +21,19 @@
  * 3) The payload: a substring (possibly empty) of the byte stream.
  *
  * 4) The FIN flag. If set, it means the payload represents the ending of the byte stream.
+ *
+ * 5) The window scale (RFC 7323), only ever on a SYN: the shift that this endpoint's receiver will apply to
+ *    the windows it advertises. Windows are scaled in both directions only if both SYNs carry it.
+ *
+ * 6) The SACK-permitted flag (RFC 2018), only ever on a SYN: this endpoint's sender understands SACK blocks,
+ *    so the peer's receiver may send them.
+ *
+ * 7) The maximum segment size (RFC 9293 3.7.1), only ever on a SYN: the largest payload this endpoint will
+ *    accept. A peer whose SYN carried none is sent at most TCPConfig::MAX_PAYLOAD_SIZE bytes per segment.
+ *
+ * 8) The timestamp (RFC 7323 TSval): the sender's clock, in milliseconds, when the segment went out. The peer's
+ *    receiver echoes it back so the sender can time the round trip. On a SYN, it offers the option; later
+ *    segments carry it only if both SYNs did.
  */
 
 struct TCPSenderMessage
@@ -27,6 +42,10 @@ struct TCPSenderMessage
   bool SYN { false };
   Buffer payload {};
   bool FIN { false };
+  std::optional<uint8_t> window_scale {};
+  bool SACK_permitted { false };
+  std::optional<uint16_t> MSS {};
+  std::optional<uint32_t> timestamp {};
 
   // How many sequence numbers does this segment use?
   size_t sequence_length() const { return SYN + payload.size() + FIN; }
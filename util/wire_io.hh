@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+// Big-endian (network order) field access, shared by the header parsers and serializers in this directory
+namespace wire {
+
+inline uint8_t get8( std::string_view bytes, size_t offset )
+{
+  return static_cast<uint8_t>( bytes[offset] );
+}
+
+inline uint16_t get16( std::string_view bytes, size_t offset )
+{
+  return static_cast<uint16_t>( get8( bytes, offset ) << 8 | get8( bytes, offset + 1 ) ); // NOLINT(*-bitwise)
+}
+
+inline uint32_t get32( std::string_view bytes, size_t offset )
+{
+  return uint32_t { get16( bytes, offset ) } << 16 | get16( bytes, offset + 2 ); // NOLINT(*-bitwise)
+}
+
+// Writes big-endian fields at a moving position
+class Writer
+{
+  char* next_;
+
+public:
+  explicit Writer( std::span<char> out ) : next_( out.data() ) {}
+
+  void u8( uint8_t value ) { *next_++ = static_cast<char>( value ); }
+
+  void u16( uint16_t value )
+  {
+    u8( static_cast<uint8_t>( value >> 8 ) ); // NOLINT(*-bitwise)
+    u8( static_cast<uint8_t>( value ) );
+  }
+
+  void u32( uint32_t value )
+  {
+    u16( static_cast<uint16_t>( value >> 16 ) ); // NOLINT(*-bitwise)
+    u16( static_cast<uint16_t>( value ) );
+  }
+
+  void bytes( std::span<const uint8_t> data ) { next_ = std::copy( data.begin(), data.end(), next_ ); }
+};
+
+inline void put16( std::span<char> out, size_t offset, uint16_t value )
+{
+  Writer { out.subspan( offset ) }.u16( value );
+}
+
+} // namespace wire